@@ -7,6 +7,7 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "HSFModelMapping.h"
 
 /*!
  @abstract SOAP action with NSURLRequest as a derived property.
@@ -24,15 +25,135 @@
  */
 @property (nonatomic,readonly) NSTimeInterval timeout;
 
+/*!
+ @abstract Priority of the action in HSFClient wait queue.
+ @discussion Catchers waiting for a connection to a host are admitted in order of priority, higher first, then in order of arrival. Default value is 0.
+ */
+@property (nonatomic,readonly) NSInteger loadPriority;
+
+/*!
+ @abstract Group tags of the action.
+ @discussion Array of NSString. Catchers of the action could be cancelled together with cancelCatchersWithTag: of HSFClient, e.g. all requests of one screen or one batch. Default value is empty array.
+ */
+@property (strong,nonatomic,readonly) NSArray *groupTags;
+
 /*!
  @abstract Determine wether parse specialized units asynchronously.
  @discussion Default value is NO;
  */
 @property (nonatomic,getter=isParseUnitsAsynchronously) BOOL parseUnitsAsynchronously;
 
+/*!
+ @abstract Maximum number of units parsed at the same time.
+ @discussion Used if parseUnitsAsynchronously is YES. Units are still delivered in document order. 0 means units are parsed on the worker pool shared by HSFClient. Default value is 1.
+ */
+@property (nonatomic,readonly) NSUInteger parseConcurrency;
+
+/*!
+ @abstract Maximum number of units in a batch.
+ @discussion Used if the delegate implements catcher:didReceiveUnits:. A batch is delivered when it reaches unitBatchSize units, unitBatchLength bytes or unitBatchInterval age, whichever comes first. 0 means no limit. Default value is HSF_UNIT_BATCH_SIZE.
+ */
+@property (nonatomic,readonly) NSUInteger unitBatchSize;
+
+/*!
+ @abstract Maximum size of a batch in bytes of raw XML of its units.
+ @discussion See unitBatchSize. 0 means no limit. Default value is HSF_UNIT_BATCH_LENGTH.
+ */
+@property (nonatomic,readonly) NSUInteger unitBatchLength;
+
+/*!
+ @abstract Seconds the first unit of a batch waits for delivery.
+ @discussion See unitBatchSize. 0 means no limit, so a batch waits for the count or the size. Default value is HSF_UNIT_BATCH_INTERVAL.
+ */
+@property (nonatomic,readonly) NSTimeInterval unitBatchInterval;
+
+/*!
+ @abstract Seconds a response of the action stays in HSFClient response cache.
+ @discussion If greater than 0, a response is cached and identical actions (same class, URL, SOAPAction header and body) are answered from the cache until it expires, units and entire response are replayed without network. Meant for idempotent lookups. Default value is 0.
+ */
+@property (nonatomic,readonly) NSTimeInterval cacheLifetime;
+
+/*!
+ @abstract Determine whether identical actions in flight share one catcher.
+ @discussion If YES, HSFClient joins a duplicate of an action in flight (same class, URL, SOAPAction header, body, credential and HTTP header fields) to the catcher of the first one, until the response starts and only if both delegates respond to the same callbacks, so every delegate receives the units and the entire response from one download and one parse. Meant for read-only actions. Default value is NO.
+ */
+@property (nonatomic,readonly,getter=isCoalescable) BOOL coalescable;
+
+/*!
+ @abstract Determine whether XML special characters of string parameter values are escaped.
+ @discussion If YES, &, < and > in NSString values of SOAPParameters (and in descriptions of other objects) are replaced with entities. Earlier versions inserted string values as they are, so subclasses which put XML markup into string values must either pass it as NSData or return NO here to keep the old behaviour. Default value is YES.
+ */
+@property (nonatomic,readonly,getter=isEscapesParameterValues) BOOL escapesParameterValues;
+
+/*!
+ @abstract Determine whether parse entire response while it is downloading.
+ @discussion If YES, entire response is fed to HSFNodePushParser chunk by chunk instead of being collected and parsed after loading, so raw response is not kept in memory. Root node's treeData is nil in this mode. Default value is NO.
+ */
+@property (nonatomic,readonly,getter=isParseEntireResponseIncrementally) BOOL parseEntireResponseIncrementally;
+
+/*!
+ @abstract Size in bytes above which entire response is kept on disk.
+ @discussion If entire response is collected and grows beyond this size, the catcher writes it into a temporary file and parses the tree from a read-only memory map of the file. The file is removed when the catcher finishes or is cancelled. If writing the file fails, loading fails with the file error (NSPOSIXErrorDomain). 0 means entire response is always kept in memory. Default value is 0.
+ */
+@property (nonatomic,readonly) NSUInteger spillThreshold;
+
+/*!
+ @abstract Determine whether build compact node trees.
+ @discussion If YES, units and entire response are parsed with compactNodeTreeFromData:error:, so HSFNodes and their strings are made lazily. Entire response is not compact if parseEntireResponseIncrementally is YES. Default value is NO.
+ */
+@property (nonatomic,readonly,getter=isCompactNodeTree) BOOL compactNodeTree;
+
+/*!
+ @abstract Determine whether catchers of the action class share one symbol table.
+ @discussion Element names and attribute keys are interned in HSFSymbolTable while parsing. If YES, the table lives as long as the application does and is shared by every response of the action class, otherwise each response has its own table. Default value is NO.
+ */
+@property (nonatomic,readonly,getter=isSharesSymbolTable) BOOL sharesSymbolTable;
+
+/*!
+ @abstract Determine whether request and response are compressed.
+ @discussion If YES, request body is sent gzipped with Content-Encoding header, and gzip and deflate responses are accepted. A response is decompressed chunk by chunk as it comes, before units and streaming tags are extracted, if its Content-Encoding is gzip or deflate; deflate may come with or without zlib header. Responses decoded by the URL loading system itself are passed through. The server must accept gzipped requests. Default value is NO.
+ */
+@property (nonatomic,readonly,getter=isCompressesMessages) BOOL compressesMessages;
+
+/*!
+ @abstract Directory for attachments of MTOM response.
+ @discussion If set, binary parts of multipart/related response are written into new files of this directory as they come, and the delegate is notified with catcher:didSaveAttachmentAtPath:forContentID:. Otherwise the bytes are passed to catcher:didReceiveAttachmentData:forContentID:lastChunk:. Files belong to the application, they are not removed. Default value is nil.
+ */
+@property (strong,nonatomic,readonly) NSString *attachmentDirectory;
+
+/*!
+ @abstract Determine whether HTTP body is streamed.
+ @discussion YES if a value of SOAPParameters is HSFStreamedParameter. Then the request has no HTTP body, the catcher sends HTTPBodyParts as a body stream with Content-Length, so large content is never held in memory. Streamed body is not compressed, its responses are neither cached nor coalesced.
+ */
+@property (nonatomic,readonly,getter=isStreamsBody) BOOL streamsBody;
+
+/*!
+ @abstract Parts of streamed HTTP body.
+ @discussion Array of NSData and HSFStreamedParameter made by HSFEnvelopeTemplate, nil if the body is not streamed.
+ */
+@property (strong,nonatomic,readonly) NSArray *HTTPBodyParts;
+
+/*!
+ @abstract Mapping of units to model objects.
+ @discussion If set and the delegate implements catcher:didReceiveUnitObject: or catcher:didReceiveUnits:, units are decoded with HSFModelDecoder straight into model objects instead of HSFNode trees, and catcher:didReceiveUnit: is not called. Default value is nil.
+ */
+@property (strong,nonatomic,readonly) HSFModelMapping *unitModelMapping;
+
+/*!
+ @abstract Mapping of entire response to model object.
+ @discussion If set and the delegate implements catcher:didReceiveResponseObject:, entire response is decoded chunk by chunk while it is downloading, no tree is made and raw response is not kept for it. Default value is nil.
+ */
+@property (strong,nonatomic,readonly) HSFModelMapping *responseModelMapping;
+
+/*!
+ @abstract Path of the element of entire response decoded with responseModelMapping.
+ @discussion Path from the document element by local names, e.g. @"Envelope/Body/GetItemResponse". nil means the document element. Default value is nil.
+ */
+@property (strong,nonatomic,readonly) NSString *responseModelPath;
+
 /*!
  @abstract Tags that represent units.
- @discussion Will be copied to HSFActionStamp's unitTags.
+ @discussion Will be copied to HSFActionStamp's unitTags. A tag may be a path selector with namespace URIs, e.g. @"Body/GetOrdersResponse/Orders/{http://example.com/orders}Order", see HSFTagScanner.
  */
 @property (strong,nonatomic) NSArray *unitTags;
 
@@ -40,7 +161,7 @@
 
 /*!
  @abstract Tags that represent streaming data.
- @discussion Will be copied to HSFActionStamp's stramingTags.
+ @discussion Will be copied to HSFActionStamp's stramingTags. A tag may be a path selector, like in unitTags.
  */
 @property (strong,nonatomic) NSArray *streamingTags;
 
@@ -64,7 +185,7 @@
 
 /*!
  @abstract Automatic reload maximum timeout.
- @discussion Using this value and number of loadAttempts timeout step will be determined. After the expiration of this step new shot to connect will be taken.
+ @discussion Timeout before a new shot to connect is doubled after every attempt, so that it reaches this value before the last attempt. Half of each timeout is random jitter.
  */
 @property (nonatomic) NSTimeInterval maxTimeout;
 
@@ -118,7 +239,7 @@
 
 /*!
  @abstract Parameters for SOAP XML document.
- @discussion These parameters will be used in SOAP envelope e.g. @{@"key":@"value"} would become <key>value</key> in the XML document. Throws an exception if resulting XML document won't be valid. It is an abstract method and must to be customized in subclasses.
+ @discussion These parameters will be used in SOAP envelope e.g. @{@"key":@"value"} would become <key>value</key> in the XML document. String values are escaped unless escapesParameterValues is NO; NSData values are inserted as raw UTF-8 XML. NSNull values become nil elements. HSFStreamedParameter values are read from files or streams while the request is sent. Envelope is compiled once per subclass (see HSFEnvelopeTemplate), an exception is thrown if it won't be valid. It is an abstract method and must to be customized in subclasses.
  @param parameters The NSDictionary of NSStrings.
  */
 @property (strong,nonatomic,readonly) NSDictionary *SOAPParameters;
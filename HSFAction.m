@@ -9,6 +9,10 @@
 #import "HSFAction.h"
 #import "HSFCommon.h"
 #import "HSFExceptions.h"
+#import "HSFEnvelopeTemplate.h"
+#import "HSFInflater.h"
+#import "HSFStreamedParameter.h"
+#import "HSFBodyStream.h"
 
 @interface HSFAction(){
     // _request is an actual, important NSURLRequest.
@@ -30,6 +34,16 @@
     return DEFAULT_CONNECTION_TIMEOUT;
 }
 
+-(NSInteger)loadPriority
+{
+    return 0;
+}
+
+-(NSArray*)groupTags
+{
+    return @[];
+}
+
 -(NSDictionary*)HTTPHeaderFields
 {
     [NSException raise:HSFAbstractNotOverridden format:@"You must override %@ in a subclass", NSStringFromSelector(_cmd)];
@@ -74,7 +88,7 @@
 
 -(NSString*)HTTPBody
 {
-    return [[NSString alloc] initWithData:[self.request HTTPBody] encoding:NSUTF8StringEncoding];
+    return [[NSString alloc] initWithData:[self envelopeData] encoding:NSUTF8StringEncoding];
 }
 
 -(BOOL)isParseUnitsAsynchronously
@@ -82,6 +96,102 @@
     return NO;
 }
 
+-(NSUInteger)parseConcurrency
+{
+    return 1;
+}
+
+-(NSUInteger)unitBatchSize
+{
+    return HSF_UNIT_BATCH_SIZE;
+}
+
+-(NSUInteger)unitBatchLength
+{
+    return HSF_UNIT_BATCH_LENGTH;
+}
+
+-(NSTimeInterval)unitBatchInterval
+{
+    return HSF_UNIT_BATCH_INTERVAL;
+}
+
+-(NSTimeInterval)cacheLifetime
+{
+    return 0.0;
+}
+
+-(BOOL)isCoalescable
+{
+    return NO;
+}
+
+-(BOOL)isEscapesParameterValues
+{
+    return YES;
+}
+
+-(BOOL)isParseEntireResponseIncrementally
+{
+    return NO;
+}
+
+-(NSUInteger)spillThreshold
+{
+    return 0;
+}
+
+-(BOOL)isCompactNodeTree
+{
+    return NO;
+}
+
+-(BOOL)isSharesSymbolTable
+{
+    return NO;
+}
+
+-(BOOL)isCompressesMessages
+{
+    return NO;
+}
+
+-(NSString*)attachmentDirectory
+{
+    return nil;
+}
+
+-(BOOL)isStreamsBody
+{
+    for (id value in [self.SOAPParameters allValues]){
+        if ([value isKindOfClass:[HSFStreamedParameter class]]) return YES;
+    }
+    return NO;
+}
+
+-(NSArray*)HTTPBodyParts
+{
+    if (!self.isStreamsBody) return nil;
+    NSDictionary *parameters = self.SOAPParameters;
+    HSFEnvelopeTemplate *template = [HSFEnvelopeTemplate templateForAction:self parameters:parameters];
+    return [template bodyPartsWithParameters:parameters];
+}
+
+-(HSFModelMapping*)unitModelMapping
+{
+    return nil;
+}
+
+-(HSFModelMapping*)responseModelMapping
+{
+    return nil;
+}
+
+-(NSString*)responseModelPath
+{
+    return nil;
+}
+
 -(NSArray*)unitTags
 {
     if (!_unitTags)_unitTags = @[];
@@ -146,14 +256,18 @@
     //Getting URL
     NSString *url = [[NSString alloc] initWithFormat:@"%@\n",[self.url absoluteString]];
     
+    // Request is made once for all parts.
+    NSURLRequest *request = self.request;
+    
     //Getting HTTP Method
-    NSString *httpMethod = [NSString stringWithFormat:@"METHOD: %@\n",[self.request HTTPMethod]];
+    NSString *httpMethod = [NSString stringWithFormat:@"METHOD: %@\n",[request HTTPMethod]];
     
     //Getting HTTP header
-    NSString *httpHeader = [NSString stringWithFormat:@"HEADER:\n%@\n",[self.request allHTTPHeaderFields]];
+    NSString *httpHeader = [NSString stringWithFormat:@"HEADER:\n%@\n",[request allHTTPHeaderFields]];
     
-    //Getting HTTP body
-    NSString *body = [NSString stringWithFormat:@"BODY:\n%@",[[NSString alloc] initWithData:[self.request HTTPBody] encoding:NSUTF8StringEncoding]];
+    //Getting HTTP body, compressed and streamed ones are shown as the envelope.
+    NSData *bodyData = (self.isCompressesMessages || self.isStreamsBody) ? [self envelopeData] : [request HTTPBody];
+    NSString *body = [NSString stringWithFormat:@"BODY:\n%@",[[NSString alloc] initWithData:bodyData encoding:NSUTF8StringEncoding]];
     
     //Print signature
     NSString *signature = [url stringByAppendingString:[httpMethod stringByAppendingString:[httpHeader stringByAppendingString:body]]];
@@ -169,61 +283,35 @@
 #pragma mark Private Methods
 
 /*
- Make xml SOAP document from parameters dictionary.
- Depends on a bunch of public methods that are meant to be customize at subclassing.
+ SOAP envelope from compiled envelope template.
+ The template is validated once, so the body is not re-parsed.
  */
--(NSString*)xmlForParameters:(NSDictionary*)parameters order:(NSArray*)order
+-(NSData*)envelopeData
 {
-    //TODO: refactor this code by using libXML2 with defines.
-    
-    NSMutableString *body;
-    NSString *SOAPTag = [[NSString alloc] initWithFormat:@"%@ %@",self.SOAPAction,self.attributesForSOAPActionTag];
-    SOAPTag = [SOAPTag stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-    
-    if ([parameters count] > 0){
-        body = [NSMutableString stringWithFormat:@"<%@>", SOAPTag];
-        //We assume that parameter order does not matter.
-        NSArray *keyOrder = (order.count)?order:[parameters allKeys];
-        for (id key in keyOrder) {
-            id value = parameters[key];
-            if (![value isKindOfClass:[NSNull class]]){
-                [body appendFormat:@"<%@>%@</%@>", key, value, key];
-            } else {
-                if (self.nilAttribute.length) {
-                    [body appendFormat:@"<%@ %@/>",key,self.nilAttribute];
-                } else {
-                    [body appendFormat:@"<%@ />",key];
-                }
-            }
-        }
-        [body appendString:[NSString stringWithFormat:@"</%@>", self.SOAPAction]];
-    } else {
-        body = [NSMutableString stringWithFormat:@"<%@ />", SOAPTag];
-    }
-    
-    NSString *xml = [[NSString alloc] initWithFormat:@"%@%@%@",self.SOAPEnvelopeHead,body,self.SOAPEnvelopeTail];
-    
-    // Check xml for valid xml document.
-    NSXMLParser *parser = [[NSXMLParser alloc] initWithData:[xml dataUsingEncoding:NSUTF8StringEncoding]];
-    [parser parse];
-    if ([parser parserError]){
-#ifdef DEBUG
-        NSLog(@"[%@ %@] EXCEPTION underlying XML: %@",[self class],NSStringFromSelector(_cmd),xml);
-        [NSException raise:HSFInvalidXMLException format:@"XML document underlying HSFAction is not valid."];
-#endif
-    }
-    
-    return xml;
+    NSDictionary *parameters = self.SOAPParameters;
+    HSFEnvelopeTemplate *template = [HSFEnvelopeTemplate templateForAction:self parameters:parameters];
+    return [template bodyWithParameters:parameters];
 }
 
 /*
- Update HTTP body for soap request from string into NSData and
- update "Content-Length" in request header
+ Update HTTP body for soap request, gzipped if messages are compressed.
+ Streamed body is set by the catcher.
  */
 -(void)updateSOAPBody
 {
-    NSString *body = [self xmlForParameters:self.SOAPParameters order:self.SOAPParameterOrder];
-    [_request setHTTPBody:[body dataUsingEncoding:NSUTF8StringEncoding]];
+    if (self.isStreamsBody){
+        [_request setHTTPBody:nil];
+        return;
+    }
+    NSData *body = [self envelopeData];
+    if (self.isCompressesMessages){
+        NSData *compressed = [HSFInflater gzipData:body];
+        if (!compressed){
+            [NSException raise:NSInternalInconsistencyException format:@"SOAP envelope could not be compressed."];
+        }
+        body = compressed;
+    }
+    [_request setHTTPBody:body];
 }
 
 /*
@@ -233,9 +321,17 @@
 -(void)updateSOAPHeader
 {
     NSMutableDictionary *fields = [NSMutableDictionary dictionaryWithDictionary:self.HTTPHeaderFields];
-    if (self.HTTPHeaderFields[CONTENT_LENGTH]){
+    BOOL isStreamsBody = self.isStreamsBody;
+    if (isStreamsBody){
+        // Otherwise body stream is sent chunked.
+        fields[CONTENT_LENGTH] = [NSString stringWithFormat:@"%llu",[HSFBodyStream lengthOfParts:self.HTTPBodyParts]];
+    } else if (fields[CONTENT_LENGTH]){
         fields[CONTENT_LENGTH] = [NSString stringWithFormat:@"%lu",(unsigned long)[[_request HTTPBody] length]];
     }
+    if (self.isCompressesMessages){
+        if (!isStreamsBody) fields[CONTENT_ENCODING_HEADER] = GZIP_ENCODING;
+        if (!fields[ACCEPT_ENCODING_HEADER]) fields[ACCEPT_ENCODING_HEADER] = ACCEPTED_ENCODINGS;
+    }
     [_request setAllHTTPHeaderFields:[fields copy]];
 }
 
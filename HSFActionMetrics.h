@@ -0,0 +1,116 @@
+//
+//  HSFActionMetrics.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 28/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFLatencyHistogram.h"
+#import "HSFCatcherMetrics.h"
+
+/*!
+ @abstract Metrics aggregated over loadings of one HSFAction class.
+ @discussion HSFClient adds HSFCatcherMetrics of every finished loading to the metrics of its action class. Thread safe.
+ */
+@interface HSFActionMetrics : NSObject
+
+/*!
+ @abstract Class of HSFAction.
+ */
+@property (nonatomic,readonly) Class actionClass;
+
+/*!
+ @abstract Number of finished loadings.
+ */
+@property (nonatomic,readonly) NSUInteger loadCount;
+
+/*!
+ @abstract Number of loadings which received entire response.
+ */
+@property (nonatomic,readonly) NSUInteger succeededCount;
+
+/*!
+ @abstract Number of loadings which failed with error.
+ */
+@property (nonatomic,readonly) NSUInteger failedCount;
+
+/*!
+ @abstract Number of loadings which were cancelled.
+ */
+@property (nonatomic,readonly) NSUInteger cancelledCount;
+
+/*!
+ @abstract Number of loadings answered from the response cache.
+ */
+@property (nonatomic,readonly) NSUInteger replayedCount;
+
+/*!
+ @abstract Number of repeated attempts.
+ */
+@property (nonatomic,readonly) NSUInteger retryCount;
+
+/*!
+ @abstract Number of received bytes.
+ */
+@property (nonatomic,readonly) long long byteCount;
+
+/*!
+ @abstract Number of parsed units.
+ */
+@property (nonatomic,readonly) NSUInteger unitCount;
+
+/*!
+ @abstract Received bytes per second of transfer, from response headers till the last byte.
+ */
+@property (nonatomic,readonly) double bytesPerSecond;
+
+/*!
+ @abstract Total durations of loadings.
+ */
+@property (strong,nonatomic,readonly) HSFLatencyHistogram *latencyHistogram;
+
+/*!
+ @abstract Intervals till the first byte of response body.
+ */
+@property (strong,nonatomic,readonly) HSFLatencyHistogram *firstByteHistogram;
+
+/*!
+ @abstract Durations of request building.
+ */
+@property (strong,nonatomic,readonly) HSFLatencyHistogram *requestBuildHistogram;
+
+/*!
+ @abstract Durations of scanning per loading.
+ */
+@property (strong,nonatomic,readonly) HSFLatencyHistogram *scanHistogram;
+
+/*!
+ @abstract Durations of entire response parsing per loading.
+ */
+@property (strong,nonatomic,readonly) HSFLatencyHistogram *entireParseHistogram;
+
+/*!
+ @abstract Parse time of every unit.
+ */
+@property (strong,nonatomic,readonly) HSFLatencyHistogram *unitParseHistogram;
+
+/*!
+ @abstract Durations of delegate callbacks per loading.
+ */
+@property (strong,nonatomic,readonly) HSFLatencyHistogram *delegateHistogram;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ */
+-(id)initWithActionClass:(Class)actionClass;
+
+/*!
+ @abstract Add metrics of a finished loading.
+ */
+-(void)addCatcherMetrics:(HSFCatcherMetrics*)metrics;
+
+@end
@@ -0,0 +1,167 @@
+//
+//  HSFActionMetrics.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 28/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFActionMetrics.h"
+
+@interface HSFActionMetrics()
+
+@property (nonatomic,readwrite) Class actionClass;
+@property (nonatomic,readwrite) NSUInteger loadCount;
+@property (nonatomic,readwrite) NSUInteger succeededCount;
+@property (nonatomic,readwrite) NSUInteger failedCount;
+@property (nonatomic,readwrite) NSUInteger cancelledCount;
+@property (nonatomic,readwrite) NSUInteger replayedCount;
+@property (nonatomic,readwrite) NSUInteger retryCount;
+@property (nonatomic,readwrite) long long byteCount;
+@property (nonatomic,readwrite) NSUInteger unitCount;
+@property (strong,nonatomic,readwrite) HSFLatencyHistogram *latencyHistogram;
+@property (strong,nonatomic,readwrite) HSFLatencyHistogram *firstByteHistogram;
+@property (strong,nonatomic,readwrite) HSFLatencyHistogram *requestBuildHistogram;
+@property (strong,nonatomic,readwrite) HSFLatencyHistogram *scanHistogram;
+@property (strong,nonatomic,readwrite) HSFLatencyHistogram *entireParseHistogram;
+@property (strong,nonatomic,readwrite) HSFLatencyHistogram *unitParseHistogram;
+@property (strong,nonatomic,readwrite) HSFLatencyHistogram *delegateHistogram;
+
+/*
+ Sum of transfer durations of loadings from the network.
+ */
+@property (nonatomic) NSTimeInterval transferDuration;
+@property (nonatomic) long long transferredByteCount;
+
+@end
+
+@implementation HSFActionMetrics
+
+#pragma mark Properties
+
+-(NSUInteger)loadCount
+{
+    @synchronized(self){
+        return _loadCount;
+    }
+}
+
+-(NSUInteger)succeededCount
+{
+    @synchronized(self){
+        return _succeededCount;
+    }
+}
+
+-(NSUInteger)failedCount
+{
+    @synchronized(self){
+        return _failedCount;
+    }
+}
+
+-(NSUInteger)cancelledCount
+{
+    @synchronized(self){
+        return _cancelledCount;
+    }
+}
+
+-(NSUInteger)replayedCount
+{
+    @synchronized(self){
+        return _replayedCount;
+    }
+}
+
+-(NSUInteger)retryCount
+{
+    @synchronized(self){
+        return _retryCount;
+    }
+}
+
+-(long long)byteCount
+{
+    @synchronized(self){
+        return _byteCount;
+    }
+}
+
+-(NSUInteger)unitCount
+{
+    @synchronized(self){
+        return _unitCount;
+    }
+}
+
+-(double)bytesPerSecond
+{
+    @synchronized(self){
+        return (self.transferDuration > 0) ? self.transferredByteCount / self.transferDuration : 0.0;
+    }
+}
+
+#pragma mark Public Methods
+
+-(id)initWithActionClass:(Class)actionClass
+{
+    self = [super init];
+    if (self){
+        _actionClass = actionClass;
+        _latencyHistogram = [[HSFLatencyHistogram alloc] init];
+        _firstByteHistogram = [[HSFLatencyHistogram alloc] init];
+        _requestBuildHistogram = [[HSFLatencyHistogram alloc] init];
+        _scanHistogram = [[HSFLatencyHistogram alloc] init];
+        _entireParseHistogram = [[HSFLatencyHistogram alloc] init];
+        _unitParseHistogram = [[HSFLatencyHistogram alloc] init];
+        _delegateHistogram = [[HSFLatencyHistogram alloc] init];
+    }
+    return self;
+}
+
+-(id)init
+{
+    return [self initWithActionClass:Nil];
+}
+
+-(void)addCatcherMetrics:(HSFCatcherMetrics*)metrics
+{
+    if (!metrics) return;
+
+    NSUInteger unitCount = metrics.unitParseHistogram.count;
+    @synchronized(self){
+        ++_loadCount;
+        if (metrics.isSucceeded) ++_succeededCount;
+        else if (metrics.error) ++_failedCount;
+        else ++_cancelledCount;
+        if (metrics.isReplayed) ++_replayedCount;
+        _retryCount += metrics.retryCount;
+        _byteCount += metrics.bytesReceived;
+        _unitCount += unitCount;
+
+        // Replayed responses are not transferred, they would inflate the throughput.
+        if (metrics.isSucceeded && !metrics.isReplayed){
+            NSTimeInterval transfer = metrics.lastByteInterval - metrics.waitInterval - metrics.connectDuration;
+            if (transfer > 0){
+                _transferDuration += transfer;
+                _transferredByteCount += metrics.bytesReceived;
+            }
+        }
+    }
+
+    [self.latencyHistogram addSample:metrics.totalDuration];
+    if (metrics.firstByteInterval > 0) [self.firstByteHistogram addSample:metrics.firstByteInterval];
+    [self.requestBuildHistogram addSample:metrics.requestBuildDuration];
+    [self.scanHistogram addSample:metrics.scanDuration];
+    if (metrics.entireParseDuration > 0) [self.entireParseHistogram addSample:metrics.entireParseDuration];
+    [self.unitParseHistogram addHistogram:metrics.unitParseHistogram];
+    [self.delegateHistogram addSample:metrics.delegateDuration];
+}
+
+-(NSString*)description
+{
+    return [NSString stringWithFormat:@"%@ %@ loads:%lu succeeded:%lu failed:%lu cancelled:%lu replayed:%lu retries:%lu bytes:%lld units:%lu bytesPerSecond:%.0f latency:(%@)",[super description],NSStringFromClass(self.actionClass),(unsigned long)self.loadCount,(unsigned long)self.succeededCount,(unsigned long)self.failedCount,(unsigned long)self.cancelledCount,(unsigned long)self.replayedCount,(unsigned long)self.retryCount,self.byteCount,(unsigned long)self.unitCount,self.bytesPerSecond,self.latencyHistogram];
+}
+
+@end
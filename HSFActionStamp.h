@@ -18,14 +18,32 @@
 //TODO: group headerDoc comment.
 //Here should be only readonly properties.
 @property (strong,nonatomic,readonly) NSURLRequest *request;
+@property (strong,nonatomic,readonly) NSArray *HTTPBodyParts;
 @property (strong,nonatomic,readonly) NSURLCredential *credential;
 @property (nonatomic,readonly) NSUInteger loadAttempts;
 @property (nonatomic,readonly) NSTimeInterval maxTimeout;
+@property (nonatomic,readonly) NSInteger loadPriority;
+@property (strong,nonatomic,readonly) NSArray *groupTags;
 @property (nonatomic,readonly) BOOL networkActivityIndicator;
 @property (strong,nonatomic,readonly) NSArray *unitTags;
 @property (strong,nonatomic,readonly) NSArray *streamingTags;
 @property (strong,nonatomic,readonly) NSArray *orderedSpecialTags;
 @property (nonatomic,getter=isParseUnitsAsynchronously,readonly) BOOL parseUnitsAsynchronously;
+@property (nonatomic,readonly) NSUInteger parseConcurrency;
+@property (nonatomic,readonly) NSUInteger unitBatchSize;
+@property (nonatomic,readonly) NSUInteger unitBatchLength;
+@property (nonatomic,readonly) NSTimeInterval unitBatchInterval;
+@property (nonatomic,readonly) NSTimeInterval cacheLifetime;
+@property (nonatomic,getter=isCoalescable,readonly) BOOL coalescable;
+@property (nonatomic,getter=isParseEntireResponseIncrementally,readonly) BOOL parseEntireResponseIncrementally;
+@property (nonatomic,readonly) NSUInteger spillThreshold;
+@property (nonatomic,getter=isCompactNodeTree,readonly) BOOL compactNodeTree;
+@property (nonatomic,getter=isSharesSymbolTable,readonly) BOOL sharesSymbolTable;
+@property (nonatomic,getter=isCompressesMessages,readonly) BOOL compressesMessages;
+@property (strong,nonatomic,readonly) NSString *attachmentDirectory;
+@property (strong,nonatomic,readonly) HSFModelMapping *unitModelMapping;
+@property (strong,nonatomic,readonly) HSFModelMapping *responseModelMapping;
+@property (strong,nonatomic,readonly) NSString *responseModelPath;
 
 /*!
  @abstract Class of the HSFAction from which stamp was made.
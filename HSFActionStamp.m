@@ -7,19 +7,38 @@
 //
 
 #import "HSFActionStamp.h"
+#import "HSFBodyStream.h"
 
 @interface HSFActionStamp()
 
 //Here we make all readonly properties readwrite.
 @property (strong,nonatomic,readwrite) NSURLRequest *request;
+@property (strong,nonatomic,readwrite) NSArray *HTTPBodyParts;
 @property (strong,nonatomic,readwrite) NSURLCredential *credential;
 @property (nonatomic,readwrite) NSUInteger loadAttempts;
 @property (nonatomic,readwrite) NSTimeInterval maxTimeout;
+@property (nonatomic,readwrite) NSInteger loadPriority;
+@property (strong,nonatomic,readwrite) NSArray *groupTags;
 @property (nonatomic,readwrite) BOOL networkActivityIndicator;
 @property (strong,nonatomic,readwrite) NSArray* unitTags;
 @property (strong,nonatomic,readwrite) NSArray* streamingTags;
 @property (strong,nonatomic,readwrite) NSArray *orderedSpecialTags;
 @property (nonatomic,getter=isParseUnitsAsynchronously,readwrite) BOOL parseUnitsAsynchronously;
+@property (nonatomic,readwrite) NSUInteger parseConcurrency;
+@property (nonatomic,readwrite) NSUInteger unitBatchSize;
+@property (nonatomic,readwrite) NSUInteger unitBatchLength;
+@property (nonatomic,readwrite) NSTimeInterval unitBatchInterval;
+@property (nonatomic,readwrite) NSTimeInterval cacheLifetime;
+@property (nonatomic,getter=isCoalescable,readwrite) BOOL coalescable;
+@property (nonatomic,getter=isParseEntireResponseIncrementally,readwrite) BOOL parseEntireResponseIncrementally;
+@property (nonatomic,readwrite) NSUInteger spillThreshold;
+@property (nonatomic,getter=isCompactNodeTree,readwrite) BOOL compactNodeTree;
+@property (nonatomic,getter=isSharesSymbolTable,readwrite) BOOL sharesSymbolTable;
+@property (nonatomic,getter=isCompressesMessages,readwrite) BOOL compressesMessages;
+@property (strong,nonatomic,readwrite) NSString *attachmentDirectory;
+@property (strong,nonatomic,readwrite) HSFModelMapping *unitModelMapping;
+@property (strong,nonatomic,readwrite) HSFModelMapping *responseModelMapping;
+@property (strong,nonatomic,readwrite) NSString *responseModelPath;
 
 @property (nonatomic,readwrite) Class actionClass;
 
@@ -37,11 +56,37 @@
         self.credential = action.credential;
         self.loadAttempts = action.loadAttempts;
         self.maxTimeout = action.maxTimeout;
+        self.loadPriority = action.loadPriority;
+        self.groupTags = [action.groupTags copy];
         self.networkActivityIndicator = action.networkActivityIndicator;
         self.unitTags = action.unitTags;
         self.parseUnitsAsynchronously = action.isParseUnitsAsynchronously;
+        self.parseConcurrency = action.parseConcurrency;
+        self.unitBatchSize = action.unitBatchSize;
+        self.unitBatchLength = action.unitBatchLength;
+        self.unitBatchInterval = action.unitBatchInterval;
+        self.cacheLifetime = action.cacheLifetime;
+        self.coalescable = action.isCoalescable;
+        self.parseEntireResponseIncrementally = action.isParseEntireResponseIncrementally;
+        self.spillThreshold = action.spillThreshold;
+        self.compactNodeTree = action.isCompactNodeTree;
+        self.sharesSymbolTable = action.isSharesSymbolTable;
+        self.compressesMessages = action.isCompressesMessages;
+        self.attachmentDirectory = [action.attachmentDirectory copy];
+        // Mappings are not changed after they are used, so they are shared.
+        self.unitModelMapping = action.unitModelMapping;
+        self.responseModelMapping = action.responseModelMapping;
+        self.responseModelPath = [action.responseModelPath copy];
         self.streamingTags = action.streamingTags;
         self.orderedSpecialTags = action.orderedSpecialTags;
+
+        // Streamed body is sent as it is read, so its response is not cached and the body is sent again only if it can be read again.
+        self.HTTPBodyParts = action.HTTPBodyParts;
+        if (self.HTTPBodyParts){
+            self.cacheLifetime = 0;
+            self.coalescable = NO;
+            if (![HSFBodyStream arePartsReplayable:self.HTTPBodyParts]) self.loadAttempts = MIN(self.loadAttempts, 1);
+        }
     }
     return self;
 }
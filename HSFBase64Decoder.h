@@ -0,0 +1,63 @@
+//
+//  HSFBase64Decoder.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 21/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Incremental base64 decoder.
+ @discussion Decodes base64 text which comes in chunks, e.g. streaming tag content, and writes decoded bytes to an output stream or a file handle at once. A quantum may be broken between chunks. Whitespace is skipped. The decoder neither opens nor closes its output.
+ */
+@interface HSFBase64Decoder : NSObject
+
+/*!
+ @abstract Decoding or writing error.
+ @discussion Set as soon as the decoder meets invalid base64 text (HSFParseErrorDomain) or output fails. Subsequent chunks are ignored until reset.
+ */
+@property (strong,nonatomic,readonly) NSError *error;
+
+/*!
+ @abstract Number of decoded bytes written to the output.
+ */
+@property (nonatomic,readonly) unsigned long long decodedLength;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Initialize decoder which writes to an output stream.
+ @param outputStream Opened output stream. Writing is blocking.
+ @return The initialized decoder.
+ */
+-(id)initWithOutputStream:(NSOutputStream*)outputStream;
+
+/*!
+ @abstract Initialize decoder which writes to a file handle.
+ @param fileHandle File handle opened for writing.
+ @return The initialized decoder.
+ */
+-(id)initWithFileHandle:(NSFileHandle*)fileHandle;
+
+/*!
+ @abstract Decode next chunk of base64 text.
+ @param data Next chunk, ASCII bytes.
+ @return NO if the text is not valid or output failed, see error.
+ */
+-(BOOL)decodeData:(NSData*)data;
+
+/*!
+ @abstract Finish decoding of the current text.
+ @discussion Writes the last incomplete quantum, padding may be omitted. The decoder is ready for the next text afterwards.
+ @return NO if the text is not valid or output failed, see error.
+ */
+-(BOOL)finish;
+
+/*!
+ @abstract Forget partial quantum and error.
+ */
+-(void)reset;
+
+@end
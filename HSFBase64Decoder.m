@@ -0,0 +1,204 @@
+//
+//  HSFBase64Decoder.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 21/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFBase64Decoder.h"
+#import "HSFCommon.h"
+
+#define HSF_BASE64_INVALID 0xFF
+#define HSF_BASE64_WHITESPACE 0xFE
+#define HSF_BASE64_PADDING 0xFD
+
+static unsigned char _base64Table[256];
+
+@interface HSFBase64Decoder(){
+    // Sextets of the incomplete quantum.
+    uint32_t _quantum;
+    NSUInteger _sextets;
+    NSUInteger _padding;
+    // Padding was completed, only whitespace may follow.
+    BOOL _isTerminated;
+    uint8_t _buffer[HSF_BASE64_BUFFER_SIZE];
+    NSUInteger _bufferLength;
+}
+
+@property (strong,nonatomic,readwrite) NSError *error;
+@property (nonatomic,readwrite) unsigned long long decodedLength;
+
+@property (strong,nonatomic) NSOutputStream *outputStream;
+@property (strong,nonatomic) NSFileHandle *fileHandle;
+
+@end
+
+@implementation HSFBase64Decoder
+
+#pragma mark Public Methods
+
+-(id)initWithOutputStream:(NSOutputStream*)outputStream
+{
+    if (!outputStream){
+        [NSException raise:NSInvalidArgumentException format:@"The output stream is nil."];
+    }
+    self = [super init];
+    if (self){
+        _outputStream = outputStream;
+    }
+    return self;
+}
+
+-(id)initWithFileHandle:(NSFileHandle*)fileHandle
+{
+    if (!fileHandle){
+        [NSException raise:NSInvalidArgumentException format:@"The file handle is nil."];
+    }
+    self = [super init];
+    if (self){
+        _fileHandle = fileHandle;
+    }
+    return self;
+}
+
+-(id)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
+    return [super init];
+}
+
+-(BOOL)decodeData:(NSData*)data
+{
+    if (self.error) return NO;
+
+    const unsigned char *bytes = [data bytes];
+    NSUInteger length = [data length];
+    for (NSUInteger i = 0; i < length; ++i){
+        unsigned char value = _base64Table[bytes[i]];
+        if (value == HSF_BASE64_WHITESPACE) continue;
+
+        if (value == HSF_BASE64_PADDING){
+            if (_sextets < 2 || _isTerminated){
+                return [self failDecoding];
+            }
+            if (_sextets + ++_padding == 4){
+                [self flushQuantum];
+                _isTerminated = YES;
+            }
+            continue;
+        }
+        if (value == HSF_BASE64_INVALID || _padding || _isTerminated){
+            return [self failDecoding];
+        }
+
+        _quantum = (_quantum << 6) | value;
+        if (++_sextets == 4){
+            _buffer[_bufferLength++] = (_quantum >> 16) & 0xFF;
+            _buffer[_bufferLength++] = (_quantum >> 8) & 0xFF;
+            _buffer[_bufferLength++] = _quantum & 0xFF;
+            _quantum = 0;
+            _sextets = 0;
+            if (_bufferLength > HSF_BASE64_BUFFER_SIZE - 3 && ![self writeBuffer]) return NO;
+        }
+    }
+    return [self writeBuffer];
+}
+
+-(BOOL)finish
+{
+    if (self.error) return NO;
+
+    if (_padding){
+        // Padding is started but not completed.
+        return [self failDecoding];
+    }
+    if (_sextets == 1){
+        return [self failDecoding];
+    }
+    if (_sextets){
+        [self flushQuantum];
+    }
+    BOOL written = [self writeBuffer];
+    _isTerminated = NO;
+    return written;
+}
+
+-(void)reset
+{
+    _quantum = 0;
+    _sextets = 0;
+    _padding = 0;
+    _isTerminated = NO;
+    _bufferLength = 0;
+    self.error = nil;
+}
+
+#pragma mark Private Methods
+
+/*
+ Move bytes of incomplete quantum to the buffer.
+ */
+-(void)flushQuantum
+{
+    if (_sextets == 2){
+        _buffer[_bufferLength++] = (_quantum >> 4) & 0xFF;
+    } else if (_sextets == 3){
+        _buffer[_bufferLength++] = (_quantum >> 10) & 0xFF;
+        _buffer[_bufferLength++] = (_quantum >> 2) & 0xFF;
+    }
+    _quantum = 0;
+    _sextets = 0;
+    _padding = 0;
+}
+
+-(BOOL)writeBuffer
+{
+    if (!_bufferLength) return YES;
+
+    NSUInteger length = _bufferLength;
+    _bufferLength = 0;
+    if (self.fileHandle){
+        [self.fileHandle writeData:[NSData dataWithBytesNoCopy:_buffer length:length freeWhenDone:NO]];
+    } else {
+        NSUInteger written = 0;
+        while (written < length){
+            NSInteger result = [self.outputStream write:_buffer + written maxLength:length - written];
+            if (result <= 0){
+                NSError *error = self.outputStream.streamError;
+                self.error = error ? error : [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOSPC userInfo:nil];
+                return NO;
+            }
+            written += result;
+        }
+    }
+    self.decodedLength += length;
+    return YES;
+}
+
+-(BOOL)failDecoding
+{
+    NSDictionary *userInfo = @{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_BASE64_DECODE_ERROR};
+    self.error = [NSError errorWithDomain:HSFParseErrorDomain code:HSF_ERROR_CODE_BASE64_DECODE_ERROR userInfo:userInfo];
+    return NO;
+}
+
+#pragma mark Class Methods
+
++(void)initialize
+{
+    if (self != [HSFBase64Decoder class]) return;
+
+    memset(_base64Table, HSF_BASE64_INVALID, sizeof(_base64Table));
+    const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (unsigned char i = 0; i < 64; ++i){
+        _base64Table[(unsigned char)alphabet[i]] = i;
+    }
+    _base64Table['='] = HSF_BASE64_PADDING;
+    _base64Table[' '] = HSF_BASE64_WHITESPACE;
+    _base64Table['\t'] = HSF_BASE64_WHITESPACE;
+    _base64Table['\r'] = HSF_BASE64_WHITESPACE;
+    _base64Table['\n'] = HSF_BASE64_WHITESPACE;
+}
+
+@end
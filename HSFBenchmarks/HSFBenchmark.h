@@ -0,0 +1,51 @@
+//
+//  HSFBenchmark.h
+//  HSFBenchmarks
+//
+//  Created by Ilnar Aliullov on 29/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Runner of microbenchmarks.
+ @discussion Every benchmark is run warmup times unmeasured and then iterations times. Results are property lists keyed by benchmark name: seconds per iteration (mean, minimum, maximum), throughput in bytes per second, heap bytes and blocks still allocated when an iteration ends, before its autorelease pool is drained, and peak resident size of the process.
+ */
+@interface HSFBenchmark : NSObject
+
+/*!
+ @abstract Number of measured iterations.
+ @discussion Default value is 10.
+ */
+@property (nonatomic) NSUInteger iterations;
+
+/*!
+ @abstract Number of unmeasured iterations.
+ @discussion Default value is 2.
+ */
+@property (nonatomic) NSUInteger warmup;
+
+/*!
+ @abstract Results of the benchmarks run so far, by name.
+ */
+@property (strong,nonatomic,readonly) NSDictionary *results;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Run and measure benchmark.
+ @param name Name of the benchmark in results.
+ @param bytes Number of bytes processed by one iteration, for throughput. May be 0.
+ @param block Iteration.
+ @return Result of the benchmark.
+ */
+-(NSDictionary*)runBenchmark:(NSString*)name bytes:(NSUInteger)bytes block:(void (^)(void))block;
+
+/*!
+ @abstract Print results, compared with baseline if given.
+ @param baseline Results of a previous run, may be nil.
+ */
+-(void)printResultsComparedWith:(NSDictionary*)baseline;
+
+@end
@@ -0,0 +1,131 @@
+//
+//  HSFBenchmark.m
+//  HSFBenchmarks
+//
+//  Created by Ilnar Aliullov on 29/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFBenchmark.h"
+#import "HSFCatcherMetrics.h"
+#import <malloc/malloc.h>
+#import <sys/resource.h>
+
+#define MEAN_KEY @"mean"
+#define MINIMUM_KEY @"minimum"
+#define MAXIMUM_KEY @"maximum"
+#define BYTES_PER_SECOND_KEY @"bytesPerSecond"
+#define HEAP_BYTES_KEY @"heapBytes"
+#define HEAP_BLOCKS_KEY @"heapBlocks"
+#define PEAK_RESIDENT_KEY @"peakResidentBytes"
+
+/*
+ Heap in use by all malloc zones.
+ */
+static malloc_statistics_t HSFHeapStatistics(void)
+{
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return stats;
+}
+
+@interface HSFBenchmark()
+
+@property (strong,nonatomic) NSMutableDictionary *mutableResults;
+@property (strong,nonatomic) NSMutableArray *names;
+
+@end
+
+@implementation HSFBenchmark
+
+#pragma mark Properties
+
+-(NSDictionary*)results
+{
+    return [self.mutableResults copy];
+}
+
+#pragma mark Public Methods
+
+-(id)init
+{
+    self = [super init];
+    if (self){
+        _iterations = 10;
+        _warmup = 2;
+        _mutableResults = [[NSMutableDictionary alloc] init];
+        _names = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+-(NSDictionary*)runBenchmark:(NSString*)name bytes:(NSUInteger)bytes block:(void (^)(void))block
+{
+    for (NSUInteger i = 0; i < self.warmup; ++i){
+        @autoreleasepool {
+            block();
+        }
+    }
+
+    NSTimeInterval sum = 0.0, minimum = DBL_MAX, maximum = 0.0;
+    double heapBytes = 0.0, heapBlocks = 0.0;
+    NSUInteger iterations = MAX(self.iterations, 1);
+    for (NSUInteger i = 0; i < iterations; ++i){
+        @autoreleasepool {
+            malloc_statistics_t before = HSFHeapStatistics();
+            NSTimeInterval start = [HSFCatcherMetrics currentTime];
+            block();
+            NSTimeInterval duration = [HSFCatcherMetrics currentTime] - start;
+            malloc_statistics_t after = HSFHeapStatistics();
+
+            sum += duration;
+            minimum = MIN(minimum, duration);
+            maximum = MAX(maximum, duration);
+            heapBytes += (double)after.size_in_use - (double)before.size_in_use;
+            heapBlocks += (double)after.blocks_in_use - (double)before.blocks_in_use;
+        }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    NSTimeInterval mean = sum / iterations;
+    NSDictionary *result = @{MEAN_KEY:@(mean),
+                             MINIMUM_KEY:@(minimum),
+                             MAXIMUM_KEY:@(maximum),
+                             BYTES_PER_SECOND_KEY:@((bytes && mean > 0) ? bytes / mean : 0.0),
+                             HEAP_BYTES_KEY:@(heapBytes / iterations),
+                             HEAP_BLOCKS_KEY:@(heapBlocks / iterations),
+                             // Bytes on OS X.
+                             PEAK_RESIDENT_KEY:@(usage.ru_maxrss)};
+    if (!self.mutableResults[name]) [self.names addObject:name];
+    self.mutableResults[name] = result;
+    return result;
+}
+
+-(void)printResultsComparedWith:(NSDictionary*)baseline
+{
+    printf("%-28s %12s %12s %12s %14s %12s %10s\n","benchmark","mean ms","min ms","max ms","MB/s","heap KB","blocks");
+    for (NSString *name in self.names){
+        NSDictionary *result = self.mutableResults[name];
+        printf("%-28s %12.3f %12.3f %12.3f %14.2f %12.1f %10.0f",
+               [name UTF8String],
+               [result[MEAN_KEY] doubleValue] * 1000.0,
+               [result[MINIMUM_KEY] doubleValue] * 1000.0,
+               [result[MAXIMUM_KEY] doubleValue] * 1000.0,
+               [result[BYTES_PER_SECOND_KEY] doubleValue] / (1024.0 * 1024.0),
+               [result[HEAP_BYTES_KEY] doubleValue] / 1024.0,
+               [result[HEAP_BLOCKS_KEY] doubleValue]);
+
+        double baselineMean = [baseline[name][MEAN_KEY] doubleValue];
+        if (baselineMean > 0){
+            // Positive change means slower.
+            printf("  %+7.1f%%",([result[MEAN_KEY] doubleValue] / baselineMean - 1.0) * 100.0);
+        }
+        printf("\n");
+    }
+
+    NSDictionary *last = self.mutableResults[[self.names lastObject]];
+    printf("peak resident size: %.1f MB\n",[last[PEAK_RESIDENT_KEY] doubleValue] / (1024.0 * 1024.0));
+}
+
+@end
@@ -0,0 +1,24 @@
+//
+//  HSFBenchmarkAction.h
+//  HSFBenchmarks
+//
+//  Created by Ilnar Aliullov on 29/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFAction.h"
+
+/*!
+ @abstract SOAP action for request building benchmark.
+ @discussion Parameters change with every instance, so every request is built anew.
+ */
+@interface HSFBenchmarkAction : HSFAction
+
+/*!
+ @abstract Designated initializer.
+ @param number Number put into parameters.
+ @param parameterCount Number of SOAP parameters.
+ */
+-(id)initWithNumber:(NSUInteger)number parameterCount:(NSUInteger)parameterCount;
+
+@end
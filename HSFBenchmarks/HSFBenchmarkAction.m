@@ -0,0 +1,68 @@
+//
+//  HSFBenchmarkAction.m
+//  HSFBenchmarks
+//
+//  Created by Ilnar Aliullov on 29/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFBenchmarkAction.h"
+
+@interface HSFBenchmarkAction()
+
+@property (nonatomic) NSUInteger number;
+@property (nonatomic) NSUInteger parameterCount;
+
+@end
+
+@implementation HSFBenchmarkAction
+
+#pragma mark Properties
+
+-(NSDictionary*)HTTPHeaderFields
+{
+    return @{@"Content-Type":@"text/xml; charset=utf-8",@"Content-Length":@"0",@"SOAPAction":@"http://example.com/benchmark/Benchmark"};
+}
+
+-(NSString*)SOAPAction
+{
+    return @"Benchmark";
+}
+
+-(NSString*)attributesForSOAPActionTag
+{
+    return @"xmlns=\"http://example.com/benchmark\"";
+}
+
+-(NSString*)SOAPEnvelopeHead
+{
+    return @"<?xml version=\"1.0\" encoding=\"utf-8\"?><soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\"><soap:Body>";
+}
+
+-(NSString*)SOAPEnvelopeTail
+{
+    return @"</soap:Body></soap:Envelope>";
+}
+
+-(NSDictionary*)SOAPParameters
+{
+    NSMutableDictionary *parameters = [[NSMutableDictionary alloc] initWithCapacity:self.parameterCount];
+    for (NSUInteger i = 0; i < self.parameterCount; ++i){
+        parameters[[NSString stringWithFormat:@"parameter%lu",(unsigned long)i]] = [NSString stringWithFormat:@"value %lu & <%lu>",(unsigned long)self.number,(unsigned long)i];
+    }
+    return parameters;
+}
+
+#pragma mark Public Methods
+
+-(id)initWithNumber:(NSUInteger)number parameterCount:(NSUInteger)parameterCount
+{
+    self = [super initWithURL:[NSURL URLWithString:@"http://example.com/benchmark"]];
+    if (self){
+        _number = number;
+        _parameterCount = parameterCount;
+    }
+    return self;
+}
+
+@end
@@ -0,0 +1,69 @@
+//
+//  HSFBenchmarkResponse.h
+//  HSFBenchmarks
+//
+//  Created by Ilnar Aliullov on 29/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Generator of synthetic SOAP responses.
+ @discussion Response body holds unitCount elements with UNIT_TAG, each nested depth levels deep, and one STREAMING_TAG element with base64 content. Values of units are padded so the whole response is about size bytes.
+ */
+@interface HSFBenchmarkResponse : NSObject
+
+/*!
+ @abstract Approximate size of the response in bytes.
+ @discussion Response is never smaller than its markup. Default value is 1 MB.
+ */
+@property (nonatomic) NSUInteger size;
+
+/*!
+ @abstract Nesting depth of elements inside a unit.
+ @discussion Default value is 4.
+ */
+@property (nonatomic) NSUInteger depth;
+
+/*!
+ @abstract Number of units.
+ @discussion Default value is 100.
+ */
+@property (nonatomic) NSUInteger unitCount;
+
+/*!
+ @abstract Size of base64 content of the streaming tag in bytes, 0 means no streaming tag.
+ @discussion Default value is 64 KB.
+ */
+@property (nonatomic) NSUInteger streamingSize;
+
+/*!
+ @abstract Unit tag.
+ */
+@property (strong,nonatomic,readonly) NSString *unitTag;
+
+/*!
+ @abstract Streaming tag.
+ */
+@property (strong,nonatomic,readonly) NSString *streamingTag;
+
+/*!
+ @abstract Name of the deepest element of a unit, once per unit.
+ */
+@property (strong,nonatomic,readonly) NSString *leafTag;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Make the response.
+ @discussion Response is the same for the same settings.
+ */
+-(NSData*)data;
+
+/*!
+ @abstract Settings as property list, to be stored with results.
+ */
+-(NSDictionary*)settings;
+
+@end
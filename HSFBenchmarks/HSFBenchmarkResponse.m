@@ -0,0 +1,110 @@
+//
+//  HSFBenchmarkResponse.m
+//  HSFBenchmarks
+//
+//  Created by Ilnar Aliullov on 29/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFBenchmarkResponse.h"
+
+#define UNIT_TAG @"item"
+#define STREAMING_TAG @"audioContent"
+#define LEAF_TAG @"leaf"
+#define RESPONSE_HEAD @"<?xml version=\"1.0\" encoding=\"utf-8\"?><soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\"><soap:Body><BenchmarkResponse xmlns=\"http://example.com/benchmark\">"
+#define RESPONSE_TAIL @"</BenchmarkResponse></soap:Body></soap:Envelope>"
+
+@implementation HSFBenchmarkResponse
+
+#pragma mark Properties
+
+-(NSString*)unitTag
+{
+    return UNIT_TAG;
+}
+
+-(NSString*)streamingTag
+{
+    return STREAMING_TAG;
+}
+
+-(NSString*)leafTag
+{
+    return LEAF_TAG;
+}
+
+#pragma mark Public Methods
+
+-(id)init
+{
+    self = [super init];
+    if (self){
+        _size = 1024 * 1024;
+        _depth = 4;
+        _unitCount = 100;
+        _streamingSize = 64 * 1024;
+    }
+    return self;
+}
+
+-(NSData*)data
+{
+    NSMutableString *streaming = [[NSMutableString alloc] init];
+    if (self.streamingSize){
+        [streaming appendFormat:@"<%@>",STREAMING_TAG];
+        [streaming appendString:[self base64OfLength:self.streamingSize]];
+        [streaming appendFormat:@"</%@>",STREAMING_TAG];
+    }
+
+    NSUInteger markupLength = [RESPONSE_HEAD length] + [RESPONSE_TAIL length] + [streaming length];
+    for (NSUInteger i = 0; i < self.unitCount; ++i){
+        markupLength += [[self unitWithNumber:i padding:@""] length];
+    }
+    NSUInteger paddingLength = (self.unitCount && self.size > markupLength) ? (self.size - markupLength) / self.unitCount : 0;
+    NSString *padding = [@"" stringByPaddingToLength:paddingLength withString:@"lorem ipsum dolor sit amet " startingAtIndex:0];
+
+    NSMutableString *response = [[NSMutableString alloc] initWithCapacity:MAX(self.size, markupLength)];
+    [response appendString:RESPONSE_HEAD];
+    for (NSUInteger i = 0; i < self.unitCount; ++i){
+        [response appendString:[self unitWithNumber:i padding:padding]];
+    }
+    [response appendString:streaming];
+    [response appendString:RESPONSE_TAIL];
+    return [response dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+-(NSDictionary*)settings
+{
+    return @{@"size":@(self.size),@"depth":@(self.depth),@"unitCount":@(self.unitCount),@"streamingSize":@(self.streamingSize)};
+}
+
+#pragma mark Private Methods
+
+-(NSString*)unitWithNumber:(NSUInteger)number padding:(NSString*)padding
+{
+    NSMutableString *unit = [[NSMutableString alloc] init];
+    [unit appendFormat:@"<%@ id=\"%lu\">",UNIT_TAG,(unsigned long)number];
+    for (NSUInteger level = 1; level <= self.depth; ++level){
+        [unit appendFormat:@"<level%lu kind=\"nested\"><index>%lu</index>",(unsigned long)level,(unsigned long)level];
+    }
+    [unit appendFormat:@"<code>%lu</code><name>%@</name><%@>true</%@>",(unsigned long)number,padding,LEAF_TAG,LEAF_TAG];
+    for (NSUInteger level = self.depth; level >= 1; --level){
+        [unit appendFormat:@"</level%lu>",(unsigned long)level];
+    }
+    [unit appendFormat:@"</%@>",UNIT_TAG];
+    return unit;
+}
+
+-(NSString*)base64OfLength:(NSUInteger)length
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    length -= length % 4;
+    NSMutableData *data = [[NSMutableData alloc] initWithLength:length];
+    char *bytes = [data mutableBytes];
+    for (NSUInteger i = 0; i < length; ++i){
+        bytes[i] = alphabet[(i * 7 + i / 64) % 64];
+    }
+    return [[NSString alloc] initWithData:data encoding:NSASCIIStringEncoding];
+}
+
+@end
@@ -0,0 +1,201 @@
+//
+//  main.m
+//  HSFBenchmarks
+//
+//  Created by Ilnar Aliullov on 29/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFCatcher.h"
+#import "HSFTagScanner.h"
+#import "HSFNode+NSXMLParserDelegate.h"
+#import "HSFBenchmark.h"
+#import "HSFBenchmarkAction.h"
+#import "HSFBenchmarkResponse.h"
+
+/*
+ Catcher handler which never lets catchers connect, data is fed to them directly. It is also delegate of catchers and scanners.
+ */
+@interface HSFBenchmarkHandler : NSObject <HSFCatcherHandler,HSFCatcherDelegate,HSFTagScannerDelegate>
+
+@property (nonatomic) NSUInteger unitCount;
+@property (nonatomic) NSUInteger contentLength;
+
+@end
+
+@implementation HSFBenchmarkHandler
+
+-(void)catcherStarted:(HSFCatcher *)catcher {}
+
+-(void)catcherFinished:(HSFCatcher *)catcher {}
+
+-(BOOL)catcherShouldStartConnection:(HSFCatcher *)catcher
+{
+    return NO;
+}
+
+-(void)catcher:(HSFCatcher *)catcher didReceiveUnit:(HSFNode *)rootNode
+{
+    ++self.unitCount;
+}
+
+-(void)catcher:(HSFCatcher *)catcher didReceiveContentData:(NSData *)data forTag:(NSString *)tag lastChunk:(BOOL)lastChunk
+{
+    self.contentLength += [data length];
+}
+
+-(void)tagScanner:(HSFTagScanner *)scanner didScanElement:(NSData *)element forTag:(NSString *)tag
+{
+    ++self.unitCount;
+}
+
+-(void)tagScanner:(HSFTagScanner *)scanner didScanContent:(NSData *)content forTag:(NSString *)tag lastChunk:(BOOL)lastChunk
+{
+    self.contentLength += [content length];
+}
+
+@end
+
+static NSUInteger HSFBenchmarkSetting(NSString *key, NSUInteger defaultValue)
+{
+    NSString *value = [[NSUserDefaults standardUserDefaults] stringForKey:key];
+    return value ? (NSUInteger)[value longLongValue] : defaultValue;
+}
+
+/*
+ Response split into chunks as a connection would deliver it.
+ */
+static NSArray *HSFBenchmarkChunks(NSData *data, NSUInteger chunkSize)
+{
+    NSMutableArray *chunks = [[NSMutableArray alloc] init];
+    for (NSUInteger location = 0; location < [data length]; location += chunkSize){
+        [chunks addObject:[data subdataWithRange:NSMakeRange(location, MIN(chunkSize, [data length] - location))]];
+    }
+    return chunks;
+}
+
+int main(int argc, const char * argv[])
+{
+    @autoreleasepool {
+        // Settings are taken from arguments, e.g. -size 4194304 -chunkSize 16384 -output results.plist -baseline previous.plist
+        HSFBenchmarkResponse *generator = [[HSFBenchmarkResponse alloc] init];
+        generator.size = HSFBenchmarkSetting(@"size", generator.size);
+        generator.depth = HSFBenchmarkSetting(@"depth", generator.depth);
+        generator.unitCount = HSFBenchmarkSetting(@"units", generator.unitCount);
+        generator.streamingSize = HSFBenchmarkSetting(@"streamingSize", generator.streamingSize);
+        NSUInteger chunkSize = MAX(HSFBenchmarkSetting(@"chunkSize", 4096), 1);
+        NSUInteger requestCount = HSFBenchmarkSetting(@"requests", 1000);
+        NSUInteger parameterCount = HSFBenchmarkSetting(@"parameters", 10);
+
+        HSFBenchmark *benchmark = [[HSFBenchmark alloc] init];
+        benchmark.iterations = HSFBenchmarkSetting(@"iterations", benchmark.iterations);
+        benchmark.warmup = HSFBenchmarkSetting(@"warmup", benchmark.warmup);
+
+        NSData *response = [generator data];
+        NSArray *chunks = HSFBenchmarkChunks(response, chunkSize);
+        NSUInteger length = [response length];
+        printf("response: %lu bytes, %lu units, %lu chunks\n",(unsigned long)length,(unsigned long)generator.unitCount,(unsigned long)[chunks count]);
+
+        HSFBenchmarkHandler *handler = [[HSFBenchmarkHandler alloc] init];
+        [HSFCatcher setHandler:handler];
+
+        NSArray *tags = @[generator.streamingTag, generator.unitTag];
+        NSArray *streamingTags = @[generator.streamingTag];
+        [benchmark runBenchmark:@"scanner" bytes:length block:^{
+            HSFTagScanner *scanner = [[HSFTagScanner alloc] initWithTags:tags streamingTags:streamingTags];
+            scanner.delegate = handler;
+            for (NSData *chunk in chunks){
+                [scanner scanData:chunk];
+            }
+        }];
+
+        NSURLResponse *urlResponse = [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"http://example.com/benchmark"] statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Length":[NSString stringWithFormat:@"%lu",(unsigned long)length]}];
+        [benchmark runBenchmark:@"catcher.didReceiveData" bytes:length block:^{
+            HSFBenchmarkAction *action = [[HSFBenchmarkAction alloc] initWithNumber:0 parameterCount:parameterCount];
+            action.unitTags = @[generator.unitTag];
+            action.streamingTags = streamingTags;
+            HSFCatcher *catcher = [[HSFCatcher alloc] initWithDelegate:handler];
+            [catcher loadAsynchronouslyWithAction:action];
+            [catcher connection:nil didReceiveResponse:urlResponse];
+            for (NSData *chunk in chunks){
+                [catcher connection:nil didReceiveData:chunk];
+            }
+            [catcher connectionDidFinishLoading:nil];
+        }];
+
+        [benchmark runBenchmark:@"nodeTreeFromData" bytes:length block:^{
+            [HSFNode nodeTreeFromData:response error:NULL];
+        }];
+
+        [benchmark runBenchmark:@"compactNodeTreeFromData" bytes:length block:^{
+            [HSFNode compactNodeTreeFromData:response error:NULL];
+        }];
+
+        NSData *archive = [[HSFNode nodeTreeFromData:response error:NULL] archivedData];
+        [benchmark runBenchmark:@"nodeTreeFromArchivedData" bytes:length block:^{
+            HSFNode *archivedRoot = [HSFNode nodeTreeFromArchivedData:archive error:NULL];
+            [archivedRoot searchNodeByName:generator.leafTag];
+        }];
+
+        HSFNode *root = [HSFNode nodeTreeFromData:response error:NULL];
+        NSMutableArray *units = [[NSMutableArray alloc] init];
+        HSFNode *body = [root searchNodeByName:generator.unitTag].parent;
+        for (HSFNode *node in body.children){
+            if ([node.name isEqualToString:generator.unitTag]) [units addObject:node];
+        }
+
+        [benchmark runBenchmark:@"dictionary" bytes:length block:^{
+            for (HSFNode *unit in units){
+                [unit dictionary];
+            }
+        }];
+
+        [benchmark runBenchmark:@"lazyDictionary" bytes:length block:^{
+            for (HSFNode *unit in units){
+                NSDictionary *dictionary = [unit lazyDictionary][unit.name];
+                if ([dictionary isKindOfClass:[NSDictionary class]]) [dictionary objectForKey:generator.leafTag];
+            }
+        }];
+
+        [benchmark runBenchmark:@"searchNodeByName.root" bytes:0 block:^{
+            for (NSUInteger i = 0; i < [units count]; ++i){
+                [root searchNodeByName:generator.leafTag];
+            }
+        }];
+
+        [benchmark runBenchmark:@"searchNodeByName.unit" bytes:0 block:^{
+            for (HSFNode *unit in units){
+                [unit searchNodeByName:generator.leafTag];
+            }
+        }];
+
+        [benchmark runBenchmark:@"HSFAction.request" bytes:0 block:^{
+            for (NSUInteger i = 0; i < requestCount; ++i){
+                HSFBenchmarkAction *action = [[HSFBenchmarkAction alloc] initWithNumber:i parameterCount:parameterCount];
+                [action request];
+            }
+        }];
+
+        NSString *baselinePath = [[NSUserDefaults standardUserDefaults] stringForKey:@"baseline"];
+        NSDictionary *baseline = baselinePath ? [NSDictionary dictionaryWithContentsOfFile:baselinePath][@"results"] : nil;
+        if (baselinePath && !baseline){
+            fprintf(stderr, "baseline %s could not be read\n", [baselinePath UTF8String]);
+        }
+        [benchmark printResultsComparedWith:baseline];
+
+        NSString *outputPath = [[NSUserDefaults standardUserDefaults] stringForKey:@"output"];
+        if (outputPath){
+            NSDictionary *run = @{@"date":[NSDate date],
+                                  @"settings":[generator settings],
+                                  @"chunkSize":@(chunkSize),
+                                  @"iterations":@(benchmark.iterations),
+                                  @"results":benchmark.results};
+            if (![run writeToFile:outputPath atomically:YES]){
+                fprintf(stderr, "results could not be written to %s\n", [outputPath UTF8String]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
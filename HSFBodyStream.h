@@ -0,0 +1,42 @@
+//
+//  HSFBodyStream.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Streamed HTTP body of HSFAction.
+ @discussion Joins parts of the envelope into one input stream for HTTPBodyStream of the request. NSData parts are copied, HSFStreamedParameter parts are read chunk by chunk and base64 encoded if needed, so memory use does not depend on the size of the body. Bytes are written into a bound pair of streams on a dedicated thread. Streams of the parameters are scheduled on its run loop and read when they have bytes, so a slow stream does not hold other bodies.
+ */
+@interface HSFBodyStream : NSObject
+
+#pragma mark Tasks
+
+/*!
+ @abstract Input stream of the body.
+ @discussion Every call makes a new stream which reads the parts from the start. Returns nil if a streamed parameter can't give its content any more.
+ @param parts Array of NSData and HSFStreamedParameter.
+ @return Not opened input stream.
+ */
++(NSInputStream*)inputStreamWithParts:(NSArray*)parts;
+
+/*!
+ @abstract Number of bytes of the body.
+ @discussion Counted without reading the parts, so it can be sent as Content-Length.
+ @param parts Array of NSData and HSFStreamedParameter.
+ @return Length of the body.
+ */
++(unsigned long long)lengthOfParts:(NSArray*)parts;
+
+/*!
+ @abstract Determine whether the body can be sent more than once.
+ @param parts Array of NSData and HSFStreamedParameter.
+ @return NO if a part is backed by an input stream.
+ */
++(BOOL)arePartsReplayable:(NSArray*)parts;
+
+@end
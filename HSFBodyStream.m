@@ -0,0 +1,309 @@
+//
+//  HSFBodyStream.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFBodyStream.h"
+#import "HSFStreamedParameter.h"
+#import "HSFCommon.h"
+
+static const char _base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Writers of open streams, they are owned here until the body is written or the reader closes it.
+static NSMutableSet *_activeWriters;
+
+/*
+ Encode length bytes into output, the last quantum is padded. Returns number of written bytes.
+ */
+static NSUInteger HSFBase64Encode(const uint8_t *input, NSUInteger length, uint8_t *output)
+{
+    uint8_t *p = output;
+    NSUInteger i = 0;
+    for (; i + 3 <= length; i += 3){
+        uint32_t quantum = (input[i] << 16) | (input[i + 1] << 8) | input[i + 2];
+        *p++ = _base64Alphabet[(quantum >> 18) & 0x3F];
+        *p++ = _base64Alphabet[(quantum >> 12) & 0x3F];
+        *p++ = _base64Alphabet[(quantum >> 6) & 0x3F];
+        *p++ = _base64Alphabet[quantum & 0x3F];
+    }
+    if (i < length){
+        uint32_t quantum = input[i] << 16;
+        if (i + 1 < length) quantum |= input[i + 1] << 8;
+        *p++ = _base64Alphabet[(quantum >> 18) & 0x3F];
+        *p++ = _base64Alphabet[(quantum >> 12) & 0x3F];
+        *p++ = (i + 1 < length) ? _base64Alphabet[(quantum >> 6) & 0x3F] : '=';
+        *p++ = '=';
+    }
+    return p - output;
+}
+
+@interface HSFBodyStream() <NSStreamDelegate>{
+    uint8_t _buffer[HSF_BODY_STREAM_BUFFER_SIZE];
+    NSUInteger _bufferOffset;
+    NSUInteger _bufferLength;
+    // Raw bytes of streamed parameter before base64 encoding, with the incomplete quantum at the start.
+    uint8_t _raw[HSF_BODY_STREAM_BUFFER_SIZE / 4 * 3];
+    NSUInteger _leftoverLength;
+    // Bytes of the current part which are not in the buffer yet.
+    unsigned long long _partRemaining;
+    unsigned long long _partOffset;
+}
+
+@property (strong,nonatomic) NSArray *parts;
+@property (nonatomic) NSUInteger partIndex;
+@property (strong,nonatomic) NSInputStream *partStream;
+@property (strong,nonatomic) NSOutputStream *outputStream;
+@property (nonatomic) BOOL isPartStarted;
+/*
+ The output stream has space, but it was not filled since the last space event.
+ */
+@property (nonatomic) BOOL isSpaceAvailable;
+
+@end
+
+@implementation HSFBodyStream
+
+#pragma mark Private Methods
+
+-(id)initWithParts:(NSArray*)parts outputStream:(NSOutputStream*)outputStream
+{
+    self = [super init];
+    if (self){
+        _parts = [parts copy];
+        _outputStream = outputStream;
+    }
+    return self;
+}
+
+/*
+ Called on the writing thread.
+ */
+-(void)open
+{
+    [_activeWriters addObject:self];
+    self.outputStream.delegate = self;
+    [self.outputStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [self.outputStream open];
+}
+
+-(void)close
+{
+    [self closePartStream];
+    self.outputStream.delegate = nil;
+    [self.outputStream removeFromRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [self.outputStream close];
+    [_activeWriters removeObject:self];
+}
+
+-(void)closePartStream
+{
+    self.partStream.delegate = nil;
+    [self.partStream removeFromRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [self.partStream close];
+    self.partStream = nil;
+}
+
+-(void)stream:(NSStream*)stream handleEvent:(NSStreamEvent)eventCode
+{
+    if (stream == self.outputStream){
+        switch (eventCode){
+            case NSStreamEventHasSpaceAvailable:
+                self.isSpaceAvailable = YES;
+                [self writeBuffer];
+                break;
+            case NSStreamEventErrorOccurred:
+            case NSStreamEventEndEncountered:
+                // The reader closed the stream.
+                [self close];
+                break;
+            default:
+                break;
+        }
+        return;
+    }
+
+    switch (eventCode){
+        case NSStreamEventHasBytesAvailable:
+        case NSStreamEventEndEncountered:
+            // Writing waited for the part stream.
+            [self writeBuffer];
+            break;
+        case NSStreamEventErrorOccurred:
+            [self close];
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ Write while the output stream has space. Stops when the part stream has no bytes yet, its event resumes writing.
+ */
+-(void)writeBuffer
+{
+    while (self.isSpaceAvailable){
+        if (_bufferOffset == _bufferLength){
+            _bufferOffset = 0;
+            _bufferLength = 0;
+            if (![self fillBuffer]){
+                // A streamed parameter ended early, the short body fails the request.
+                [self close];
+                return;
+            }
+            if (!_bufferLength){
+                if (self.partIndex == [self.parts count]) [self close];
+                return;
+            }
+        }
+        NSInteger written = [self.outputStream write:_buffer + _bufferOffset maxLength:_bufferLength - _bufferOffset];
+        if (written < 0){
+            [self close];
+            return;
+        }
+        _bufferOffset += written;
+        self.isSpaceAvailable = [self.outputStream hasSpaceAvailable];
+    }
+}
+
+/*
+ Fill the buffer from the parts. Streamed parameters are read only when they have bytes, so a slow stream does not hold other bodies written on the thread. Returns NO if a part can't be read.
+ */
+-(BOOL)fillBuffer
+{
+    while (_bufferLength < HSF_BODY_STREAM_BUFFER_SIZE && self.partIndex < [self.parts count]){
+        id part = self.parts[self.partIndex];
+        if (!self.isPartStarted && ![self startPart:part]) return NO;
+
+        if (![part isKindOfClass:[NSData class]] && _partRemaining && ![self.partStream hasBytesAvailable]){
+            NSStreamStatus status = [self.partStream streamStatus];
+            if (status == NSStreamStatusAtEnd || status == NSStreamStatusClosed || status == NSStreamStatusError) return NO;
+            break;
+        }
+
+        NSUInteger space = HSF_BODY_STREAM_BUFFER_SIZE - _bufferLength;
+        if ([part isKindOfClass:[NSData class]]){
+            NSUInteger length = (NSUInteger)MIN((unsigned long long)space, _partRemaining);
+            [part getBytes:_buffer + _bufferLength range:NSMakeRange((NSUInteger)_partOffset, length)];
+            _bufferLength += length;
+            _partOffset += length;
+            _partRemaining -= length;
+        } else if ([(HSFStreamedParameter*)part isBase64Encoded]){
+            // Encoded quanta must fit the buffer whole.
+            if (space < 4) break;
+            NSUInteger length = (NSUInteger)MIN((unsigned long long)(space / 4 * 3 - _leftoverLength), _partRemaining);
+            NSInteger read = length ? [self.partStream read:_raw + _leftoverLength maxLength:length] : 0;
+            if (read < 0 || (read == 0 && _partRemaining > 0)) return NO;
+            _partRemaining -= read;
+            NSUInteger rawLength = _leftoverLength + read;
+            NSUInteger encodedLength = _partRemaining ? rawLength / 3 * 3 : rawLength;
+            _bufferLength += HSFBase64Encode(_raw, encodedLength, _buffer + _bufferLength);
+            _leftoverLength = rawLength - encodedLength;
+            memmove(_raw, _raw + encodedLength, _leftoverLength);
+        } else {
+            NSUInteger length = (NSUInteger)MIN((unsigned long long)space, _partRemaining);
+            NSInteger read = length ? [self.partStream read:_buffer + _bufferLength maxLength:length] : 0;
+            if (read < 0 || (read == 0 && _partRemaining > 0)) return NO;
+            _bufferLength += read;
+            _partRemaining -= read;
+        }
+
+        if (!_partRemaining){
+            [self closePartStream];
+            self.isPartStarted = NO;
+            self.partIndex++;
+        }
+    }
+    return YES;
+}
+
+-(BOOL)startPart:(id)part
+{
+    self.isPartStarted = YES;
+    _partOffset = 0;
+    _leftoverLength = 0;
+    if ([part isKindOfClass:[NSData class]]){
+        _partRemaining = [(NSData*)part length];
+        return YES;
+    }
+    // Bytes over the declared length are not sent.
+    HSFStreamedParameter *parameter = part;
+    _partRemaining = parameter.length;
+    self.partStream = [parameter inputStream];
+    if (!self.partStream) return NO;
+    self.partStream.delegate = self;
+    [self.partStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [self.partStream open];
+    return [self.partStream streamStatus] != NSStreamStatusError;
+}
+
+#pragma mark Class Methods
+
++(NSThread*)writingThread
+{
+    static NSThread *thread;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _activeWriters = [[NSMutableSet alloc] init];
+        thread = [[NSThread alloc] initWithTarget:self selector:@selector(runWritingThread) object:nil];
+        thread.name = BODY_STREAM_THREAD;
+        [thread start];
+    });
+    return thread;
+}
+
++(void)runWritingThread
+{
+    @autoreleasepool {
+        NSRunLoop *runLoop = [NSRunLoop currentRunLoop];
+        // The port keeps the run loop running while there are no streams.
+        [runLoop addPort:[NSMachPort port] forMode:NSDefaultRunLoopMode];
+        [runLoop run];
+    }
+}
+
++(NSInputStream*)inputStreamWithParts:(NSArray*)parts
+{
+    // Stream-backed parameters give their content once.
+    NSMutableArray *openedParts = [[NSMutableArray alloc] initWithCapacity:[parts count]];
+    for (id part in parts){
+        if ([part isKindOfClass:[HSFStreamedParameter class]] && ![part isReplayable]){
+            HSFStreamedParameter *parameter = part;
+            NSInputStream *stream = [parameter inputStream];
+            if (!stream) return nil;
+            part = [[HSFStreamedParameter alloc] initWithInputStream:stream length:parameter.length base64Encoded:parameter.isBase64Encoded];
+        }
+        [openedParts addObject:part];
+    }
+
+    CFReadStreamRef readStream;
+    CFWriteStreamRef writeStream;
+    CFStreamCreateBoundPair(kCFAllocatorDefault, &readStream, &writeStream, HSF_BODY_STREAM_BUFFER_SIZE);
+    NSInputStream *inputStream = CFBridgingRelease(readStream);
+    NSOutputStream *outputStream = CFBridgingRelease(writeStream);
+
+    HSFBodyStream *writer = [[HSFBodyStream alloc] initWithParts:openedParts outputStream:outputStream];
+    [writer performSelector:@selector(open) onThread:[self writingThread] withObject:nil waitUntilDone:NO];
+    return inputStream;
+}
+
++(unsigned long long)lengthOfParts:(NSArray*)parts
+{
+    unsigned long long length = 0;
+    for (id part in parts){
+        length += [part isKindOfClass:[NSData class]] ? [(NSData*)part length] : [(HSFStreamedParameter*)part encodedLength];
+    }
+    return length;
+}
+
++(BOOL)arePartsReplayable:(NSArray*)parts
+{
+    for (id part in parts){
+        if ([part isKindOfClass:[HSFStreamedParameter class]] && ![part isReplayable]) return NO;
+    }
+    return YES;
+}
+
+@end
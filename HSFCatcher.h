@@ -11,6 +11,10 @@
 #import "HSFNode.h"
 #import "HSFNode+NSXMLParserDelegate.h"
 #import "HSFActionStamp.h"
+#import "HSFBase64Decoder.h"
+#import "HSFCircuitBreaker.h"
+#import "HSFCatcherMetrics.h"
+#import "HSFInflater.h"
 
 @protocol HSFCatcherDelegate;
 @protocol HSFCatcherHandler;
@@ -28,7 +32,7 @@
 
 /*!
  @abstract Determine wether a catcher is performing asynchronous parsing.
- @discussion If parseUnitsAsynchronously set to YES, then this BOOL value determine whether if it is in parsing process or finished.
+ @discussion If parseUnitsAsynchronously set to YES, then this BOOL value determine whether if it is in parsing process or finished. It stays YES until the last recognized unit is delivered. Thread safe.
  */
 @property (nonatomic,readonly) BOOL isParsing;
 
@@ -40,16 +44,40 @@
 
 /*!
  @abstract Unit recognized.
- @discussion This represents number of extracted unit in xml format.
+ @discussion This represents number of extracted unit in xml format. Thread safe.
  */
 @property (nonatomic,readonly) NSUInteger unitRecognized;
 
 /*!
  @abstract Unit processed.
- @discussion Unit parsed and sent to delegate.
+ @discussion Unit parsed and sent to delegate. Thread safe.
  */
 @property (nonatomic,readonly) NSUInteger unitProcessed;
 
+/*!
+ @abstract Expected length of the response body as reported by the server, NSURLResponseUnknownLength if it is unknown.
+ @discussion Also NSURLResponseUnknownLength once the first chunk shows that the URL loading system has decoded the body, since the reported length counts encoded bytes.
+ */
+@property (nonatomic,readonly) long long expectedLength;
+
+/*!
+ @abstract Number of response body bytes received so far.
+ @discussion Counts compressed bytes if the catcher decompresses the response, see compressesMessages of HSFAction.
+ */
+@property (nonatomic,readonly) long long loadedLength;
+
+/*!
+ @abstract Number of XML bytes received so far, after decompression.
+ @discussion Equal to loadedLength if the response is not compressed or is decoded by the URL loading system.
+ */
+@property (nonatomic,readonly) long long decodedLength;
+
+/*!
+ @abstract Paths of saved attachments by content ID.
+ @discussion Filled while MTOM response is loading if the action has attachmentDirectory. Content IDs are the ones returned by XOPContentID of HSFNode, so xop:Include elements of units and entire response are resolved to files with it.
+ */
+@property (strong,nonatomic,readonly) NSDictionary *attachmentPaths;
+
 /*!
  @abstract Connection object that loads content.
  @discussion This object is created by HSFCatcher, it is a readonly property. Using this API you can cancel downloading. TODO: Here probably should not be this api to cancel connection, instead put method -cancelLoading with all required notification to handler/delegate.
@@ -62,6 +90,12 @@
  */
 @property (strong,nonatomic) id <HSFCatcherDelegate> delegate;
 
+/*!
+ @abstract Timing of the current or the last asynchronous loading.
+ @discussion Collected only if the handler asks for it in shouldCollectMetricsForCatcher:, nil otherwise.
+ */
+@property (strong,nonatomic,readonly) HSFCatcherMetrics *metrics;
+
 #pragma mark Tasks
 
 /*!
@@ -99,6 +133,20 @@
  */
 -(id)initWithDelegate:(id <HSFCatcherDelegate>)delegate;
 
+/*!
+ @abstract Start connection of the catcher waiting for admission.
+ @discussion Called by handler which postponed the connection in catcherShouldStartConnection:. Connection is started on the thread which started loading. Does nothing if loading is finished or cancelled meanwhile.
+ */
+-(void)admitConnection;
+
+/*!
+ @abstract Decode content of streaming tag as base64.
+ @discussion Content of the tag is decoded as it comes and written to the decoder's output, delegate is not notified about it. Decoder is finished after every element of the tag. Loading fails if the content is not valid base64. Set decoders before response is received, e.g. right after loading is started. Output of a failed attempt is not rolled back when loading is repeated.
+ @param decoder Decoder for the tag, nil to remove one.
+ @param tag One of streamingTags.
+ */
+-(void)setBase64Decoder:(HSFBase64Decoder*)decoder forTag:(NSString*)tag;
+
 #pragma mark NSURLConnectionDataDelegate Methods
 
 /*!
@@ -112,7 +160,7 @@
 
 /*!
  @abstract Handle arbitrary piece of downloaded data.
- @discussion This task extracts XML structures with unitTags as root tags the moment it downloads them. Then it parses them and dispatches to delegate using client:didReceiveUnit:. Parsing happens synchronously or asynchronously depending on parseUnitsAsynchronously property. It also collect the data to handle entire response.
+ @discussion This task extracts XML structures with unitTags as root tags the moment it downloads them. Then it parses them and dispatches to delegate using client:didReceiveUnit:, or in batches using catcher:didReceiveUnits:. Parsing happens synchronously or asynchronously depending on parseUnitsAsynchronously property. Asynchronous units are parsed in parallel by a pool of parseConcurrency workers and delivered in document order from a serial queue. It also collect the data to handle entire response.
  @param connection The connection sending the message.
  @param data The newly available data.
  */
@@ -127,7 +175,7 @@
 
 /*!
  @abstract Loading error handler.
- @discussion This tasks sets connection to nil and repeats loading after timeout. The timeout is gradually increased until MAX_TIMEOUT, then connection is closed.
+ @discussion This tasks sets connection to nil and repeats loading after timeout, until loadAttempts are made. The timeout grows exponentially up to maxTimeout with random jitter, and is not shorter than Retry-After of the server. Loading is not repeated if the host is tripped by circuit breaker of the handler.
  @param connection The connection sending the message.
  @param error An error object containing details of why the connection failed to load the request successfully.
  */
@@ -170,6 +218,60 @@
  */
 -(void)catcherFinished:(HSFCatcher*)catcher;
 
+@optional
+
+/*!
+ @abstract Ask whether catcher may start its connection right now.
+ @discussion Called each time a catcher is going to connect, retries included. If NO is returned, the handler must later call admitConnection of the catcher, or the catcher waits until it is cancelled. catcherFinished: is called for waiting catchers as well.
+ */
+-(BOOL)catcherShouldStartConnection:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Notification of catcher which failed an attempt and waits to retry.
+ @discussion Its connection is released, but its loading is not over: catcherStarted: is called again when it retries and catcherFinished: when it finally finishes, fails or is cancelled. If not implemented, catcherFinished: is called instead.
+ */
+-(void)catcherWillRetry:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Circuit breaker shared by catchers.
+ @discussion Catchers refuse to connect to tripped hosts and fail at once with HSFCircuitBreakerErrorDomain error. Connection failures and HTTP 503 are recorded as failures of the host.
+ @return Circuit breaker or nil.
+ */
+-(HSFCircuitBreaker*)circuitBreakerForCatcher:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Cached response for catcher.
+ @discussion Asked before the first connection attempt of actions with cacheLifetime. If data is returned, the catcher replays it asynchronously through the usual callbacks without touching the network.
+ @return Raw response or nil.
+ */
+-(NSData*)cachedResponseDataForCatcher:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Response of action with cacheLifetime is loaded from the network.
+ @discussion Called only for HTTP status 200 and valid entire response, if it was parsed.
+ @param data Raw response.
+ */
+-(void)catcher:(HSFCatcher*)catcher didLoadResponseData:(NSData*)data;
+
+/*!
+ @abstract Worker pool shared by catchers.
+ @discussion Asked by catchers whose actions have parseConcurrency of 0. If not implemented, such a catcher makes its own pool with default number of workers.
+ @return Operation queue to parse units on.
+ */
+-(NSOperationQueue*)parseQueueForCatcher:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Determine whether catcher collects metrics of the loading.
+ @discussion Asked once per asynchronous loading. If not implemented or NO is returned, nothing is measured.
+ */
+-(BOOL)shouldCollectMetricsForCatcher:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Metrics of finished loading.
+ @discussion Called once per asynchronous loading which collected metrics, before catcherFinished:. Units parsed asynchronously may still be in delivery.
+ */
+-(void)catcher:(HSFCatcher*)catcher didCollectMetrics:(HSFCatcherMetrics*)metrics;
+
 @end
 
 /*!
@@ -182,7 +284,7 @@
 
 /*!
  @abstract Downloading progress notification.
- @discussion Notifies a delegate about downloading progress. Note progress = 0.0 means loading is finished.
+ @discussion Notifies a delegate about downloading progress. Note progress = 0.0 means loading is finished. Progress is loadedLength to expectedLength, both count bytes on the wire, so it stays true for compressed responses; decodedLength tells how much XML was received. Not sent while expectedLength is unknown.
  @param catcher HSFCatcher which handled connection.
  @param progress Progress of downloading.
  */
@@ -213,6 +315,16 @@
  */
 -(void)catcher:(HSFCatcher *)catcher didReceiveContent:(NSString*)content forTag:(NSString*)tag lastChunk:(BOOL)lastChunk;
 
+/*!
+ @abstract Handle received raw bytes for specified XML tag.
+ @discussion Preferred to catcher:didReceiveContent:forTag:lastChunk: if both are implemented. Bytes are slices of received data, they are not copied or decoded, so a multibyte character may be broken between chunks. The data is valid only during the call; copy it to keep.
+ @param catcher HSFCatcher which handled connection.
+ @param data Raw bytes received for tag. May be empty for the last chunk.
+ @param tag NSString XML tag for which data was received.
+ @param lastChunk Indicates that receiving chunk of data is a last one.
+ */
+-(void)catcher:(HSFCatcher *)catcher didReceiveContentData:(NSData*)data forTag:(NSString*)tag lastChunk:(BOOL)lastChunk;
+
 /*!
  @abstract Handle entire response asynchronously.
  @discussion This task handles an entire XML tree received from server.
@@ -221,6 +333,48 @@
  */
 -(void)catcher:(HSFCatcher*)catcher didReceiveEntireResponse:(HSFNode*)rootNode;
 
+/*!
+ @abstract Handle raw bytes of MTOM attachment.
+ @discussion If response is multipart/related, its root part goes through unit tags, streaming tags and entire response as usual, and the other parts are passed here chunk by chunk without base64 inflation. The data is valid only during the call; copy it to keep. Not called if the action has attachmentDirectory.
+ @param catcher HSFCatcher which handled connection.
+ @param data Next bytes of the attachment. May be empty for the last chunk.
+ @param contentID Content ID of the part, see XOPContentID of HSFNode.
+ @param lastChunk Indicates that the part is finished.
+ */
+-(void)catcher:(HSFCatcher*)catcher didReceiveAttachmentData:(NSData*)data forContentID:(NSString*)contentID lastChunk:(BOOL)lastChunk;
+
+/*!
+ @abstract Handle MTOM attachment written into attachmentDirectory of the action.
+ @param catcher HSFCatcher which handled connection.
+ @param path Path of the file.
+ @param contentID Content ID of the part, see XOPContentID of HSFNode.
+ */
+-(void)catcher:(HSFCatcher*)catcher didSaveAttachmentAtPath:(NSString*)path forContentID:(NSString*)contentID;
+
+/*!
+ @abstract Handle unit decoded into model object.
+ @discussion Called instead of catcher:didReceiveUnit: if the action has unitModelMapping. Units are decoded synchronously or asynchronously like trees.
+ @param catcher HSFCatcher which handled connection.
+ @param object Model object of the unit.
+ */
+-(void)catcher:(HSFCatcher*)catcher didReceiveUnitObject:(id)object;
+
+/*!
+ @abstract Handle batch of received units.
+ @discussion Called instead of catcher:didReceiveUnit: and catcher:didReceiveUnitObject: if implemented. Units are collected in document order and delivered when a batch reaches unitBatchSize, unitBatchLength or unitBatchInterval of the action; the last partial batch is delivered before catcherDidFinishLoading:, which waits for asynchronously parsed units in this case. A partial batch is dropped if loading fails or is cancelled.
+ @param catcher HSFCatcher which handled connection.
+ @param units Array of root nodes of units, or of model objects if the action has unitModelMapping.
+ */
+-(void)catcher:(HSFCatcher*)catcher didReceiveUnits:(NSArray*)units;
+
+/*!
+ @abstract Handle entire response decoded into model object.
+ @discussion Called if the action has responseModelMapping, after catcher:didReceiveEntireResponse: if both are implemented. Response is decoded while it is downloading.
+ @param catcher HSFCatcher which handled a connection.
+ @param object Model object of the first element at responseModelPath, or nil if the response has no such element.
+ */
+-(void)catcher:(HSFCatcher*)catcher didReceiveResponseObject:(id)object;
+
 /*!
  @abstract Handle async loading error.
  @discussion This task is called if async loading failed after all necessary attempts.
@@ -259,4 +413,11 @@
  */
 -(void)catcherDidFinishLoading:(HSFCatcher *)catcher;
 
+/*!
+ @abstract Cancel notification.
+ @discussion Called by cancel if loading was in progress, after the handler is notified. Loading which finished or failed is not cancelled.
+ @param catcher HSFCatcher which loading is cancelled.
+ */
+-(void)catcherDidCancelLoading:(HSFCatcher *)catcher;
+
 @end
@@ -10,18 +10,81 @@
 #import "HSFAction.h"
 #import "HSFCommon.h"
 #import "HSFExceptions.h"
+#import "HSFTagScanner.h"
+#import "HSFNodePushParser.h"
+#import "HSFModelDecoder.h"
+#import "HSFBodyStream.h"
+#import "HSFMultipartParser.h"
+#import "HSFCatcherDelegateGroup.h"
+#import <unistd.h>
 
 #define HSF_CATCHER_DEBUG 0
 
 static id <HSFCatcherHandler> _handler;
 
-@interface HSFCatcher()
+/*
+ Length of the prefix of UTF-8 bytes which does not end with an incomplete character.
+ */
+static NSUInteger HSFUTF8CompleteLength(const unsigned char *bytes, NSUInteger length)
+{
+    NSUInteger back = 0;
+    while (back < length && back < 4){
+        unsigned char c = bytes[length - 1 - back];
+        ++back;
+        if ((c & 0xC0) != 0x80){
+            NSUInteger expected = 1;
+            if ((c & 0xE0) == 0xC0) expected = 2;
+            else if ((c & 0xF0) == 0xE0) expected = 3;
+            else if ((c & 0xF8) == 0xF0) expected = 4;
+            return (back < expected) ? length - back : length;
+        }
+    }
+    return length;
+}
+
+@interface HSFCatcher() <HSFTagScannerDelegate,HSFMultipartParserDelegate>
 
 /*
  Temporary storage for received data
  */
 @property (strong, nonatomic) NSMutableData *cumulativeData;
 
+/*
+ Temporary file the received data is spilled to once it exceeds spillThreshold of the action.
+ */
+@property (strong,nonatomic) NSString *spillPath;
+@property (strong,nonatomic) NSFileHandle *spillFile;
+
+/*
+ Memory map of the temporary file, once data is collected.
+ */
+@property (strong,nonatomic) NSData *mappedData;
+
+/*
+ HTTP status code of the response, only successful responses are cached.
+ */
+@property (nonatomic) NSInteger responseStatusCode;
+
+/*
+ Determine whether the response is replayed from cache.
+ */
+@property (nonatomic) BOOL isReplaying;
+
+/*
+ Parser of entire response, if it is parsed incrementally.
+ */
+@property (strong,nonatomic) HSFNodePushParser *pushParser;
+
+/*
+ Decoder of entire response into model object, if the action has responseModelMapping.
+ */
+@property (strong,nonatomic) HSFModelDecoder *modelDecoder;
+
+/*
+ Symbol table for names and attribute keys of the response trees. Made before parsing starts, parse queue interns names into it concurrently.
+ */
+@property (strong,nonatomic) HSFSymbolTable *symbolTable;
+
 // Make writeable properties at private side.
 @property (nonatomic,readwrite) BOOL isInLoading;
 @property (nonatomic,readwrite) NSUInteger unitRecognized;
@@ -29,19 +92,117 @@ static id <HSFCatcherHandler> _handler;
 @property (strong,nonatomic,readwrite) NSURLConnection *connection;
 
 @property (nonatomic) NSInteger unitInProgress;
-@property (strong,nonatomic) dispatch_queue_t parseQueue;
+@property (strong,nonatomic) NSOperationQueue *parseQueue;
+
+/*
+ Serial queue which delivers asynchronously parsed units in document order.
+ */
+@property (strong,nonatomic) dispatch_queue_t deliveryQueue;
+
+/*
+ Reorder buffer. Parsed unit trees and parse errors by unit number, waiting for preceding units.
+ */
+@property (strong,nonatomic) NSMutableDictionary *parsedUnits;
+
+/*
+ Number of the next unit to deliver.
+ */
+@property (nonatomic) NSUInteger unitDelivered;
+
+/*
+ Determine whether a unit of the current response failed to parse, subsequent units are dropped.
+ */
+@property (nonatomic) BOOL unitFailed;
+
+/*
+ Units waiting for batch delivery and their size in bytes of raw XML.
+ */
+@property (strong,nonatomic) NSMutableArray *unitBatch;
+@property (nonatomic) NSUInteger unitBatchLength;
+
+/*
+ Incremented whenever a batch is taken or dropped, so a timer of a previous batch does nothing.
+ */
+@property (nonatomic) NSUInteger unitBatchNumber;
+
+/*
+ Determine whether catcherDidFinishLoading: waits for the last asynchronously parsed unit.
+ */
+@property (nonatomic) BOOL isFinishDeferred;
+
+/*
+ Incremented for every response, units parsed for a previous response are dropped.
+ */
+@property (nonatomic) NSUInteger responseGeneration;
 @property (nonatomic) NSTimeInterval timeout;
 @property (nonatomic) NSUInteger failAttemptsMade;
 
-@property (strong,nonatomic) NSString *fixedTag;
-@property (strong,nonatomic) NSString *openTag;
-@property (strong,nonatomic) NSMutableString *bufferString;
-@property (strong,nonatomic) NSString *closedTag;
+/*
+ Scanner of unit and streaming tags, nil if there are no special tags.
+ */
+@property (strong,nonatomic) HSFTagScanner *tagScanner;
+
+/*
+ Tail of streaming content which is an incomplete UTF-8 character.
+ */
+@property (strong,nonatomic) NSMutableData *contentRemainder;
+
+/*
+ Base64 decoders by streaming tag.
+ */
+@property (strong,nonatomic) NSMutableDictionary *base64Decoders;
 
 @property (strong,nonatomic,readwrite) HSFActionStamp *actionStamp;
+@property (strong,nonatomic,readwrite) HSFCatcherMetrics *metrics;
+
+/*
+ Time spent in parsing and callbacks called by the tag scanner, while it scans a piece of data.
+ */
+@property (nonatomic) NSTimeInterval nestedScanDuration;
+
+/*
+ Thread which started networking, connection is scheduled in its run loop.
+ */
+@property (strong,nonatomic) NSThread *networkingThread;
+
+@property (nonatomic,readwrite) long long expectedLength;
+@property (nonatomic,readwrite) long long loadedLength;
+@property (nonatomic,readwrite) long long decodedLength;
+
+/*
+ Content coding of the response in lower case, nil if the response has no Content-Encoding header.
+ */
+@property (strong,nonatomic) NSString *contentEncoding;
+
+/*
+ Decompressor of the response, nil if it is not compressed. Chosen by contentEncoding with the first chunk.
+ */
+@property (strong,nonatomic) HSFInflater *inflater;
+@property (nonatomic) BOOL isEncodingChecked;
+
+/*
+ Parser of multipart/related (MTOM) response, nil if the response is not multipart.
+ */
+@property (strong,nonatomic) HSFMultipartParser *multipartParser;
+
+/*
+ Content ID of the root part from start parameter of the content type, nil if the first part is the root.
+ */
+@property (strong,nonatomic) NSString *rootContentID;
+@property (nonatomic) BOOL isRootPartFound;
+@property (nonatomic) BOOL isInRootPart;
+
+/*
+ Content ID of the current attachment, nil in the root part and in parts without Content-ID.
+ */
+@property (strong,nonatomic) NSString *attachmentContentID;
 
-@property (nonatomic) long long expectedLength;
-@property (nonatomic) long long loadedLength;
+/*
+ File of the current attachment, if the action has attachmentDirectory.
+ */
+@property (strong,nonatomic) NSString *attachmentPath;
+@property (strong,nonatomic) NSFileHandle *attachmentFile;
+@property (strong,nonatomic) NSMutableDictionary *mutableAttachmentPaths;
 
 @end
 
@@ -49,21 +210,71 @@ static id <HSFCatcherHandler> _handler;
 
 #pragma mark Properties
 
--(NSMutableString*)bufferString
+-(NSMutableData*)contentRemainder
 {
-    if(!_bufferString)_bufferString = [[NSMutableString alloc] init];
-    return _bufferString;
+    if(!_contentRemainder)_contentRemainder = [[NSMutableData alloc] init];
+    return _contentRemainder;
 }
 
--(dispatch_queue_t)parseQueue
+-(NSOperationQueue*)parseQueue
 {
-    if(!_parseQueue)_parseQueue = dispatch_queue_create(PARSE_QUEUE, NULL);
+    if (!_parseQueue){
+        NSUInteger concurrency = self.actionStamp.parseConcurrency;
+        id<HSFCatcherHandler> handler = [[self class] handler];
+        if (!concurrency && [handler respondsToSelector:@selector(parseQueueForCatcher:)]){
+            _parseQueue = [handler parseQueueForCatcher:self];
+        }
+        if (!_parseQueue){
+            _parseQueue = [[NSOperationQueue alloc] init];
+            _parseQueue.name = @PARSE_QUEUE;
+            _parseQueue.maxConcurrentOperationCount = concurrency ? concurrency : NSOperationQueueDefaultMaxConcurrentOperationCount;
+        }
+    }
     return _parseQueue;
 }
 
+-(NSMutableDictionary*)base64Decoders
+{
+    if(!_base64Decoders)_base64Decoders = [[NSMutableDictionary alloc] init];
+    return _base64Decoders;
+}
+
+-(NSMutableDictionary*)mutableAttachmentPaths
+{
+    if(!_mutableAttachmentPaths)_mutableAttachmentPaths = [[NSMutableDictionary alloc] init];
+    return _mutableAttachmentPaths;
+}
+
+-(NSDictionary*)attachmentPaths
+{
+    return [self.mutableAttachmentPaths copy];
+}
+
+-(NSMutableDictionary*)parsedUnits
+{
+    if(!_parsedUnits)_parsedUnits = [[NSMutableDictionary alloc] init];
+    return _parsedUnits;
+}
+
 -(BOOL)isParsing
 {
-    return (self.unitInProgress) ? YES : NO;
+    @synchronized(self){
+        return (self.unitInProgress) ? YES : NO;
+    }
+}
+
+-(NSUInteger)unitRecognized
+{
+    @synchronized(self){
+        return _unitRecognized;
+    }
+}
+
+-(NSUInteger)unitProcessed
+{
+    @synchronized(self){
+        return _unitProcessed;
+    }
 }
 
 -(NSMutableData*)cumulativeData
@@ -79,13 +290,30 @@ static id <HSFCatcherHandler> _handler;
 #ifdef DEBUG
     NSLog(@"[%@ %@] %@, catcher.isInLoading:%@",[self class],NSStringFromSelector(_cmd),self.actionStamp.actionClass,self.isInLoading?@"YES":@"NO");
 #endif
+    BOOL wasInLoading = self.isInLoading;
+    [self discardUnitBatch];
     [self finishJobAndHotifyHandler];
+    
+    if (wasInLoading && [self.delegate respondsToSelector:@selector(CATCHER_DID_CANCEL_LOADING_SELECTOR)])
+        [self.delegate performSelector:@selector(CATCHER_DID_CANCEL_LOADING_SELECTOR) withObject:self];
 }
 
 //TODO: shift it to HSFClient, rework, rethink, reconsider.
 +(HSFNode*)loadSynchronouslyWithAction:(HSFAction*)action response:(NSURLResponse **)response error:(NSError **)error;
 {
-    NSData *data = [NSURLConnection sendSynchronousRequest:action.request returningResponse:response error:error];
+    NSURLRequest *request = action.request;
+    NSArray *parts = action.HTTPBodyParts;
+    if (parts){
+        NSInputStream *bodyStream = [HSFBodyStream inputStreamWithParts:parts];
+        if (!bodyStream){
+            if (error) *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorRequestBodyStreamExhausted userInfo:nil];
+            return nil;
+        }
+        NSMutableURLRequest *streamedRequest = [request mutableCopy];
+        [streamedRequest setHTTPBodyStream:bodyStream];
+        request = streamedRequest;
+    }
+    NSData *data = [NSURLConnection sendSynchronousRequest:request returningResponse:response error:error];
     NSError *parseError;
     HSFNode * root = [HSFNode nodeTreeFromData:data error:&parseError];
     if (parseError != NULL) *error = parseError;
@@ -111,13 +339,41 @@ static id <HSFCatcherHandler> _handler;
     }
     
     self.isInLoading = YES;
+    // Attempts are counted per loading, a response which fails after its headers is still an attempt.
+    self.failAttemptsMade = 0;
+    
+    self.metrics = nil;
+    id<HSFCatcherHandler> handler = [[self class] handler];
+    if ([handler respondsToSelector:@selector(shouldCollectMetricsForCatcher:)] && [handler shouldCollectMetricsForCatcher:self]){
+        self.metrics = [[HSFCatcherMetrics alloc] initWithActionClass:[action class]];
+    }
     
     // Fix action in the actionStamp
+    NSTimeInterval buildStart = [self metricsTime];
     self.actionStamp = [[HSFActionStamp alloc] initWithAction:action];
+    [self.metrics addRequestBuildDuration:[self metricsTime] - buildStart];
     
     [self startNetworkingProcess];
 }
 
+-(void)admitConnection
+{
+    NSThread *thread = self.networkingThread ? self.networkingThread : [NSThread mainThread];
+    [self performSelector:@selector(startConnection) onThread:thread withObject:nil waitUntilDone:NO];
+}
+
+-(void)setBase64Decoder:(HSFBase64Decoder*)decoder forTag:(NSString*)tag
+{
+    if (!tag){
+        [NSException raise:NSInvalidArgumentException format:@"The tag is nil."];
+    }
+    if (decoder){
+        self.base64Decoders[tag] = decoder;
+    } else {
+        [self.base64Decoders removeObjectForKey:tag];
+    }
+}
+
 -(id)initWithDelegate:(id <HSFCatcherDelegate>)delegate
 {
     self = [super init];
@@ -129,6 +385,7 @@ static id <HSFCatcherHandler> _handler;
     if (self){
         _delegate = delegate;
         _isInLoading = NO;
+        _deliveryQueue = dispatch_queue_create(DELIVERY_QUEUE, NULL);
     }
     
     return self;
@@ -144,153 +401,116 @@ static id <HSFCatcherHandler> _handler;
 
 -(void)connection:(NSURLConnection *)connection didReceiveResponse:(NSURLResponse *)response
 {
+    // Callbacks of a shared catcher are fixed from here on.
+    if ([self.delegate isKindOfClass:[HSFCatcherDelegateGroup class]]){
+        [(HSFCatcherDelegateGroup*)self.delegate closeJoining];
+    }
+    [self.metrics markResponse];
+    self.responseStatusCode = [response isKindOfClass:[NSHTTPURLResponse class]] ? [(NSHTTPURLResponse*)response statusCode] : HTTP_STATUS_OK;
+    HSFCircuitBreaker *circuitBreaker = [self circuitBreaker];
+    if (self.responseStatusCode == HTTP_STATUS_SERVICE_UNAVAILABLE || self.responseStatusCode == HTTP_STATUS_TOO_MANY_REQUESTS){
+        // Server asks to come back later, the body is not a SOAP response.
+        NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:@{NSLocalizedDescriptionKey:[NSHTTPURLResponse localizedStringForStatusCode:self.responseStatusCode]}];
+        NSTimeInterval retryAfter = [[self class] retryAfterIntervalForResponse:(NSHTTPURLResponse*)response];
+        if (retryAfter > 0){
+            userInfo[HSF_RETRY_AFTER_KEY] = @(retryAfter);
+        }
+        NSError *error = [NSError errorWithDomain:HSFHTTPErrorDomain code:self.responseStatusCode userInfo:[userInfo copy]];
+        [self.connection cancel];
+        [self connection:self.connection didFailWithError:error];
+        return;
+    }
+    if (!self.isReplaying){
+        [circuitBreaker recordSuccessForURL:self.actionStamp.request.URL];
+    }
+    
     self.expectedLength = [response expectedContentLength];
     self.loadedLength = 0;
+    self.decodedLength = 0;
+    self.contentEncoding = [[self class] contentEncodingOfResponse:response];
+    self.inflater = nil;
+    self.isEncodingChecked = NO;
     [self.cumulativeData setLength:0];
-    self.unitInProgress = 0;
-    self.unitRecognized = 0;
-    self.unitProcessed = 0;
+    @synchronized(self){
+        ++self.responseGeneration;
+        self.unitInProgress = 0;
+        self.unitRecognized = 0;
+        self.unitProcessed = 0;
+        self.unitDelivered = 0;
+        self.unitFailed = NO;
+        self.parsedUnits = nil;
+    }
+    [self discardUnitBatch];
+    self.parseQueue = nil;
     self.timeout = 0.0;
-    self.failAttemptsMade = 0;
-    if ([self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_RESPONSE_SELECTOR)])
+    self.tagScanner = nil;
+    self.contentRemainder = nil;
+    for (HSFBase64Decoder *decoder in [self.base64Decoders allValues]){
+        [decoder reset];
+    }
+    [self removeSpillFile];
+    [self removePartialAttachment];
+    [self.mutableAttachmentPaths removeAllObjects];
+    self.multipartParser = [self multipartParserForResponse:response];
+    self.isRootPartFound = NO;
+    self.isInRootPart = NO;
+    self.pushParser = nil;
+    self.symbolTable = [self symbolTableForActionStamp:self.actionStamp];
+    if ([self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_ENTIRE_RESPONSE_SELECTOR)] && self.actionStamp.isParseEntireResponseIncrementally){
+        self.pushParser = [[HSFNodePushParser alloc] initWithSymbolTable:self.symbolTable];
+    }
+    self.modelDecoder = nil;
+    if (self.actionStamp.responseModelMapping && [self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_RESPONSE_OBJECT_SELECTOR)]){
+        self.modelDecoder = [[HSFModelDecoder alloc] initWithMapping:self.actionStamp.responseModelMapping path:self.actionStamp.responseModelPath];
+    }
+    if ([self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_RESPONSE_SELECTOR)]){
+        NSTimeInterval delegateStart = [self metricsTime];
         [self.delegate performSelector:@selector(CATCHER_DID_RECEIVE_RESPONSE_SELECTOR) withObject:self withObject:response];
+        [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
+    }
 }
 
 -(void)connection:(NSURLConnection *)connection didReceiveData:(NSData *)data
 {
     self.loadedLength += [data length];
-    if ([self.delegate respondsToSelector:@selector(CLIENT_DID_PROGRESS)]){
+    [self.metrics markDataReceived:[data length]];
+    if (!self.isEncodingChecked){
+        self.isEncodingChecked = YES;
+        [self prepareDecodingWithData:data];
+    }
+    // Wire bytes of a body decoded by the URL loading system are not known.
+    if (self.expectedLength > 0 && [self.delegate respondsToSelector:@selector(CLIENT_DID_PROGRESS)]){
         float progress = (float)self.loadedLength / self.expectedLength;
+        NSTimeInterval delegateStart = [self metricsTime];
         [self.delegate catcher:self didProgress:(progress < 1.0) ? progress : 1.0];
+        [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
     }
     
     if ([data length] == 0)
         //TODO: Get rid of this exception.
         [NSException raise:HSFServiceResponseException format:@"Server should not return empty data in SOAP exchange."];
     
-    if ([self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_ENTIRE_RESPONSE_SELECTOR)])
-        [self.cumulativeData appendData:data];
-    
-    if ([self.actionStamp.unitTags count] > 0 && ![self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_UNIT_SELECTOR)])
-        [NSException raise:HSFCatcherSpecialTagsException format:@"HSFCatcher unit tags are defined, but delegate does not responds for the selector."];
-    
-    if ([self.actionStamp.streamingTags count] > 0 && ![self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_CONTENT_SELECTOR)])
-        [NSException raise:HSFCatcherSpecialTagsException format:@"HSFCatcher streming tags are defined, but delegate does not responds for the selector."];
-    
-    
-    //Order matter!
-    NSArray *specialTags;
-    if ([self.actionStamp.orderedSpecialTags count]){
-        if ([self.actionStamp.orderedSpecialTags count] != [self.actionStamp.unitTags count] + [self.actionStamp.streamingTags count])
-            [NSException raise:HSFCatcherSpecialTagsException format:@"HSFCatcher orderedSpecialTags number is not equal to unitTag and streamingTags number."];
-        specialTags = [self.actionStamp.orderedSpecialTags mutableCopy];
-    } else {
-        NSMutableArray *arr = [[NSMutableArray alloc] initWithArray:self.actionStamp.unitTags];
-        [arr removeObjectsInArray:self.actionStamp.streamingTags];
-        specialTags = [self.actionStamp.streamingTags arrayByAddingObjectsFromArray:arr];
+    data = [self decodedDataFromData:data];
+    if (!data){
+        [self.connection cancel];
+        [self connection:self.connection didFailWithError:self.inflater.error];
+        return;
     }
+    // Chunk may hold only part of a compressed block.
+    if (![data length]) return;
+    self.decodedLength += [data length];
     
-    if ([specialTags count] > 0){
-    
-        NSString *stringToProcess;
-        
-        if (!self.bufferString){
-            self.bufferString = [[NSMutableString alloc] init];
-        }
-        [self.bufferString appendString:[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding]];
-        
-        NSRange range;
-        BOOL isNeedNewData = NO;
-        
-        //Start process received string.
-        while (!isNeedNewData){
-            
-            // Search if non of the tags is found.
-            if ([self.fixedTag length] == 0){
-                for (NSString *tag in specialTags){
-                    NSString *openTag_pattern = [NSString stringWithFormat:@"<%@(( [^>]*>)|>)",tag];
-                    range = [self.bufferString rangeOfString:openTag_pattern options:NSRegularExpressionSearch|NSCaseInsensitiveSearch];
-                    if (range.location != NSNotFound){
-                        self.fixedTag = tag;
-                        self.openTag = [self.bufferString substringWithRange:range];
-                        //Cutting buffer
-                        [self.bufferString deleteCharactersInRange:NSMakeRange(0, range.location+range.length)];
-                        range = [self.openTag rangeOfString:@"/>"];
-                        if (range.location != NSNotFound){
-                            self.closedTag = self.openTag;
-                            stringToProcess = @"";
-                        }
-                        break;
-                    }
-                }
-            }
-            
-            // Free buffer string if data is not broken in the middle of the tag e.g. "djkaafsdf<AudioDa.."
-            if ([self.fixedTag length] == 0){
-                isNeedNewData = YES;
-                if (![self isTagBreakingString:self.bufferString]){
-                    self.bufferString = nil;
-                    break;
-                }
-            }
-            
-            if ([self.fixedTag length] && ![self.closedTag length]){
-                NSString *closedTag_template = [NSString stringWithFormat:@"</%@>", self.fixedTag];
-                range = [self.bufferString rangeOfString:closedTag_template options:NSCaseInsensitiveSearch];
-                if (range.location != NSNotFound){
-                    self.closedTag = [self.bufferString substringWithRange:range];
-                    stringToProcess = [self.bufferString substringToIndex:range.location];
-                    [self.bufferString setString:[self.bufferString substringFromIndex:(range.location+range.length)]];
-                } else {
-                    isNeedNewData = YES;
-                }
-            }
-            
-            if ([self.closedTag length] && ![self.openTag length]){
-                [NSException raise:HSFCatcherSpecialTagsException format:@"HSFCatcher openTag is empty while closed is set"];
-            }
-            
-            if ([self.openTag length] && [self.actionStamp.streamingTags containsObject:self.fixedTag] && [self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_CONTENT_SELECTOR)]){
-                if ([self.closedTag length]){
-                    [self.delegate catcher:self didReceiveContent:stringToProcess forTag:self.fixedTag lastChunk:YES];
-                    stringToProcess = nil;
-                    self.openTag = nil;
-                    self.closedTag = nil;
-                    self.fixedTag = nil;
-                } else if (![self isTagBreakingString:self.bufferString]){
-                    [self.delegate catcher:self didReceiveContent:self.bufferString forTag:self.fixedTag lastChunk:NO];
-                    self.bufferString = nil;
-                }
-            }
-            
-            if ([self.closedTag length] && [self.actionStamp.unitTags containsObject:self.fixedTag] && [self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_UNIT_SELECTOR)]){
-                ++self.unitRecognized;
-                if ([stringToProcess length]){
-                    stringToProcess = [NSString stringWithFormat:@"%@%@%@",self.openTag,stringToProcess,self.closedTag];
-                } else {
-                    stringToProcess = self.closedTag;
-                }
-                NSData *dataToParse = [stringToProcess dataUsingEncoding:NSUTF8StringEncoding];
-                
-                [self performParseOperation:^{
-                    NSError *parseError;
-                    HSFNode *root = [HSFNode nodeTreeFromData:dataToParse error:&parseError];
-                    ++self.unitProcessed;
-                    if (!parseError) {
-                        [self.delegate performSelector:@selector(CLIENT_DID_RECEIVE_UNIT_SELECTOR) withObject:self withObject:[root.children firstObject]];
-                    } else {
-                        [self.connection cancel];
-                        [self connection:self.connection didFailWithError:parseError];
-                        return;
-                    }
-                }];
-                self.openTag = nil;
-                self.closedTag = nil;
-                self.fixedTag = nil;
-                stringToProcess = nil;
-            }
+    HSFMultipartParser *multipartParser = self.multipartParser;
+    if (multipartParser){
+        // The root part comes back through processXMLData:.
+        // Failed loading resets the parser, then it stops at once.
+        if (![multipartParser parseData:data]){
+            [self.connection cancel];
+            [self connection:self.connection didFailWithError:multipartParser.error];
         }
+        return;
     }
+    [self processXMLData:data];
 }
 
 -(void)connectionDidFinishLoading:(NSURLConnection *)connection
@@ -298,7 +518,28 @@ static id <HSFCatcherHandler> _handler;
 //    if ([self.cumulativeData length] == 0)
 //        [NSException raise:HSFServiceResponseException format:@"No data received while loading."];
     
-    if (self.openTag != nil && self.closedTag == nil){
+    [self.metrics markLastByte];
+    if (self.inflater && !self.inflater.isFinished){
+        // Compressed stream is truncated.
+        NSDictionary *userInfo = @{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_DECOMPRESSION_ERROR};
+        NSError *error = [NSError errorWithDomain:HSFParseErrorDomain
+                                             code:HSF_ERROR_CODE_DECOMPRESSION_ERROR
+                                         userInfo:userInfo];
+        [self connection:connection didFailWithError:error];
+        return;
+    }
+    
+    if (self.multipartParser && !self.multipartParser.isFinished){
+        // Close delimiter is missing, the last part is truncated.
+        NSDictionary *userInfo = @{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_MULTIPART_ERROR};
+        NSError *error = [NSError errorWithDomain:HSFParseErrorDomain
+                                             code:HSF_ERROR_CODE_MULTIPART_ERROR
+                                         userInfo:userInfo];
+        [self connection:connection didFailWithError:error];
+        return;
+    }
+    
+    if (self.tagScanner.isInElement){
         NSDictionary *userInfo = @{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_XML_PARSE_ERROR};
         NSError *error = [NSError errorWithDomain:HSFParseErrorDomain
                                              code:HSF_ERROR_CODE_XML_PARSE_ERROR
@@ -307,12 +548,23 @@ static id <HSFCatcherHandler> _handler;
         return;
     }
     
+    HSFNode* root;
     if ([self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_ENTIRE_RESPONSE_SELECTOR)]){
         NSError *parseError;
-        HSFNode* root = [HSFNode nodeTreeFromData:self.cumulativeData error:&parseError];
+        NSTimeInterval parseStart = [self metricsTime];
+        if (self.pushParser){
+            root = [self.pushParser finishWithError:&parseError];
+            self.pushParser = nil;
+        } else {
+            NSData *data = [self collectedDataWithError:&parseError];
+            if (data) root = [self nodeTreeFromData:data error:&parseError];
+        }
+        [self.metrics addEntireParseDuration:[self metricsTime] - parseStart];
         // root is pointer to tree root element
         if (!parseError) {
+            NSTimeInterval delegateStart = [self metricsTime];
             [self.delegate performSelector:@selector(CLIENT_DID_RECEIVE_ENTIRE_RESPONSE_SELECTOR) withObject:self withObject:[root.children firstObject]];
+            [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
         } else {
             [self.connection cancel];
             [self connection:self.connection didFailWithError:parseError];
@@ -320,16 +572,40 @@ static id <HSFCatcherHandler> _handler;
         }
     }
     
+    if (self.modelDecoder){
+        NSError *parseError;
+        NSTimeInterval parseStart = [self metricsTime];
+        NSArray *objects = [self.modelDecoder finishWithError:&parseError];
+        self.modelDecoder = nil;
+        [self.metrics addEntireParseDuration:[self metricsTime] - parseStart];
+        if (parseError){
+            [self.connection cancel];
+            [self connection:self.connection didFailWithError:parseError];
+            return;
+        }
+        NSTimeInterval delegateStart = [self metricsTime];
+        [self.delegate performSelector:@selector(CLIENT_DID_RECEIVE_RESPONSE_OBJECT_SELECTOR) withObject:self withObject:[objects firstObject]];
+        [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
+    }
+    
+    if ([self isCachingResponse] && self.responseStatusCode == HTTP_STATUS_OK){
+        NSData *data = [self collectedDataWithError:NULL];
+        if ([data length]) [[[self class] handler] catcher:self didLoadResponseData:data];
+    }
+    
     // Perform this test only in DEBUG mode.
 #ifdef DEBUG
-    if ([self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_UNIT_SELECTOR)] && [self.actionStamp.unitTags count] > 0 && [self.cumulativeData length] > 0){
-        HSFNode* root = [HSFNode nodeTreeFromData:self.cumulativeData error:NULL];
+    if ([self isReceivingUnits] && [self.actionStamp.unitTags count] > 0 && (root || [self.cumulativeData length] > 0)){
+        if (!root) root = [HSFNode nodeTreeFromData:self.cumulativeData error:NULL];
         NSUInteger total = 0;
+        BOOL hasSelectors = NO;
         for (NSString *tag in self.actionStamp.unitTags){
+            // Elements of path selectors can't be counted by name.
+            hasSelectors = hasSelectors || [HSFTagScanner isPathSelector:tag];
             total += [root countOfNodesByName:tag];
         }
         if (self.actionStamp.isParseUnitsAsynchronously) while (self.isParsing) {};
-        if (self.unitProcessed != total){
+        if (!hasSelectors && self.unitProcessed != total){
             [NSException raise:HSFCatcherMissedElementException format:@"Number of elements counted from entire xml document mismatches with number of processed elements, unitProcessed = %lu, total = %lu",(unsigned long)self.unitProcessed,(unsigned long)total];
         }
     }
@@ -339,10 +615,29 @@ static id <HSFCatcherHandler> _handler;
         NSLog(@"[%@ %@] %@, cumulativeData: %@",[self class],NSStringFromSelector(_cmd),self.actionStamp.actionClass,[[NSString alloc] initWithData:self.cumulativeData encoding:NSUTF8StringEncoding]);
     }
 #endif
+    // The last batch goes before the finish notification, even if units are still parsed.
+    BOOL isFinishDeferred = NO;
+    if ([self isBatchingUnits]){
+        @synchronized(self){
+            isFinishDeferred = self.unitInProgress > 0 && !self.unitFailed;
+            self.isFinishDeferred = isFinishDeferred;
+        }
+        if (!isFinishDeferred && self.actionStamp.isParseUnitsAsynchronously){
+            // Let a batch timer on the delivery queue finish first. Waiting for the queue here would deadlock with a delegate which waits for this thread.
+            isFinishDeferred = YES;
+            dispatch_async(self.deliveryQueue, ^{
+                [self flushUnitBatch];
+                [self notifyDelegateFinishLoadingOnNetworkingThread];
+            });
+        } else if (!isFinishDeferred){
+            [self flushUnitBatch];
+        }
+    }
+    
+    [self reportMetricsSucceeded:YES error:nil];
     [self finishJobAndHotifyHandler];
     
-    if ([self.delegate respondsToSelector:@selector(CATCHER_DID_FINISH_LOADING_SELECTOR)])
-        [self.delegate performSelector:@selector(CATCHER_DID_FINISH_LOADING_SELECTOR) withObject:self];
+    if (!isFinishDeferred) [self notifyDelegateFinishLoading];
 #ifdef DEBUG
     NSLog(@"[%@ %@] %@",[self class],NSStringFromSelector(_cmd),self.actionStamp.actionClass);
 #endif
@@ -351,14 +646,23 @@ static id <HSFCatcherHandler> _handler;
 -(void)connection:(NSURLConnection *)connection didFailWithError:(NSError *)error
 {
     ++self.failAttemptsMade;
-    if ((self.actionStamp.loadAttempts > 1) && self.actionStamp.maxTimeout && self.timeout < self.actionStamp.maxTimeout) {
-        self.timeout += (double)self.actionStamp.maxTimeout/(self.actionStamp.loadAttempts-1);
-        [self finishNetworkingProcess];
+    HSFCircuitBreaker *circuitBreaker = [self circuitBreaker];
+    if ([[self class] isHostFailureError:error]){
+        [circuitBreaker recordFailureForURL:self.actionStamp.request.URL];
+    }
+    
+    // Streamed body which was read already can't be sent again.
+    BOOL isReloadable = [HSFBodyStream arePartsReplayable:self.actionStamp.HTTPBodyParts];
+    if (isReloadable && (self.actionStamp.loadAttempts > 1) && self.actionStamp.maxTimeout && self.failAttemptsMade < self.actionStamp.loadAttempts && ![circuitBreaker isTrippedForURL:self.actionStamp.request.URL]) {
+        self.timeout = [self retryDelayAfterError:error];
+        [self.metrics markRetry];
+        [self finishNetworkingProcessForRetry];
         [self performSelector:@selector(reloadAsynchronously) withObject:nil afterDelay:self.timeout];
     }  else {
         NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:@{ATTEMPTS_KEY:[NSString stringWithFormat:@"%lu",(unsigned long)self.failAttemptsMade]}];
         [userInfo addEntriesFromDictionary:error.userInfo];
         NSError *finalError = [NSError errorWithDomain:[error domain] code:[error code] userInfo:[userInfo copy]];
+        [self discardUnitBatch];
         if ([[[self class] networkErrorCodes] containsObject:[NSNumber numberWithInteger:[error code]]]){
             [self notifyDelegateFailConnectionWithError:finalError];
         } else {
@@ -377,70 +681,458 @@ static id <HSFCatcherHandler> _handler;
     } else {
         [[challenge sender] cancelAuthenticationChallenge:challenge];
         NSError *error = [NSError errorWithDomain:HSFAuthenticationErrorDomain code:403 userInfo:nil];
+        [self discardUnitBatch];
         [self notifyDelegateAuthenticationFailWithError:error];
     }
 }
 
-#pragma mark Private Methods
+/*
+ Called when streamed body has to be sent again, e.g. after authentication or redirect.
+ */
+-(NSInputStream*)connection:(NSURLConnection *)connection needNewBodyStream:(NSURLRequest *)request
+{
+    if (![HSFBodyStream arePartsReplayable:self.actionStamp.HTTPBodyParts]) return nil;
+    return [HSFBodyStream inputStreamWithParts:self.actionStamp.HTTPBodyParts];
+}
 
--(void)reloadAsynchronously
+#pragma mark HSFTagScannerDelegate
+
+-(void)tagScanner:(HSFTagScanner *)scanner didScanElement:(NSData *)element forTag:(NSString *)tag
 {
-    if (!self.isInLoading){
-        [NSException raise:NSInvalidArgumentException format:@"Attempt to loadAsynchronously while catcher isInLoading = NO."];
+    if (![self.actionStamp.unitTags containsObject:tag] || ![self isReceivingUnits])
+        return;
+    
+    NSUInteger number;
+    NSUInteger generation;
+    @synchronized(self){
+        number = self.unitRecognized;
+        ++self.unitRecognized;
+        generation = self.responseGeneration;
     }
     
-    [self startNetworkingProcess];
+    if (!self.actionStamp.isParseUnitsAsynchronously){
+        NSTimeInterval start = [self metricsTime];
+        [self deliverParsedUnit:[self parsedUnitFromData:element] length:[element length]];
+        if (self.metrics) self.nestedScanDuration += [self metricsTime] - start;
+        return;
+    }
+    
+    @synchronized(self){
+        ++self.unitInProgress;
+    }
+    [self.parseQueue addOperationWithBlock:^{
+        id unit = [self parsedUnitFromData:element];
+        NSUInteger length = [element length];
+        dispatch_async(self.deliveryQueue, ^{
+            [self receiveParsedUnit:unit length:length number:number generation:generation];
+        });
+    }];
 }
 
-+(NSArray*)networkErrorCodes
+-(void)tagScanner:(HSFTagScanner *)scanner didScanContent:(NSData *)content forTag:(NSString *)tag lastChunk:(BOOL)lastChunk
 {
-    static NSArray *codesArray;
-    if (![codesArray count]){
-        @synchronized(self){
-            const int codes[] = {
-                //kCFURLErrorUnknown,     //-998
-                //kCFURLErrorCancelled,   //-999
-                //kCFURLErrorBadURL,      //-1000
-                //kCFURLErrorTimedOut,    //-1001
-                //kCFURLErrorUnsupportedURL, //-1002
-                //kCFURLErrorCannotFindHost, //-1003
-                kCFURLErrorCannotConnectToHost,     //-1004
-                kCFURLErrorNetworkConnectionLost,   //-1005
-                kCFURLErrorDNSLookupFailed,         //-1006
-                //kCFURLErrorHTTPTooManyRedirects,    //-1007
-                kCFURLErrorResourceUnavailable,     //-1008
-                kCFURLErrorNotConnectedToInternet,  //-1009
-                //kCFURLErrorRedirectToNonExistentLocation,   //-1010
-                kCFURLErrorBadServerResponse,               //-1011
-                //kCFURLErrorUserCancelledAuthentication,     //-1012
-                //kCFURLErrorUserAuthenticationRequired,      //-1013
-                //kCFURLErrorZeroByteResource,        //-1014
-                //kCFURLErrorCannotDecodeRawData,     //-1015
-                //kCFURLErrorCannotDecodeContentData, //-1016
-                //kCFURLErrorCannotParseResponse,     //-1017
-                kCFURLErrorInternationalRoamingOff, //-1018
-                kCFURLErrorCallIsActive,                //-1019
-                //kCFURLErrorDataNotAllowed,              //-1020
-                //kCFURLErrorRequestBodyStreamExhausted,  //-1021
-                kCFURLErrorFileDoesNotExist,            //-1100
-                //kCFURLErrorFileIsDirectory,             //-1101
-                kCFURLErrorNoPermissionsToReadFile,     //-1102
-                //kCFURLErrorDataLengthExceedsMaximum,     //-1103
-            };
-            int size = sizeof(codes)/sizeof(int);
-            NSMutableArray *array = [[NSMutableArray alloc] init];
-            for (int i=0;i<size;++i){
-                [array addObject:[NSNumber numberWithInt:codes[i]]];
-            }
-            codesArray = [array copy];
-        }
-    }
-    return codesArray;
+    NSTimeInterval start = [self metricsTime];
+    [self dispatchContent:content forTag:tag lastChunk:lastChunk];
+    if (self.metrics) self.nestedScanDuration += [self metricsTime] - start;
 }
 
--(void)notifyDelegateAuthenticationFailWithError:(NSError*)error
+#pragma mark HSFMultipartParserDelegate
+
+-(void)multipartParser:(HSFMultipartParser *)parser didBeginPartWithHeaders:(NSDictionary *)headers
 {
-    if ([self.delegate respondsToSelector:@selector(DID_FAIL_AUTH_SELECTOR)]){
+    NSString *contentID = headers[CONTENT_ID_HEADER] ? [HSFMultipartParser contentIDFromString:headers[CONTENT_ID_HEADER]] : nil;
+    if (!self.isRootPartFound && (!self.rootContentID || [self.rootContentID isEqualToString:contentID])){
+        self.isRootPartFound = YES;
+        self.isInRootPart = YES;
+        return;
+    }
+    // Part without Content-ID can't be referenced, it is skipped.
+    self.attachmentContentID = contentID;
+    if (contentID && self.actionStamp.attachmentDirectory && ![self openAttachmentFile]){
+        NSError *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey:self.actionStamp.attachmentDirectory}];
+        [self.connection cancel];
+        [self connection:self.connection didFailWithError:error];
+    }
+}
+
+-(void)multipartParser:(HSFMultipartParser *)parser didReceiveData:(NSData *)data
+{
+    if (self.isInRootPart){
+        [self processXMLData:data];
+    } else if (self.attachmentContentID){
+        [self dispatchAttachmentData:data lastChunk:NO];
+    }
+}
+
+-(void)multipartParserDidEndPart:(HSFMultipartParser *)parser
+{
+    if (self.isInRootPart){
+        self.isInRootPart = NO;
+    } else if (self.attachmentContentID){
+        [self dispatchAttachmentData:[NSData data] lastChunk:YES];
+    }
+    self.attachmentContentID = nil;
+}
+
+#pragma mark Private Methods
+
+/*
+ Pass decoded XML of the response to the parsers and the tag scanner.
+ */
+-(void)processXMLData:(NSData*)data
+{
+    if ([self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_ENTIRE_RESPONSE_SELECTOR)]){
+        if (self.pushParser){
+            NSTimeInterval parseStart = [self metricsTime];
+            BOOL parsed = [self.pushParser parseData:data];
+            [self.metrics addEntireParseDuration:[self metricsTime] - parseStart];
+            if (!parsed){
+                NSError *parseError = self.pushParser.parseError;
+                [self.connection cancel];
+                [self connection:self.connection didFailWithError:parseError];
+                return;
+            }
+        }
+    }
+    if (self.modelDecoder){
+        NSTimeInterval parseStart = [self metricsTime];
+        BOOL parsed = [self.modelDecoder parseData:data];
+        [self.metrics addEntireParseDuration:[self metricsTime] - parseStart];
+        if (!parsed){
+            NSError *parseError = self.modelDecoder.parseError;
+            [self.connection cancel];
+            [self connection:self.connection didFailWithError:parseError];
+            return;
+        }
+    }
+    // Raw response is also kept for the response cache.
+    if (([self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_ENTIRE_RESPONSE_SELECTOR)] && !self.pushParser) || [self isCachingResponse]){
+        NSError *collectError;
+        if (![self collectData:data error:&collectError]){
+            [self.connection cancel];
+            [self connection:self.connection didFailWithError:collectError];
+            return;
+        }
+    }
+    
+    if ([self.actionStamp.unitTags count] > 0 && ![self isReceivingUnits])
+        [NSException raise:HSFCatcherSpecialTagsException format:@"HSFCatcher unit tags are defined, but delegate does not responds for the selector."];
+    
+    if ([self.actionStamp.streamingTags count] > 0 && ![self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_CONTENT_SELECTOR)] && ![self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_CONTENT_DATA_SELECTOR)] && ![self.base64Decoders count])
+        [NSException raise:HSFCatcherSpecialTagsException format:@"HSFCatcher streming tags are defined, but delegate does not responds for the selector."];
+    
+    
+    if (!self.tagScanner){
+        self.tagScanner = [self tagScannerForActionStamp:self.actionStamp];
+    }
+    NSTimeInterval scanStart = [self metricsTime];
+    self.nestedScanDuration = 0.0;
+    [self.tagScanner scanData:data];
+    if (self.metrics && self.tagScanner){
+        [self.metrics addScanDuration:[self metricsTime] - scanStart - self.nestedScanDuration];
+    }
+}
+
+/*
+ Pass streaming content to its decoder or to delegate.
+ */
+-(void)dispatchContent:(NSData *)content forTag:(NSString *)tag lastChunk:(BOOL)lastChunk
+{
+    HSFBase64Decoder *decoder = self.base64Decoders[tag];
+    if (decoder){
+        if (![decoder decodeData:content] || (lastChunk && ![decoder finish])){
+            [self.connection cancel];
+            [self connection:self.connection didFailWithError:decoder.error];
+        }
+        return;
+    }
+    
+    NSTimeInterval delegateStart = [self metricsTime];
+    if ([self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_CONTENT_DATA_SELECTOR)]){
+        [self.delegate catcher:self didReceiveContentData:content forTag:tag lastChunk:lastChunk];
+        [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
+        return;
+    }
+    
+    if (![self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_CONTENT_SELECTOR)])
+        return;
+    
+    NSString *string = [self stringFromContent:content lastChunk:lastChunk];
+    if ([string length] || lastChunk){
+        delegateStart = [self metricsTime];
+        [self.delegate catcher:self didReceiveContent:string forTag:tag lastChunk:lastChunk];
+        [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
+    }
+}
+
+/*
+ Parser for multipart/related response, nil for other responses.
+ */
+-(HSFMultipartParser*)multipartParserForResponse:(NSURLResponse*)response
+{
+    NSString *contentType = [response isKindOfClass:[NSHTTPURLResponse class]] ? [(NSHTTPURLResponse*)response allHeaderFields][CONTENT_TYPE] : [response MIMEType];
+    if (![contentType length]) return nil;
+    NSString *mediaType;
+    NSDictionary *parameters = [HSFMultipartParser parametersOfContentType:contentType mediaType:&mediaType];
+    if (![mediaType isEqualToString:MULTIPART_RELATED_TYPE] || ![parameters[@"boundary"] length]) return nil;
+
+    self.rootContentID = parameters[@"start"] ? [HSFMultipartParser contentIDFromString:parameters[@"start"]] : nil;
+    HSFMultipartParser *parser = [[HSFMultipartParser alloc] initWithBoundary:parameters[@"boundary"]];
+    parser.delegate = self;
+    return parser;
+}
+
+/*
+ Write bytes of the current attachment into its file or pass them to delegate.
+ */
+-(void)dispatchAttachmentData:(NSData*)data lastChunk:(BOOL)lastChunk
+{
+    NSString *contentID = self.attachmentContentID;
+    if (self.attachmentFile){
+        [self.attachmentFile writeData:data];
+        if (!lastChunk) return;
+        [self.attachmentFile closeFile];
+        self.attachmentFile = nil;
+        NSString *path = self.attachmentPath;
+        self.attachmentPath = nil;
+        self.mutableAttachmentPaths[contentID] = path;
+        if ([self.delegate respondsToSelector:@selector(CATCHER_DID_SAVE_ATTACHMENT_SELECTOR)]){
+            NSTimeInterval delegateStart = [self metricsTime];
+            [self.delegate catcher:self didSaveAttachmentAtPath:path forContentID:contentID];
+            [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
+        }
+        return;
+    }
+    if ([self.delegate respondsToSelector:@selector(CATCHER_DID_RECEIVE_ATTACHMENT_DATA_SELECTOR)]){
+        NSTimeInterval delegateStart = [self metricsTime];
+        [self.delegate catcher:self didReceiveAttachmentData:data forContentID:contentID lastChunk:lastChunk];
+        [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
+    }
+}
+
+/*
+ Create file of the current attachment in attachmentDirectory. Returns NO if it can't be created.
+ */
+-(BOOL)openAttachmentFile
+{
+    NSString *name = [NSString stringWithFormat:ATTACHMENT_FILE_NAME_FORMAT,[[NSProcessInfo processInfo] globallyUniqueString]];
+    NSString *path = [self.actionStamp.attachmentDirectory stringByAppendingPathComponent:name];
+    if (![[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil]) return NO;
+    self.attachmentPath = path;
+    self.attachmentFile = [NSFileHandle fileHandleForWritingAtPath:path];
+    return self.attachmentFile != nil;
+}
+
+/*
+ Remove file of the attachment which was not finished, saved ones belong to the application.
+ */
+-(void)removePartialAttachment
+{
+    [self.attachmentFile closeFile];
+    self.attachmentFile = nil;
+    self.attachmentContentID = nil;
+    if (self.attachmentPath){
+        [[NSFileManager defaultManager] removeItemAtPath:self.attachmentPath error:NULL];
+        self.attachmentPath = nil;
+    }
+}
+
+/*
+ Make scanner for special tags of the action, nil if there is nothing to scan.
+ */
+-(HSFTagScanner*)tagScannerForActionStamp:(HSFActionStamp*)actionStamp
+{
+    //Order matter!
+    NSArray *specialTags;
+    if ([actionStamp.orderedSpecialTags count]){
+        if ([actionStamp.orderedSpecialTags count] != [actionStamp.unitTags count] + [actionStamp.streamingTags count])
+            [NSException raise:HSFCatcherSpecialTagsException format:@"HSFCatcher orderedSpecialTags number is not equal to unitTag and streamingTags number."];
+        specialTags = actionStamp.orderedSpecialTags;
+    } else {
+        NSMutableArray *arr = [[NSMutableArray alloc] initWithArray:actionStamp.unitTags];
+        [arr removeObjectsInArray:actionStamp.streamingTags];
+        specialTags = [actionStamp.streamingTags arrayByAddingObjectsFromArray:arr];
+    }
+    
+    if (![specialTags count]) return nil;
+    
+    HSFTagScanner *scanner = [[HSFTagScanner alloc] initWithTags:specialTags streamingTags:actionStamp.streamingTags];
+    scanner.delegate = self;
+    return scanner;
+}
+
+/*
+ Parse data into the kind of tree the action asks for.
+ */
+-(HSFNode*)nodeTreeFromData:(NSData*)data error:(NSError**)error
+{
+    if (self.actionStamp.isCompactNodeTree){
+        return [HSFNode compactNodeTreeFromData:data symbolTable:self.symbolTable error:error];
+    }
+    return [HSFNode nodeTreeFromData:data symbolTable:self.symbolTable error:error];
+}
+
+/*
+ Symbol table shared by all catchers of the action class or owned by this catcher.
+ */
+-(HSFSymbolTable*)symbolTableForActionStamp:(HSFActionStamp*)actionStamp
+{
+    if (actionStamp.isSharesSymbolTable){
+        return [HSFSymbolTable sharedSymbolTableForActionClass:actionStamp.actionClass];
+    }
+    return [[HSFSymbolTable alloc] init];
+}
+
+/*
+ Decode streaming content keeping a character broken between chunks till the next one.
+ */
+-(NSString*)stringFromContent:(NSData*)content lastChunk:(BOOL)lastChunk
+{
+    NSData *bytes = content;
+    if ([self.contentRemainder length]){
+        [self.contentRemainder appendData:content];
+        bytes = [self.contentRemainder copy];
+    }
+    
+    NSUInteger length = lastChunk ? [bytes length] : HSFUTF8CompleteLength([bytes bytes], [bytes length]);
+    [self.contentRemainder setData:[bytes subdataWithRange:NSMakeRange(length, [bytes length] - length)]];
+    
+    NSString *string = [[NSString alloc] initWithBytes:[bytes bytes] length:length encoding:NSUTF8StringEncoding];
+    return string ? string : @"";
+}
+
+
+-(void)reloadAsynchronously
+{
+    // Cancelled during backoff.
+    if (!self.isInLoading) return;
+    
+    [self startNetworkingProcess];
+}
+
+/*
+ Drop the reload scheduled after a failed attempt. Scheduled call lives in the run loop of the networking thread.
+ */
+-(void)cancelScheduledReload
+{
+    NSThread *thread = self.networkingThread;
+    if (!thread || thread == [NSThread currentThread]){
+        [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(reloadAsynchronously) object:nil];
+    } else {
+        [self performSelector:@selector(cancelScheduledReload) onThread:thread withObject:nil waitUntilDone:NO];
+    }
+}
+
+/*
+ Request of the stamp with a new stream of streamed body, every connection reads the body from the start. nil if the body was read already and can't be read again.
+ */
++(NSURLRequest*)requestWithStamp:(HSFActionStamp*)actionStamp
+{
+    if (!actionStamp.HTTPBodyParts) return actionStamp.request;
+    NSInputStream *bodyStream = [HSFBodyStream inputStreamWithParts:actionStamp.HTTPBodyParts];
+    if (!bodyStream) return nil;
+    NSMutableURLRequest *request = [actionStamp.request mutableCopy];
+    [request setHTTPBodyStream:bodyStream];
+    return request;
+}
+
+/*
+ Errors which tell that the host is unreachable or unavailable, unlike parse errors.
+ */
++(BOOL)isHostFailureError:(NSError*)error
+{
+    if ([[error domain] isEqualToString:HSFHTTPErrorDomain]){
+        return [error code] == HTTP_STATUS_SERVICE_UNAVAILABLE;
+    }
+    if ([[error domain] isEqualToString:NSURLErrorDomain]){
+        return [error code] == NSURLErrorTimedOut || [[self networkErrorCodes] containsObject:@([error code])];
+    }
+    return NO;
+}
+
+/*
+ Retry-After header in seconds or HTTP-date, 0 if there is none.
+ */
++(NSTimeInterval)retryAfterIntervalForResponse:(NSHTTPURLResponse*)response
+{
+    NSString *value = [response allHeaderFields][RETRY_AFTER_HEADER];
+    if (![value length]) return 0.0;
+    
+    NSScanner *scanner = [NSScanner scannerWithString:value];
+    NSInteger seconds;
+    if ([scanner scanInteger:&seconds] && [scanner isAtEnd]){
+        return MAX(seconds, 0);
+    }
+    
+    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
+    formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    formatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"GMT"];
+    formatter.dateFormat = HTTP_DATE_FORMAT;
+    NSDate *date = [formatter dateFromString:value];
+    return date ? MAX([date timeIntervalSinceNow], 0.0) : 0.0;
+}
+
+/*
+ Content-Encoding header in lower case, nil if there is none or the body is not encoded.
+ */
++(NSString*)contentEncodingOfResponse:(NSURLResponse*)response
+{
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) return nil;
+    NSString *value = [(NSHTTPURLResponse*)response allHeaderFields][CONTENT_ENCODING_HEADER];
+    value = [[value stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] lowercaseString];
+    if (![value length] || [value isEqualToString:@"identity"]) return nil;
+    return value;
+}
+
++(NSArray*)networkErrorCodes
+{
+    static NSArray *codesArray;
+    if (![codesArray count]){
+        @synchronized(self){
+            const int codes[] = {
+                //kCFURLErrorUnknown,     //-998
+                //kCFURLErrorCancelled,   //-999
+                //kCFURLErrorBadURL,      //-1000
+                //kCFURLErrorTimedOut,    //-1001
+                //kCFURLErrorUnsupportedURL, //-1002
+                //kCFURLErrorCannotFindHost, //-1003
+                kCFURLErrorCannotConnectToHost,     //-1004
+                kCFURLErrorNetworkConnectionLost,   //-1005
+                kCFURLErrorDNSLookupFailed,         //-1006
+                //kCFURLErrorHTTPTooManyRedirects,    //-1007
+                kCFURLErrorResourceUnavailable,     //-1008
+                kCFURLErrorNotConnectedToInternet,  //-1009
+                //kCFURLErrorRedirectToNonExistentLocation,   //-1010
+                kCFURLErrorBadServerResponse,               //-1011
+                //kCFURLErrorUserCancelledAuthentication,     //-1012
+                //kCFURLErrorUserAuthenticationRequired,      //-1013
+                //kCFURLErrorZeroByteResource,        //-1014
+                //kCFURLErrorCannotDecodeRawData,     //-1015
+                //kCFURLErrorCannotDecodeContentData, //-1016
+                //kCFURLErrorCannotParseResponse,     //-1017
+                kCFURLErrorInternationalRoamingOff, //-1018
+                kCFURLErrorCallIsActive,                //-1019
+                //kCFURLErrorDataNotAllowed,              //-1020
+                //kCFURLErrorRequestBodyStreamExhausted,  //-1021
+                kCFURLErrorFileDoesNotExist,            //-1100
+                //kCFURLErrorFileIsDirectory,             //-1101
+                kCFURLErrorNoPermissionsToReadFile,     //-1102
+                //kCFURLErrorDataLengthExceedsMaximum,     //-1103
+            };
+            int size = sizeof(codes)/sizeof(int);
+            NSMutableArray *array = [[NSMutableArray alloc] init];
+            for (int i=0;i<size;++i){
+                [array addObject:[NSNumber numberWithInt:codes[i]]];
+            }
+            codesArray = [array copy];
+        }
+    }
+    return codesArray;
+}
+
+-(void)notifyDelegateAuthenticationFailWithError:(NSError*)error
+{
+    if ([self.delegate respondsToSelector:@selector(DID_FAIL_AUTH_SELECTOR)]){
         [self.delegate performSelector:@selector(DID_FAIL_AUTH_SELECTOR) withObject:self withObject:error];
     }
     // This callback will cause two notification probably, as auth error will be sent as genrail didReceiveError.
@@ -453,6 +1145,7 @@ static id <HSFCatcherHandler> _handler;
         [self.delegate performSelector:@selector(DID_FAIL_LOADING_SELECTOR) withObject:self withObject:error];
     }
     [self notifyDelegateCommonFailWithError:error];
+    [self reportMetricsSucceeded:NO error:error];
     [self finishJobAndHotifyHandler];
 }
 
@@ -462,6 +1155,7 @@ static id <HSFCatcherHandler> _handler;
         [self.delegate performSelector:@selector(DID_FAIL_CONNECTION_SELECTOR) withObject:self withObject:error];
     }
     [self notifyDelegateCommonFailWithError:error];
+    [self reportMetricsSucceeded:NO error:error];
     [self finishJobAndHotifyHandler];
 }
 
@@ -474,7 +1168,10 @@ static id <HSFCatcherHandler> _handler;
 
 -(void)finishJobAndHotifyHandler
 {
+    // Loading which neither finished nor failed is cancelled.
+    [self reportMetricsSucceeded:NO error:nil];
     self.isInLoading = NO;
+    [self cancelScheduledReload];
     [self finishNetworkingProcess];
 }
 
@@ -487,11 +1184,176 @@ static id <HSFCatcherHandler> _handler;
         [NSException raise:NSInvalidArgumentException format:@"The delegate or action is not set."];
     }
     
-    [[[self class] handler] catcherStarted:self];
-    self.connection = [[NSURLConnection alloc] initWithRequest:self.actionStamp.request delegate:self];
+    id<HSFCatcherHandler> handler = [[self class] handler];
+    [handler catcherStarted:self];
+    self.networkingThread = [NSThread currentThread];
+    self.isReplaying = NO;
+    // Cache is consulted before the first attempt only, a broken cached response is loaded from the network on retry.
+    if (self.actionStamp.cacheLifetime > 0 && !self.failAttemptsMade && [handler respondsToSelector:@selector(cachedResponseDataForCatcher:)]){
+        NSData *data = [handler cachedResponseDataForCatcher:self];
+        if (data){
+            self.isReplaying = YES;
+            [self performSelector:@selector(replayResponseData:) withObject:data afterDelay:0.0];
+            return;
+        }
+    }
+    HSFCircuitBreaker *circuitBreaker = [self circuitBreaker];
+    if (circuitBreaker && ![circuitBreaker allowsRequestToURL:self.actionStamp.request.URL]){
+        NSDictionary *userInfo = @{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_CIRCUIT_OPEN};
+        NSError *error = [NSError errorWithDomain:HSFCircuitBreakerErrorDomain code:HSF_ERROR_CODE_CIRCUIT_OPEN userInfo:userInfo];
+        // Fail fast, but asynchronously as any other loading.
+        [self performSelector:@selector(failFastWithError:) withObject:error afterDelay:0.0];
+        return;
+    }
+    if ([handler respondsToSelector:@selector(catcherShouldStartConnection:)] && ![handler catcherShouldStartConnection:self]){
+        // Handler admits the catcher later, when a connection is free.
+        return;
+    }
+    [self startConnection];
+}
+
+/*
+ Finish metrics of the loading and pass them to handler, once.
+ */
+-(void)reportMetricsSucceeded:(BOOL)succeeded error:(NSError*)error
+{
+    if (![self.metrics finishSucceeded:succeeded error:error]) return;
+    id<HSFCatcherHandler> handler = [[self class] handler];
+    if ([handler respondsToSelector:@selector(catcher:didCollectMetrics:)]){
+        [handler catcher:self didCollectMetrics:self.metrics];
+    }
+}
+
+/*
+ Current time for metrics, 0 if metrics are not collected.
+ */
+-(NSTimeInterval)metricsTime
+{
+    return self.metrics ? [HSFCatcherMetrics currentTime] : 0.0;
+}
+
+-(void)failFastWithError:(NSError*)error
+{
+    if (!self.isInLoading) return;
+    [self notifyDelegateFailConnectionWithError:error];
+}
+
+-(HSFCircuitBreaker*)circuitBreaker
+{
+    id<HSFCatcherHandler> handler = [[self class] handler];
+    if (![handler respondsToSelector:@selector(circuitBreakerForCatcher:)]) return nil;
+    return [handler circuitBreakerForCatcher:self];
+}
+
+/*
+ Exponential backoff with jitter, which reaches maxTimeout at the last attempt. Server's Retry-After is honored.
+ */
+-(NSTimeInterval)retryDelayAfterError:(NSError*)error
+{
+    NSUInteger retriesLeft = self.actionStamp.loadAttempts - 1 - self.failAttemptsMade;
+    NSTimeInterval delay = self.actionStamp.maxTimeout / pow(2.0, (double)retriesLeft);
+    // Half of the delay is random, so catchers do not retry in lockstep.
+    delay = delay / 2.0 + (delay / 2.0) * arc4random_uniform(UINT32_MAX) / UINT32_MAX;
+    
+    NSTimeInterval retryAfter = [error.userInfo[HSF_RETRY_AFTER_KEY] doubleValue];
+    return MAX(delay, retryAfter);
+}
+
+/*
+ Choose decompressor by Content-Encoding of the response. The URL loading system may have decoded the body already and kept the header, the first chunk tells it: gzip and zlib streams start with their headers, raw deflate stream inflates without error.
+ */
+-(void)prepareDecodingWithData:(NSData*)data
+{
+    NSString *encoding = self.contentEncoding;
+    if (!encoding) return;
+    
+    if (self.actionStamp.isCompressesMessages){
+        BOOL isGzip = [encoding isEqualToString:GZIP_ENCODING] || [encoding isEqualToString:X_GZIP_ENCODING];
+        BOOL isDeflate = [encoding isEqualToString:DEFLATE_ENCODING];
+        if ((isGzip || isDeflate) && [HSFInflater isCompressedData:data]){
+            self.inflater = [[HSFInflater alloc] init];
+            return;
+        }
+        if (isDeflate){
+            HSFInflater *inflater = [[HSFInflater alloc] initWithRawDeflate:YES];
+            if ([inflater inflateData:data]){
+                self.inflater = [[HSFInflater alloc] initWithRawDeflate:YES];
+                return;
+            }
+        }
+    }
+    // Expected length counts encoded bytes, loadedLength counts decoded ones.
+    self.expectedLength = NSURLResponseUnknownLength;
+}
+
+/*
+ Decompress received chunk if the response is compressed, nil if it is corrupted.
+ */
+-(NSData*)decodedDataFromData:(NSData*)data
+{
+    if (!self.inflater) return data;
+    return [self.inflater inflateData:data];
+}
+
+/*
+ Pass cached response through the usual connection callbacks.
+ */
+-(void)replayResponseData:(NSData*)data
+{
+    if (!self.isInLoading || !self.isReplaying) return;
+    
+    [self.metrics markConnectionStartReplayed:YES];
+    NSURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.actionStamp.request.URL statusCode:HTTP_STATUS_OK HTTPVersion:HTTP_VERSION headerFields:@{CONTENT_LENGTH:[NSString stringWithFormat:@"%lu",(unsigned long)[data length]]}];
+    [self connection:self.connection didReceiveResponse:response];
+    [self connection:self.connection didReceiveData:data];
+    // Callbacks may fail or cancel loading.
+    if (!self.isInLoading || !self.isReplaying) return;
+    [self connectionDidFinishLoading:self.connection];
+}
+
+/*
+ Determine whether a response loaded from the network goes to the response cache.
+ */
+-(BOOL)isCachingResponse
+{
+    // Only the root part of multipart response is collected, attachments would be lost.
+    return self.actionStamp.cacheLifetime > 0 && !self.isReplaying && !self.multipartParser && [[[self class] handler] respondsToSelector:@selector(catcher:didLoadResponseData:)];
+}
+
+-(void)startConnection
+{
+    if (!self.isInLoading || self.connection) return;
+    [self.metrics markConnectionStartReplayed:NO];
+    NSURLRequest *request = [[self class] requestWithStamp:self.actionStamp];
+    if (!request){
+        NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorRequestBodyStreamExhausted userInfo:nil];
+        [self connection:nil didFailWithError:error];
+        return;
+    }
+    self.connection = [[NSURLConnection alloc] initWithRequest:request delegate:self];
 }
 
 -(void)finishNetworkingProcess
+{
+    [self stopNetworking];
+    [[[self class] handler] catcherFinished:self];
+}
+
+/*
+ Release the connection of a failed attempt before backoff. The catcher stays known to the handler until the loading finally ends, so it can still be cancelled in bulk.
+ */
+-(void)finishNetworkingProcessForRetry
+{
+    [self stopNetworking];
+    id<HSFCatcherHandler> handler = [[self class] handler];
+    if ([handler respondsToSelector:@selector(catcherWillRetry:)]){
+        [handler catcherWillRetry:self];
+    } else {
+        [handler catcherFinished:self];
+    }
+}
+
+-(void)stopNetworking
 {
     if ([self.delegate respondsToSelector:@selector(CLIENT_DID_PROGRESS)]){
         // 0.0 means loding is finished.
@@ -500,35 +1362,305 @@ static id <HSFCatcherHandler> _handler;
     [self.connection cancel];
     self.connection = nil;
     self.cumulativeData = nil;
-    [[[self class] handler] catcherFinished:self];
+    [self removeSpillFile];
+    [self.multipartParser reset];
+    self.multipartParser = nil;
+    [self removePartialAttachment];
+    self.pushParser = nil;
+    self.modelDecoder = nil;
+    self.symbolTable = nil;
+    self.inflater = nil;
+    [self.tagScanner reset];
+}
+
+/*
+ Keep received data in memory, or in the temporary file once it exceeds spillThreshold.
+ */
+-(BOOL)collectData:(NSData*)data error:(NSError**)error
+{
+    if (!self.spillFile){
+        [self.cumulativeData appendData:data];
+        NSUInteger threshold = self.actionStamp.spillThreshold;
+        if (!threshold || [self.cumulativeData length] <= threshold) return YES;
+        
+        NSString *name = [NSString stringWithFormat:SPILL_FILE_NAME_FORMAT,[[NSProcessInfo processInfo] globallyUniqueString]];
+        NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:name];
+        if (![[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil]){
+            // Nowhere to spill, keep collecting in memory.
+            return YES;
+        }
+        NSFileHandle *spillFile = [NSFileHandle fileHandleForWritingAtPath:path];
+        if (!spillFile){
+            [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+            return YES;
+        }
+        self.spillPath = path;
+        self.spillFile = spillFile;
+        data = self.cumulativeData;
+        self.cumulativeData = nil;
+    }
+    return [self writeSpillData:data error:error];
+}
+
+/*
+ Write through the file descriptor, writeData: of NSFileHandle raises if the disk is full.
+ */
+-(BOOL)writeSpillData:(NSData*)data error:(NSError**)error
+{
+    int descriptor = [self.spillFile fileDescriptor];
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    NSUInteger written = 0;
+    while (written < length){
+        ssize_t result = write(descriptor, bytes + written, length - written);
+        if (result < 0){
+            if (errno == EINTR) continue;
+            if (error){
+                *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey:self.spillPath}];
+            }
+            return NO;
+        }
+        written += result;
+    }
+    return YES;
+}
+
+/*
+ All received data, mapped from the temporary file if it was spilled.
+ */
+-(NSData*)collectedDataWithError:(NSError**)error
+{
+    if (self.mappedData) return self.mappedData;
+    if (!self.spillFile) return self.cumulativeData;
     
+    [self.spillFile closeFile];
+    self.spillFile = nil;
+    // The mapping stays valid after the file is removed.
+    self.mappedData = [NSData dataWithContentsOfFile:self.spillPath options:NSDataReadingMappedAlways error:error];
+    return self.mappedData;
 }
 
--(void)performParseOperation:(void (^)())block
+-(void)removeSpillFile
 {
-    if (self.actionStamp.isParseUnitsAsynchronously) {
-        ++self.unitInProgress;
-        dispatch_async(self.parseQueue, ^{
-            block();
-            --self.unitInProgress;
-        });
+    [self.spillFile closeFile];
+    self.spillFile = nil;
+    self.mappedData = nil;
+    if (self.spillPath){
+        [[NSFileManager defaultManager] removeItemAtPath:self.spillPath error:NULL];
+        self.spillPath = nil;
+    }
+}
+
+/*
+ Unit tree or model object, or parse error if the unit is not valid.
+ */
+-(id)parsedUnitFromData:(NSData*)data
+{
+    NSError *parseError;
+    NSTimeInterval parseStart = [self metricsTime];
+    id unit;
+    if ([self isDecodingUnitObjects]){
+        unit = [HSFModelDecoder objectFromData:data mapping:self.actionStamp.unitModelMapping error:&parseError];
     } else {
-        block();
+        unit = [self nodeTreeFromData:data error:&parseError];
+    }
+    [self.metrics addUnitParseDuration:[self metricsTime] - parseStart];
+    return parseError ? parseError : unit;
+}
+
+/*
+ Determine whether units are decoded into model objects.
+ */
+-(BOOL)isDecodingUnitObjects
+{
+    return self.actionStamp.unitModelMapping && ([self isBatchingUnits] || [self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_UNIT_OBJECT_SELECTOR)]);
+}
+
+/*
+ Determine whether delegate receives units as trees or model objects.
+ */
+-(BOOL)isReceivingUnits
+{
+    return [self isBatchingUnits] || [self isDecodingUnitObjects] || [self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_UNIT_SELECTOR)];
+}
+
+/*
+ Determine whether delegate receives units in batches.
+ */
+-(BOOL)isBatchingUnits
+{
+    return [self.delegate respondsToSelector:@selector(CLIENT_DID_RECEIVE_UNITS_SELECTOR)];
+}
+
+/*
+ Put parsed unit into reorder buffer and deliver all units which are in turn. Called on deliveryQueue.
+ */
+-(void)receiveParsedUnit:(id)unit length:(NSUInteger)length number:(NSUInteger)number generation:(NSUInteger)generation
+{
+    NSMutableArray *units = [[NSMutableArray alloc] init];
+    @synchronized(self){
+        if (generation != self.responseGeneration) return;
+        self.parsedUnits[@(number)] = @[unit,@(length)];
+        NSArray *nextUnit;
+        while ((nextUnit = self.parsedUnits[@(self.unitDelivered)])){
+            [self.parsedUnits removeObjectForKey:@(self.unitDelivered)];
+            ++self.unitDelivered;
+            [units addObject:nextUnit];
+        }
+    }
+    
+    for (NSArray *nextUnit in units){
+        [self deliverParsedUnit:nextUnit[0] length:[nextUnit[1] unsignedIntegerValue]];
+        BOOL isLastUnit = NO;
+        @synchronized(self){
+            if (generation == self.responseGeneration) --self.unitInProgress;
+            if (!self.unitInProgress && self.isFinishDeferred){
+                self.isFinishDeferred = NO;
+                isLastUnit = !self.unitFailed;
+            }
+        }
+        if (isLastUnit){
+            [self flushUnitBatch];
+            [self notifyDelegateFinishLoadingOnNetworkingThread];
+        }
     }
 }
 
--(BOOL)isTagBreakingString:(NSString*)string
+/*
+ Send unit to delegate, or fail loading on the first invalid unit.
+ */
+-(void)deliverParsedUnit:(id)unit length:(NSUInteger)length
 {
-    NSRange lessThanSignRange = [self.bufferString rangeOfString:@"<" options:NSBackwardsSearch];
-    if (lessThanSignRange.location == NSNotFound){
-        return NO;
+    @synchronized(self){
+        if (self.unitFailed) return;
+        if ([unit isKindOfClass:[NSError class]]){
+            self.unitFailed = YES;
+        } else {
+            ++self.unitProcessed;
+        }
+    }
+    
+    if (![unit isKindOfClass:[NSError class]] && [self isBatchingUnits]){
+        [self addUnitToBatch:[self isDecodingUnitObjects] ? unit : [((HSFNode*)unit).children firstObject] length:length];
+    } else if (![unit isKindOfClass:[NSError class]]){
+        NSTimeInterval delegateStart = [self metricsTime];
+        if ([self isDecodingUnitObjects]){
+            [self.delegate performSelector:@selector(CLIENT_DID_RECEIVE_UNIT_OBJECT_SELECTOR) withObject:self withObject:unit];
+        } else {
+            [self.delegate performSelector:@selector(CLIENT_DID_RECEIVE_UNIT_SELECTOR) withObject:self withObject:[((HSFNode*)unit).children firstObject]];
+        }
+        [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
     } else {
-        NSRange greatThanSignRange = [self.bufferString rangeOfString:@">" options:NSBackwardsSearch];
-        if (greatThanSignRange.location != NSNotFound && greatThanSignRange.location > lessThanSignRange.location){
-            return NO;
+        [self.connection cancel];
+        [self connection:self.connection didFailWithError:unit];
+    }
+}
+
+/*
+ Collect unit and deliver the batch if it is full. Called on the thread which delivers units.
+ */
+-(void)addUnitToBatch:(id)unit length:(NSUInteger)length
+{
+    NSArray *units;
+    BOOL isFirstUnit = NO;
+    NSUInteger batchNumber;
+    @synchronized(self){
+        if(!_unitBatch)_unitBatch = [[NSMutableArray alloc] init];
+        [self.unitBatch addObject:unit];
+        self.unitBatchLength += length;
+        
+        NSUInteger maxCount = self.actionStamp.unitBatchSize;
+        NSUInteger maxLength = self.actionStamp.unitBatchLength;
+        if ((maxCount && [self.unitBatch count] >= maxCount) || (maxLength && self.unitBatchLength >= maxLength)){
+            units = [self takeUnitBatch];
+        } else {
+            isFirstUnit = [self.unitBatch count] == 1;
         }
+        batchNumber = self.unitBatchNumber;
     }
-    return YES;
+    
+    if (units){
+        [self notifyDelegateUnits:units];
+    } else if (isFirstUnit && self.actionStamp.unitBatchInterval > 0){
+        [self scheduleFlushOfUnitBatch:batchNumber];
+    }
+}
+
+/*
+ Deliver the batch when its interval is over, on the thread which delivers units.
+ */
+-(void)scheduleFlushOfUnitBatch:(NSUInteger)batchNumber
+{
+    NSTimeInterval interval = self.actionStamp.unitBatchInterval;
+    if (self.actionStamp.isParseUnitsAsynchronously){
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), self.deliveryQueue, ^{
+            [self flushUnitBatchWithNumber:@(batchNumber)];
+        });
+    } else {
+        [self performSelector:@selector(flushUnitBatchWithNumber:) withObject:@(batchNumber) afterDelay:interval];
+    }
+}
+
+-(void)flushUnitBatchWithNumber:(NSNumber*)batchNumber
+{
+    NSArray *units;
+    @synchronized(self){
+        if ([batchNumber unsignedIntegerValue] != self.unitBatchNumber) return;
+        units = [self takeUnitBatch];
+    }
+    [self notifyDelegateUnits:units];
+}
+
+-(void)flushUnitBatch
+{
+    NSArray *units;
+    @synchronized(self){
+        units = [self takeUnitBatch];
+    }
+    [self notifyDelegateUnits:units];
+}
+
+-(void)discardUnitBatch
+{
+    @synchronized(self){
+        [self takeUnitBatch];
+        self.isFinishDeferred = NO;
+    }
+}
+
+/*
+ Empty the batch. Called under the lock.
+ */
+-(NSArray*)takeUnitBatch
+{
+    NSArray *units = [self.unitBatch copy];
+    self.unitBatch = nil;
+    self.unitBatchLength = 0;
+    ++self.unitBatchNumber;
+    return units;
+}
+
+-(void)notifyDelegateUnits:(NSArray*)units
+{
+    if (![units count]) return;
+    NSTimeInterval delegateStart = [self metricsTime];
+    [self.delegate performSelector:@selector(CLIENT_DID_RECEIVE_UNITS_SELECTOR) withObject:self withObject:units];
+    [self.metrics addDelegateDuration:[self metricsTime] - delegateStart];
+}
+
+-(void)notifyDelegateFinishLoading
+{
+    if ([self.delegate respondsToSelector:@selector(CATCHER_DID_FINISH_LOADING_SELECTOR)])
+        [self.delegate performSelector:@selector(CATCHER_DID_FINISH_LOADING_SELECTOR) withObject:self];
+}
+
+/*
+ Finish is sent from the thread of the other callbacks, after the units delivered on deliveryQueue.
+ */
+-(void)notifyDelegateFinishLoadingOnNetworkingThread
+{
+    NSThread *thread = self.networkingThread ? self.networkingThread : [NSThread mainThread];
+    [self performSelector:@selector(notifyDelegateFinishLoading) onThread:thread withObject:nil waitUntilDone:NO];
 }
 
 #pragma mark Class Methods
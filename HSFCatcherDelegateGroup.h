@@ -0,0 +1,56 @@
+//
+//  HSFCatcherDelegateGroup.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 23/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFCatcher.h"
+
+/*!
+ @abstract Delegate of HSFCatcher which forwards callbacks to several delegates.
+ @discussion Used by HSFClient to share one catcher between identical actions. Every callback is forwarded to each subscribed delegate. Only delegates which respond to the same HSFCatcherDelegate callbacks are grouped, so the callbacks the catcher chooses by respondsToSelector: never change while it loads. Thread safe.
+ */
+@interface HSFCatcherDelegateGroup : NSObject <HSFCatcherDelegate>
+
+/*!
+ @abstract Number of subscribed delegates.
+ */
+@property (nonatomic,readonly) NSUInteger count;
+
+/*!
+ @abstract Determine whether delegates may still join.
+ @discussion YES until the catcher receives a response (see closeJoining) or the first callback other than progress is forwarded, so a joined delegate misses nothing.
+ */
+@property (nonatomic,readonly,getter=isJoinable) BOOL joinable;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @param delegate The first delegate. Must not be nil.
+ @return The initialized group.
+ */
+-(id)initWithDelegate:(id<HSFCatcherDelegate>)delegate;
+
+/*!
+ @abstract Subscribe delegate.
+ @return NO if the group is not joinable anymore or the delegate responds to other callbacks.
+ */
+-(BOOL)addDelegate:(id<HSFCatcherDelegate>)delegate;
+
+/*!
+ @abstract Stop accepting delegates.
+ @discussion Called by the catcher when a response starts, before per-response state is set up by the callbacks the group responds to.
+ */
+-(void)closeJoining;
+
+/*!
+ @abstract Unsubscribe delegate.
+ @discussion Removes one subscription of the delegate.
+ */
+-(void)removeDelegate:(id<HSFCatcherDelegate>)delegate;
+
+@end
@@ -0,0 +1,155 @@
+//
+//  HSFCatcherDelegateGroup.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 23/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFCatcherDelegateGroup.h"
+#import "HSFCommon.h"
+#import <objc/runtime.h>
+
+@interface HSFCatcherDelegateGroup()
+
+@property (strong,nonatomic) NSMutableArray *delegates;
+@property (nonatomic,readwrite,getter=isJoinable) BOOL joinable;
+
+/*
+ Selectors of HSFCatcherDelegate the first delegate responds to, joined delegates must respond to the same ones.
+ */
+@property (strong,nonatomic) NSSet *callbacks;
+
+@end
+
+@implementation HSFCatcherDelegateGroup
+
+#pragma mark Properties
+
+-(NSUInteger)count
+{
+    @synchronized(self){
+        return [self.delegates count];
+    }
+}
+
+#pragma mark Public Methods
+
+-(id)initWithDelegate:(id<HSFCatcherDelegate>)delegate
+{
+    if (!delegate){
+        [NSException raise:NSInvalidArgumentException format:@"The delegate is nil."];
+    }
+    self = [super init];
+    if (self){
+        _delegates = [[NSMutableArray alloc] initWithObjects:delegate, nil];
+        _callbacks = [[self class] callbacksOfDelegate:delegate];
+        _joinable = YES;
+    }
+    return self;
+}
+
+-(id)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
+    return [super init];
+}
+
+-(BOOL)addDelegate:(id<HSFCatcherDelegate>)delegate
+{
+    if (!delegate){
+        [NSException raise:NSInvalidArgumentException format:@"The delegate is nil."];
+    }
+    if (![[[self class] callbacksOfDelegate:delegate] isEqualToSet:self.callbacks]) return NO;
+    @synchronized(self){
+        if (!self.joinable) return NO;
+        [self.delegates addObject:delegate];
+        return YES;
+    }
+}
+
+-(void)closeJoining
+{
+    @synchronized(self){
+        self.joinable = NO;
+    }
+}
+
+-(void)removeDelegate:(id<HSFCatcherDelegate>)delegate
+{
+    @synchronized(self){
+        NSUInteger index = [self.delegates indexOfObjectIdenticalTo:delegate];
+        if (index != NSNotFound){
+            [self.delegates removeObjectAtIndex:index];
+        }
+    }
+}
+
+#pragma mark Forwarding
+
+-(BOOL)respondsToSelector:(SEL)aSelector
+{
+    if ([super respondsToSelector:aSelector]) return YES;
+    for (id delegate in [self delegatesSnapshot]){
+        if ([delegate respondsToSelector:aSelector]) return YES;
+    }
+    return NO;
+}
+
+-(NSMethodSignature*)methodSignatureForSelector:(SEL)aSelector
+{
+    NSMethodSignature *signature = [super methodSignatureForSelector:aSelector];
+    if (signature) return signature;
+    for (id delegate in [self delegatesSnapshot]){
+        if ([delegate respondsToSelector:aSelector]){
+            return [delegate methodSignatureForSelector:aSelector];
+        }
+    }
+    return nil;
+}
+
+-(void)forwardInvocation:(NSInvocation *)anInvocation
+{
+    NSArray *delegates;
+    @synchronized(self){
+        if ([anInvocation selector] != @selector(CLIENT_DID_PROGRESS)){
+            self.joinable = NO;
+        }
+        delegates = [self.delegates copy];
+    }
+    for (id delegate in delegates){
+        if ([delegate respondsToSelector:[anInvocation selector]]){
+            [anInvocation invokeWithTarget:delegate];
+        }
+    }
+}
+
+#pragma mark Private Methods
+
+-(NSArray*)delegatesSnapshot
+{
+    @synchronized(self){
+        return [self.delegates copy];
+    }
+}
+
+#pragma mark Class Methods
+
+/*
+ Optional HSFCatcherDelegate selectors the delegate responds to, as strings.
+ */
++(NSSet*)callbacksOfDelegate:(id<HSFCatcherDelegate>)delegate
+{
+    NSMutableSet *callbacks = [[NSMutableSet alloc] init];
+    unsigned int count;
+    struct objc_method_description *methods = protocol_copyMethodDescriptionList(@protocol(HSFCatcherDelegate), NO, YES, &count);
+    for (unsigned int i = 0; i < count; ++i){
+        if ([delegate respondsToSelector:methods[i].name]){
+            [callbacks addObject:NSStringFromSelector(methods[i].name)];
+        }
+    }
+    free(methods);
+    return callbacks;
+}
+
+@end
@@ -0,0 +1,177 @@
+//
+//  HSFCatcherMetrics.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 28/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFLatencyHistogram.h"
+
+/*!
+ @abstract Timing of one asynchronous loading.
+ @discussion HSFCatcher fills it in while loading, if its handler collects metrics. Intervals are in seconds, measured with monotonic clock from the start of loading. Connection phases describe the last attempt, durations of scanning, parsing and delegate callbacks are summed over all attempts. Thread safe.
+ */
+@interface HSFCatcherMetrics : NSObject
+
+/*!
+ @abstract Class of the loaded HSFAction.
+ */
+@property (nonatomic,readonly) Class actionClass;
+
+/*!
+ @abstract Time to make the action stamp, request and SOAP envelope included.
+ */
+@property (nonatomic,readonly) NSTimeInterval requestBuildDuration;
+
+/*!
+ @abstract Interval from start till the connection was started.
+ @discussion Includes waiting for a free connection to the host and retry delays.
+ */
+@property (nonatomic,readonly) NSTimeInterval waitInterval;
+
+/*!
+ @abstract Time from the start of connection till response headers.
+ */
+@property (nonatomic,readonly) NSTimeInterval connectDuration;
+
+/*!
+ @abstract Interval from start till the first byte of response body, 0 if none was received.
+ */
+@property (nonatomic,readonly) NSTimeInterval firstByteInterval;
+
+/*!
+ @abstract Interval from start till the last byte of response body, 0 if loading was not finished.
+ */
+@property (nonatomic,readonly) NSTimeInterval lastByteInterval;
+
+/*!
+ @abstract Interval from start till the catcher finished its job.
+ */
+@property (nonatomic,readonly) NSTimeInterval totalDuration;
+
+/*!
+ @abstract Time spent scanning received data for unit and streaming tags.
+ @discussion Parsing of units and delegate callbacks made while scanning are not included.
+ */
+@property (nonatomic,readonly) NSTimeInterval scanDuration;
+
+/*!
+ @abstract Time spent parsing entire response.
+ */
+@property (nonatomic,readonly) NSTimeInterval entireParseDuration;
+
+/*!
+ @abstract Parse time of every unit.
+ */
+@property (strong,nonatomic,readonly) HSFLatencyHistogram *unitParseHistogram;
+
+/*!
+ @abstract Time spent in delegate callbacks.
+ */
+@property (nonatomic,readonly) NSTimeInterval delegateDuration;
+
+/*!
+ @abstract Number of repeated attempts.
+ */
+@property (nonatomic,readonly) NSUInteger retryCount;
+
+/*!
+ @abstract Number of bytes received by the last attempt.
+ */
+@property (nonatomic,readonly) long long bytesReceived;
+
+/*!
+ @abstract Determine whether the response was replayed from the response cache.
+ */
+@property (nonatomic,readonly) BOOL isReplayed;
+
+/*!
+ @abstract Determine whether the entire response was received.
+ */
+@property (nonatomic,readonly) BOOL isSucceeded;
+
+/*!
+ @abstract Error the loading failed with, nil if it succeeded or was cancelled.
+ */
+@property (strong,nonatomic,readonly) NSError *error;
+
+/*!
+ @abstract Determine whether the loading is over.
+ */
+@property (nonatomic,readonly) BOOL isFinished;
+
+#pragma mark Recording
+
+/*!
+ @abstract Designated initializer.
+ @discussion Loading is considered started at this moment.
+ */
+-(id)initWithActionClass:(Class)actionClass;
+
+/*!
+ @abstract Time to make the action stamp.
+ */
+-(void)addRequestBuildDuration:(NSTimeInterval)duration;
+
+/*!
+ @abstract Connection of an attempt is started.
+ @param replayed YES if the response is replayed from cache instead.
+ */
+-(void)markConnectionStartReplayed:(BOOL)replayed;
+
+/*!
+ @abstract Response headers are received.
+ */
+-(void)markResponse;
+
+/*!
+ @abstract Piece of response body is received.
+ */
+-(void)markDataReceived:(NSUInteger)length;
+
+/*!
+ @abstract Response body is received.
+ */
+-(void)markLastByte;
+
+/*!
+ @abstract Loading is going to be repeated.
+ */
+-(void)markRetry;
+
+/*!
+ @abstract Time of scanning a piece of response body.
+ */
+-(void)addScanDuration:(NSTimeInterval)duration;
+
+/*!
+ @abstract Time of parsing entire response or a piece of it.
+ */
+-(void)addEntireParseDuration:(NSTimeInterval)duration;
+
+/*!
+ @abstract Time of parsing one unit.
+ */
+-(void)addUnitParseDuration:(NSTimeInterval)duration;
+
+/*!
+ @abstract Time of a delegate callback.
+ */
+-(void)addDelegateDuration:(NSTimeInterval)duration;
+
+/*!
+ @abstract Loading is over.
+ @param succeeded YES if the entire response was received.
+ @param error Error the loading failed with.
+ @return NO if the loading is already finished.
+ */
+-(BOOL)finishSucceeded:(BOOL)succeeded error:(NSError*)error;
+
+/*!
+ @abstract Monotonic time in seconds.
+ */
++(NSTimeInterval)currentTime;
+
+@end
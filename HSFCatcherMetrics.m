@@ -0,0 +1,172 @@
+//
+//  HSFCatcherMetrics.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 28/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFCatcherMetrics.h"
+#import <mach/mach_time.h>
+
+@interface HSFCatcherMetrics()
+
+@property (nonatomic,readwrite) Class actionClass;
+@property (nonatomic,readwrite) NSTimeInterval requestBuildDuration;
+@property (nonatomic,readwrite) NSTimeInterval waitInterval;
+@property (nonatomic,readwrite) NSTimeInterval connectDuration;
+@property (nonatomic,readwrite) NSTimeInterval firstByteInterval;
+@property (nonatomic,readwrite) NSTimeInterval lastByteInterval;
+@property (nonatomic,readwrite) NSTimeInterval totalDuration;
+@property (nonatomic,readwrite) NSTimeInterval scanDuration;
+@property (nonatomic,readwrite) NSTimeInterval entireParseDuration;
+@property (strong,nonatomic,readwrite) HSFLatencyHistogram *unitParseHistogram;
+@property (nonatomic,readwrite) NSTimeInterval delegateDuration;
+@property (nonatomic,readwrite) NSUInteger retryCount;
+@property (nonatomic,readwrite) long long bytesReceived;
+@property (nonatomic,readwrite) BOOL isReplayed;
+@property (nonatomic,readwrite) BOOL isSucceeded;
+@property (strong,nonatomic,readwrite) NSError *error;
+@property (nonatomic,readwrite) BOOL isFinished;
+
+/*
+ Moments loading and the connection of the last attempt were started.
+ */
+@property (nonatomic) NSTimeInterval startTime;
+@property (nonatomic) NSTimeInterval connectionStartTime;
+
+@end
+
+@implementation HSFCatcherMetrics
+
+#pragma mark Public Methods
+
+-(id)initWithActionClass:(Class)actionClass
+{
+    self = [super init];
+    if (self){
+        _actionClass = actionClass;
+        _unitParseHistogram = [[HSFLatencyHistogram alloc] init];
+        _startTime = [[self class] currentTime];
+        _connectionStartTime = _startTime;
+    }
+    return self;
+}
+
+-(id)init
+{
+    return [self initWithActionClass:Nil];
+}
+
+-(void)addRequestBuildDuration:(NSTimeInterval)duration
+{
+    @synchronized(self){
+        self.requestBuildDuration += duration;
+    }
+}
+
+-(void)markConnectionStartReplayed:(BOOL)replayed
+{
+    NSTimeInterval now = [[self class] currentTime];
+    @synchronized(self){
+        self.connectionStartTime = now;
+        self.waitInterval = now - self.startTime;
+        self.connectDuration = 0.0;
+        self.firstByteInterval = 0.0;
+        self.lastByteInterval = 0.0;
+        self.bytesReceived = 0;
+        self.isReplayed = replayed;
+    }
+}
+
+-(void)markResponse
+{
+    NSTimeInterval now = [[self class] currentTime];
+    @synchronized(self){
+        self.connectDuration = now - self.connectionStartTime;
+    }
+}
+
+-(void)markDataReceived:(NSUInteger)length
+{
+    NSTimeInterval now = [[self class] currentTime];
+    @synchronized(self){
+        if (!self.firstByteInterval) self.firstByteInterval = now - self.startTime;
+        self.bytesReceived += length;
+    }
+}
+
+-(void)markLastByte
+{
+    NSTimeInterval now = [[self class] currentTime];
+    @synchronized(self){
+        self.lastByteInterval = now - self.startTime;
+    }
+}
+
+-(void)markRetry
+{
+    @synchronized(self){
+        ++self.retryCount;
+    }
+}
+
+-(void)addScanDuration:(NSTimeInterval)duration
+{
+    @synchronized(self){
+        self.scanDuration += duration;
+    }
+}
+
+-(void)addEntireParseDuration:(NSTimeInterval)duration
+{
+    @synchronized(self){
+        self.entireParseDuration += duration;
+    }
+}
+
+-(void)addUnitParseDuration:(NSTimeInterval)duration
+{
+    [self.unitParseHistogram addSample:duration];
+}
+
+-(void)addDelegateDuration:(NSTimeInterval)duration
+{
+    @synchronized(self){
+        self.delegateDuration += duration;
+    }
+}
+
+-(BOOL)finishSucceeded:(BOOL)succeeded error:(NSError*)error
+{
+    NSTimeInterval now = [[self class] currentTime];
+    @synchronized(self){
+        if (self.isFinished) return NO;
+        self.isFinished = YES;
+        self.isSucceeded = succeeded;
+        self.error = error;
+        self.totalDuration = now - self.startTime;
+        return YES;
+    }
+}
+
+-(NSString*)description
+{
+    @synchronized(self){
+        return [NSString stringWithFormat:@"%@ %@ build:%.6f wait:%.6f connect:%.6f firstByte:%.6f lastByte:%.6f total:%.6f scan:%.6f parse:%.6f units:%lu delegate:%.6f retries:%lu bytes:%lld",[super description],NSStringFromClass(self.actionClass),self.requestBuildDuration,self.waitInterval,self.connectDuration,self.firstByteInterval,self.lastByteInterval,self.totalDuration,self.scanDuration,self.entireParseDuration,(unsigned long)self.unitParseHistogram.count,self.delegateDuration,(unsigned long)self.retryCount,self.bytesReceived];
+    }
+}
+
+#pragma mark Class Methods
+
++(NSTimeInterval)currentTime
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / 1000000000.0;
+}
+
+@end
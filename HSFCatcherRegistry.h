@@ -0,0 +1,59 @@
+//
+//  HSFCatcherRegistry.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 27/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class HSFCatcher;
+
+/*!
+ @abstract Registry of active catchers.
+ @discussion Catchers are kept in hashed sets split into shards, every shard has its own lock, so registering catchers from many threads does not contend on one lock. Catchers are indexed by action class and by groupTags of their actions, so a group is found without scanning all catchers. Registry retains catchers. Thread safe.
+ */
+@interface HSFCatcherRegistry : NSObject
+
+/*!
+ @abstract Number of registered catchers.
+ */
+@property (nonatomic,readonly) NSUInteger count;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Register catcher.
+ @discussion Catcher is indexed by its actionStamp, which must be set.
+ @return NO if the catcher was already registered.
+ */
+-(BOOL)addCatcher:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Unregister catcher.
+ @return NO if the catcher was not registered.
+ */
+-(BOOL)removeCatcher:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Determine whether catcher is registered.
+ */
+-(BOOL)containsCatcher:(HSFCatcher*)catcher;
+
+/*!
+ @abstract Catchers of actions of the class, subclasses excluded.
+ */
+-(NSArray*)catchersOfActionClass:(Class)actionClass;
+
+/*!
+ @abstract Catchers of actions with the group tag.
+ */
+-(NSArray*)catchersWithTag:(NSString*)tag;
+
+/*!
+ @abstract All registered catchers.
+ */
+-(NSArray*)allCatchers;
+
+@end
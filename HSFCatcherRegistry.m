@@ -0,0 +1,206 @@
+//
+//  HSFCatcherRegistry.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 27/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFCatcherRegistry.h"
+#import "HSFCatcher.h"
+#import "HSFCommon.h"
+#import <pthread.h>
+
+/*
+ Part of the registry with its own lock.
+ */
+@interface HSFCatcherRegistryShard : NSObject{
+@public
+    pthread_mutex_t _lock;
+}
+
+@property (strong,nonatomic) NSMutableSet *catchers;
+@property (strong,nonatomic) NSMutableDictionary *catchersByClass;
+@property (strong,nonatomic) NSMutableDictionary *catchersByTag;
+
+@end
+
+@implementation HSFCatcherRegistryShard
+
+-(id)init
+{
+    self = [super init];
+    if (self){
+        pthread_mutex_init(&_lock, NULL);
+        _catchers = [[NSMutableSet alloc] init];
+        _catchersByClass = [[NSMutableDictionary alloc] init];
+        _catchersByTag = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    pthread_mutex_destroy(&_lock);
+}
+
+@end
+
+@interface HSFCatcherRegistry()
+
+@property (strong,nonatomic) NSArray *shards;
+
+@end
+
+@implementation HSFCatcherRegistry
+
+#pragma mark Properties
+
+-(NSUInteger)count
+{
+    NSUInteger count = 0;
+    for (HSFCatcherRegistryShard *shard in self.shards){
+        pthread_mutex_lock(&shard->_lock);
+        count += [shard.catchers count];
+        pthread_mutex_unlock(&shard->_lock);
+    }
+    return count;
+}
+
+#pragma mark Public Methods
+
+-(id)init
+{
+    self = [super init];
+    if (self){
+        NSMutableArray *shards = [[NSMutableArray alloc] initWithCapacity:HSF_CATCHER_REGISTRY_SHARDS];
+        for (NSUInteger i = 0; i < HSF_CATCHER_REGISTRY_SHARDS; ++i){
+            [shards addObject:[[HSFCatcherRegistryShard alloc] init]];
+        }
+        _shards = [shards copy];
+    }
+    return self;
+}
+
+-(BOOL)addCatcher:(HSFCatcher*)catcher
+{
+    if (!catcher) return NO;
+    HSFCatcherRegistryShard *shard = [self shardForCatcher:catcher];
+    NSString *className = NSStringFromClass(catcher.actionStamp.actionClass);
+    NSArray *tags = catcher.actionStamp.groupTags;
+
+    pthread_mutex_lock(&shard->_lock);
+    BOOL added = ![shard.catchers containsObject:catcher];
+    if (added){
+        [shard.catchers addObject:catcher];
+        if (className){
+            [self addCatcher:catcher forKey:className inIndex:shard.catchersByClass];
+        }
+        for (NSString *tag in tags){
+            [self addCatcher:catcher forKey:tag inIndex:shard.catchersByTag];
+        }
+    }
+    pthread_mutex_unlock(&shard->_lock);
+    return added;
+}
+
+-(BOOL)removeCatcher:(HSFCatcher*)catcher
+{
+    if (!catcher) return NO;
+    HSFCatcherRegistryShard *shard = [self shardForCatcher:catcher];
+    NSString *className = NSStringFromClass(catcher.actionStamp.actionClass);
+    NSArray *tags = catcher.actionStamp.groupTags;
+
+    pthread_mutex_lock(&shard->_lock);
+    BOOL contained = [shard.catchers containsObject:catcher];
+    if (contained){
+        [shard.catchers removeObject:catcher];
+        if (className){
+            [self removeCatcher:catcher forKey:className inIndex:shard.catchersByClass];
+        }
+        for (NSString *tag in tags){
+            [self removeCatcher:catcher forKey:tag inIndex:shard.catchersByTag];
+        }
+    }
+    pthread_mutex_unlock(&shard->_lock);
+    return contained;
+}
+
+-(BOOL)containsCatcher:(HSFCatcher*)catcher
+{
+    if (!catcher) return NO;
+    HSFCatcherRegistryShard *shard = [self shardForCatcher:catcher];
+    pthread_mutex_lock(&shard->_lock);
+    BOOL contained = [shard.catchers containsObject:catcher];
+    pthread_mutex_unlock(&shard->_lock);
+    return contained;
+}
+
+-(NSArray*)catchersOfActionClass:(Class)actionClass
+{
+    NSString *className = NSStringFromClass(actionClass);
+    if (!className) return @[];
+    return [self catchersForKey:className inIndex:^NSDictionary*(HSFCatcherRegistryShard *shard){ return shard.catchersByClass; }];
+}
+
+-(NSArray*)catchersWithTag:(NSString*)tag
+{
+    if (!tag) return @[];
+    return [self catchersForKey:tag inIndex:^NSDictionary*(HSFCatcherRegistryShard *shard){ return shard.catchersByTag; }];
+}
+
+-(NSArray*)allCatchers
+{
+    NSMutableArray *catchers = [[NSMutableArray alloc] init];
+    for (HSFCatcherRegistryShard *shard in self.shards){
+        pthread_mutex_lock(&shard->_lock);
+        [catchers addObjectsFromArray:[shard.catchers allObjects]];
+        pthread_mutex_unlock(&shard->_lock);
+    }
+    return [catchers copy];
+}
+
+#pragma mark Private Methods
+
+-(HSFCatcherRegistryShard*)shardForCatcher:(HSFCatcher*)catcher
+{
+    // Objects are aligned, low bits of the address carry no information.
+    NSUInteger hash = ((uintptr_t)(__bridge void*)catcher) >> 4;
+    return self.shards[hash % HSF_CATCHER_REGISTRY_SHARDS];
+}
+
+-(void)addCatcher:(HSFCatcher*)catcher forKey:(NSString*)key inIndex:(NSMutableDictionary*)index
+{
+    NSMutableSet *catchers = index[key];
+    if (!catchers){
+        catchers = [[NSMutableSet alloc] init];
+        index[key] = catchers;
+    }
+    [catchers addObject:catcher];
+}
+
+-(void)removeCatcher:(HSFCatcher*)catcher forKey:(NSString*)key inIndex:(NSMutableDictionary*)index
+{
+    NSMutableSet *catchers = index[key];
+    [catchers removeObject:catcher];
+    if (catchers && ![catchers count]){
+        [index removeObjectForKey:key];
+    }
+}
+
+/*
+ Collect catchers of the key from every shard, the block picks the index of a shard.
+ */
+-(NSArray*)catchersForKey:(NSString*)key inIndex:(NSDictionary* (^)(HSFCatcherRegistryShard *shard))indexOfShard
+{
+    NSMutableArray *catchers = [[NSMutableArray alloc] init];
+    for (HSFCatcherRegistryShard *shard in self.shards){
+        pthread_mutex_lock(&shard->_lock);
+        NSDictionary *index = indexOfShard(shard);
+        [catchers addObjectsFromArray:[index[key] allObjects]];
+        pthread_mutex_unlock(&shard->_lock);
+    }
+    return [catchers copy];
+}
+
+@end
@@ -0,0 +1,52 @@
+//
+//  HSFCircuitBreaker.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 26/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Per host circuit breaker.
+ @discussion After failureThreshold consecutive failures a host is tripped: requests to it are refused for cooldownInterval. Then one trial request is let through; its success closes the circuit, its failure trips it again. Hosts are told apart by host name and port. Thread safe.
+ */
+@interface HSFCircuitBreaker : NSObject
+
+/*!
+ @abstract Number of consecutive failures which trips a host.
+ @discussion Default value is HSF_CIRCUIT_BREAKER_THRESHOLD.
+ */
+@property (nonatomic) NSUInteger failureThreshold;
+
+/*!
+ @abstract Seconds a tripped host is refused.
+ @discussion Default value is HSF_CIRCUIT_BREAKER_COOLDOWN.
+ */
+@property (nonatomic) NSTimeInterval cooldownInterval;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Determine whether a request may be sent to the host of URL.
+ @discussion Returns YES for the first request after cooldown, and treats it as trial.
+ */
+-(BOOL)allowsRequestToURL:(NSURL*)url;
+
+/*!
+ @abstract Host of URL responded.
+ */
+-(void)recordSuccessForURL:(NSURL*)url;
+
+/*!
+ @abstract Host of URL is unreachable or unavailable.
+ */
+-(void)recordFailureForURL:(NSURL*)url;
+
+/*!
+ @abstract Determine whether host of URL is tripped now.
+ */
+-(BOOL)isTrippedForURL:(NSURL*)url;
+
+@end
@@ -0,0 +1,88 @@
+//
+//  HSFCircuitBreaker.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 26/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFCircuitBreaker.h"
+#import "HSFCommon.h"
+
+@interface HSFCircuitBreaker()
+
+/*
+ Consecutive failures and end of refusal by host.
+ */
+@property (strong,nonatomic) NSMutableDictionary *failureCounts;
+@property (strong,nonatomic) NSMutableDictionary *trippedUntilDates;
+
+@end
+
+@implementation HSFCircuitBreaker
+
+#pragma mark Public Methods
+
+-(id)init
+{
+    self = [super init];
+    if (self){
+        _failureThreshold = HSF_CIRCUIT_BREAKER_THRESHOLD;
+        _cooldownInterval = HSF_CIRCUIT_BREAKER_COOLDOWN;
+        _failureCounts = [[NSMutableDictionary alloc] init];
+        _trippedUntilDates = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+-(BOOL)allowsRequestToURL:(NSURL*)url
+{
+    NSString *host = [self hostForURL:url];
+    @synchronized(self){
+        NSDate *trippedUntil = self.trippedUntilDates[host];
+        if (!trippedUntil) return YES;
+        if ([trippedUntil timeIntervalSinceNow] > 0) return NO;
+
+        // Trial request. Others are refused until it finishes or the next cooldown is over.
+        self.trippedUntilDates[host] = [NSDate dateWithTimeIntervalSinceNow:self.cooldownInterval];
+        return YES;
+    }
+}
+
+-(void)recordSuccessForURL:(NSURL*)url
+{
+    NSString *host = [self hostForURL:url];
+    @synchronized(self){
+        [self.failureCounts removeObjectForKey:host];
+        [self.trippedUntilDates removeObjectForKey:host];
+    }
+}
+
+-(void)recordFailureForURL:(NSURL*)url
+{
+    NSString *host = [self hostForURL:url];
+    @synchronized(self){
+        NSUInteger failures = [self.failureCounts[host] unsignedIntegerValue] + 1;
+        self.failureCounts[host] = @(failures);
+        if (failures >= self.failureThreshold){
+            self.trippedUntilDates[host] = [NSDate dateWithTimeIntervalSinceNow:self.cooldownInterval];
+        }
+    }
+}
+
+-(BOOL)isTrippedForURL:(NSURL*)url
+{
+    NSString *host = [self hostForURL:url];
+    @synchronized(self){
+        return [self.trippedUntilDates[host] timeIntervalSinceNow] > 0;
+    }
+}
+
+#pragma mark Private Methods
+
+-(NSString*)hostForURL:(NSURL*)url
+{
+    return [NSString stringWithFormat:@"%@:%@",[[url host] lowercaseString],[url port]];
+}
+
+@end
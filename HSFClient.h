@@ -9,8 +9,13 @@
 #import <Foundation/Foundation.h>
 #import "HSFAction.h"
 #import "HSFCatcher.h"
+#import "HSFResponseCache.h"
+#import "HSFCatcherRegistry.h"
+#import "HSFActionMetrics.h"
+#import "HSFFuture.h"
 
 @protocol HSFClientDelegate;
+@protocol HSFMetricsObserver;
 
 /*!
  @abstract Handmade SOAP Framework client singleton.
@@ -23,26 +28,166 @@
  */
 @property (weak,nonatomic) id <HSFClientDelegate> delegate;
 
+/*!
+ @abstract Metrics observer (weak pointer).
+ @discussion Catchers measure their loadings only while the observer is set, otherwise metrics cost nothing but a nil check.
+ */
+@property (weak,nonatomic) id <HSFMetricsObserver> metricsObserver;
+
 /*!
  @abstract Count of active HSFCatcher instances.
  */
 @property (nonatomic,readonly) NSUInteger count;
 
+/*!
+ @abstract Maximum number of connections in flight per host.
+ @discussion Catchers beyond the limit wait in a queue ordered by loadPriority of their actions, then by arrival. Connections themselves are kept alive and reused by the URL loading system. 0 means no limit. Default value is HSF_MAX_CONNECTIONS_PER_HOST, which is 0.
+ */
+@property (nonatomic) NSUInteger maxConnectionsPerHost;
+
+/*!
+ @abstract Number of catchers which connections are in flight.
+ */
+@property (nonatomic,readonly) NSUInteger activeConnectionCount;
+
+/*!
+ @abstract Number of catchers waiting for a connection.
+ */
+@property (nonatomic,readonly) NSUInteger waitingCatcherCount;
+
+/*!
+ @abstract Number of connections admitted since launch, retries included.
+ */
+@property (nonatomic,readonly) NSUInteger admittedConnectionTotal;
+
+/*!
+ @abstract Number of times a catcher had to wait for a connection since launch.
+ */
+@property (nonatomic,readonly) NSUInteger queuedConnectionTotal;
+
+/*!
+ @abstract The most connections which were in flight at once since launch.
+ */
+@property (nonatomic,readonly) NSUInteger peakActiveConnectionCount;
+
+/*!
+ @abstract The most catchers which waited for a connection at once since launch.
+ */
+@property (nonatomic,readonly) NSUInteger peakWaitingCatcherCount;
+
+/*!
+ @abstract Time catchers spent waiting for a connection since launch, in seconds.
+ @discussion Divided by queuedConnectionTotal it gives the mean wait. Catchers cancelled while waiting are counted too.
+ */
+@property (nonatomic,readonly) NSTimeInterval totalWaitDuration;
+
+/*!
+ @abstract Circuit breaker shared by all catchers.
+ */
+@property (strong,nonatomic,readonly) HSFCircuitBreaker *circuitBreaker;
+
+/*!
+ @abstract Cache of responses of actions with cacheLifetime.
+ @discussion Disk tier is kept in caches directory. Hit, miss and eviction counters are exposed by the cache.
+ */
+@property (strong,nonatomic,readonly) HSFResponseCache *responseCache;
+
+/*!
+ @abstract Worker pool shared by catchers.
+ @discussion Units of actions with parseConcurrency of 0 are parsed here. Number of workers could be limited with maxConcurrentOperationCount.
+ */
+@property (strong,nonatomic,readonly) NSOperationQueue *parseQueue;
+
 /*!
  @abstract Perform SOAP action on a server, and handle response asynchronously.
- @discussion This methods creates new HSFCatcher and performs SOAP action.
+ @discussion This methods creates new HSFCatcher and performs SOAP action. If the action is coalescable and an identical action (same class, URL, SOAPAction header, body, credential and header fields) is in flight, the delegate joins its catcher instead, unless the catcher has already received a response or the delegates respond to different callbacks. The delegate of a shared catcher is HSFCatcherDelegateGroup.
  @param action HSFAction to perform.
  @param delegate HSFCatcherDelegate which will receive callbacks about processing request.
  @return HSFCatcher which were assigned to handle network job for this action.
  */
 -(HSFCatcher*)loadAsynchronouslyWithAction:(HSFAction*)action delegate:(id<HSFCatcherDelegate>)delegate;
 
+/*!
+ @abstract Stop loading for one delegate.
+ @discussion Cancellation of a shared catcher is reference counted: the delegate is unsubscribed, and the catcher is cancelled when no delegates are left. Other catchers are cancelled at once.
+ @param catcher Catcher returned by loadAsynchronouslyWithAction:delegate:.
+ @param delegate The delegate passed with the action.
+ */
+-(void)cancelCatcher:(HSFCatcher*)catcher delegate:(id<HSFCatcherDelegate>)delegate;
+
+/*!
+ @abstract Cancel catchers of actions of the class.
+ @discussion Subclasses of the class are not affected. Catchers are looked up in the registry index, not by scanning all catchers. Shared catchers are cancelled for all their delegates.
+ */
+-(void)cancelCatchersOfActionClass:(Class)actionClass;
+
+/*!
+ @abstract Cancel catchers of actions with the group tag.
+ @discussion See groupTags of HSFAction. Shared catchers are cancelled for all their delegates.
+ */
+-(void)cancelCatchersWithTag:(NSString*)tag;
+
+/*!
+ @abstract Cancel all active catchers.
+ @discussion Catchers waiting to retry after a failed attempt are active too, their pending retry is dropped.
+ */
+-(void)cancelAllCatchers;
+
+/*!
+ @abstract Metrics aggregated for the action class.
+ @return Metrics or nil if no loading of the class was measured.
+ */
+-(HSFActionMetrics*)metricsForActionClass:(Class)actionClass;
+
+/*!
+ @abstract Metrics of all measured action classes.
+ @return Array of HSFActionMetrics.
+ */
+-(NSArray*)allActionMetrics;
+
+/*!
+ @abstract Discard aggregated metrics.
+ */
+-(void)resetMetrics;
+
+/*!
+ @abstract Number of connections in flight to the host of the URL.
+ @discussion Connections are counted per host and port, as maxConnectionsPerHost limits them.
+ @param url URL of the host.
+ @return Number of admitted catchers of the host.
+ */
+-(NSUInteger)activeConnectionCountForURL:(NSURL*)url;
+
+/*!
+ @abstract Number of catchers waiting for a connection to the host of the URL.
+ @param url URL of the host.
+ @return Number of waiting catchers of the host.
+ */
+-(NSUInteger)waitingCatcherCountForURL:(NSURL*)url;
+
 /*!
  @abstract Load data from server synchronously.
  @discussion This is just a wrapper for HSFCatcher analogous method. TODO: may shift it from HSFCatcher to here?
  */
 -(HSFNode*)loadSynchronouslyWithAction:(HSFAction*)action response:(NSURLResponse **)response error:(NSError **)error;
 
+/*!
+ @abstract Perform SOAP action and get a future of its result.
+ @discussion Loading is started on a thread owned by HSFClient, whose run loop receives the callbacks of the catcher, so the method may be called from any thread, never waits for the network and the main thread is not used. Result of the future is array of units (HSFNode or model objects of unitModelMapping) if the action has unitTags, model object if it has responseModelMapping, otherwise root node of the entire response. Actions with streamingTags are not supported. Cancelling the future cancels loading for it, a shared catcher of coalescable action is cancelled only when no delegates are left.
+ @param action HSFAction to perform.
+ @return Future of the response.
+ */
+-(HSFFuture*)futureWithAction:(HSFAction*)action;
+
+/*!
+ @abstract Perform several SOAP actions with limited concurrency.
+ @discussion At most maxConcurrentLoads actions are loaded at a time, the next pending one is started as soon as one finishes, so no thread waits for them. Connections are still limited by maxConnectionsPerHost. Result of the returned future is array of futures of the actions, see futureWithAction:, in the same order; it is finished when all of them are finished, failed ones included. Cancelling it cancels the actions which are not finished yet.
+ @param actions Array of HSFAction.
+ @param maxConcurrentLoads Maximum number of actions in flight. 0 means no limit.
+ @return Future of the futures of the actions.
+ */
+-(HSFFuture*)loadAll:(NSArray*)actions maxConcurrentLoads:(NSUInteger)maxConcurrentLoads;
+
 /*!
  @abstract Notification of catcher about finished job handler.
  */
@@ -63,12 +208,31 @@
 
 /*!
  @abstract Send when network activity indicating should begin.
+ @discussion Sent on the thread of the catcher which started, that is the loading thread of HSFClient for futures.
  */
 -(void)didStartNetworkIndicating;
 
 /*!
  @abstract Send when network activity indicating should stop.
+ @discussion Sent on the thread of the catcher which finished.
  */
 -(void)didStopNetworkIndicating;
 
 @end
+
+/*!
+ @abstract HSFClient metrics observer.
+ @discussion HSFClient passes metrics of every measured loading to the observer, after they are added to the metrics of the action class.
+ */
+@protocol HSFMetricsObserver <NSObject>
+
+/*!
+ @abstract Loading is measured.
+ @discussion Called on the thread which finished the loading.
+ @param client HSFClient which aggregated metrics.
+ @param metrics Metrics of the loading.
+ @param actionMetrics Metrics of the action class, the loading included.
+ */
+-(void)client:(HSFClient*)client didCollectMetrics:(HSFCatcherMetrics*)metrics actionMetrics:(HSFActionMetrics*)actionMetrics;
+
+@end
@@ -8,13 +8,149 @@
 
 #import "HSFClient.h"
 #import "HSFCommon.h"
+#import "HSFCatcherDelegateGroup.h"
 
 static HSFClient *_sharedHSFClient;
 
+/*
+ Catcher delegate which collects the response of an action and finishes its future.
+ */
+@interface HSFFutureCatcherDelegate : NSObject <HSFCatcherDelegate>
+
+@property (strong,nonatomic) HSFFuture *future;
+@property (nonatomic) BOOL collectsUnits;
+@property (nonatomic) BOOL decodesResponse;
+
+/*
+ Units or model objects of units, appended in batches.
+ */
+@property (strong,nonatomic) NSMutableArray *units;
+@property (strong,nonatomic) id response;
+
+-(id)initWithFuture:(HSFFuture*)future action:(HSFAction*)action;
+
+@end
+
+@implementation HSFFutureCatcherDelegate
+
+-(id)initWithFuture:(HSFFuture*)future action:(HSFAction*)action
+{
+    self = [super init];
+    if (self){
+        _future = future;
+        _collectsUnits = [action.unitTags count] > 0;
+        _decodesResponse = !_collectsUnits && action.responseModelMapping;
+        _units = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+/*
+ Catcher chooses what to deliver by the callbacks its delegate responds to.
+ */
+-(BOOL)respondsToSelector:(SEL)aSelector
+{
+    if (aSelector == @selector(CLIENT_DID_RECEIVE_UNITS_SELECTOR)) return self.collectsUnits;
+    if (aSelector == @selector(CLIENT_DID_RECEIVE_ENTIRE_RESPONSE_SELECTOR)) return !self.collectsUnits && !self.decodesResponse;
+    if (aSelector == @selector(CLIENT_DID_RECEIVE_RESPONSE_OBJECT_SELECTOR)) return self.decodesResponse;
+    return [super respondsToSelector:aSelector];
+}
+
+-(void)catcher:(HSFCatcher *)catcher didReceiveUnits:(NSArray *)units
+{
+    @synchronized(self){
+        [self.units addObjectsFromArray:units];
+    }
+}
+
+-(void)catcher:(HSFCatcher *)catcher didReceiveEntireResponse:(HSFNode *)root
+{
+    self.response = root;
+}
+
+-(void)catcher:(HSFCatcher *)catcher didReceiveResponseObject:(id)object
+{
+    self.response = object;
+}
+
+-(void)catcher:(HSFCatcher *)catcher didFailWithCommonError:(NSError *)error
+{
+    [self.future finishWithResult:nil error:error];
+}
+
+-(void)catcher:(HSFCatcher *)catcher didFailAuthenticationWithError:(NSError *)error
+{
+    [self.future finishWithResult:nil error:error];
+}
+
+-(void)catcherDidCancelLoading:(HSFCatcher *)catcher
+{
+    [self.future finishWithResult:nil error:[HSFFuture cancellationError]];
+}
+
+-(void)catcherDidFinishLoading:(HSFCatcher *)catcher
+{
+    // Batched units are all delivered before this call.
+    if (self.collectsUnits){
+        @synchronized(self){
+            [self.future finishWithResult:[self.units copy] error:nil];
+        }
+    } else {
+        [self.future finishWithResult:self.response error:nil];
+    }
+}
+
+@end
+
 @interface HSFClient()
 
-@property (strong,nonatomic) NSMutableArray* catchers;
+/*
+ Active catchers. The registry has its own locks, it is not guarded by the client.
+ */
+@property (strong,nonatomic) HSFCatcherRegistry *catchers;
 @property (nonatomic) NSUInteger networkActivities;
+@property (strong,nonatomic,readwrite) NSOperationQueue *parseQueue;
+@property (strong,nonatomic,readwrite) HSFResponseCache *responseCache;
+@property (strong,nonatomic,readwrite) HSFCircuitBreaker *circuitBreaker;
+
+/*
+ Shared catchers of coalescable actions by request key, and the keys by catcher.
+ */
+@property (strong,nonatomic) NSMutableDictionary *coalescedCatchers;
+@property (strong,nonatomic) NSMapTable *coalescingKeys;
+
+/*
+ Catchers which connections are in flight, and their hosts.
+ */
+@property (strong,nonatomic) NSMutableSet *admittedCatchers;
+@property (strong,nonatomic) NSCountedSet *activeHosts;
+
+/*
+ Catchers waiting for a connection by host, each queue is ordered by priority then by arrival.
+ */
+@property (strong,nonatomic) NSMutableDictionary *waitingCatchers;
+@property (nonatomic) NSUInteger waitingCount;
+
+/*
+ Time when waiting catchers were queued.
+ */
+@property (strong,nonatomic) NSMapTable *waitingStartTimes;
+
+/*
+ Thread with its own run loop, where catchers of futures are started and receive their callbacks.
+ */
+@property (strong,nonatomic) NSThread *loadingThread;
+
+/*
+ Aggregated metrics by action class name.
+ */
+@property (strong,nonatomic) NSMutableDictionary *actionMetrics;
+
+@property (nonatomic,readwrite) NSUInteger admittedConnectionTotal;
+@property (nonatomic,readwrite) NSUInteger queuedConnectionTotal;
+@property (nonatomic,readwrite) NSUInteger peakActiveConnectionCount;
+@property (nonatomic,readwrite) NSUInteger peakWaitingCatcherCount;
+@property (nonatomic,readwrite) NSTimeInterval totalWaitDuration;
 
 @end
 
@@ -22,15 +158,93 @@ static HSFClient *_sharedHSFClient;
 
 #pragma mark Properties
 
--(NSMutableArray*)catchers
+-(NSOperationQueue*)parseQueue
 {
-    if (!_catchers)_catchers = [[NSMutableArray alloc] init];
-    return _catchers;
+    @synchronized(self){
+        if (!_parseQueue){
+            _parseQueue = [[NSOperationQueue alloc] init];
+            _parseQueue.name = @PARSE_QUEUE;
+        }
+        return _parseQueue;
+    }
 }
 
 -(NSUInteger)count
 {
-    return [self.catchers count];
+    return self.catchers.count;
+}
+
+-(HSFResponseCache*)responseCache
+{
+    @synchronized(self){
+        if (!_responseCache){
+            NSString *caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+            _responseCache = [[HSFResponseCache alloc] initWithPath:[caches stringByAppendingPathComponent:RESPONSE_CACHE_DIRECTORY]];
+        }
+        return _responseCache;
+    }
+}
+
+-(NSMutableDictionary*)coalescedCatchers
+{
+    if (!_coalescedCatchers)_coalescedCatchers = [[NSMutableDictionary alloc] init];
+    return _coalescedCatchers;
+}
+
+-(NSMapTable*)coalescingKeys
+{
+    if (!_coalescingKeys)_coalescingKeys = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    return _coalescingKeys;
+}
+
+-(NSMutableSet*)admittedCatchers
+{
+    if (!_admittedCatchers)_admittedCatchers = [[NSMutableSet alloc] init];
+    return _admittedCatchers;
+}
+
+-(NSCountedSet*)activeHosts
+{
+    if (!_activeHosts)_activeHosts = [[NSCountedSet alloc] init];
+    return _activeHosts;
+}
+
+-(NSMutableDictionary*)waitingCatchers
+{
+    if (!_waitingCatchers)_waitingCatchers = [[NSMutableDictionary alloc] init];
+    return _waitingCatchers;
+}
+
+-(NSMapTable*)waitingStartTimes
+{
+    if (!_waitingStartTimes)_waitingStartTimes = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    return _waitingStartTimes;
+}
+
+-(NSUInteger)activeConnectionCount
+{
+    @synchronized(self){
+        return [self.admittedCatchers count];
+    }
+}
+
+-(NSUInteger)waitingCatcherCount
+{
+    @synchronized(self){
+        return self.waitingCount;
+    }
+}
+
+-(NSThread*)loadingThread
+{
+    @synchronized(self){
+        if (!_loadingThread){
+            _loadingThread = [[NSThread alloc] initWithTarget:self selector:@selector(runLoadingThread) object:nil];
+            [_loadingThread setName:@"HSFClient loading"];
+            [_loadingThread start];
+        }
+        return _loadingThread;
+    }
 }
 
 -(void)setNetworkActivities:(NSUInteger)networkActivities
@@ -48,64 +262,485 @@ static HSFClient *_sharedHSFClient;
 
 #pragma mark Tasks
 
+-(id)init
+{
+    self = [super init];
+    if (self){
+        _maxConnectionsPerHost = HSF_MAX_CONNECTIONS_PER_HOST;
+        _circuitBreaker = [[HSFCircuitBreaker alloc] init];
+        _catchers = [[HSFCatcherRegistry alloc] init];
+        _actionMetrics = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
 -(HSFCatcher*)loadAsynchronouslyWithAction:(HSFAction*)action delegate:(id<HSFCatcherDelegate>)delegate
 {
     if (!delegate || !action){
         [NSException raise:NSInvalidArgumentException format:@"The delegate or action is not set."];
     }
     @synchronized(self){
+        if (action.isCoalescable && !action.isStreamsBody){
+            return [self supplyCoalescedCatcherWithAction:action delegate:delegate];
+        }
         HSFCatcher *catcher = [self supplyCatcherWithDelegate:delegate];
         [catcher loadAsynchronouslyWithAction:action];
         return catcher;
     }
 }
 
+-(void)cancelCatcher:(HSFCatcher*)catcher delegate:(id<HSFCatcherDelegate>)delegate
+{
+    @synchronized(self){
+        if ([catcher.delegate isKindOfClass:[HSFCatcherDelegateGroup class]]){
+            HSFCatcherDelegateGroup *group = (HSFCatcherDelegateGroup*)catcher.delegate;
+            [group removeDelegate:delegate];
+            if (group.count) return;
+            // The catcher is going to be cancelled, nobody may join it after the lock is released.
+            [group closeJoining];
+            NSString *key = [self.coalescingKeys objectForKey:catcher];
+            if (key){
+                if (self.coalescedCatchers[key] == catcher) [self.coalescedCatchers removeObjectForKey:key];
+                [self.coalescingKeys removeObjectForKey:catcher];
+            }
+        }
+    }
+    [catcher cancel];
+}
+
+-(void)cancelCatchersOfActionClass:(Class)actionClass
+{
+    [self cancelCatchers:[self.catchers catchersOfActionClass:actionClass]];
+}
+
+-(void)cancelCatchersWithTag:(NSString*)tag
+{
+    [self cancelCatchers:[self.catchers catchersWithTag:tag]];
+}
+
+-(void)cancelAllCatchers
+{
+    [self cancelCatchers:[self.catchers allCatchers]];
+}
+
+-(HSFActionMetrics*)metricsForActionClass:(Class)actionClass
+{
+    NSString *className = NSStringFromClass(actionClass);
+    if (!className) return nil;
+    @synchronized(self.actionMetrics){
+        return self.actionMetrics[className];
+    }
+}
+
+-(NSArray*)allActionMetrics
+{
+    @synchronized(self.actionMetrics){
+        return [self.actionMetrics allValues];
+    }
+}
+
+-(void)resetMetrics
+{
+    @synchronized(self.actionMetrics){
+        [self.actionMetrics removeAllObjects];
+    }
+}
+
+-(NSUInteger)activeConnectionCountForURL:(NSURL*)url
+{
+    @synchronized(self){
+        return [self.activeHosts countForObject:[self hostForURL:url]];
+    }
+}
+
+-(NSUInteger)waitingCatcherCountForURL:(NSURL*)url
+{
+    @synchronized(self){
+        return [self.waitingCatchers[[self hostForURL:url]] count];
+    }
+}
+
 -(HSFNode*)loadSynchronouslyWithAction:(HSFAction*)action response:(NSURLResponse **)response error:(NSError **)error
 {
     return [HSFCatcher loadSynchronouslyWithAction:action response:response error:error];
 }
 
-#pragma mark Private Methods
+-(HSFFuture*)futureWithAction:(HSFAction*)action
+{
+    [self validateFutureAction:action];
+    HSFFuture *future = [[HSFFuture alloc] init];
+    [self startFuture:future withAction:action];
+    return future;
+}
 
--(HSFCatcher*)supplyCatcherWithDelegate:(id<HSFCatcherDelegate>)delegate
+-(HSFFuture*)loadAll:(NSArray*)actions maxConcurrentLoads:(NSUInteger)maxConcurrentLoads
 {
-    @synchronized(self){
-        if (!delegate){
-            [NSException raise:NSInvalidArgumentException format:@"The delegate is not set."];
+    NSMutableArray *futures = [[NSMutableArray alloc] initWithCapacity:[actions count]];
+    for (HSFAction *action in actions){
+        [self validateFutureAction:action];
+        [futures addObject:[[HSFFuture alloc] init]];
+    }
+    HSFFuture *batch = [HSFFuture futureWithFutures:futures];
+    
+    NSMutableArray *pending = [[NSMutableArray alloc] initWithCapacity:[actions count]];
+    for (NSUInteger i = 0; i < [actions count]; ++i){
+        [pending addObject:@(i)];
+    }
+    NSUInteger limit = maxConcurrentLoads ? MIN(maxConcurrentLoads,[actions count]) : [actions count];
+    NSArray *batchActions = [actions copy];
+    // Pending indexes are taken on the loading thread only.
+    [self performOnLoadingThread:^{
+        for (NSUInteger i = 0; i < limit; ++i){
+            [self loadNextOfActions:batchActions futures:futures pending:pending];
         }
+    }];
+    return batch;
+}
+
+#pragma mark Private Methods
+
+/*
+ Connections are limited per host and port.
+ */
+-(NSString*)hostForCatcher:(HSFCatcher*)catcher
+{
+    return [self hostForURL:catcher.actionStamp.request.URL];
+}
+
+-(NSString*)hostForURL:(NSURL*)url
+{
+    return [NSString stringWithFormat:@"%@:%@",[[url host] lowercaseString],[url port]];
+}
+
+-(void)admitCatcher:(HSFCatcher*)catcher
+{
+    [self.admittedCatchers addObject:catcher];
+    [self.activeHosts addObject:[self hostForCatcher:catcher]];
+    self.admittedConnectionTotal++;
+    self.peakActiveConnectionCount = MAX(self.peakActiveConnectionCount, [self.admittedCatchers count]);
+}
+
+/*
+ Admit waiting catchers while the host has free connections.
+ */
+-(void)admitWaitingCatchersForHost:(NSString*)host
+{
+    NSMutableOrderedSet *queue = self.waitingCatchers[host];
+    while ([queue count]){
+        if (self.maxConnectionsPerHost && [self.activeHosts countForObject:host] >= self.maxConnectionsPerHost)
+            return;
         
-        HSFCatcher * catcher = [[HSFCatcher alloc] initWithDelegate:delegate];
-        [self.catchers addObject:catcher];
-       
+        HSFCatcher *catcher = [queue firstObject];
+        [queue removeObjectAtIndex:0];
+        self.waitingCount--;
+        [self finishWaitingOfCatcher:catcher];
+        [self admitCatcher:catcher];
+        [catcher admitConnection];
+    }
+    [self.waitingCatchers removeObjectForKey:host];
+}
+
+/*
+ Free the connection of the catcher for the next waiting one, or take the catcher out of the wait queue. Called under the client lock.
+ */
+-(void)releaseAdmissionOfCatcher:(HSFCatcher*)catcher
+{
+    NSString *host = [self hostForCatcher:catcher];
+    if ([self.admittedCatchers containsObject:catcher]){
+        [self.admittedCatchers removeObject:catcher];
+        [self.activeHosts removeObject:host];
+        [self admitWaitingCatchersForHost:host];
+    } else {
+        [self dequeueWaitingCatcher:catcher forHost:host];
+    }
+}
+
+-(void)enqueueWaitingCatcher:(HSFCatcher*)catcher forHost:(NSString*)host
+{
+    NSMutableOrderedSet *queue = self.waitingCatchers[host];
+    if (!queue){
+        queue = [[NSMutableOrderedSet alloc] init];
+        self.waitingCatchers[host] = queue;
+    }
+    // Keep FIFO order among catchers of the same priority.
+    NSUInteger index = [queue indexOfObject:catcher inSortedRange:NSMakeRange(0, [queue count]) options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual usingComparator:^NSComparisonResult(HSFCatcher *first, HSFCatcher *second){
+        NSInteger firstPriority = first.actionStamp.loadPriority;
+        NSInteger secondPriority = second.actionStamp.loadPriority;
+        if (firstPriority == secondPriority) return NSOrderedSame;
+        return firstPriority > secondPriority ? NSOrderedAscending : NSOrderedDescending;
+    }];
+    [queue insertObject:catcher atIndex:index];
+    self.waitingCount++;
+    self.peakWaitingCatcherCount = MAX(self.peakWaitingCatcherCount, self.waitingCount);
+    [self.waitingStartTimes setObject:@([HSFCatcherMetrics currentTime]) forKey:catcher];
+}
+
+-(void)finishWaitingOfCatcher:(HSFCatcher*)catcher
+{
+    NSNumber *startTime = [self.waitingStartTimes objectForKey:catcher];
+    [self.waitingStartTimes removeObjectForKey:catcher];
+    if (startTime) self.totalWaitDuration += [HSFCatcherMetrics currentTime] - [startTime doubleValue];
+}
+
+/*
+ Returns NO if the catcher was not waiting.
+ */
+-(BOOL)dequeueWaitingCatcher:(HSFCatcher*)catcher forHost:(NSString*)host
+{
+    NSMutableOrderedSet *queue = self.waitingCatchers[host];
+    if (![queue containsObject:catcher]) return NO;
+    [queue removeObject:catcher];
+    if (![queue count]) [self.waitingCatchers removeObjectForKey:host];
+    self.waitingCount--;
+    [self finishWaitingOfCatcher:catcher];
+    return YES;
+}
+
+/*
+ Join identical action in flight or start a shared catcher.
+ */
+-(HSFCatcher*)supplyCoalescedCatcherWithAction:(HSFAction*)action delegate:(id<HSFCatcherDelegate>)delegate
+{
+    NSURLRequest *request = action.request;
+    // Actions of different users are never joined.
+    NSString *key = [HSFResponseCache keyForRequest:request actionClass:[action class] credential:action.credential];
+    if (!key){
+        HSFCatcher *catcher = [self supplyCatcherWithDelegate:delegate];
+        [catcher loadAsynchronouslyWithAction:action];
         return catcher;
     }
+    
+    HSFCatcher *catcher = self.coalescedCatchers[key];
+    if (catcher.isInLoading && [(HSFCatcherDelegateGroup*)catcher.delegate addDelegate:delegate]){
+        return catcher;
+    }
+    
+    catcher = [self supplyCatcherWithDelegate:[[HSFCatcherDelegateGroup alloc] initWithDelegate:delegate]];
+    self.coalescedCatchers[key] = catcher;
+    [self.coalescingKeys setObject:key forKey:catcher];
+    [catcher loadAsynchronouslyWithAction:action];
+    return catcher;
+}
+
+-(void)validateFutureAction:(HSFAction*)action
+{
+    if (!action){
+        [NSException raise:NSInvalidArgumentException format:@"The action is not set."];
+    }
+    if ([action.streamingTags count]){
+        [NSException raise:NSInvalidArgumentException format:@"Streaming content of %@ can't be collected into a future.",[action class]];
+    }
+}
+
+/*
+ Catchers run on the loading thread run loop, so the caller never waits for loading to start and the main thread is not used.
+ */
+-(void)startFuture:(HSFFuture*)future withAction:(HSFAction*)action
+{
+    [self performOnLoadingThread:^{
+        // Cancelled before start.
+        if (future.isFinished) return;
+        
+        HSFFutureCatcherDelegate *delegate = [[HSFFutureCatcherDelegate alloc] initWithFuture:future action:action];
+        HSFCatcher *catcher = [self loadAsynchronouslyWithAction:action delegate:delegate];
+        // Catcher keeps delegate and future, the handler must not keep them back.
+        __weak HSFCatcher *weakCatcher = catcher;
+        __weak HSFFutureCatcherDelegate *weakDelegate = delegate;
+        future.cancellationHandler = ^{
+            [self performOnLoadingThread:^{
+                HSFCatcher *strongCatcher = weakCatcher;
+                HSFFutureCatcherDelegate *strongDelegate = weakDelegate;
+                if (strongCatcher && strongDelegate) [self cancelCatcher:strongCatcher delegate:strongDelegate];
+            }];
+        };
+        // Cancelled while the handler was not set.
+        if (future.isCancelled) [self cancelCatcher:catcher delegate:delegate];
+    }];
+}
+
+/*
+ Start the next pending action of a batch, the action after it is started when it finishes. Called on the loading thread.
+ */
+-(void)loadNextOfActions:(NSArray*)actions futures:(NSArray*)futures pending:(NSMutableArray*)pending
+{
+    while ([pending count]){
+        NSUInteger index = [pending[0] unsignedIntegerValue];
+        [pending removeObjectAtIndex:0];
+        HSFFuture *future = futures[index];
+        // Cancelled while waiting.
+        if (future.isFinished) continue;
+        
+        [future addCompletionBlock:^(HSFFuture *finished) {
+            [self performOnLoadingThread:^{
+                [self loadNextOfActions:actions futures:futures pending:pending];
+            }];
+        } queue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)];
+        [self startFuture:future withAction:actions[index]];
+        return;
+    }
+}
+
+/*
+ Run the block on the loading thread, at once if called on it.
+ */
+-(void)performOnLoadingThread:(dispatch_block_t)block
+{
+    NSThread *thread = self.loadingThread;
+    if ([NSThread currentThread] == thread){
+        block();
+    } else {
+        [self performSelector:@selector(runBlock:) onThread:thread withObject:[block copy] waitUntilDone:NO];
+    }
+}
+
+-(void)runBlock:(dispatch_block_t)block
+{
+    block();
+}
+
+/*
+ Entry point of the loading thread. The port keeps its run loop running when no connection is scheduled.
+ */
+-(void)runLoadingThread
+{
+    @autoreleasepool {
+        NSRunLoop *runLoop = [NSRunLoop currentRunLoop];
+        [runLoop addPort:[NSMachPort port] forMode:NSDefaultRunLoopMode];
+        [runLoop run];
+    }
+}
+
+/*
+ Catchers are cancelled outside of any lock, cancel calls catcherFinished: back.
+ */
+-(void)cancelCatchers:(NSArray*)catchers
+{
+    for (HSFCatcher *catcher in catchers){
+        [catcher cancel];
+    }
+}
+
+/*
+ Responses are cached per user, nil if the request can't be keyed by its identity.
+ */
+-(NSString*)cacheKeyForActionStamp:(HSFActionStamp*)actionStamp
+{
+    return [HSFResponseCache keyForRequest:actionStamp.request actionClass:actionStamp.actionClass credential:actionStamp.credential];
+}
+
+-(HSFCatcher*)supplyCatcherWithDelegate:(id<HSFCatcherDelegate>)delegate
+{
+    if (!delegate){
+        [NSException raise:NSInvalidArgumentException format:@"The delegate is not set."];
+    }
+    
+    // Catcher is registered in catcherStarted:, when its action stamp is known.
+    return [[HSFCatcher alloc] initWithDelegate:delegate];
 }
 
 #pragma mark HSFCatcherHandler protocol
 
 -(void)catcherStarted:(HSFCatcher *)catcher
+{
+    if (![self.catchers addCatcher:catcher])
+        return;
+    
+    if (catcher.actionStamp.networkActivityIndicator){
+        @synchronized(self) {
+            self.networkActivities++;
+        }
+    }
+}
+
+-(BOOL)catcherShouldStartConnection:(HSFCatcher *)catcher
 {
     @synchronized(self) {
-        if (![self.catchers containsObject:catcher])
-            [self.catchers addObject:catcher];
+        NSString *host = [self hostForCatcher:catcher];
+        if (!self.maxConnectionsPerHost || [self.activeHosts countForObject:host] < self.maxConnectionsPerHost){
+            [self admitCatcher:catcher];
+            return YES;
+        }
         
-        if (catcher.actionStamp.networkActivityIndicator)
-            self.networkActivities++;
+        [self enqueueWaitingCatcher:catcher forHost:host];
+        self.queuedConnectionTotal++;
+        return NO;
+    }
+}
+
+-(HSFCircuitBreaker*)circuitBreakerForCatcher:(HSFCatcher *)catcher
+{
+    return self.circuitBreaker;
+}
+
+-(NSData*)cachedResponseDataForCatcher:(HSFCatcher *)catcher
+{
+    NSString *key = [self cacheKeyForActionStamp:catcher.actionStamp];
+    return key ? [self.responseCache dataForKey:key] : nil;
+}
+
+-(void)catcher:(HSFCatcher *)catcher didLoadResponseData:(NSData *)data
+{
+    NSString *key = [self cacheKeyForActionStamp:catcher.actionStamp];
+    if (key) [self.responseCache storeData:data forKey:key lifetime:catcher.actionStamp.cacheLifetime];
+}
+
+-(void)catcherWillRetry:(HSFCatcher *)catcher
+{
+    // Catcher stays registered during backoff, so bulk cancel finds it.
+    @synchronized(self) {
+        [self releaseAdmissionOfCatcher:catcher];
     }
-    
 }
 
 -(void)catcherFinished:(HSFCatcher*)catcher
 {
     @synchronized(self) {
-        if (![self.catchers containsObject:catcher]){
-            return;
-        }
-        [self.catchers removeObject:catcher];
+        [self releaseAdmissionOfCatcher:catcher];
         
-        if (catcher.actionStamp.networkActivityIndicator)
+        NSString *key = [self.coalescingKeys objectForKey:catcher];
+        if (key && !catcher.isInLoading){
+            // The key may be taken by a newer catcher already.
+            if (self.coalescedCatchers[key] == catcher) [self.coalescedCatchers removeObjectForKey:key];
+            [self.coalescingKeys removeObjectForKey:catcher];
+        }
+    }
+    
+    if (![self.catchers removeCatcher:catcher])
+        return;
+    
+    if (catcher.actionStamp.networkActivityIndicator){
+        @synchronized(self) {
             self.networkActivities--;
+        }
+    }
+}
+
+-(NSOperationQueue*)parseQueueForCatcher:(HSFCatcher*)catcher
+{
+    return self.parseQueue;
+}
+
+-(BOOL)shouldCollectMetricsForCatcher:(HSFCatcher *)catcher
+{
+    return self.metricsObserver != nil;
+}
+
+-(void)catcher:(HSFCatcher *)catcher didCollectMetrics:(HSFCatcherMetrics *)metrics
+{
+    NSString *className = NSStringFromClass(metrics.actionClass);
+    if (!className) return;
+    
+    // Metrics have their own lock, the client one guards admission.
+    HSFActionMetrics *actionMetrics;
+    @synchronized(self.actionMetrics){
+        actionMetrics = self.actionMetrics[className];
+        if (!actionMetrics){
+            actionMetrics = [[HSFActionMetrics alloc] initWithActionClass:metrics.actionClass];
+            self.actionMetrics[className] = actionMetrics;
+        }
     }
+    [actionMetrics addCatcherMetrics:metrics];
+    [self.metricsObserver client:self didCollectMetrics:metrics actionMetrics:actionMetrics];
 }
 
 #pragma mark Class Methods
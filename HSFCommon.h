@@ -13,6 +13,20 @@
 #define POST_METHOD @"POST"
 #define CONTENT_TYPE @"Content-Type"
 #define CONTENT_LENGTH @"Content-Length"
+#define SOAP_ACTION_HEADER @"SOAPAction"
+#define HTTP_STATUS_OK 200
+#define HTTP_STATUS_TOO_MANY_REQUESTS 429
+#define HTTP_STATUS_SERVICE_UNAVAILABLE 503
+#define RETRY_AFTER_HEADER @"Retry-After"
+#define HTTP_DATE_FORMAT @"EEE, dd MMM yyyy HH:mm:ss zzz"
+#define HSF_RETRY_AFTER_KEY @"retryAfter"
+#define HTTP_VERSION @"HTTP/1.1"
+#define CONTENT_ENCODING_HEADER @"Content-Encoding"
+#define ACCEPT_ENCODING_HEADER @"Accept-Encoding"
+#define GZIP_ENCODING @"gzip"
+#define X_GZIP_ENCODING @"x-gzip"
+#define DEFLATE_ENCODING @"deflate"
+#define ACCEPTED_ENCODINGS @"gzip, deflate"
 
 
 #define DID_FAIL_LOADING_SELECTOR catcher:didFailLoadingWithError:
@@ -20,16 +34,52 @@
 #define DID_FAIL_AUTH_SELECTOR catcher:didFailAuthenticationWithError:
 #define DID_FAIL_COMMON_SELECTOR catcher:didFailWithCommonError:
 #define CLIENT_DID_RECEIVE_UNIT_SELECTOR catcher:didReceiveUnit:
+#define CLIENT_DID_RECEIVE_UNITS_SELECTOR catcher:didReceiveUnits:
 #define CLIENT_DID_RECEIVE_ENTIRE_RESPONSE_SELECTOR catcher:didReceiveEntireResponse:
+#define CLIENT_DID_RECEIVE_UNIT_OBJECT_SELECTOR catcher:didReceiveUnitObject:
+#define CLIENT_DID_RECEIVE_RESPONSE_OBJECT_SELECTOR catcher:didReceiveResponseObject:
 #define CLIENT_DID_PROGRESS catcher:didProgress:
 #define CATCHER_DID_RECEIVE_CONTENT_SELECTOR catcher:didReceiveContent:forTag:lastChunk:
+#define CATCHER_DID_RECEIVE_CONTENT_DATA_SELECTOR catcher:didReceiveContentData:forTag:lastChunk:
 #define CATCHER_DID_RECEIVE_RESPONSE_SELECTOR catcher:didReceiveResponse:
 #define CATCHER_DID_FINISH_LOADING_SELECTOR catcherDidFinishLoading:
+#define CATCHER_DID_CANCEL_LOADING_SELECTOR catcherDidCancelLoading:
+#define CATCHER_DID_RECEIVE_ATTACHMENT_DATA_SELECTOR catcher:didReceiveAttachmentData:forContentID:lastChunk:
+#define CATCHER_DID_SAVE_ATTACHMENT_SELECTOR catcher:didSaveAttachmentAtPath:forContentID:
 
 #define PARSE_QUEUE "Parse queue"
+#define DELIVERY_QUEUE "Unit delivery queue"
+#define SPILL_FILE_NAME_FORMAT @"HSFResponse-%@.xml"
+#define HSF_BASE64_BUFFER_SIZE 4096
+#define HSF_INFLATE_BUFFER_SIZE 16384
+#define HSF_BODY_STREAM_BUFFER_SIZE 32768
+#define BODY_STREAM_THREAD @"Body stream thread"
+#define HSF_MULTIPART_HEADER_LIMIT 16384
+#define MULTIPART_RELATED_TYPE @"multipart/related"
+#define XOP_INCLUDE_NAME @"Include"
+#define XOP_HREF_ATTRIBUTE @"href"
+#define CONTENT_ID_HEADER @"content-id"
+#define ATTACHMENT_FILE_NAME_FORMAT @"HSFAttachment-%@"
+#define RESPONSE_CACHE_QUEUE "Response cache queue"
+#define RESPONSE_CACHE_DIRECTORY @"HSFResponseCache"
+#define HSF_RESPONSE_CACHE_MEMORY_CAPACITY (4 * 1024 * 1024)
 #define ROOT_NODE_NAME @"root"
+#define HSF_SYMBOL_TABLE_CAPACITY 4096
+#define HSF_MODEL_DATE_FORMAT @"yyyy-MM-dd'T'HH:mm:ss'Z'"
+#define HSF_MODEL_PATH_SEPARATOR @"/"
+#define HSF_MODEL_ATTRIBUTE_PREFIX @"@"
+#define HSF_ARCHIVE_MAGIC 0x4E465348
+#define HSF_ARCHIVE_VERSION 1
 
 #define DEFAULT_CONNECTION_TIMEOUT 60.0
+#define HSF_CIRCUIT_BREAKER_THRESHOLD 5
+#define HSF_CIRCUIT_BREAKER_COOLDOWN 30.0
+#define HSF_MAX_CONNECTIONS_PER_HOST 0
+#define HSF_UNIT_BATCH_SIZE 100
+#define HSF_UNIT_BATCH_LENGTH (64 * 1024)
+#define HSF_UNIT_BATCH_INTERVAL 0.1
+#define HSF_CATCHER_REGISTRY_SHARDS 16
+#define HSF_HISTOGRAM_BUCKETS 40
 
 /*!
  @abstract Authentication error domain.
@@ -37,6 +87,18 @@
  */
 #define HSFAuthenticationErrorDomain @"HSFAuthenticationErrorDomain"
 
+/*!
+ @abstract HTTP error domain.
+ @discussion Server answered with HTTP status which asks to retry later, error code is the status. Retry-After is in userInfo under HSF_RETRY_AFTER_KEY, in seconds.
+ */
+#define HSFHTTPErrorDomain @"HSFHTTPErrorDomain"
+
+/*!
+ @abstract Circuit breaker error domain.
+ @discussion Request was not sent, because its host is tripped after consecutive failures.
+ */
+#define HSFCircuitBreakerErrorDomain @"HSFCircuitBreakerErrorDomain"
+
 /*!
  @abstract Parse error domain.
  @discussion Error occurred during parsing process.
@@ -44,4 +106,22 @@
 #define HSFParseErrorDomain @"HSFParseErrorDomain"
 
 #define HSF_ERROR_CODE_XML_PARSE_ERROR 1
-#define HSF_ERROR_MESSAGE_XML_PARSE_ERROR @"XML parsing error occcured."
\ No newline at end of file
+#define HSF_ERROR_MESSAGE_XML_PARSE_ERROR @"XML parsing error occcured."
+
+#define HSF_ERROR_CODE_BASE64_DECODE_ERROR 2
+#define HSF_ERROR_MESSAGE_BASE64_DECODE_ERROR @"Base64 decoding error occurred."
+
+#define HSF_ERROR_CODE_DECOMPRESSION_ERROR 3
+#define HSF_ERROR_MESSAGE_DECOMPRESSION_ERROR @"Response decompression error occurred."
+
+#define HSF_ERROR_CODE_MODEL_DECODE_ERROR 4
+#define HSF_ERROR_MESSAGE_MODEL_DECODE_ERROR @"Model decoding error occurred."
+
+#define HSF_ERROR_CODE_ARCHIVE_ERROR 5
+#define HSF_ERROR_MESSAGE_ARCHIVE_ERROR @"Node archive is not valid."
+
+#define HSF_ERROR_CODE_MULTIPART_ERROR 6
+#define HSF_ERROR_MESSAGE_MULTIPART_ERROR @"Multipart response is not valid."
+
+#define HSF_ERROR_CODE_CIRCUIT_OPEN 1
+#define HSF_ERROR_MESSAGE_CIRCUIT_OPEN @"Host is temporarily unavailable."
\ No newline at end of file
@@ -0,0 +1,51 @@
+//
+//  HSFEnvelopeTemplate.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 22/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class HSFAction;
+
+/*!
+ @abstract Compiled SOAP envelope of HSFAction.
+ @discussion Envelope head and tail, SOAP action tag and tags of parameters are encoded into bytes and validated once. HTTP body is then made by filling escaped parameter values between these bytes. Templates are cached per HSFAction subclass and set of parameter keys (or SOAPParameterOrder), and recompiled only when the envelope of an action changes. Templates are immutable and thread safe.
+ */
+@interface HSFEnvelopeTemplate : NSObject
+
+/*!
+ @abstract Parameter keys in the order of the slots.
+ */
+@property (strong,nonatomic,readonly) NSArray *keys;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Template for the action and its parameters.
+ @discussion Returns the cached template of the action class and parameter keys if it fits the action, otherwise compiles a new one and caches it. In DEBUG mode throws HSFInvalidXMLException if the envelope is not valid XML.
+ @param action Action to make HTTP body for.
+ @param parameters SOAPParameters of the action.
+ @return The template.
+ */
++(HSFEnvelopeTemplate*)templateForAction:(HSFAction*)action parameters:(NSDictionary*)parameters;
+
+/*!
+ @abstract Make HTTP body.
+ @discussion String values (and descriptions of other objects) are escaped, unless escapesParameterValues of the action is NO. NSData values are inserted as they are, so they may carry raw XML. NSNull values and values missing in parameters make nil elements.
+ @param parameters Values by parameter key.
+ @return UTF-8 encoded SOAP envelope.
+ */
+-(NSData*)bodyWithParameters:(NSDictionary*)parameters;
+
+/*!
+ @abstract Make parts of streamed HTTP body.
+ @discussion The same as bodyWithParameters:, but HSFStreamedParameter values are not read: the envelope bytes around them are joined into NSData parts and the parameters are put between them.
+ @param parameters Values by parameter key.
+ @return Array of NSData and HSFStreamedParameter.
+ */
+-(NSArray*)bodyPartsWithParameters:(NSDictionary*)parameters;
+
+@end
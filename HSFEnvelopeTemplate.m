@@ -0,0 +1,292 @@
+//
+//  HSFEnvelopeTemplate.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 22/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFEnvelopeTemplate.h"
+#import "HSFAction.h"
+#import "HSFExceptions.h"
+#import "HSFStreamedParameter.h"
+
+static NSMutableDictionary *_templates;
+
+static BOOL HSFStringsEqual(NSString *first, NSString *second)
+{
+    return first == second || [first isEqualToString:second];
+}
+
+/*
+ Append UTF-8 bytes of the string with XML special characters escaped.
+ */
+static void HSFAppendEscapedString(NSMutableData *body, NSString *string)
+{
+    const char *bytes = [string UTF8String];
+    if (!bytes) return;
+
+    const char *run = bytes;
+    const char *p = bytes;
+    for (; *p; ++p){
+        const char *entity;
+        switch (*p){
+            case '&':
+                entity = "&amp;";
+                break;
+            case '<':
+                entity = "&lt;";
+                break;
+            case '>':
+                entity = "&gt;";
+                break;
+            default:
+                continue;
+        }
+        [body appendBytes:run length:p - run];
+        [body appendBytes:entity length:strlen(entity)];
+        run = p + 1;
+    }
+    [body appendBytes:run length:p - run];
+}
+
+@interface HSFEnvelopeTemplate()
+
+@property (strong,nonatomic,readwrite) NSArray *keys;
+
+// Sources the template was compiled from.
+@property (strong,nonatomic) NSString *SOAPEnvelopeHead;
+@property (strong,nonatomic) NSString *SOAPEnvelopeTail;
+@property (strong,nonatomic) NSString *SOAPAction;
+@property (strong,nonatomic) NSString *attributesForSOAPActionTag;
+@property (strong,nonatomic) NSString *nilAttribute;
+@property (nonatomic) BOOL isOrdered;
+@property (nonatomic) BOOL isEscaping;
+
+// Envelope head with start tag of SOAP action, and end tag with envelope tail.
+@property (strong,nonatomic) NSData *head;
+@property (strong,nonatomic) NSData *tail;
+
+// Bytes of the slots, in the order of keys.
+@property (strong,nonatomic) NSArray *startTags;
+@property (strong,nonatomic) NSArray *endTags;
+@property (strong,nonatomic) NSArray *nilElements;
+
+// Length of the body without values.
+@property (nonatomic) NSUInteger fixedLength;
+
+@end
+
+@implementation HSFEnvelopeTemplate
+
+#pragma mark Public Methods
+
+-(NSData*)bodyWithParameters:(NSDictionary*)parameters
+{
+    NSUInteger capacity = self.fixedLength;
+    for (id key in self.keys){
+        id value = parameters[key];
+        if ([value isKindOfClass:[NSString class]] || [value isKindOfClass:[NSData class]]){
+            capacity += [value length];
+        }
+    }
+
+    NSMutableData *body = [[NSMutableData alloc] initWithCapacity:capacity];
+    [body appendData:self.head];
+    NSUInteger count = [self.keys count];
+    for (NSUInteger i = 0; i < count; ++i){
+        id value = parameters[self.keys[i]];
+        if (!value || [value isKindOfClass:[NSNull class]]){
+            [body appendData:self.nilElements[i]];
+            continue;
+        }
+        [body appendData:self.startTags[i]];
+        [self appendValue:value toBody:body];
+        [body appendData:self.endTags[i]];
+    }
+    [body appendData:self.tail];
+    return body;
+}
+
+-(NSArray*)bodyPartsWithParameters:(NSDictionary*)parameters
+{
+    NSMutableArray *parts = [[NSMutableArray alloc] init];
+    NSMutableData *body = [[NSMutableData alloc] initWithData:self.head];
+    NSUInteger count = [self.keys count];
+    for (NSUInteger i = 0; i < count; ++i){
+        id value = parameters[self.keys[i]];
+        if (!value || [value isKindOfClass:[NSNull class]]){
+            [body appendData:self.nilElements[i]];
+            continue;
+        }
+        [body appendData:self.startTags[i]];
+        if ([value isKindOfClass:[HSFStreamedParameter class]]){
+            [parts addObject:body];
+            [parts addObject:value];
+            body = [[NSMutableData alloc] init];
+        } else {
+            [self appendValue:value toBody:body];
+        }
+        [body appendData:self.endTags[i]];
+    }
+    [body appendData:self.tail];
+    [parts addObject:body];
+    return parts;
+}
+
+#pragma mark Private Methods
+
+-(id)initWithAction:(HSFAction*)action parameters:(NSDictionary*)parameters
+{
+    self = [super init];
+    if (self){
+        _SOAPEnvelopeHead = action.SOAPEnvelopeHead;
+        _SOAPEnvelopeTail = action.SOAPEnvelopeTail;
+        _SOAPAction = action.SOAPAction;
+        _attributesForSOAPActionTag = action.attributesForSOAPActionTag;
+        _nilAttribute = action.nilAttribute;
+        _isEscaping = action.isEscapesParameterValues;
+        [self compileWithParameters:parameters order:action.SOAPParameterOrder];
+        [self validateForAction:action];
+    }
+    return self;
+}
+
+-(void)appendValue:(id)value toBody:(NSMutableData*)body
+{
+    if ([value isKindOfClass:[NSData class]]){
+        [body appendData:value];
+    } else if (self.isEscaping){
+        HSFAppendEscapedString(body, [value description]);
+    } else {
+        // Raw strings, as before values were escaped.
+        const char *bytes = [[value description] UTF8String];
+        if (bytes) [body appendBytes:bytes length:strlen(bytes)];
+    }
+}
+
+-(void)compileWithParameters:(NSDictionary*)parameters order:(NSArray*)order
+{
+    NSString *SOAPTag = [[NSString alloc] initWithFormat:@"%@ %@",self.SOAPAction,self.attributesForSOAPActionTag];
+    SOAPTag = [SOAPTag stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+
+    NSMutableArray *startTags = [[NSMutableArray alloc] init];
+    NSMutableArray *endTags = [[NSMutableArray alloc] init];
+    NSMutableArray *nilElements = [[NSMutableArray alloc] init];
+    NSString *head;
+    NSString *tail;
+
+    if ([parameters count] > 0){
+        self.isOrdered = ([order count] > 0);
+        self.keys = self.isOrdered ? [order copy] : [parameters allKeys];
+        for (id key in self.keys){
+            [startTags addObject:[[NSString stringWithFormat:@"<%@>",key] dataUsingEncoding:NSUTF8StringEncoding]];
+            [endTags addObject:[[NSString stringWithFormat:@"</%@>",key] dataUsingEncoding:NSUTF8StringEncoding]];
+            NSString *nilElement = (self.nilAttribute.length) ? [NSString stringWithFormat:@"<%@ %@/>",key,self.nilAttribute] : [NSString stringWithFormat:@"<%@ />",key];
+            [nilElements addObject:[nilElement dataUsingEncoding:NSUTF8StringEncoding]];
+        }
+        head = [NSString stringWithFormat:@"%@<%@>",self.SOAPEnvelopeHead,SOAPTag];
+        tail = [NSString stringWithFormat:@"</%@>%@",self.SOAPAction,self.SOAPEnvelopeTail];
+    } else {
+        self.keys = @[];
+        head = [NSString stringWithFormat:@"%@<%@ />",self.SOAPEnvelopeHead,SOAPTag];
+        tail = self.SOAPEnvelopeTail;
+    }
+
+    self.head = [head dataUsingEncoding:NSUTF8StringEncoding];
+    self.tail = [tail dataUsingEncoding:NSUTF8StringEncoding];
+    self.startTags = [startTags copy];
+    self.endTags = [endTags copy];
+    self.nilElements = [nilElements copy];
+
+    NSUInteger fixedLength = [self.head length] + [self.tail length];
+    for (NSUInteger i = 0; i < [self.keys count]; ++i){
+        fixedLength += [self.startTags[i] length] + [self.endTags[i] length];
+    }
+    self.fixedLength = fixedLength;
+}
+
+/*
+ Check envelope with empty values for valid xml document. Values are escaped, so they can't break it.
+ */
+-(void)validateForAction:(HSFAction*)action
+{
+    NSData *xml = [self bodyWithParameters:@{}];
+    NSMutableData *sample = [[NSMutableData alloc] initWithData:self.head];
+    for (NSUInteger i = 0; i < [self.keys count]; ++i){
+        [sample appendData:self.startTags[i]];
+        [sample appendData:self.endTags[i]];
+    }
+    [sample appendData:self.tail];
+
+    for (NSData *document in @[xml,sample]){
+        NSXMLParser *parser = [[NSXMLParser alloc] initWithData:document];
+        [parser parse];
+        if ([parser parserError]){
+#ifdef DEBUG
+            NSLog(@"[%@ %@] EXCEPTION underlying XML: %@",[action class],NSStringFromSelector(_cmd),[[NSString alloc] initWithData:document encoding:NSUTF8StringEncoding]);
+            [NSException raise:HSFInvalidXMLException format:@"XML document underlying HSFAction is not valid."];
+#endif
+        }
+    }
+}
+
+/*
+ Determine whether the template was compiled from the same envelope and parameter keys.
+ */
+-(BOOL)isCompiledFromAction:(HSFAction*)action parameters:(NSDictionary*)parameters
+{
+    if (!HSFStringsEqual(self.SOAPEnvelopeHead, action.SOAPEnvelopeHead) ||
+        !HSFStringsEqual(self.SOAPEnvelopeTail, action.SOAPEnvelopeTail) ||
+        !HSFStringsEqual(self.SOAPAction, action.SOAPAction) ||
+        !HSFStringsEqual(self.attributesForSOAPActionTag, action.attributesForSOAPActionTag) ||
+        !HSFStringsEqual(self.nilAttribute, action.nilAttribute) ||
+        self.isEscaping != action.isEscapesParameterValues){
+        return NO;
+    }
+
+    if (![parameters count]) return ![self.keys count];
+
+    NSArray *order = action.SOAPParameterOrder;
+    if ([order count]) return self.isOrdered && [order isEqualToArray:self.keys];
+
+    if (self.isOrdered || [parameters count] != [self.keys count]) return NO;
+    for (id key in self.keys){
+        if (!parameters[key]) return NO;
+    }
+    return YES;
+}
+
+#pragma mark Class Methods
+
+/*
+ Templates are cached by action class and parameter keys, so an action which sends different sets of parameters keeps a template for every set instead of recompiling one.
+ */
++(id)cacheKeyForAction:(HSFAction*)action parameters:(NSDictionary*)parameters
+{
+    NSArray *order = action.SOAPParameterOrder;
+    if ([order count]) return @[NSStringFromClass([action class]),@YES,order];
+    NSArray *keys = [[parameters allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    return @[NSStringFromClass([action class]),@NO,keys];
+}
+
++(HSFEnvelopeTemplate*)templateForAction:(HSFAction*)action parameters:(NSDictionary*)parameters
+{
+    id key = [self cacheKeyForAction:action parameters:parameters];
+    HSFEnvelopeTemplate *template;
+    @synchronized(self){
+        if (!_templates)_templates = [[NSMutableDictionary alloc] init];
+        template = _templates[key];
+    }
+    if (template && [template isCompiledFromAction:action parameters:parameters]){
+        return template;
+    }
+
+    template = [[HSFEnvelopeTemplate alloc] initWithAction:action parameters:parameters];
+    @synchronized(self){
+        _templates[key] = template;
+    }
+    return template;
+}
+
+@end
@@ -11,3 +11,14 @@
  */
 
 #import "HSFClient.h"
+#import "HSFBase64Decoder.h"
+#import "HSFCatcherDelegateGroup.h"
+#import "HSFResponseCache.h"
+#import "HSFCircuitBreaker.h"
+#import "HSFActionMetrics.h"
+#import "HSFModelDecoder.h"
+#import "HSFNodeDictionary.h"
+#import "HSFFuture.h"
+#import "HSFNodeArchive.h"
+#import "HSFStreamedParameter.h"
+#import "HSFMultipartParser.h"
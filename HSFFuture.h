@@ -0,0 +1,82 @@
+//
+//  HSFFuture.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Result of an asynchronous job which is not known yet.
+ @discussion A future is finished once, with a result or an error. Completion blocks may be added at any time from any thread, they are called on the queue given with them; a block added to a finished future is dispatched at once. Cancelled future is finished with NSUserCancelledError in NSCocoaErrorDomain. Thread safe.
+ */
+@interface HSFFuture : NSObject
+
+/*!
+ @abstract Result of the job.
+ @discussion nil until the future is finished, and if the job failed.
+ */
+@property (strong,readonly) id result;
+
+/*!
+ @abstract Error of the job.
+ @discussion nil until the future is finished, and if the job succeeded.
+ */
+@property (strong,readonly) NSError *error;
+
+/*!
+ @abstract Determine whether the future is finished.
+ */
+@property (readonly) BOOL isFinished;
+
+/*!
+ @abstract Determine whether the future is finished by cancellation.
+ */
+@property (readonly) BOOL isCancelled;
+
+/*!
+ @abstract Block which stops the job.
+ @discussion Set by the producer of the future. Called once by cancel, on the calling thread, unless the future is already finished. Released when the future is finished.
+ */
+@property (copy) void (^cancellationHandler)(void);
+
+#pragma mark Tasks
+
+/*!
+ @abstract Add completion block.
+ @param block Block called when the future is finished. Must not be nil.
+ @param queue Queue of the block. nil means the main queue.
+ */
+-(void)addCompletionBlock:(void (^)(HSFFuture *future))block queue:(dispatch_queue_t)queue;
+
+/*!
+ @abstract Finish the future.
+ @discussion Called by the producer of the future. Completion blocks are dispatched to their queues.
+ @param result Result of the job.
+ @param error Error of the job, nil if it succeeded.
+ @return NO if the future has already been finished.
+ */
+-(BOOL)finishWithResult:(id)result error:(NSError*)error;
+
+/*!
+ @abstract Cancel the job.
+ @discussion Calls cancellationHandler and finishes the future with cancellation error. Does nothing if the future is already finished.
+ */
+-(void)cancel;
+
+/*!
+ @abstract Future of several futures.
+ @discussion Finished when all the futures are finished, failed and cancelled ones included. Its result is the futures array, so every result and error is read from its own future. Cancelling it cancels the futures.
+ @param futures Array of HSFFuture.
+ @return Future of the futures.
+ */
++(HSFFuture*)futureWithFutures:(NSArray*)futures;
+
+/*!
+ @abstract Error of cancelled future.
+ */
++(NSError*)cancellationError;
+
+@end
@@ -0,0 +1,129 @@
+//
+//  HSFFuture.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFFuture.h"
+
+@interface HSFFuture()
+
+@property (strong,readwrite) id result;
+@property (strong,readwrite) NSError *error;
+@property (readwrite) BOOL isFinished;
+
+/*
+ Pairs of completion block and its queue, released when the future is finished.
+ */
+@property (strong,nonatomic) NSMutableArray *completions;
+
+@end
+
+@implementation HSFFuture
+
+#pragma mark Properties
+
+-(BOOL)isCancelled
+{
+    NSError *error = self.error;
+    return [error.domain isEqualToString:NSCocoaErrorDomain] && error.code == NSUserCancelledError;
+}
+
+#pragma mark Public Methods
+
+-(void)addCompletionBlock:(void (^)(HSFFuture *future))block queue:(dispatch_queue_t)queue
+{
+    if (!block){
+        [NSException raise:NSInvalidArgumentException format:@"Completion block is nil."];
+    }
+    if (!queue) queue = dispatch_get_main_queue();
+    @synchronized(self){
+        if (!self.isFinished){
+            if(!_completions)_completions = [[NSMutableArray alloc] init];
+            [self.completions addObject:@[[block copy],queue]];
+            return;
+        }
+    }
+    [self dispatchCompletionBlock:block queue:queue];
+}
+
+-(BOOL)finishWithResult:(id)result error:(NSError*)error
+{
+    NSArray *completions;
+    @synchronized(self){
+        if (self.isFinished) return NO;
+        self.result = result;
+        self.error = error;
+        self.isFinished = YES;
+        completions = self.completions;
+        self.completions = nil;
+        // Handler usually refers to the job which refers to the future.
+        self.cancellationHandler = nil;
+    }
+    for (NSArray *completion in completions){
+        [self dispatchCompletionBlock:completion[0] queue:completion[1]];
+    }
+    return YES;
+}
+
+-(void)cancel
+{
+    void (^handler)(void);
+    @synchronized(self){
+        if (self.isFinished) return;
+        handler = self.cancellationHandler;
+    }
+    if (handler) handler();
+    [self finishWithResult:nil error:[[self class] cancellationError]];
+}
+
+-(NSString*)description
+{
+    return [NSString stringWithFormat:@"<%@: %p, finished: %@, result: %@, error: %@>",[self class],self,self.isFinished?@"YES":@"NO",self.result,self.error];
+}
+
+#pragma mark Private Methods
+
+-(void)dispatchCompletionBlock:(void (^)(HSFFuture *future))block queue:(dispatch_queue_t)queue
+{
+    dispatch_async(queue, ^{
+        block(self);
+    });
+}
+
+#pragma mark Class Methods
+
++(HSFFuture*)futureWithFutures:(NSArray*)futures
+{
+    HSFFuture *future = [[HSFFuture alloc] init];
+    NSArray *parts = [futures copy];
+    if (![parts count]){
+        [future finishWithResult:parts error:nil];
+        return future;
+    }
+
+    __block NSUInteger pending = [parts count];
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    for (HSFFuture *part in parts){
+        [part addCompletionBlock:^(HSFFuture *finished) {
+            BOOL last;
+            @synchronized(future){
+                last = --pending == 0;
+            }
+            if (last) [future finishWithResult:parts error:nil];
+        } queue:queue];
+    }
+    future.cancellationHandler = ^{
+        for (HSFFuture *part in parts) [part cancel];
+    };
+    return future;
+}
+
++(NSError*)cancellationError
+{
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:NSUserCancelledError userInfo:nil];
+}
+
+@end
@@ -0,0 +1,67 @@
+//
+//  HSFInflater.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 30/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Incremental gzip and zlib decompressor.
+ @discussion Decompresses a response which comes in chunks, so every chunk is decompressed as soon as it is received. The format is detected from the header, unless raw deflate data is expected. Concatenated gzip members are decompressed one after another.
+ */
+@interface HSFInflater : NSObject
+
+/*!
+ @abstract Determine whether data is raw deflate without zlib header.
+ */
+@property (nonatomic,readonly) BOOL isRawDeflate;
+
+/*!
+ @abstract Decompression error.
+ @discussion Set as soon as the decompressor meets corrupted data (HSFParseErrorDomain). Subsequent chunks are ignored until reset.
+ */
+@property (strong,nonatomic,readonly) NSError *error;
+
+/*!
+ @abstract Determine whether the end of compressed stream was reached.
+ */
+@property (nonatomic,readonly) BOOL isFinished;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Initialize decompressor.
+ @discussion Some servers send deflate content coding without zlib header, such data is decompressed as raw deflate. Otherwise gzip or zlib header is detected. Default initializer detects the header.
+ @param rawDeflate YES if data is raw deflate.
+ */
+-(id)initWithRawDeflate:(BOOL)rawDeflate;
+
+/*!
+ @abstract Decompress next chunk.
+ @param data Next chunk of compressed data.
+ @return Decompressed bytes, may be empty if the chunk holds only part of a block. nil if data is corrupted, see error.
+ */
+-(NSData*)inflateData:(NSData*)data;
+
+/*!
+ @abstract Forget the stream state and error.
+ */
+-(void)reset;
+
+/*!
+ @abstract Determine whether data starts with gzip or zlib header.
+ @discussion XML never starts with these bytes. Data shorter than a header is checked by its first byte.
+ */
++(BOOL)isCompressedData:(NSData*)data;
+
+/*!
+ @abstract Compress data into gzip format.
+ @discussion Modification time in the header is 0, so the same data is always compressed into the same bytes.
+ @return Compressed data or nil if compression failed.
+ */
++(NSData*)gzipData:(NSData*)data;
+
+@end
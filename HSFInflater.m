@@ -0,0 +1,158 @@
+//
+//  HSFInflater.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 30/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFInflater.h"
+#import "HSFCommon.h"
+#import <zlib.h>
+
+// Window bits for automatic detection of gzip and zlib headers.
+#define HSF_ZLIB_DETECT_WINDOW_BITS (MAX_WBITS + 32)
+// Window bits for gzip header.
+#define HSF_ZLIB_GZIP_WINDOW_BITS (MAX_WBITS + 16)
+// Window bits for raw deflate without header.
+#define HSF_ZLIB_RAW_WINDOW_BITS (-MAX_WBITS)
+
+@interface HSFInflater(){
+    z_stream _stream;
+    BOOL _isStreamInitialized;
+}
+
+@property (strong,nonatomic,readwrite) NSError *error;
+@property (nonatomic,readwrite) BOOL isFinished;
+@property (nonatomic,readwrite) BOOL isRawDeflate;
+
+@end
+
+@implementation HSFInflater
+
+#pragma mark Public Methods
+
+-(id)initWithRawDeflate:(BOOL)rawDeflate
+{
+    self = [super init];
+    if (self){
+        _isRawDeflate = rawDeflate;
+    }
+    
+    return self;
+}
+
+-(id)init
+{
+    return [self initWithRawDeflate:NO];
+}
+
+-(void)dealloc
+{
+    if (_isStreamInitialized) inflateEnd(&_stream);
+}
+
+-(NSData*)inflateData:(NSData*)data
+{
+    if (self.error) return nil;
+    if (![self initializeStream]) return nil;
+
+    NSMutableData *output = [[NSMutableData alloc] init];
+    uint8_t buffer[HSF_INFLATE_BUFFER_SIZE];
+    _stream.next_in = (Bytef*)[data bytes];
+    _stream.avail_in = (uInt)[data length];
+
+    // Output buffer may be filled up while input is left in the stream.
+    do {
+        if (self.isFinished){
+            if (!_stream.avail_in) break;
+            // Next gzip member follows.
+            inflateReset(&_stream);
+            self.isFinished = NO;
+        }
+        _stream.next_out = buffer;
+        _stream.avail_out = sizeof(buffer);
+        int status = inflate(&_stream, Z_NO_FLUSH);
+        [output appendBytes:buffer length:sizeof(buffer) - _stream.avail_out];
+
+        if (status == Z_STREAM_END){
+            self.isFinished = YES;
+        } else if (status == Z_BUF_ERROR){
+            // Whole chunk is consumed, the rest of the block comes with the next one.
+            break;
+        } else if (status != Z_OK){
+            [self failWithMessage:_stream.msg];
+            return nil;
+        }
+    } while (_stream.avail_in > 0 || _stream.avail_out == 0);
+    return output;
+}
+
+-(void)reset
+{
+    if (_isStreamInitialized){
+        inflateEnd(&_stream);
+        _isStreamInitialized = NO;
+    }
+    self.error = nil;
+    self.isFinished = NO;
+}
+
+#pragma mark Private Methods
+
+-(BOOL)initializeStream
+{
+    if (_isStreamInitialized) return YES;
+    memset(&_stream, 0, sizeof(_stream));
+    int windowBits = self.isRawDeflate ? HSF_ZLIB_RAW_WINDOW_BITS : HSF_ZLIB_DETECT_WINDOW_BITS;
+    if (inflateInit2(&_stream, windowBits) != Z_OK){
+        [self failWithMessage:_stream.msg];
+        return NO;
+    }
+    _isStreamInitialized = YES;
+    return YES;
+}
+
+-(void)failWithMessage:(const char*)message
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:@{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_DECOMPRESSION_ERROR}];
+    if (message){
+        userInfo[NSLocalizedFailureReasonErrorKey] = [NSString stringWithUTF8String:message];
+    }
+    self.error = [NSError errorWithDomain:HSFParseErrorDomain code:HSF_ERROR_CODE_DECOMPRESSION_ERROR userInfo:[userInfo copy]];
+}
+
+#pragma mark Class Methods
+
++(BOOL)isCompressedData:(NSData*)data
+{
+    const unsigned char *bytes = [data bytes];
+    NSUInteger length = [data length];
+    if (!length) return NO;
+    if (length == 1) return bytes[0] == 0x1f || bytes[0] == 0x78;
+
+    // gzip magic, or zlib deflate method with a valid header check.
+    if (bytes[0] == 0x1f && bytes[1] == 0x8b) return YES;
+    return (bytes[0] & 0x0f) == Z_DEFLATED && (bytes[0] >> 4) <= 7 && ((bytes[0] << 8) | bytes[1]) % 31 == 0;
+}
+
++(NSData*)gzipData:(NSData*)data
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, HSF_ZLIB_GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+        return nil;
+    }
+
+    NSMutableData *output = [[NSMutableData alloc] initWithLength:deflateBound(&stream, (uLong)[data length])];
+    stream.next_in = (Bytef*)[data bytes];
+    stream.avail_in = (uInt)[data length];
+    stream.next_out = [output mutableBytes];
+    stream.avail_out = (uInt)[output length];
+    int status = deflate(&stream, Z_FINISH);
+    [output setLength:stream.total_out];
+    deflateEnd(&stream);
+    return (status == Z_STREAM_END) ? output : nil;
+}
+
+@end
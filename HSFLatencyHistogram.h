@@ -0,0 +1,78 @@
+//
+//  HSFLatencyHistogram.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 28/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Histogram of durations.
+ @discussion Durations are counted in HSF_HISTOGRAM_BUCKETS buckets with power of two bounds in microseconds: bucket 0 counts durations below 1 microsecond, bucket i counts durations from 2^(i-1) to 2^i microseconds. Memory does not grow with number of samples. Thread safe.
+ */
+@interface HSFLatencyHistogram : NSObject
+
+/*!
+ @abstract Number of samples.
+ */
+@property (nonatomic,readonly) NSUInteger count;
+
+/*!
+ @abstract Sum of samples in seconds.
+ */
+@property (nonatomic,readonly) NSTimeInterval sum;
+
+/*!
+ @abstract Smallest sample in seconds, 0 if there are no samples.
+ */
+@property (nonatomic,readonly) NSTimeInterval minimum;
+
+/*!
+ @abstract Largest sample in seconds.
+ */
+@property (nonatomic,readonly) NSTimeInterval maximum;
+
+/*!
+ @abstract Mean of samples in seconds, 0 if there are no samples.
+ */
+@property (nonatomic,readonly) NSTimeInterval mean;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Count a duration.
+ @param duration Duration in seconds.
+ */
+-(void)addSample:(NSTimeInterval)duration;
+
+/*!
+ @abstract Count all samples of another histogram.
+ */
+-(void)addHistogram:(HSFLatencyHistogram*)histogram;
+
+/*!
+ @abstract Estimate percentile.
+ @param percentile From 0.0 to 100.0.
+ @return Upper bound of the bucket containing the percentile, capped by maximum. 0 if there are no samples.
+ */
+-(NSTimeInterval)valueAtPercentile:(double)percentile;
+
+/*!
+ @abstract Number of samples in the bucket.
+ @param bucket From 0 to HSF_HISTOGRAM_BUCKETS - 1.
+ */
+-(NSUInteger)countInBucket:(NSUInteger)bucket;
+
+/*!
+ @abstract Remove all samples.
+ */
+-(void)reset;
+
+/*!
+ @abstract Upper bound of the bucket in seconds.
+ */
++(NSTimeInterval)upperBoundOfBucket:(NSUInteger)bucket;
+
+@end
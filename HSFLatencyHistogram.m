@@ -0,0 +1,161 @@
+//
+//  HSFLatencyHistogram.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 28/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFLatencyHistogram.h"
+#import "HSFCommon.h"
+
+@interface HSFLatencyHistogram(){
+    NSUInteger _buckets[HSF_HISTOGRAM_BUCKETS];
+}
+
+@property (nonatomic,readwrite) NSUInteger count;
+@property (nonatomic,readwrite) NSTimeInterval sum;
+@property (nonatomic,readwrite) NSTimeInterval minimum;
+@property (nonatomic,readwrite) NSTimeInterval maximum;
+
+@end
+
+@implementation HSFLatencyHistogram
+
+#pragma mark Properties
+
+-(NSUInteger)count
+{
+    @synchronized(self){
+        return _count;
+    }
+}
+
+-(NSTimeInterval)sum
+{
+    @synchronized(self){
+        return _sum;
+    }
+}
+
+-(NSTimeInterval)minimum
+{
+    @synchronized(self){
+        return _minimum;
+    }
+}
+
+-(NSTimeInterval)maximum
+{
+    @synchronized(self){
+        return _maximum;
+    }
+}
+
+-(NSTimeInterval)mean
+{
+    @synchronized(self){
+        return _count ? _sum / _count : 0.0;
+    }
+}
+
+#pragma mark Public Methods
+
+-(void)addSample:(NSTimeInterval)duration
+{
+    if (duration < 0) duration = 0;
+    NSUInteger bucket = [[self class] bucketForDuration:duration];
+    @synchronized(self){
+        ++_buckets[bucket];
+        if (!_count || duration < _minimum) _minimum = duration;
+        if (duration > _maximum) _maximum = duration;
+        ++_count;
+        _sum += duration;
+    }
+}
+
+-(void)addHistogram:(HSFLatencyHistogram*)histogram
+{
+    if (!histogram || histogram == self) return;
+
+    NSUInteger buckets[HSF_HISTOGRAM_BUCKETS];
+    NSUInteger count;
+    NSTimeInterval sum, minimum, maximum;
+    @synchronized(histogram){
+        memcpy(buckets, histogram->_buckets, sizeof(buckets));
+        count = histogram->_count;
+        sum = histogram->_sum;
+        minimum = histogram->_minimum;
+        maximum = histogram->_maximum;
+    }
+    if (!count) return;
+
+    @synchronized(self){
+        for (NSUInteger i = 0; i < HSF_HISTOGRAM_BUCKETS; ++i){
+            _buckets[i] += buckets[i];
+        }
+        if (!_count || minimum < _minimum) _minimum = minimum;
+        if (maximum > _maximum) _maximum = maximum;
+        _count += count;
+        _sum += sum;
+    }
+}
+
+-(NSTimeInterval)valueAtPercentile:(double)percentile
+{
+    @synchronized(self){
+        if (!_count) return 0.0;
+
+        double rank = MIN(MAX(percentile, 0.0), 100.0) / 100.0 * _count;
+        NSUInteger seen = 0;
+        for (NSUInteger i = 0; i < HSF_HISTOGRAM_BUCKETS; ++i){
+            seen += _buckets[i];
+            if (seen && seen >= rank){
+                return MIN([[self class] upperBoundOfBucket:i], _maximum);
+            }
+        }
+        return _maximum;
+    }
+}
+
+-(NSUInteger)countInBucket:(NSUInteger)bucket
+{
+    if (bucket >= HSF_HISTOGRAM_BUCKETS) return 0;
+    @synchronized(self){
+        return _buckets[bucket];
+    }
+}
+
+-(void)reset
+{
+    @synchronized(self){
+        memset(_buckets, 0, sizeof(_buckets));
+        _count = 0;
+        _sum = 0.0;
+        _minimum = 0.0;
+        _maximum = 0.0;
+    }
+}
+
+-(NSString*)description
+{
+    return [NSString stringWithFormat:@"%@ count:%lu mean:%.6f p50:%.6f p90:%.6f p99:%.6f max:%.6f",[super description],(unsigned long)self.count,self.mean,[self valueAtPercentile:50.0],[self valueAtPercentile:90.0],[self valueAtPercentile:99.0],self.maximum];
+}
+
+#pragma mark Class Methods
+
++(NSTimeInterval)upperBoundOfBucket:(NSUInteger)bucket
+{
+    return ldexp(1.0, (int)MIN(bucket, HSF_HISTOGRAM_BUCKETS - 1)) / 1000000.0;
+}
+
++(NSUInteger)bucketForDuration:(NSTimeInterval)duration
+{
+    double microseconds = duration * 1000000.0;
+    if (microseconds < 1.0) return 0;
+    int exponent;
+    frexp(microseconds, &exponent);
+    return MIN((NSUInteger)exponent, HSF_HISTOGRAM_BUCKETS - 1);
+}
+
+@end
@@ -0,0 +1,67 @@
+//
+//  HSFModelDecoder.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFModelMapping.h"
+
+/*!
+ @abstract Push decoder of model objects.
+ @discussion Fills model objects right from SAX events according to HSFModelMapping, so neither HSFNode tree nor dictionary is made. Elements which are not mapped are skipped. Like HSFNodePushParser it is fed with chunks of XML document as they come. Based on libxml2 push parser, so the application must be linked with libxml2.
+ */
+@interface HSFModelDecoder : NSObject
+
+/*!
+ @abstract Mapping of the decoded elements.
+ */
+@property (strong,nonatomic,readonly) HSFModelMapping *mapping;
+
+/*!
+ @abstract Model objects decoded so far, in document order.
+ @discussion An object is added when its element is closed.
+ */
+@property (strong,nonatomic,readonly) NSArray *objects;
+
+/*!
+ @abstract Parse error.
+ @discussion Set as soon as the decoder meets invalid XML or a value which can't be converted to its type (HSF_ERROR_CODE_MODEL_DECODE_ERROR), in HSFParseErrorDomain. Subsequent chunks are ignored.
+ */
+@property (strong,nonatomic,readonly) NSError *parseError;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @param mapping Mapping of model objects.
+ @param path Path of mapped elements from the document element, e.g. @"Envelope/Body/GetItemsResponse/item". Names are matched by local name. Every element at the path is decoded into a model object. nil means the document element itself.
+ @return The initialized decoder.
+ */
+-(id)initWithMapping:(HSFModelMapping*)mapping path:(NSString*)path;
+
+/*!
+ @abstract Parse next chunk of the document.
+ @param data Next chunk of XML document.
+ @return NO if the document turned out to be invalid, see parseError.
+ */
+-(BOOL)parseData:(NSData*)data;
+
+/*!
+ @abstract Finish parsing.
+ @discussion Tells the decoder that the document is over. The decoder can't be used after this call.
+ @param error Out parameter used if an error occurs while parsing the data. May be NULL. Error domain will be HSFParseErrorDomain.
+ @return Decoded objects, see objects.
+ */
+-(NSArray*)finishWithError:(NSError**)error;
+
+/*!
+ @abstract Decode document element of data into model object.
+ @param error Out parameter used if an error occurs while parsing the data. May be NULL.
+ @return Model object or nil if data is invalid.
+ */
++(id)objectFromData:(NSData*)data mapping:(HSFModelMapping*)mapping error:(NSError**)error;
+
+@end
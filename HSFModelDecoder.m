@@ -0,0 +1,419 @@
+//
+//  HSFModelDecoder.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFModelDecoder.h"
+#import "HSFCommon.h"
+#import <libxml/parser.h>
+
+/*
+ Local part of qualified name. The string does not copy the bytes, so it is valid only while libxml2 keeps the name, i.e. during the callback. It is meant for lookups only.
+ */
+static NSString *HSFLocalName(const xmlChar *name)
+{
+    const xmlChar *colon = xmlStrchr(name, ':');
+    const char *local = (const char*)(colon ? colon + 1 : name);
+    return [[NSString alloc] initWithBytesNoCopy:(void*)local length:strlen(local) encoding:NSUTF8StringEncoding freeWhenDone:NO];
+}
+
+/*
+ Open element inside of a decoded object.
+ */
+@interface HSFModelFrame : NSObject
+
+/*
+ Node of the element in mapping of the parent, nil for the element of a decoded root object.
+ */
+@property (strong,nonatomic) HSFModelPathNode *element;
+
+/*
+ Node which children of the element are looked up in.
+ */
+@property (strong,nonatomic) HSFModelPathNode *node;
+
+/*
+ Object which values of the children are set to, and its mapping.
+ */
+@property (strong,nonatomic) id object;
+@property (strong,nonatomic) HSFModelMapping *mapping;
+
+/*
+ Repeated values of the object by key, set to the object when its element is closed.
+ */
+@property (strong,nonatomic) NSMutableDictionary *arrays;
+
+/*
+ Text of the element, collected only if the element is mapped to values.
+ */
+@property (strong,nonatomic) NSMutableString *text;
+
+@end
+
+@implementation HSFModelFrame
+
+@end
+
+@interface HSFModelDecoder(){
+    xmlParserCtxtPtr _context;
+    // Open elements outside of decoded objects.
+    NSUInteger _depth;
+    // Number of path components matched by open elements.
+    NSUInteger _matchedDepth;
+    // Open elements of a skipped subtree.
+    NSUInteger _skipDepth;
+}
+
+@property (strong,nonatomic,readwrite) HSFModelMapping *mapping;
+@property (strong,nonatomic,readwrite) NSError *parseError;
+
+@property (strong,nonatomic) NSMutableArray *mutableObjects;
+@property (strong,nonatomic) NSArray *pathComponents;
+@property (strong,nonatomic) NSMutableArray *frames;
+
+/*
+ Date formatters by date format. NSDateFormatter is not thread safe, so every decoder has its own.
+ */
+@property (strong,nonatomic) NSMutableDictionary *dateFormatters;
+
+-(void)startElement:(const xmlChar*)name attributes:(const xmlChar**)attributes;
+-(void)endElement;
+-(void)foundCharacters:(const xmlChar*)characters length:(int)length;
+-(void)errorOccurred:(xmlErrorPtr)error;
+
+@end
+
+#pragma mark libxml2 SAX callbacks
+
+static void HSFModelDecoderStartElement(void *context, const xmlChar *name, const xmlChar **attributes)
+{
+    [(__bridge HSFModelDecoder*)context startElement:name attributes:attributes];
+}
+
+static void HSFModelDecoderEndElement(void *context, const xmlChar *name)
+{
+    [(__bridge HSFModelDecoder*)context endElement];
+}
+
+static void HSFModelDecoderCharacters(void *context, const xmlChar *characters, int length)
+{
+    [(__bridge HSFModelDecoder*)context foundCharacters:characters length:length];
+}
+
+static void HSFModelDecoderError(void *context, xmlErrorPtr error)
+{
+    [(__bridge HSFModelDecoder*)context errorOccurred:error];
+}
+
+@implementation HSFModelDecoder
+
+#pragma mark Properties
+
+-(NSArray*)objects
+{
+    return [self.mutableObjects copy];
+}
+
+-(NSMutableDictionary*)dateFormatters
+{
+    if(!_dateFormatters)_dateFormatters = [[NSMutableDictionary alloc] init];
+    return _dateFormatters;
+}
+
+#pragma mark Public Methods
+
+-(id)initWithMapping:(HSFModelMapping*)mapping path:(NSString*)path
+{
+    if (!mapping){
+        [NSException raise:NSInvalidArgumentException format:@"Mapping is nil."];
+    }
+    self = [super init];
+    if (self){
+        _mapping = mapping;
+        _pathComponents = [path length] ? [path componentsSeparatedByString:HSF_MODEL_PATH_SEPARATOR] : nil;
+        _mutableObjects = [[NSMutableArray alloc] init];
+        _frames = [[NSMutableArray alloc] init];
+
+        xmlSAXHandler handler;
+        memset(&handler, 0, sizeof(xmlSAXHandler));
+        // SAX1 callbacks as in HSFNodePushParser, names are qualified and matched by local part.
+        handler.initialized = XML_SAX2_MAGIC;
+        handler.startElement = HSFModelDecoderStartElement;
+        handler.endElement = HSFModelDecoderEndElement;
+        handler.characters = HSFModelDecoderCharacters;
+        handler.ignorableWhitespace = HSFModelDecoderCharacters;
+        handler.cdataBlock = HSFModelDecoderCharacters;
+        handler.serror = HSFModelDecoderError;
+
+        _context = xmlCreatePushParserCtxt(&handler, (__bridge void*)self, NULL, 0, NULL);
+        xmlCtxtUseOptions(_context, XML_PARSE_NONET);
+    }
+    return self;
+}
+
+-(id)init
+{
+    [NSException raise:NSInvalidArgumentException format:@"Use initWithMapping:path: instead."];
+    return nil;
+}
+
+-(void)dealloc
+{
+    if (_context){
+        xmlFreeParserCtxt(_context);
+    }
+}
+
+-(BOOL)parseData:(NSData*)data
+{
+    if (!_context){
+        [NSException raise:NSInternalInconsistencyException format:@"Decoder is finished."];
+    }
+    if (self.parseError) return NO;
+
+    const char *bytes = [data bytes];
+    NSUInteger length = [data length];
+    while (length > 0 && !self.parseError){
+        int size = (length > INT_MAX) ? INT_MAX : (int)length;
+        xmlParseChunk(_context, bytes, size, 0);
+        bytes += size;
+        length -= size;
+    }
+    return self.parseError == nil;
+}
+
+-(NSArray*)finishWithError:(NSError**)error
+{
+    if (_context){
+        if (!self.parseError){
+            xmlParseChunk(_context, NULL, 0, 1);
+        }
+        xmlFreeParserCtxt(_context);
+        _context = NULL;
+    }
+    [self.frames removeAllObjects];
+
+    if (error != NULL){
+        *error = self.parseError;
+    }
+    return self.objects;
+}
+
+#pragma mark Private Methods
+
+-(void)startElement:(const xmlChar*)name attributes:(const xmlChar**)attributes
+{
+    if (_skipDepth){
+        ++_skipDepth;
+        return;
+    }
+
+    NSString *localName = HSFLocalName(name);
+    HSFModelFrame *parent = [self.frames lastObject];
+    if (!parent){
+        // Looking for the next element at the path.
+        NSUInteger depth = _depth++;
+        NSUInteger count = self.pathComponents ? [self.pathComponents count] : 1;
+        if (_matchedDepth != depth || depth >= count) return;
+        if (self.pathComponents && ![self.pathComponents[depth] isEqualToString:localName]) return;
+        _matchedDepth = depth + 1;
+        if (_matchedDepth < count) return;
+
+        HSFModelFrame *frame = [self frameWithObjectOfMapping:self.mapping];
+        [self applyAttributes:attributes rules:frame.node.attributeRules frame:frame];
+        [self.frames addObject:frame];
+        return;
+    }
+
+    HSFModelPathNode *element = parent.node.children[localName];
+    if (!element){
+        _skipDepth = 1;
+        return;
+    }
+
+    // Attributes of the element itself are mapped by the mapping of the parent.
+    [self applyAttributes:attributes rules:element.attributeRules frame:parent];
+    HSFModelFrame *frame;
+    if (element.objectRule){
+        frame = [self frameWithObjectOfMapping:element.objectRule.mapping];
+        [self applyAttributes:attributes rules:frame.node.attributeRules frame:frame];
+    } else {
+        frame = [[HSFModelFrame alloc] init];
+        frame.node = element;
+        frame.object = parent.object;
+        frame.mapping = parent.mapping;
+        frame.arrays = parent.arrays;
+    }
+    frame.element = element;
+    if (element.valueRules){
+        frame.text = [[NSMutableString alloc] init];
+    }
+    [self.frames addObject:frame];
+}
+
+-(void)endElement
+{
+    if (_skipDepth){
+        --_skipDepth;
+        return;
+    }
+
+    HSFModelFrame *frame = [self.frames lastObject];
+    if (!frame){
+        --_depth;
+        if (_matchedDepth > _depth) _matchedDepth = _depth;
+        return;
+    }
+    [self.frames removeLastObject];
+    HSFModelFrame *parent = [self.frames lastObject];
+
+    if (frame.text){
+        [self applyRules:frame.element.valueRules string:frame.text frame:parent];
+    }
+    if (frame.element && !frame.element.objectRule) return;
+
+    [frame.arrays enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSMutableArray *array, BOOL *stop) {
+        [frame.object setValue:[array copy] forKey:key];
+    }];
+    if (parent){
+        [self setValue:frame.object rule:frame.element.objectRule frame:parent];
+    } else {
+        [self.mutableObjects addObject:frame.object];
+        // Element at the path is closed, siblings may follow.
+        --_depth;
+        _matchedDepth = _depth;
+    }
+}
+
+-(void)foundCharacters:(const xmlChar*)characters length:(int)length
+{
+    if (_skipDepth) return;
+    HSFModelFrame *frame = [self.frames lastObject];
+    if (!frame.text) return;
+
+    NSString *string = [[NSString alloc] initWithBytes:characters length:length encoding:NSUTF8StringEncoding];
+    if (string) [frame.text appendString:string];
+}
+
+-(void)errorOccurred:(xmlErrorPtr)error
+{
+    if (error->level != XML_ERR_FATAL || self.parseError) return;
+
+    NSString *message = error->message ? [NSString stringWithUTF8String:error->message] : HSF_ERROR_MESSAGE_XML_PARSE_ERROR;
+    NSDictionary *userInfo = @{NSLocalizedDescriptionKey:message};
+#ifdef DEBUG
+    NSLog(@"[%@ %@] ERROR: %@, line: %d",[self class],NSStringFromSelector(_cmd),message,error->line);
+#endif
+    self.parseError = [NSError errorWithDomain:HSFParseErrorDomain code:error->code userInfo:userInfo];
+    xmlStopParser(_context);
+}
+
+-(HSFModelFrame*)frameWithObjectOfMapping:(HSFModelMapping*)mapping
+{
+    HSFModelFrame *frame = [[HSFModelFrame alloc] init];
+    frame.mapping = mapping;
+    frame.node = mapping.rootNode;
+    frame.object = [[mapping.modelClass alloc] init];
+    frame.arrays = [[NSMutableDictionary alloc] init];
+    return frame;
+}
+
+-(void)applyAttributes:(const xmlChar**)attributes rules:(NSDictionary*)attributeRules frame:(HSFModelFrame*)frame
+{
+    if (!attributes || !attributeRules) return;
+    for (NSUInteger i = 0; attributes[i] && !self.parseError; i += 2){
+        NSArray *rules = attributeRules[HSFLocalName(attributes[i])];
+        if (!rules) continue;
+        NSString *value = attributes[i+1] ? [NSString stringWithUTF8String:(const char*)attributes[i+1]] : @"";
+        [self applyRules:rules string:value frame:frame];
+    }
+}
+
+-(void)applyRules:(NSArray*)rules string:(NSString*)string frame:(HSFModelFrame*)frame
+{
+    for (HSFModelRule *rule in rules){
+        id value = [self valueFromString:string rule:rule mapping:frame.mapping];
+        if (self.parseError) return;
+        if (value) [self setValue:value rule:rule frame:frame];
+    }
+}
+
+-(void)setValue:(id)value rule:(HSFModelRule*)rule frame:(HSFModelFrame*)frame
+{
+    if (!rule.isRepeated){
+        [frame.object setValue:value forKey:rule.key];
+        return;
+    }
+    NSMutableArray *array = frame.arrays[rule.key];
+    if (!array){
+        array = [[NSMutableArray alloc] init];
+        frame.arrays[rule.key] = array;
+    }
+    [array addObject:value];
+}
+
+/*
+ Value of the type of the rule. nil for empty text of non-string types, nil with parseError for invalid text.
+ */
+-(id)valueFromString:(NSString*)string rule:(HSFModelRule*)rule mapping:(HSFModelMapping*)mapping
+{
+    if (rule.type == HSFModelTypeString) return [string copy];
+
+    NSString *trimmed = [string stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    if (![trimmed length]) return nil;
+
+    id value;
+    switch (rule.type){
+        case HSFModelTypeNumber:{
+            NSDecimalNumber *number = [NSDecimalNumber decimalNumberWithString:trimmed locale:@{NSLocaleDecimalSeparator:@"."}];
+            if (![[NSDecimalNumber notANumber] isEqualToNumber:number]) value = number;
+            break;
+        }
+        case HSFModelTypeBool:
+            if ([trimmed isEqualToString:@"true"] || [trimmed isEqualToString:@"1"]) value = @YES;
+            else if ([trimmed isEqualToString:@"false"] || [trimmed isEqualToString:@"0"]) value = @NO;
+            break;
+        case HSFModelTypeDate:
+            value = [[self dateFormatterForFormat:mapping.dateFormat] dateFromString:trimmed];
+            break;
+        default:
+            value = trimmed;
+            break;
+    }
+
+    if (!value){
+        NSString *reason = [NSString stringWithFormat:@"Invalid value \"%@\" of %@.%@",trimmed,NSStringFromClass(mapping.modelClass),rule.key];
+        NSDictionary *userInfo = @{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_MODEL_DECODE_ERROR,NSLocalizedFailureReasonErrorKey:reason};
+        self.parseError = [NSError errorWithDomain:HSFParseErrorDomain code:HSF_ERROR_CODE_MODEL_DECODE_ERROR userInfo:userInfo];
+        xmlStopParser(_context);
+    }
+    return value;
+}
+
+-(NSDateFormatter*)dateFormatterForFormat:(NSString*)format
+{
+    NSDateFormatter *formatter = self.dateFormatters[format];
+    if (!formatter){
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"GMT"];
+        formatter.dateFormat = format;
+        self.dateFormatters[format] = formatter;
+    }
+    return formatter;
+}
+
+#pragma mark Class Methods
+
++(id)objectFromData:(NSData*)data mapping:(HSFModelMapping*)mapping error:(NSError**)error
+{
+    HSFModelDecoder *decoder = [[HSFModelDecoder alloc] initWithMapping:mapping path:nil];
+    [decoder parseData:data];
+    NSArray *objects = [decoder finishWithError:error];
+    return decoder.parseError ? nil : [objects firstObject];
+}
+
+@end
@@ -0,0 +1,133 @@
+//
+//  HSFModelMapping.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Type of mapped value.
+ @constant HSFModelTypeString Text of the element as it is.
+ @constant HSFModelTypeNumber NSDecimalNumber, also set to scalar properties.
+ @constant HSFModelTypeBool NSNumber with BOOL, true and 1 are YES.
+ @constant HSFModelTypeDate NSDate parsed with dateFormat of the mapping.
+ */
+typedef NS_ENUM(NSUInteger, HSFModelType){
+    HSFModelTypeString,
+    HSFModelTypeNumber,
+    HSFModelTypeBool,
+    HSFModelTypeDate
+};
+
+@class HSFModelPathNode;
+
+/*!
+ @abstract Mapping of XML elements to properties of a model class.
+ @discussion Paths are element names separated by slash, relative to the mapped element, e.g. @"address/city". The last component may name an attribute with @ prefix, e.g. @"@id" or @"price/@currency". Names are matched by local name, so namespace prefixes do not matter. Children of an element mapped to a nested object are matched by the nested mapping. Values are set with key-value coding. Mapping is used by HSFModelDecoder, it must not be changed after the first decoding. Thread safe for decoding.
+ */
+@interface HSFModelMapping : NSObject
+
+/*!
+ @abstract Class of the model objects, instances are made with init.
+ */
+@property (nonatomic,readonly) Class modelClass;
+
+/*!
+ @abstract Date format of HSFModelTypeDate values.
+ @discussion Dates are parsed in POSIX locale. Default value is HSF_MODEL_DATE_FORMAT (xsd:dateTime in UTC).
+ */
+@property (strong,nonatomic) NSString *dateFormat;
+
+/*!
+ @abstract Compiled paths, root is the mapped element.
+ */
+@property (strong,nonatomic,readonly) HSFModelPathNode *rootNode;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @param modelClass Class of the model objects.
+ @return The initialized mapping.
+ */
+-(id)initWithModelClass:(Class)modelClass;
+
+/*!
+ @abstract Map text of element or value of attribute to property.
+ @discussion Throws an exception if the model class has no such property.
+ */
+-(void)mapPath:(NSString*)path toProperty:(NSString*)key type:(HSFModelType)type;
+
+/*!
+ @abstract Map element to property holding a nested model object.
+ */
+-(void)mapPath:(NSString*)path toProperty:(NSString*)key mapping:(HSFModelMapping*)mapping;
+
+/*!
+ @abstract Map repeated elements to NSArray property of values.
+ */
+-(void)mapRepeatedPath:(NSString*)path toProperty:(NSString*)key type:(HSFModelType)type;
+
+/*!
+ @abstract Map repeated elements to NSArray property of nested model objects.
+ */
+-(void)mapRepeatedPath:(NSString*)path toProperty:(NSString*)key mapping:(HSFModelMapping*)mapping;
+
+@end
+
+/*!
+ @abstract Rule of mapping.
+ */
+@interface HSFModelRule : NSObject
+
+/*!
+ @abstract Property key.
+ */
+@property (strong,nonatomic,readonly) NSString *key;
+
+/*!
+ @abstract Type of value, unless it is a nested object.
+ */
+@property (nonatomic,readonly) HSFModelType type;
+
+/*!
+ @abstract Mapping of nested object, nil for values.
+ */
+@property (strong,nonatomic,readonly) HSFModelMapping *mapping;
+
+/*!
+ @abstract Determine whether the property is an array of repeated elements.
+ */
+@property (nonatomic,readonly) BOOL isRepeated;
+
+@end
+
+/*!
+ @abstract Element of compiled mapping paths.
+ */
+@interface HSFModelPathNode : NSObject
+
+/*!
+ @abstract Nodes of child elements by local name.
+ */
+@property (strong,nonatomic,readonly) NSDictionary *children;
+
+/*!
+ @abstract Rules for text of the element.
+ */
+@property (strong,nonatomic,readonly) NSArray *valueRules;
+
+/*!
+ @abstract Arrays of rules for attributes of the element by name.
+ */
+@property (strong,nonatomic,readonly) NSDictionary *attributeRules;
+
+/*!
+ @abstract Rule for nested object made of the element, or nil.
+ */
+@property (strong,nonatomic,readonly) HSFModelRule *objectRule;
+
+@end
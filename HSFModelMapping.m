@@ -0,0 +1,198 @@
+//
+//  HSFModelMapping.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFModelMapping.h"
+#import "HSFCommon.h"
+
+@interface HSFModelRule()
+
+@property (strong,nonatomic,readwrite) NSString *key;
+@property (nonatomic,readwrite) HSFModelType type;
+@property (strong,nonatomic,readwrite) HSFModelMapping *mapping;
+@property (nonatomic,readwrite) BOOL isRepeated;
+
+/*
+ Path components, the last one may be an attribute.
+ */
+@property (strong,nonatomic) NSArray *components;
+
+@end
+
+@implementation HSFModelRule
+
+@end
+
+@interface HSFModelPathNode()
+
+@property (strong,nonatomic,readwrite) NSDictionary *children;
+@property (strong,nonatomic,readwrite) NSArray *valueRules;
+@property (strong,nonatomic,readwrite) NSDictionary *attributeRules;
+@property (strong,nonatomic,readwrite) HSFModelRule *objectRule;
+
+/*
+ Node of child element, made if absent.
+ */
+-(HSFModelPathNode*)childForName:(NSString*)name;
+
+@end
+
+@implementation HSFModelPathNode
+
+-(HSFModelPathNode*)childForName:(NSString*)name
+{
+    HSFModelPathNode *child = self.children[name];
+    if (!child){
+        child = [[HSFModelPathNode alloc] init];
+        NSMutableDictionary *children = [NSMutableDictionary dictionaryWithDictionary:self.children];
+        children[name] = child;
+        self.children = [children copy];
+    }
+    return child;
+}
+
+@end
+
+@interface HSFModelMapping()
+
+@property (strong,nonatomic,readwrite) HSFModelPathNode *rootNode;
+@property (strong,nonatomic) NSMutableArray *rules;
+
+@end
+
+@implementation HSFModelMapping
+
+#pragma mark Properties
+
+-(NSString*)dateFormat
+{
+    if(!_dateFormat)_dateFormat = HSF_MODEL_DATE_FORMAT;
+    return _dateFormat;
+}
+
+-(HSFModelPathNode*)rootNode
+{
+    // Compiled on first decoding, rules are not added after that.
+    @synchronized(self){
+        if(!_rootNode)_rootNode = [self compiledRules];
+        return _rootNode;
+    }
+}
+
+#pragma mark Public Methods
+
+-(id)initWithModelClass:(Class)modelClass
+{
+    if (!modelClass){
+        [NSException raise:NSInvalidArgumentException format:@"Model class is nil."];
+    }
+    self = [super init];
+    if (self){
+        _modelClass = modelClass;
+        _rules = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+-(void)mapPath:(NSString*)path toProperty:(NSString*)key type:(HSFModelType)type
+{
+    [self addRuleWithPath:path key:key type:type mapping:nil repeated:NO];
+}
+
+-(void)mapPath:(NSString*)path toProperty:(NSString*)key mapping:(HSFModelMapping*)mapping
+{
+    if (!mapping){
+        [NSException raise:NSInvalidArgumentException format:@"Mapping of nested object is nil."];
+    }
+    [self addRuleWithPath:path key:key type:HSFModelTypeString mapping:mapping repeated:NO];
+}
+
+-(void)mapRepeatedPath:(NSString*)path toProperty:(NSString*)key type:(HSFModelType)type
+{
+    [self addRuleWithPath:path key:key type:type mapping:nil repeated:YES];
+}
+
+-(void)mapRepeatedPath:(NSString*)path toProperty:(NSString*)key mapping:(HSFModelMapping*)mapping
+{
+    if (!mapping){
+        [NSException raise:NSInvalidArgumentException format:@"Mapping of nested object is nil."];
+    }
+    [self addRuleWithPath:path key:key type:HSFModelTypeString mapping:mapping repeated:YES];
+}
+
+-(NSString*)description
+{
+    return [NSString stringWithFormat:@"<%@: %p, model: %@, rules: %lu>",[self class],self,NSStringFromClass(self.modelClass),(unsigned long)[self.rules count]];
+}
+
+#pragma mark Private Methods
+
+-(void)addRuleWithPath:(NSString*)path key:(NSString*)key type:(HSFModelType)type mapping:(HSFModelMapping*)mapping repeated:(BOOL)repeated
+{
+    NSArray *components = [path componentsSeparatedByString:HSF_MODEL_PATH_SEPARATOR];
+    if (![path length] || [components containsObject:@""]){
+        [NSException raise:NSInvalidArgumentException format:@"Invalid path: %@",path];
+    }
+    for (NSUInteger i = 0; i < [components count]; ++i){
+        if ([components[i] hasPrefix:HSF_MODEL_ATTRIBUTE_PREFIX] && (i + 1 < [components count] || mapping)){
+            [NSException raise:NSInvalidArgumentException format:@"Attribute can be only the last component of a value path: %@",path];
+        }
+    }
+    if (![key length]){
+        [NSException raise:NSInvalidArgumentException format:@"Property key is empty."];
+    }
+    NSString *setter = [NSString stringWithFormat:@"set%@%@:",[[key substringToIndex:1] uppercaseString],[key substringFromIndex:1]];
+    if (![self.modelClass instancesRespondToSelector:NSSelectorFromString(setter)]){
+        [NSException raise:NSInvalidArgumentException format:@"%@ has no property %@.",NSStringFromClass(self.modelClass),key];
+    }
+
+    HSFModelRule *rule = [[HSFModelRule alloc] init];
+    rule.key = key;
+    rule.type = type;
+    rule.mapping = mapping;
+    rule.isRepeated = repeated;
+    rule.components = components;
+
+    @synchronized(self){
+        if (_rootNode){
+            [NSException raise:NSInternalInconsistencyException format:@"Mapping is already in use."];
+        }
+        [self.rules addObject:rule];
+    }
+}
+
+-(HSFModelPathNode*)compiledRules
+{
+    HSFModelPathNode *root = [[HSFModelPathNode alloc] init];
+    for (HSFModelRule *rule in self.rules){
+        HSFModelPathNode *node = root;
+        NSString *attribute = nil;
+        for (NSString *component in rule.components){
+            if ([component hasPrefix:HSF_MODEL_ATTRIBUTE_PREFIX]){
+                attribute = [component substringFromIndex:1];
+            } else {
+                node = [node childForName:component];
+            }
+        }
+
+        if (attribute){
+            NSMutableDictionary *attributeRules = [NSMutableDictionary dictionaryWithDictionary:node.attributeRules];
+            attributeRules[attribute] = [(attributeRules[attribute] ?: @[]) arrayByAddingObject:rule];
+            node.attributeRules = [attributeRules copy];
+        } else if (rule.mapping){
+            if (node.objectRule){
+                [NSException raise:NSInvalidArgumentException format:@"Path %@ is mapped to two objects.",[rule.components componentsJoinedByString:HSF_MODEL_PATH_SEPARATOR]];
+            }
+            node.objectRule = rule;
+        } else {
+            node.valueRules = [(node.valueRules ?: @[]) arrayByAddingObject:rule];
+        }
+    }
+    return root;
+}
+
+@end
@@ -0,0 +1,104 @@
+//
+//  HSFMultipartParser.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@protocol HSFMultipartParserDelegate;
+
+/*!
+ @abstract Incremental parser of MIME multipart body.
+ @discussion Splits a multipart/related response (e.g. MTOM/XOP message) into parts chunk by chunk, so a delimiter may be broken at any place. Bytes of a part are passed to the delegate as they come, they are not collected. Preamble and epilogue are skipped. Content-Transfer-Encoding is not applied, MTOM parts are binary.
+ */
+@interface HSFMultipartParser : NSObject
+
+/*!
+ @abstract HSFMultipartParser delegate.
+ */
+@property (weak,nonatomic) id <HSFMultipartParserDelegate> delegate;
+
+/*!
+ @abstract Parse error.
+ @discussion Set if a delimiter line or part headers are broken (HSFParseErrorDomain). Subsequent chunks are ignored until reset.
+ */
+@property (strong,nonatomic,readonly) NSError *error;
+
+/*!
+ @abstract Determine whether the close delimiter was reached.
+ */
+@property (nonatomic,readonly) BOOL isFinished;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @discussion Throws an exception if boundary is empty.
+ @param boundary Boundary parameter of the content type.
+ @return The initialized parser.
+ */
+-(id)initWithBoundary:(NSString*)boundary;
+
+/*!
+ @abstract Parse next chunk of the body.
+ @discussion Delegate is notified synchronously about parts found in the chunk.
+ @param data Next chunk of the body.
+ @return NO if the body is not valid, see error.
+ */
+-(BOOL)parseData:(NSData*)data;
+
+/*!
+ @abstract Forget the state and error.
+ @discussion Also stops parsing of the current chunk, e.g. when the delegate fails loading.
+ */
+-(void)reset;
+
+/*!
+ @abstract Parameters of a content type header.
+ @discussion Parameter names are lowercased, quoted values are unquoted.
+ @param contentType Value of Content-Type header.
+ @param mediaType Out parameter for lowercased media type. May be NULL.
+ @return Parameters by name.
+ */
++(NSDictionary*)parametersOfContentType:(NSString*)contentType mediaType:(NSString**)mediaType;
+
+/*!
+ @abstract Content ID of a Content-ID header or of a cid: URL.
+ @discussion Angle brackets and cid: scheme are removed, the URL is percent decoded, so both forms of the same ID are equal.
+ @param value Header value or href of xop:Include.
+ @return The content ID.
+ */
++(NSString*)contentIDFromString:(NSString*)value;
+
+@end
+
+/*!
+ @abstract Protocol for delegate of HSFMultipartParser.
+ */
+@protocol HSFMultipartParserDelegate <NSObject>
+
+/*!
+ @abstract Headers of the next part are parsed.
+ @param parser Parser which found the part.
+ @param headers Header values by lowercased header name.
+ */
+-(void)multipartParser:(HSFMultipartParser*)parser didBeginPartWithHeaders:(NSDictionary*)headers;
+
+/*!
+ @abstract Bytes of the current part are parsed.
+ @discussion Data refers to the parser buffer without copying, so it is valid only during the call; copy it to keep.
+ @param parser Parser which parsed the bytes.
+ @param data Next bytes of the part.
+ */
+-(void)multipartParser:(HSFMultipartParser*)parser didReceiveData:(NSData*)data;
+
+/*!
+ @abstract The current part is finished.
+ @param parser Parser which finished the part.
+ */
+-(void)multipartParserDidEndPart:(HSFMultipartParser*)parser;
+
+@end
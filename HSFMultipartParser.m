@@ -0,0 +1,302 @@
+//
+//  HSFMultipartParser.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFMultipartParser.h"
+#import "HSFCommon.h"
+
+#define HSF_MULTIPART_CRLF "\r\n"
+#define HSF_MULTIPART_HEADERS_END "\r\n\r\n"
+#define HSF_MULTIPART_CLOSE "--"
+
+typedef NS_ENUM(NSInteger, HSFMultipartState) {
+    HSFMultipartStatePreamble,  // Looking for the first delimiter.
+    HSFMultipartStateDelimiter, // After a delimiter, looking for the end of its line or for close delimiter.
+    HSFMultipartStateHeaders,   // Looking for the empty line after part headers.
+    HSFMultipartStateBody,      // Passing part bytes until the next delimiter.
+    HSFMultipartStateEpilogue   // After close delimiter, everything is skipped.
+};
+
+@interface HSFMultipartParser(){
+    HSFMultipartState _state;
+    // Unparsed bytes start at _offset, consumed ones are removed after every chunk.
+    NSMutableData *_buffer;
+    NSUInteger _offset;
+    // Incremented by reset, so parsing of the current chunk stops.
+    NSUInteger _generation;
+}
+
+@property (strong,nonatomic,readwrite) NSError *error;
+@property (nonatomic,readwrite) BOOL isFinished;
+
+/*
+ CRLF, two hyphens and the boundary.
+ */
+@property (strong,nonatomic) NSData *delimiter;
+
+@end
+
+@implementation HSFMultipartParser
+
+#pragma mark Public Methods
+
+-(id)initWithBoundary:(NSString*)boundary
+{
+    if (![boundary length]){
+        [NSException raise:NSInvalidArgumentException format:@"The boundary is empty."];
+    }
+    self = [super init];
+    if (self){
+        _delimiter = [[NSString stringWithFormat:@"\r\n--%@",boundary] dataUsingEncoding:NSUTF8StringEncoding];
+        _buffer = [[NSMutableData alloc] init];
+        [self reset];
+    }
+    return self;
+}
+
+-(id)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
+    return [super init];
+}
+
+-(BOOL)parseData:(NSData*)data
+{
+    if (self.error) return NO;
+    if (self.isFinished) return YES;
+
+    [_buffer appendData:data];
+    NSUInteger generation = _generation;
+    while ([self parseNext] && generation == _generation);
+    if (generation != _generation) return YES;
+
+    [_buffer replaceBytesInRange:NSMakeRange(0, _offset) withBytes:NULL length:0];
+    _offset = 0;
+    return !self.error;
+}
+
+-(void)reset
+{
+    ++_generation;
+    _state = HSFMultipartStatePreamble;
+    // The first delimiter may start the body without CRLF.
+    [_buffer setLength:0];
+    [_buffer appendBytes:HSF_MULTIPART_CRLF length:2];
+    _offset = 0;
+    self.error = nil;
+    self.isFinished = NO;
+}
+
+#pragma mark Private Methods
+
+/*
+ Parse what the buffer allows in the current state. Returns YES if the state changed and parsing may go on.
+ */
+-(BOOL)parseNext
+{
+    switch (_state){
+        case HSFMultipartStatePreamble:
+        case HSFMultipartStateBody:
+            return [self parseUntilDelimiter];
+        case HSFMultipartStateDelimiter:
+            return [self parseDelimiterLine];
+        case HSFMultipartStateHeaders:
+            return [self parseHeaders];
+        case HSFMultipartStateEpilogue:
+            return NO;
+    }
+    return NO;
+}
+
+-(BOOL)parseUntilDelimiter
+{
+    NSUInteger length = [_buffer length];
+    NSRange range = [_buffer rangeOfData:self.delimiter options:0 range:NSMakeRange(_offset, length - _offset)];
+    if (range.location == NSNotFound){
+        // The tail may be the start of a delimiter.
+        NSUInteger kept = [self.delimiter length] - 1;
+        if (length - _offset > kept){
+            NSUInteger end = length - kept;
+            [self passBytesInRange:NSMakeRange(_offset, end - _offset)];
+            _offset = end;
+        }
+        return NO;
+    }
+
+    [self passBytesInRange:NSMakeRange(_offset, range.location - _offset)];
+    _offset = NSMaxRange(range);
+    if (_state == HSFMultipartStateBody){
+        [self.delegate multipartParserDidEndPart:self];
+    }
+    _state = HSFMultipartStateDelimiter;
+    return YES;
+}
+
+-(void)passBytesInRange:(NSRange)range
+{
+    if (_state != HSFMultipartStateBody || !range.length) return;
+    NSData *data = [NSData dataWithBytesNoCopy:(unsigned char*)[_buffer mutableBytes] + range.location length:range.length freeWhenDone:NO];
+    [self.delegate multipartParser:self didReceiveData:data];
+}
+
+/*
+ Close delimiter ends the body, otherwise only transport padding may follow the boundary.
+ */
+-(BOOL)parseDelimiterLine
+{
+    NSUInteger length = [_buffer length];
+    if (length - _offset < 2) return NO;
+    const unsigned char *bytes = [_buffer bytes];
+    if (memcmp(bytes + _offset, HSF_MULTIPART_CLOSE, 2) == 0){
+        _offset = length;
+        _state = HSFMultipartStateEpilogue;
+        self.isFinished = YES;
+        return NO;
+    }
+
+    NSData *lineEnd = [NSData dataWithBytesNoCopy:(void*)HSF_MULTIPART_CRLF length:2 freeWhenDone:NO];
+    NSRange range = [_buffer rangeOfData:lineEnd options:0 range:NSMakeRange(_offset, length - _offset)];
+    if (range.location == NSNotFound){
+        if (length - _offset > HSF_MULTIPART_HEADER_LIMIT) [self failWithMessage:"Delimiter line is too long."];
+        return NO;
+    }
+    for (NSUInteger i = _offset; i < range.location; ++i){
+        if (bytes[i] != ' ' && bytes[i] != '\t'){
+            [self failWithMessage:"Delimiter line is broken."];
+            return NO;
+        }
+    }
+    _offset = NSMaxRange(range);
+    _state = HSFMultipartStateHeaders;
+    return YES;
+}
+
+-(BOOL)parseHeaders
+{
+    NSUInteger length = [_buffer length];
+    if (length - _offset < 2) return NO;
+    const unsigned char *bytes = [_buffer bytes];
+
+    NSUInteger end;
+    NSUInteger next;
+    if (memcmp(bytes + _offset, HSF_MULTIPART_CRLF, 2) == 0){
+        // Part without headers.
+        end = _offset;
+        next = _offset + 2;
+    } else {
+        NSData *headersEnd = [NSData dataWithBytesNoCopy:(void*)HSF_MULTIPART_HEADERS_END length:4 freeWhenDone:NO];
+        NSRange range = [_buffer rangeOfData:headersEnd options:0 range:NSMakeRange(_offset, length - _offset)];
+        if (range.location == NSNotFound){
+            if (length - _offset > HSF_MULTIPART_HEADER_LIMIT) [self failWithMessage:"Part headers are too long."];
+            return NO;
+        }
+        end = range.location;
+        next = NSMaxRange(range);
+    }
+
+    NSDictionary *headers = [self headersFromBytes:bytes + _offset length:end - _offset];
+    if (!headers){
+        [self failWithMessage:"Part headers are broken."];
+        return NO;
+    }
+    _offset = next;
+    _state = HSFMultipartStateBody;
+    [self.delegate multipartParser:self didBeginPartWithHeaders:headers];
+    return YES;
+}
+
+/*
+ Header fields by lowercased name, folded lines are unfolded. nil if a line is not a field.
+ */
+-(NSDictionary*)headersFromBytes:(const unsigned char*)bytes length:(NSUInteger)length
+{
+    NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    if (!string) string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSISOLatin1StringEncoding];
+
+    NSMutableDictionary *headers = [[NSMutableDictionary alloc] init];
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceCharacterSet];
+    NSString *name;
+    for (NSString *line in [string componentsSeparatedByString:@HSF_MULTIPART_CRLF]){
+        if (![line length]) continue;
+        if ([whitespace characterIsMember:[line characterAtIndex:0]]){
+            if (!name) return nil;
+            NSString *value = [line stringByTrimmingCharactersInSet:whitespace];
+            headers[name] = [NSString stringWithFormat:@"%@ %@",headers[name],value];
+            continue;
+        }
+        NSRange colon = [line rangeOfString:@":"];
+        if (colon.location == NSNotFound || colon.location == 0) return nil;
+        name = [[[line substringToIndex:colon.location] stringByTrimmingCharactersInSet:whitespace] lowercaseString];
+        headers[name] = [[line substringFromIndex:NSMaxRange(colon)] stringByTrimmingCharactersInSet:whitespace];
+    }
+    return [headers copy];
+}
+
+-(void)failWithMessage:(const char*)message
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:@{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_MULTIPART_ERROR}];
+    if (message){
+        userInfo[NSLocalizedFailureReasonErrorKey] = [NSString stringWithUTF8String:message];
+    }
+    self.error = [NSError errorWithDomain:HSFParseErrorDomain code:HSF_ERROR_CODE_MULTIPART_ERROR userInfo:[userInfo copy]];
+}
+
+#pragma mark Class Methods
+
++(NSDictionary*)parametersOfContentType:(NSString*)contentType mediaType:(NSString**)mediaType
+{
+    // Split by semicolons outside of quoted strings.
+    NSMutableArray *fields = [[NSMutableArray alloc] init];
+    NSMutableString *field = [[NSMutableString alloc] init];
+    BOOL isQuoted = NO;
+    NSUInteger length = [contentType length];
+    for (NSUInteger i = 0; i < length; ++i){
+        unichar c = [contentType characterAtIndex:i];
+        if (isQuoted && c == '\\' && i + 1 < length){
+            [field appendFormat:@"%C",[contentType characterAtIndex:++i]];
+            continue;
+        }
+        if (c == '"'){
+            isQuoted = !isQuoted;
+            continue;
+        }
+        if (c == ';' && !isQuoted){
+            [fields addObject:[field copy]];
+            [field setString:@""];
+            continue;
+        }
+        [field appendFormat:@"%C",c];
+    }
+    [fields addObject:field];
+
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    if (mediaType) *mediaType = [[fields[0] stringByTrimmingCharactersInSet:whitespace] lowercaseString];
+    NSMutableDictionary *parameters = [[NSMutableDictionary alloc] init];
+    for (NSUInteger i = 1; i < [fields count]; ++i){
+        NSRange equal = [fields[i] rangeOfString:@"="];
+        if (equal.location == NSNotFound) continue;
+        NSString *name = [[[fields[i] substringToIndex:equal.location] stringByTrimmingCharactersInSet:whitespace] lowercaseString];
+        parameters[name] = [[fields[i] substringFromIndex:NSMaxRange(equal)] stringByTrimmingCharactersInSet:whitespace];
+    }
+    return [parameters copy];
+}
+
++(NSString*)contentIDFromString:(NSString*)value
+{
+    NSString *contentID = [value stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    if ([contentID length] >= 4 && [[contentID substringToIndex:4] caseInsensitiveCompare:@"cid:"] == NSOrderedSame){
+        contentID = [contentID substringFromIndex:4];
+        NSString *decoded = [contentID stringByRemovingPercentEncoding];
+        if (decoded) contentID = decoded;
+    }
+    if ([contentID hasPrefix:@"<"] && [contentID hasSuffix:@">"] && [contentID length] >= 2){
+        contentID = [contentID substringWithRange:NSMakeRange(1, [contentID length] - 2)];
+    }
+    return contentID;
+}
+
+@end
@@ -7,6 +7,7 @@
 //
 
 #import "HSFNode.h"
+#import "HSFSymbolTable.h"
 
 /*!
  @abstract Category to make a HSFNode be a NSXMLParserDelegate.
@@ -23,21 +24,31 @@
  */
 +(HSFNode*)nodeTreeFromData:(NSData*)data error:(NSError**)error;
 
+/*!
+ @abstract Parse data and return node tree with interned names.
+ @discussion The same as nodeTreeFromData:error:, but element names and attribute keys are interned in the symbol table.
+ @param data Data bag to parse.
+ @param symbolTable Symbol table for names and keys. May be nil.
+ @param error Out parameter used if an error occurs while parsing the data. May be NULL. Error domain will be HSFParseErrorDomain.
+ @return Root node with name of ROOT_NODE_NAME macro.
+ */
++(HSFNode*)nodeTreeFromData:(NSData*)data symbolTable:(HSFSymbolTable*)symbolTable error:(NSError**)error;
+
 /*!
  @abstract Handle open tag.
- @discussion This task creates a new node and add sets it as a child of the current node. It the new node as parser delegate.
+ @discussion This task creates a new node and add sets it as an indexed child of the current node. It the new node as parser delegate.
  */
 -(void)parser:(NSXMLParser *)parser didStartElement:(NSString *)elementName namespaceURI:(NSString *)namespaceURI qualifiedName:(NSString *)qName attributes:(NSDictionary *)attributeDict;
 
 /*!
  @abstract Handle data inside a tag.
- @discussion Appends character to the node's value.
+ @discussion Appends characters to the node's value without reformatting it.
  */
 -(void)parser:(NSXMLParser *)parser foundCharacters:(NSString *)string;
 
 /*!
  @abstract Handle close tag.
- @discussion Sets parent as parser delegate.
+ @discussion Finishes the node in the name index and sets parent as parser delegate.
  */
 -(void)parser:(NSXMLParser *)parser didEndElement:(NSString *)elementName namespaceURI:(NSString *)namespaceURI qualifiedName:(NSString *)qName;
 
@@ -7,17 +7,43 @@
 //
 
 #import "HSFNode+NSXMLParserDelegate.h"
+#import "HSFNode+Parsing.h"
 #import "HSFExceptions.h"
 #import "HSFCommon.h"
+#import <objc/runtime.h>
+
+static char HSFParseContextKey;
+
+/*
+ State of one parse, which nodes find by the parser. It is not kept in the tree.
+ */
+@interface HSFNodeParseContext : NSObject
+
+@property (strong,nonatomic) HSFSymbolTable *symbolTable;
+
+@end
+
+@implementation HSFNodeParseContext
+
+@end
 
 @implementation HSFNode (NSXMLParserDelegate)
 
 +(HSFNode*)nodeTreeFromData:(NSData*)data error:(NSError**)error
+{
+    return [self nodeTreeFromData:data symbolTable:nil error:error];
+}
+
++(HSFNode*)nodeTreeFromData:(NSData*)data symbolTable:(HSFSymbolTable*)symbolTable error:(NSError**)error
 {
     HSFNode *root = [[HSFNode alloc] initWithName:ROOT_NODE_NAME];
     NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
     parser.delegate = root;
     root.treeData = data;
+    [root beginNameIndex];
+    HSFNodeParseContext *context = [[HSFNodeParseContext alloc] init];
+    context.symbolTable = symbolTable;
+    objc_setAssociatedObject(parser, &HSFParseContextKey, context, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
     [parser parse];
     if (error != NULL){
         *error = (NSError*)root.userInfo[HSF_PARSE_ERROR_KEY];
@@ -27,24 +53,29 @@
 
 -(void)parser:(NSXMLParser *)parser didStartElement:(NSString *)elementName namespaceURI:(NSString *)namespaceURI qualifiedName:(NSString *)qName attributes:(NSDictionary *)attributeDict
 {
-    HSFNode * newNode = [[HSFNode alloc] initWithName:elementName];
-    newNode.attributes = attributeDict;
+    HSFNodeParseContext *context = objc_getAssociatedObject(parser, &HSFParseContextKey);
+    HSFSymbolTable *symbolTable = context.symbolTable;
+    HSFNode * newNode;
+    if (symbolTable){
+        newNode = [[HSFNode alloc] initWithName:[symbolTable symbolForString:elementName]];
+        newNode.attributes = [symbolTable attributesWithInternedKeys:attributeDict];
+    } else {
+        newNode = [[HSFNode alloc] initWithName:elementName];
+        newNode.attributes = attributeDict;
+    }
     
-    [self addChild:newNode];
+    [self addIndexedChild:newNode];
     [parser setDelegate:newNode];
 }
 
 -(void)parser:(NSXMLParser *)parser foundCharacters:(NSString *)string
 {
-    if(![self.value length]){
-        self.value = string;
-    } else {
-        self.value = [NSString stringWithFormat:@"%@%@",self.value,string];
-    }
+    [self appendParsedText:string];
 }
 
 -(void)parser:(NSXMLParser *)parser didEndElement:(NSString *)elementName namespaceURI:(NSString *)namespaceURI qualifiedName:(NSString *)qName
 {
+    [self endIndexedNode];
     if (self.parent)
         parser.delegate = self.parent;
 }
@@ -0,0 +1,43 @@
+//
+//  HSFNode+Parsing.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFNode.h"
+
+/*!
+ @abstract Tree building methods of HSFNode for parsers.
+ @discussion Private to the framework, imported by HSFNode+NSXMLParserDelegate and HSFNodePushParser only. Other callers use addChild:, as a tree built with these methods carries a name index which wrong calls would corrupt.
+ */
+@interface HSFNode (Parsing)
+
+/*!
+ @abstract Start name index for the tree.
+ @discussion Parsers call it for the root before building the tree.
+ */
+-(void)beginNameIndex;
+
+/*!
+ @abstract Add child registering it in the name index.
+ @discussion Parsers use it instead of addChild: to build the tree in document order. Throws an exception if the child is nil.
+ @param node Node to be a child.
+ */
+-(void)addIndexedChild:(HSFNode*)node;
+
+/*!
+ @abstract Finish indexed node.
+ @discussion Parsers call it when the end tag of the node is parsed.
+ */
+-(void)endIndexedNode;
+
+/*!
+ @abstract Append piece of text to the value.
+ @discussion Parsers use it for text which comes in pieces. Text is accumulated without copying the value for every piece; the value is finalized by endIndexedNode.
+ @param text Piece of text.
+ */
+-(void)appendParsedText:(NSString*)text;
+
+@end
@@ -9,12 +9,14 @@
 #import <Foundation/Foundation.h>
 
 @protocol HSFNodeParseErrorHandler;
+@protocol HSFNodeStorage;
+@class HSFSymbolTable;
 
 /*!
  @abstract XML node of SOAP envelope XML document.
  @discussion An instances of this class construct a tree which represents SOAP XML document.
  */
-@interface HSFNode : NSObject
+@interface HSFNode : NSObject <NSFastEnumeration>
 
 /*!
  @abstract Storage to keep any necessary data.
@@ -38,6 +40,12 @@
  */
 @property (strong,nonatomic,readonly) NSDictionary *dictionary;
 
+/*!
+ @abstract Lazy dictionary view of the node tree.
+ @discussion Has the same shape as dictionary, but the entries are HSFNodeDictionary views which convert children on access, and repeated siblings are returned as arrays instead of throwing an exception. The view is reused while it is alive, so repeated access does not index the children again.
+ */
+@property (strong,nonatomic,readonly) NSDictionary *lazyDictionary;
+
 /*!
  @abstract Attributes of the node.
  @discussion These attributes represent xml tag's attributes.
@@ -56,6 +64,12 @@
  */
 @property (strong,nonatomic) NSString *value;
 
+/*!
+ @abstract Determine whether the value of the node was set.
+ @discussion value returns empty string for a node without value.
+ */
+@property (nonatomic,readonly) BOOL hasValue;
+
 /*!
  @abstract Name of the node.
  @discussion This name represents tag of the XML document.
@@ -68,10 +82,17 @@
  */
 @property (strong,nonatomic,readonly) NSArray *children; //Of nodes
 
+/*!
+ @abstract Number of children.
+ @discussion Unlike children it does not copy anything.
+ */
+@property (nonatomic,readonly) NSUInteger childCount;
+
 #pragma mark Tasks
 
 /*!
  @abstract Search node's tree for node with specified name.
+ @discussion Returns a child with the name if there is one, otherwise searches subtrees of the children in their order; the node itself is excluded. Uses the name index if the tree has one, then only children which have the name in their subtree are visited.
  @param name Name of an element to search.
  @retrun Node with specified name or nil.
  */
@@ -79,12 +100,19 @@
 
 /*!
  @abstract Count of nodes with specified name.
- @discussion Goes through the entire tree and count all elements with specified name.
+ @discussion Count all elements with specified name in the node's tree, the node itself included. Uses the name index if the tree has one, otherwise goes through the entire tree.
  @param name Name to search.
  @return Number of element with specified name.
  */
 -(NSUInteger)countOfNodesByName:(NSString*)name;
 
+/*!
+ @abstract Enumerate children.
+ @discussion Walks children without copying them. The node also supports fast enumeration of its children, e.g. for (HSFNode *child in node).
+ @param block Block to apply to each child.
+ */
+-(void)enumerateChildrenUsingBlock:(void (^)(HSFNode *child, NSUInteger idx, BOOL *stop))block;
+
 /*!
  @abstract First nonsingle parent element in the tree.
  @discussion Occasionally tree data from xml document will contain a bunch of wrapping elements. This method returns a node which likely has sense. If tree contains only single parents, it returns nil.
@@ -92,6 +120,13 @@
  */
 -(HSFNode*)firstNonsingleParent;
 
+/*!
+ @abstract Content ID of XOP reference.
+ @discussion In MTOM response binary content of an element is replaced with xop:Include child which refers to a part of the message. Returns the content ID of the node if it is xop:Include or has such child, in the form given to catcher:didReceiveAttachmentData:forContentID:lastChunk: and used in attachmentPaths of HSFCatcher.
+ @return The content ID or nil.
+ */
+-(NSString*)XOPContentID;
+
 /*!
  @abstract Designated initializer.
  @discussion Returns an initialized node with specified name.
@@ -100,6 +135,47 @@
  */
 -(id)initWithName:(NSString*)name;
 
+/*!
+ @abstract Initializer of a node backed by compact storage.
+ @discussion Name, value, attributes and children of the node are taken from the storage on first access.
+ @param arena Compact storage of the tree, HSFNodeArena or HSFNodeArchive. Must not be nil.
+ @param index Index of the node in the storage.
+ @return The initialized node.
+ */
+-(id)initWithArena:(id<HSFNodeStorage>)arena index:(NSUInteger)index;
+
+/*!
+ @abstract Parse data into compact node tree.
+ @discussion Unlike nodeTreeFromData:error: nodes are kept in HSFNodeArena as ranges of the data, HSFNode objects and their strings are made lazily when the tree is traversed. Data is kept as root's treeData. Documents which are not in UTF-8 are parsed as nodeTreeFromData:error: does.
+ @param data Data bag to parse.
+ @param error Out parameter used if an error occurs while parsing the data. May be NULL. Error domain will be HSFParseErrorDomain.
+ @return Root node with name of ROOT_NODE_NAME macro, nil if data is not valid XML document. Note that this root node itself is not a part of a given XML data.
+ */
++(HSFNode*)compactNodeTreeFromData:(NSData*)data error:(NSError**)error;
+
+/*!
+ @abstract Parse data into compact node tree with interned names.
+ @discussion The same as compactNodeTreeFromData:error:, but element names and attribute keys are interned in the symbol table when they are made.
+ @param symbolTable Symbol table for names and keys. May be nil.
+ */
++(HSFNode*)compactNodeTreeFromData:(NSData*)data symbolTable:(HSFSymbolTable*)symbolTable error:(NSError**)error;
+
+/*!
+ @abstract Read node tree from binary archive.
+ @discussion No XML is parsed: nodes are backed by HSFNodeArchive and their strings are made on first access. Data may be memory mapped, e.g. read with NSDataReadingMappedIfSafe.
+ @param data Archive made by archivedData.
+ @param error Out parameter used if the archive is not valid. May be NULL. Error domain will be HSFParseErrorDomain.
+ @return Root node of the archived tree, nil if data is not valid archive.
+ */
++(HSFNode*)nodeTreeFromArchivedData:(NSData*)data error:(NSError**)error;
+
+/*!
+ @abstract Binary archive of the node tree.
+ @discussion The node is the root of the archive. Names, values, attributes and structure are kept, userInfo and treeData are not. See HSFNodeArchive for the format.
+ @return Archive data.
+ */
+-(NSData*)archivedData;
+
 /*!
  @abstract Add child.
  @discussion This method adds a child to the current node and sets itself as its parent. Throws an exception if the child is nil.
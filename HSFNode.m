@@ -8,12 +8,45 @@
 
 #import "HSFNode.h"
 #import "HSFExceptions.h"
+#import "HSFNodeArena.h"
+#import "HSFNode+NSXMLParserDelegate.h"
+#import "HSFNode+Parsing.h"
+#import "HSFNodeArchive.h"
+#import "HSFNodeDictionary.h"
+#import "HSFMultipartParser.h"
+#import "HSFCommon.h"
 
-@interface HSFNode()
+@interface HSFNode(){
+    // Compact storage, nil if the node is not backed by an arena or an archive.
+    id<HSFNodeStorage> _arena;
+    NSUInteger _arenaIndex;
+    
+    // Position of the node in document order and the last position of its subtree, for indexed trees.
+    NSUInteger _documentOrder;
+    NSUInteger _subtreeEnd;
+    // Number of indexed nodes, for the root.
+    NSUInteger _indexedCount;
+    
+    // Value accumulated while parsing, if text came in several pieces.
+    NSMutableString *_valueBuffer;
+    
+    // Dictionary view of the children, weak because the view keeps the node.
+    __weak HSFNodeDictionary *_childrenDictionary;
+}
 
 @property (weak,nonatomic,readwrite) HSFNode *parent;
 @property (strong,nonatomic) NSMutableArray *mutableChildren;
 
+/*
+ Root which holds the name index the node is registered in.
+ */
+@property (weak,nonatomic) HSFNode *indexRoot;
+
+/*
+ Name index, for the root only.
+ */
+@property (strong,nonatomic) NSMutableDictionary *mutableNameIndex;
+
 @end
 
 @implementation HSFNode
@@ -22,19 +55,22 @@
 
 -(HSFNode*)searchNodeByName:(NSString*)name
 {
-    if ([self.children count]){
-        NSUInteger index = [self.children indexOfObjectPassingTest:^BOOL(id obj, NSUInteger idx, BOOL *stop){
-            HSFNode *node = (HSFNode*)obj;
-            return [name isEqualToString:node.name];
-        }];
-        if (index != NSNotFound){
-            return self.children[index];
-        } else {
-            for (HSFNode *node in self.children){
-                HSFNode *testNode = [node searchNodeByName:name];
-                if  (testNode) return testNode;
-            }
-        }
+    if (_arena && !_arena.isTreeModified){
+        return [self searchStorageByName:name];
+    }
+    
+    NSArray *nodes = [self indexedNodesByName:name];
+    if (nodes){
+        return [self searchIndexedNodes:nodes];
+    }
+    
+    // Children are checked before their subtrees.
+    for (HSFNode *node in self.mutableChildren){
+        if ([name isEqualToString:node.name]) return node;
+    }
+    for (HSFNode *node in self.mutableChildren){
+        HSFNode *testNode = [node searchNodeByName:name];
+        if  (testNode) return testNode;
     }
     
     return nil;
@@ -49,20 +85,32 @@
     }
 }
 
+-(NSString*)name
+{
+    if(!_name && _arena)_name = [_arena nameAtIndex:_arenaIndex];
+    return _name;
+}
+
 -(NSString*)value
 {
-    if(!_value)_value = @"";
-    return _value;
+    if(!_value && _arena)_value = [_arena valueAtIndex:_arenaIndex];
+    return _value ? _value : @"";
+}
+
+-(BOOL)hasValue
+{
+    if(!_value && _arena)_value = [_arena valueAtIndex:_arenaIndex];
+    return _value != nil;
 }
 
 -(NSDictionary*)dictionary
 {
     NSDictionary *result;
     
-    if ([self.children count] > 0){
+    if ([self.mutableChildren count] > 0){
         NSMutableDictionary* subResult = [[NSMutableDictionary alloc] init];
-        for (HSFNode* node in self.children){
-            if ([[subResult allKeys] containsObject:node.name]){
+        for (HSFNode* node in self.mutableChildren){
+            if (subResult[node.name]){
                 [NSException raise:HSFNodeTreeIsNotConvertableToNSDictionary format:@"HSFNode tree structure contains duplicate keys = '%@'",node.name];
             }
             [subResult addEntriesFromDictionary:node.dictionary];
@@ -75,15 +123,37 @@
     return result;
 }
 
+-(NSDictionary*)lazyDictionary
+{
+    if (!self.childCount) return @{self.name: self.value};
+    
+    HSFNodeDictionary *children = _childrenDictionary;
+    if (!children){
+        children = [[HSFNodeDictionary alloc] initWithNode:self];
+        _childrenDictionary = children;
+    }
+    return @{self.name: children};
+}
+
 -(NSDictionary*)attributes
 {
-    if(!_attributes)_attributes = @{};
+    if(!_attributes)_attributes = _arena ? [_arena attributesAtIndex:_arenaIndex] : @{};
     return _attributes;
 }
 
 -(NSMutableArray*)mutableChildren
 {
-    if(!_mutableChildren)_mutableChildren = [[NSMutableArray alloc] init];
+    if(!_mutableChildren){
+        _mutableChildren = [[NSMutableArray alloc] init];
+        // Children of arena backed node are made on first access.
+        if (_arena){
+            for (NSUInteger index = [_arena firstChildAtIndex:_arenaIndex]; index != NSNotFound; index = [_arena nextSiblingAtIndex:index]){
+                HSFNode *node = [[HSFNode alloc] initWithArena:_arena index:index];
+                node.parent = self;
+                [_mutableChildren addObject:node];
+            }
+        }
+    }
     return _mutableChildren;
 }
 
@@ -92,6 +162,11 @@
     return [self.mutableChildren copy];
 }
 
+-(NSUInteger)childCount
+{
+    return [self.mutableChildren count];
+}
+
 -(NSData*)treeData
 {
     if (self.parent){
@@ -111,33 +186,65 @@
 }
 
 @synthesize treeData = _treeData;
+@synthesize name = _name;
 
 #pragma mark Public Methods
 
 -(NSUInteger)countOfNodesByName:(NSString *)name
 {
+    if (_arena && !_arena.isTreeModified){
+        return [_arena countOfNodesByName:name inSubtreeAtIndex:_arenaIndex];
+    }
+    
     NSUInteger count = 0;
     if ([name isEqualToString:[self name]]) count++;
-    if ([self.children count] > 0){
-        for (HSFNode *node in self.children){
-            count += [node countOfNodesByName:name];
-        }
+    
+    NSArray *nodes = [self indexedNodesByName:name];
+    if (nodes){
+        return count + [self indexedRangeOfNodes:nodes].length;
+    }
+    
+    for (HSFNode *node in self.mutableChildren){
+        count += [node countOfNodesByName:name];
     }
     return count;
 }
 
+-(void)enumerateChildrenUsingBlock:(void (^)(HSFNode *child, NSUInteger idx, BOOL *stop))block
+{
+    [self.mutableChildren enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop){
+        block(obj, idx, stop);
+    }];
+}
+
+-(NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len
+{
+    return [self.mutableChildren countByEnumeratingWithState:state objects:buffer count:len];
+}
+
 -(HSFNode*)firstNonsingleParent
 {
-    if ([self.children count] > 1)
+    if ([self.mutableChildren count] > 1)
         return self;
     
-    if ([self.children count] == 1){
-        HSFNode *singleton = self.children[0];
+    if ([self.mutableChildren count] == 1){
+        HSFNode *singleton = self.mutableChildren[0];
         return [singleton firstNonsingleParent];
     } else
         return nil;
 }
 
+-(NSString*)XOPContentID
+{
+    NSString *contentID = [self includedContentID];
+    if (contentID) return contentID;
+    for (HSFNode *child in self){
+        contentID = [child includedContentID];
+        if (contentID) return contentID;
+    }
+    return nil;
+}
+
 -(id)initWithName:(NSString*)name
 {
     self = [super init];
@@ -152,6 +259,56 @@
     return self;
 }
 
+-(id)initWithArena:(id<HSFNodeStorage>)arena index:(NSUInteger)index
+{
+    self = [super init];
+    
+    if (self){
+        if (!arena || index >= arena.count){
+            [NSException raise:NSInvalidArgumentException format:@"arena is nil or index is out of bounds."];
+        }
+        _arena = arena;
+        _arenaIndex = index;
+    }
+    
+    return self;
+}
+
++(HSFNode*)compactNodeTreeFromData:(NSData*)data error:(NSError**)error
+{
+    return [self compactNodeTreeFromData:data symbolTable:nil error:error];
+}
+
++(HSFNode*)compactNodeTreeFromData:(NSData*)data symbolTable:(HSFSymbolTable*)symbolTable error:(NSError**)error
+{
+    // Arena reads UTF-8 only, documents in other encodings are parsed by NSXMLParser.
+    if (![HSFNodeArena isUTF8Document:data]){
+        NSError *parseError;
+        HSFNode *root = [self nodeTreeFromData:data symbolTable:symbolTable error:&parseError];
+        if (error != NULL) *error = parseError;
+        return parseError ? nil : root;
+    }
+    HSFNodeArena *arena = [[HSFNodeArena alloc] initWithData:data error:error];
+    if (!arena) return nil;
+    arena.symbolTable = symbolTable;
+    
+    HSFNode *root = [[HSFNode alloc] initWithArena:arena index:0];
+    root.treeData = data;
+    return root;
+}
+
++(HSFNode*)nodeTreeFromArchivedData:(NSData*)data error:(NSError**)error
+{
+    HSFNodeArchive *archive = [[HSFNodeArchive alloc] initWithData:data error:error];
+    if (!archive) return nil;
+    return [[HSFNode alloc] initWithArena:archive index:0];
+}
+
+-(NSData*)archivedData
+{
+    return [HSFNodeArchive archivedDataWithNode:self];
+}
+
 -(id)init
 {
     [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
@@ -164,6 +321,182 @@
         [NSException raise:HSFNodeChildNil format:@"Child is nil."];
     node.parent = self;
     [self.mutableChildren addObject:node];
+    _arena.treeModified = YES;
+    _childrenDictionary = nil;
+    
+    // Positions of nodes are not valid anymore.
+    self.rootNode.mutableNameIndex = nil;
+}
+
+-(void)beginNameIndex
+{
+    self.mutableNameIndex = [[NSMutableDictionary alloc] init];
+    _indexedCount = 0;
+    _documentOrder = 0;
+}
+
+-(void)addIndexedChild:(HSFNode*)node
+{
+    if (!node)
+        [NSException raise:HSFNodeChildNil format:@"Child is nil."];
+    node.parent = self;
+    [self.mutableChildren addObject:node];
+    
+    HSFNode *root = self.mutableNameIndex ? self : self.indexRoot;
+    if (!root.mutableNameIndex) return;
+    
+    node.indexRoot = root;
+    node->_documentOrder = ++root->_indexedCount;
+    node->_subtreeEnd = node->_documentOrder;
+    
+    NSMutableArray *nodes = root.mutableNameIndex[node.name];
+    if (!nodes){
+        nodes = [[NSMutableArray alloc] init];
+        root.mutableNameIndex[node.name] = nodes;
+    }
+    [nodes addObject:node];
+}
+
+-(void)endIndexedNode
+{
+    HSFNode *root = self.indexRoot;
+    if (root){
+        _subtreeEnd = root->_indexedCount;
+    }
+    if (_valueBuffer){
+        _value = [_valueBuffer copy];
+        _valueBuffer = nil;
+    }
+}
+
+-(void)appendParsedText:(NSString*)text
+{
+    if (!_valueBuffer){
+        // The most of elements have a single piece of text, it is kept as it is.
+        if (![_value length]){
+            _value = text;
+            return;
+        }
+        _valueBuffer = [_value mutableCopy];
+        _value = _valueBuffer;
+    }
+    [_valueBuffer appendString:text];
+}
+
+#pragma mark Private Methods
+
+/*
+ Content ID of the node if it is xop:Include, the prefix may be any.
+ */
+-(NSString*)includedContentID
+{
+    NSString *name = self.name;
+    NSRange colon = [name rangeOfString:@":" options:NSBackwardsSearch];
+    NSString *localName = (colon.location == NSNotFound) ? name : [name substringFromIndex:NSMaxRange(colon)];
+    if (![localName isEqualToString:XOP_INCLUDE_NAME]) return nil;
+    NSString *href = self.attributes[XOP_HREF_ATTRIBUTE];
+    return [href length] ? [HSFMultipartParser contentIDFromString:href] : nil;
+}
+
+/*
+ Nodes with the name from the index of the tree, nil if the tree is not indexed.
+ */
+-(NSArray*)indexedNodesByName:(NSString*)name
+{
+    HSFNode *root = self.mutableNameIndex ? self : self.indexRoot;
+    if (!root.mutableNameIndex) return nil;
+    
+    NSArray *nodes = root.mutableNameIndex[name];
+    return nodes ? nodes : @[];
+}
+
+/*
+ The same order as the search through children: a child with the name, otherwise the search in the first child whose subtree has one. Nodes with the name are in document order, so all of them inside a child subtree are skipped at once.
+ */
+-(HSFNode*)searchIndexedNodes:(NSArray*)nodes
+{
+    HSFNode *node = self;
+    while (YES){
+        NSRange range = [node indexedRangeOfNodes:nodes];
+        HSFNode *first = nil;
+        NSUInteger i = range.location;
+        while (i < NSMaxRange(range)){
+            HSFNode *found = nodes[i];
+            HSFNode *child = found;
+            while (child.parent != node) child = child.parent;
+            if (child == found) return found;
+            if (!first) first = child;
+            i = [self insertionIndexOfOrder:child->_subtreeEnd inNodes:nodes];
+        }
+        if (!first) return nil;
+        node = first;
+    }
+}
+
+/*
+ The same as searchIndexedNodes:, on the name index of the storage.
+ */
+-(HSFNode*)searchStorageByName:(NSString*)name
+{
+    NSUInteger index = _arenaIndex;
+    while (YES){
+        NSUInteger end = [_arena subtreeEndAtIndex:index];
+        NSUInteger first = NSNotFound;
+        NSUInteger position = index + 1;
+        while (position <= end){
+            NSUInteger found = [_arena indexOfNodeByName:name inRange:NSMakeRange(position, end - position + 1)];
+            if (found == NSNotFound) break;
+            NSUInteger child = found;
+            while ([_arena parentAtIndex:child] != index) child = [_arena parentAtIndex:child];
+            if (child == found) return [self descendantAtArenaIndex:found];
+            if (first == NSNotFound) first = child;
+            position = [_arena subtreeEndAtIndex:child] + 1;
+        }
+        if (first == NSNotFound) return nil;
+        index = first;
+    }
+}
+
+/*
+ Range of indexed nodes which belong to the subtree of the node, the node itself excluded.
+ */
+-(NSRange)indexedRangeOfNodes:(NSArray*)nodes
+{
+    if (self.mutableNameIndex){
+        return NSMakeRange(0, [nodes count]);
+    }
+    NSUInteger first = [self insertionIndexOfOrder:_documentOrder inNodes:nodes];
+    NSUInteger last = [self insertionIndexOfOrder:_subtreeEnd inNodes:nodes];
+    return NSMakeRange(first, last - first);
+}
+
+/*
+ Index of the first node with document order greater than the given one.
+ */
+-(NSUInteger)insertionIndexOfOrder:(NSUInteger)order inNodes:(NSArray*)nodes
+{
+    NSUInteger low = 0;
+    NSUInteger high = [nodes count];
+    while (low < high){
+        NSUInteger middle = low + (high - low) / 2;
+        HSFNode *node = nodes[middle];
+        if (node->_documentOrder <= order){
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/*
+ Node of the subtree for the arena index, nodes on the way are made as children of their parents.
+ */
+-(HSFNode*)descendantAtArenaIndex:(NSUInteger)index
+{
+    if (index == _arenaIndex) return self;
+    HSFNode *parent = [self descendantAtArenaIndex:[_arena parentAtIndex:index]];
+    return parent.mutableChildren[[_arena positionAtIndex:index]];
 }
 
 /*
@@ -180,9 +513,9 @@
         [desc appendString:@"--|"];
     [desc appendFormat:@"%@: '%@'",self.name, [self.value stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]]];
     
-    if ([self.children count] > 0){
+    if ([self.mutableChildren count] > 0){
         ++j;
-        for (HSFNode *child in self.children){
+        for (HSFNode *child in self.mutableChildren){
             [desc appendFormat:@"%@",[child description]];
         }
         --j;
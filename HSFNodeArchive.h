@@ -0,0 +1,76 @@
+//
+//  HSFNodeArchive.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFNodeStorage.h"
+
+@class HSFNode;
+
+/*!
+ @abstract Compact storage of HSFNode tree read from binary archive.
+ @discussion Archive is a versioned binary form of a node tree which is read back without XML parsing. All numbers are 32 bit little endian and every table starts at 4 byte boundary:
+ 
+ header: magic HSF_ARCHIVE_MAGIC, version HSF_ARCHIVE_VERSION, counts of nodes, attributes and strings, offsets of node, attribute and string tables, offset and length of string bytes;
+ 
+ node table: name, value, first attribute, attribute count, parent, first child, next sibling, position among siblings and last index of subtree of every node, in document order with the archived node at index 0;
+ 
+ attribute table: key and value of every attribute;
+ 
+ string table: offset and length of UTF-8 bytes of every distinct string.
+ 
+ Names, values, keys are indexes of interned strings, absent index is 0xFFFFFFFF. Name and value which are nil are stored as absent index and read back as nil, so hasValue of such node is NO again. Opening an archive checks the header, bounds and tree structure, but neither copies the data nor makes strings, so the data may be memory mapped; strings are made on first access.
+ */
+@interface HSFNodeArchive : NSObject <HSFNodeStorage>
+
+/*!
+ @abstract Archive data the storage refers to.
+ */
+@property (strong,nonatomic,readonly) NSData *data;
+
+/*!
+ @abstract Number of nodes, the root included.
+ */
+@property (nonatomic,readonly) NSUInteger count;
+
+/*!
+ @abstract Determine whether HSFNode tree backed by the archive was restructured.
+ */
+@property (nonatomic,getter=isTreeModified) BOOL treeModified;
+
+/*!
+ @abstract Symbol table to intern names and attribute keys when they are made.
+ */
+@property (strong,nonatomic) HSFSymbolTable *symbolTable;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @param data Archive data made by archivedDataWithNode:.
+ @param error Out parameter used if the archive is not valid or has unknown version. May be NULL. Error domain will be HSFParseErrorDomain.
+ @return The initialized archive or nil if the archive is not valid.
+ */
+-(id)initWithData:(NSData*)data error:(NSError**)error;
+
+/*!
+ @abstract Open archive file.
+ @discussion The file is memory mapped if it is safe.
+ @param path Path of the archive file.
+ @param error Out parameter used if the file can't be read or the archive is not valid. May be NULL.
+ @return The initialized archive or nil.
+ */
+-(id)initWithContentsOfFile:(NSString*)path error:(NSError**)error;
+
+/*!
+ @abstract Archive node tree.
+ @param node Root of the archived tree. Must not be nil.
+ @return Archive data.
+ */
++(NSData*)archivedDataWithNode:(HSFNode*)node;
+
+@end
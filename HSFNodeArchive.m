@@ -0,0 +1,490 @@
+//
+//  HSFNodeArchive.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFNodeArchive.h"
+#import "HSFNode.h"
+#import "HSFCommon.h"
+#import <libkern/OSByteOrder.h>
+
+#define HSF_ARCHIVE_NONE UINT32_MAX
+#define HSF_ARCHIVE_WORD_SIZE 4
+
+// Fields of the header, in words.
+typedef NS_ENUM(NSUInteger, HSFArchiveHeaderField) {
+    HSFArchiveHeaderMagic,
+    HSFArchiveHeaderVersion,
+    HSFArchiveHeaderNodeCount,
+    HSFArchiveHeaderAttributeCount,
+    HSFArchiveHeaderStringCount,
+    HSFArchiveHeaderNodeTableOffset,
+    HSFArchiveHeaderAttributeTableOffset,
+    HSFArchiveHeaderStringTableOffset,
+    HSFArchiveHeaderStringDataOffset,
+    HSFArchiveHeaderStringDataLength,
+    HSFArchiveHeaderFieldCount
+};
+
+// Fields of a node record, in words.
+typedef NS_ENUM(NSUInteger, HSFArchiveNodeField) {
+    HSFArchiveNodeName,
+    HSFArchiveNodeValue,
+    HSFArchiveNodeFirstAttribute,
+    HSFArchiveNodeAttributeCount,
+    HSFArchiveNodeParent,
+    HSFArchiveNodeFirstChild,
+    HSFArchiveNodeNextSibling,
+    HSFArchiveNodePosition,
+    HSFArchiveNodeSubtreeEnd,
+    HSFArchiveNodeFieldCount
+};
+
+// Attribute record is key and value, string record is offset and length.
+#define HSF_ARCHIVE_PAIR_FIELD_COUNT 2
+
+/*
+ Word at the offset, the data need not be aligned.
+ */
+static inline uint32_t HSFArchiveReadWord(const unsigned char *bytes, NSUInteger offset)
+{
+    uint32_t word;
+    memcpy(&word, bytes + offset, HSF_ARCHIVE_WORD_SIZE);
+    return OSSwapLittleToHostInt32(word);
+}
+
+static inline void HSFArchiveAppendWord(NSMutableData *data, uint32_t word)
+{
+    word = OSSwapHostToLittleInt32(word);
+    [data appendBytes:&word length:HSF_ARCHIVE_WORD_SIZE];
+}
+
+static inline void HSFArchiveWriteWord(NSMutableData *data, NSUInteger offset, uint32_t word)
+{
+    word = OSSwapHostToLittleInt32(word);
+    [data replaceBytesInRange:NSMakeRange(offset, HSF_ARCHIVE_WORD_SIZE) withBytes:&word];
+}
+
+/*
+ Builder of archive data, nodes are appended in document order.
+ */
+@interface HSFNodeArchiveWriter : NSObject
+
+@property (strong,nonatomic) NSMutableData *nodes;
+@property (strong,nonatomic) NSMutableData *attributes;
+@property (strong,nonatomic) NSMutableData *strings;
+@property (strong,nonatomic) NSMutableData *stringData;
+
+/*
+ Indexes of interned strings.
+ */
+@property (strong,nonatomic) NSMutableDictionary *stringIndexes;
+@property (nonatomic) uint32_t nodeCount;
+@property (nonatomic) uint32_t attributeCount;
+
+-(uint32_t)appendNode:(HSFNode*)node parent:(uint32_t)parent position:(uint32_t)position;
+-(NSData*)archivedData;
+
+@end
+
+@implementation HSFNodeArchiveWriter
+
+-(id)init
+{
+    self = [super init];
+    if (self){
+        _nodes = [[NSMutableData alloc] init];
+        _attributes = [[NSMutableData alloc] init];
+        _strings = [[NSMutableData alloc] init];
+        _stringData = [[NSMutableData alloc] init];
+        _stringIndexes = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+-(uint32_t)indexOfString:(NSString*)string
+{
+    if (!string) return HSF_ARCHIVE_NONE;
+    NSNumber *index = self.stringIndexes[string];
+    if (index) return [index unsignedIntValue];
+
+    NSData *bytes = [string dataUsingEncoding:NSUTF8StringEncoding];
+    if ([self.stringData length] + [bytes length] > UINT32_MAX){
+        [NSException raise:NSInvalidArgumentException format:@"Node tree is too big to archive."];
+    }
+    uint32_t stringIndex = (uint32_t)[self.stringIndexes count];
+    HSFArchiveAppendWord(self.strings, (uint32_t)[self.stringData length]);
+    HSFArchiveAppendWord(self.strings, (uint32_t)[bytes length]);
+    [self.stringData appendData:bytes];
+    self.stringIndexes[string] = @(stringIndex);
+    return stringIndex;
+}
+
+-(void)setWord:(uint32_t)word ofNode:(uint32_t)index field:(HSFArchiveNodeField)field
+{
+    HSFArchiveWriteWord(self.nodes, (index * HSFArchiveNodeFieldCount + field) * HSF_ARCHIVE_WORD_SIZE, word);
+}
+
+-(uint32_t)appendNode:(HSFNode*)node parent:(uint32_t)parent position:(uint32_t)position
+{
+    uint32_t index = self.nodeCount++;
+
+    // Sorted keys keep archives of equal trees equal.
+    NSDictionary *attributes = node.attributes;
+    NSArray *keys = [[attributes allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    uint32_t firstAttribute = self.attributeCount;
+    for (NSString *key in keys){
+        HSFArchiveAppendWord(self.attributes, [self indexOfString:key]);
+        HSFArchiveAppendWord(self.attributes, [self indexOfString:[attributes[key] description]]);
+        ++self.attributeCount;
+    }
+
+    HSFArchiveAppendWord(self.nodes, [self indexOfString:node.name]);
+    HSFArchiveAppendWord(self.nodes, node.hasValue ? [self indexOfString:node.value] : HSF_ARCHIVE_NONE);
+    HSFArchiveAppendWord(self.nodes, firstAttribute);
+    HSFArchiveAppendWord(self.nodes, (uint32_t)[keys count]);
+    HSFArchiveAppendWord(self.nodes, parent);
+    HSFArchiveAppendWord(self.nodes, HSF_ARCHIVE_NONE);
+    HSFArchiveAppendWord(self.nodes, HSF_ARCHIVE_NONE);
+    HSFArchiveAppendWord(self.nodes, position);
+    HSFArchiveAppendWord(self.nodes, index);
+
+    uint32_t previous = HSF_ARCHIVE_NONE;
+    uint32_t childPosition = 0;
+    for (HSFNode *child in node){
+        uint32_t childIndex = [self appendNode:child parent:index position:childPosition++];
+        if (previous == HSF_ARCHIVE_NONE){
+            [self setWord:childIndex ofNode:index field:HSFArchiveNodeFirstChild];
+        } else {
+            [self setWord:childIndex ofNode:previous field:HSFArchiveNodeNextSibling];
+        }
+        previous = childIndex;
+    }
+    [self setWord:self.nodeCount - 1 ofNode:index field:HSFArchiveNodeSubtreeEnd];
+    return index;
+}
+
+-(NSData*)archivedData
+{
+    NSUInteger nodeTableOffset = HSFArchiveHeaderFieldCount * HSF_ARCHIVE_WORD_SIZE;
+    NSUInteger attributeTableOffset = nodeTableOffset + [self.nodes length];
+    NSUInteger stringTableOffset = attributeTableOffset + [self.attributes length];
+    NSUInteger stringDataOffset = stringTableOffset + [self.strings length];
+    if (stringDataOffset + [self.stringData length] > UINT32_MAX){
+        [NSException raise:NSInvalidArgumentException format:@"Node tree is too big to archive."];
+    }
+
+    NSMutableData *data = [[NSMutableData alloc] initWithCapacity:stringDataOffset + [self.stringData length]];
+    HSFArchiveAppendWord(data, HSF_ARCHIVE_MAGIC);
+    HSFArchiveAppendWord(data, HSF_ARCHIVE_VERSION);
+    HSFArchiveAppendWord(data, self.nodeCount);
+    HSFArchiveAppendWord(data, self.attributeCount);
+    HSFArchiveAppendWord(data, (uint32_t)[self.stringIndexes count]);
+    HSFArchiveAppendWord(data, (uint32_t)nodeTableOffset);
+    HSFArchiveAppendWord(data, (uint32_t)attributeTableOffset);
+    HSFArchiveAppendWord(data, (uint32_t)stringTableOffset);
+    HSFArchiveAppendWord(data, (uint32_t)stringDataOffset);
+    HSFArchiveAppendWord(data, (uint32_t)[self.stringData length]);
+    [data appendData:self.nodes];
+    [data appendData:self.attributes];
+    [data appendData:self.strings];
+    [data appendData:self.stringData];
+    return [data copy];
+}
+
+@end
+
+@interface HSFNodeArchive(){
+    const unsigned char *_bytes;
+    NSUInteger _attributeCount;
+    NSUInteger _stringCount;
+    NSUInteger _nodeTableOffset;
+    NSUInteger _attributeTableOffset;
+    NSUInteger _stringTableOffset;
+    NSUInteger _stringDataOffset;
+    NSUInteger _stringDataLength;
+}
+
+@property (strong,nonatomic,readwrite) NSData *data;
+@property (nonatomic,readwrite) NSUInteger count;
+
+/*
+ Indexes of nodes by UTF-8 bytes of their names, made on the first search.
+ */
+@property (strong,nonatomic) NSDictionary *nameIndex;
+
+@end
+
+@implementation HSFNodeArchive
+
+#pragma mark Public Methods
+
+-(id)initWithData:(NSData*)data error:(NSError**)error
+{
+    self = [super init];
+    if (self){
+        _data = data;
+        _bytes = [data bytes];
+        if (![self readHeader] || ![self checkTables]){
+            if (error != NULL){
+                NSDictionary *userInfo = @{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_ARCHIVE_ERROR};
+                *error = [NSError errorWithDomain:HSFParseErrorDomain code:HSF_ERROR_CODE_ARCHIVE_ERROR userInfo:userInfo];
+            }
+            return nil;
+        }
+    }
+    return self;
+}
+
+-(id)initWithContentsOfFile:(NSString*)path error:(NSError**)error
+{
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:error];
+    if (!data) return nil;
+    return [self initWithData:data error:error];
+}
+
+-(id)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
+    return [super init];
+}
+
+-(NSString*)nameAtIndex:(NSUInteger)index
+{
+    return [self symbolAtIndex:[self wordOfNode:index field:HSFArchiveNodeName]];
+}
+
+-(NSString*)valueAtIndex:(NSUInteger)index
+{
+    return [self stringAtIndex:[self wordOfNode:index field:HSFArchiveNodeValue]];
+}
+
+-(NSDictionary*)attributesAtIndex:(NSUInteger)index
+{
+    NSUInteger first = [self wordOfNode:index field:HSFArchiveNodeFirstAttribute];
+    NSUInteger count = [self wordOfNode:index field:HSFArchiveNodeAttributeCount];
+    if (!count) return @{};
+
+    NSMutableDictionary *attributes = [[NSMutableDictionary alloc] initWithCapacity:count];
+    for (NSUInteger i = first; i < first + count; ++i){
+        NSUInteger offset = _attributeTableOffset + i * HSF_ARCHIVE_PAIR_FIELD_COUNT * HSF_ARCHIVE_WORD_SIZE;
+        NSString *key = [self symbolAtIndex:HSFArchiveReadWord(_bytes, offset)];
+        attributes[key] = [self stringAtIndex:HSFArchiveReadWord(_bytes, offset + HSF_ARCHIVE_WORD_SIZE)];
+    }
+    return [attributes copy];
+}
+
+-(NSUInteger)parentAtIndex:(NSUInteger)index
+{
+    return [self indexOfWord:[self wordOfNode:index field:HSFArchiveNodeParent]];
+}
+
+-(NSUInteger)firstChildAtIndex:(NSUInteger)index
+{
+    return [self indexOfWord:[self wordOfNode:index field:HSFArchiveNodeFirstChild]];
+}
+
+-(NSUInteger)nextSiblingAtIndex:(NSUInteger)index
+{
+    return [self indexOfWord:[self wordOfNode:index field:HSFArchiveNodeNextSibling]];
+}
+
+-(NSUInteger)positionAtIndex:(NSUInteger)index
+{
+    return [self wordOfNode:index field:HSFArchiveNodePosition];
+}
+
+-(NSUInteger)subtreeEndAtIndex:(NSUInteger)index
+{
+    return [self wordOfNode:index field:HSFArchiveNodeSubtreeEnd];
+}
+
+-(NSUInteger)indexOfNodeByName:(NSString*)name inRange:(NSRange)range
+{
+    NSIndexSet *nodes = self.nameIndex[[name dataUsingEncoding:NSUTF8StringEncoding]];
+    if (!nodes) return NSNotFound;
+    NSUInteger found = [nodes indexGreaterThanOrEqualToIndex:range.location];
+    return found < NSMaxRange(range) ? found : NSNotFound;
+}
+
+-(NSUInteger)countOfNodesByName:(NSString*)name inSubtreeAtIndex:(NSUInteger)index
+{
+    NSIndexSet *nodes = self.nameIndex[[name dataUsingEncoding:NSUTF8StringEncoding]];
+    return [nodes countOfIndexesInRange:NSMakeRange(index, [self subtreeEndAtIndex:index] - index + 1)];
+}
+
+#pragma mark Private Methods
+
+-(uint32_t)wordOfNode:(NSUInteger)index field:(HSFArchiveNodeField)field
+{
+    return HSFArchiveReadWord(_bytes, _nodeTableOffset + (index * HSFArchiveNodeFieldCount + field) * HSF_ARCHIVE_WORD_SIZE);
+}
+
+-(NSUInteger)indexOfWord:(uint32_t)word
+{
+    return word == HSF_ARCHIVE_NONE ? NSNotFound : word;
+}
+
+-(NSRange)rangeOfStringAtIndex:(NSUInteger)index
+{
+    NSUInteger offset = _stringTableOffset + index * HSF_ARCHIVE_PAIR_FIELD_COUNT * HSF_ARCHIVE_WORD_SIZE;
+    return NSMakeRange(_stringDataOffset + HSFArchiveReadWord(_bytes, offset), HSFArchiveReadWord(_bytes, offset + HSF_ARCHIVE_WORD_SIZE));
+}
+
+-(NSString*)stringAtIndex:(NSUInteger)index
+{
+    if (index == HSF_ARCHIVE_NONE) return nil;
+    NSRange range = [self rangeOfStringAtIndex:index];
+    return [[NSString alloc] initWithBytes:_bytes + range.location length:range.length encoding:NSUTF8StringEncoding] ?: @"";
+}
+
+/*
+ Name or attribute key, interned in the symbol table if there is one.
+ */
+-(NSString*)symbolAtIndex:(NSUInteger)index
+{
+    if (!self.symbolTable || index == HSF_ARCHIVE_NONE) return [self stringAtIndex:index];
+    NSRange range = [self rangeOfStringAtIndex:index];
+    return [self.symbolTable symbolForBytes:_bytes + range.location length:range.length] ?: @"";
+}
+
+-(NSDictionary*)nameIndex
+{
+    @synchronized(self){
+        if (!_nameIndex){
+            // Names are interned, nodes are grouped by string index first.
+            NSMutableDictionary *nodesByString = [[NSMutableDictionary alloc] init];
+            for (NSUInteger i = 0; i < self.count; ++i){
+                uint32_t word = [self wordOfNode:i field:HSFArchiveNodeName];
+                if (word == HSF_ARCHIVE_NONE) continue;
+                NSNumber *string = @(word);
+                NSMutableIndexSet *nodes = nodesByString[string];
+                if (!nodes){
+                    nodes = [[NSMutableIndexSet alloc] init];
+                    nodesByString[string] = nodes;
+                }
+                [nodes addIndex:i];
+            }
+            NSMutableDictionary *nameIndex = [[NSMutableDictionary alloc] initWithCapacity:[nodesByString count]];
+            for (NSNumber *string in nodesByString){
+                NSRange range = [self rangeOfStringAtIndex:[string unsignedIntegerValue]];
+                NSData *name = [NSData dataWithBytesNoCopy:(void*)(_bytes + range.location) length:range.length freeWhenDone:NO];
+                // An archive made elsewhere may store equal names twice.
+                NSMutableIndexSet *nodes = nameIndex[name];
+                if (nodes){
+                    [nodes addIndexes:nodesByString[string]];
+                } else {
+                    nameIndex[name] = nodesByString[string];
+                }
+            }
+            _nameIndex = [nameIndex copy];
+        }
+        return _nameIndex;
+    }
+}
+
+-(BOOL)readHeader
+{
+    NSUInteger length = [self.data length];
+    if (length < HSFArchiveHeaderFieldCount * HSF_ARCHIVE_WORD_SIZE) return NO;
+    if (HSFArchiveReadWord(_bytes, HSFArchiveHeaderMagic * HSF_ARCHIVE_WORD_SIZE) != HSF_ARCHIVE_MAGIC) return NO;
+    if (HSFArchiveReadWord(_bytes, HSFArchiveHeaderVersion * HSF_ARCHIVE_WORD_SIZE) != HSF_ARCHIVE_VERSION) return NO;
+
+    _count = HSFArchiveReadWord(_bytes, HSFArchiveHeaderNodeCount * HSF_ARCHIVE_WORD_SIZE);
+    _attributeCount = HSFArchiveReadWord(_bytes, HSFArchiveHeaderAttributeCount * HSF_ARCHIVE_WORD_SIZE);
+    _stringCount = HSFArchiveReadWord(_bytes, HSFArchiveHeaderStringCount * HSF_ARCHIVE_WORD_SIZE);
+    _nodeTableOffset = HSFArchiveReadWord(_bytes, HSFArchiveHeaderNodeTableOffset * HSF_ARCHIVE_WORD_SIZE);
+    _attributeTableOffset = HSFArchiveReadWord(_bytes, HSFArchiveHeaderAttributeTableOffset * HSF_ARCHIVE_WORD_SIZE);
+    _stringTableOffset = HSFArchiveReadWord(_bytes, HSFArchiveHeaderStringTableOffset * HSF_ARCHIVE_WORD_SIZE);
+    _stringDataOffset = HSFArchiveReadWord(_bytes, HSFArchiveHeaderStringDataOffset * HSF_ARCHIVE_WORD_SIZE);
+    _stringDataLength = HSFArchiveReadWord(_bytes, HSFArchiveHeaderStringDataLength * HSF_ARCHIVE_WORD_SIZE);
+
+    // Tables must lie inside of the data, 64 bit arithmetic can't overflow here.
+    if (_count == 0) return NO;
+    if ((uint64_t)_nodeTableOffset + (uint64_t)_count * HSFArchiveNodeFieldCount * HSF_ARCHIVE_WORD_SIZE > length) return NO;
+    if ((uint64_t)_attributeTableOffset + (uint64_t)_attributeCount * HSF_ARCHIVE_PAIR_FIELD_COUNT * HSF_ARCHIVE_WORD_SIZE > length) return NO;
+    if ((uint64_t)_stringTableOffset + (uint64_t)_stringCount * HSF_ARCHIVE_PAIR_FIELD_COUNT * HSF_ARCHIVE_WORD_SIZE > length) return NO;
+    if ((uint64_t)_stringDataOffset + (uint64_t)_stringDataLength > length) return NO;
+    return YES;
+}
+
+/*
+ Check that every index is in bounds and the node table is a tree in document order, so accessors may trust the archive.
+ */
+-(BOOL)checkTables
+{
+    for (NSUInteger i = 0; i < _stringCount; ++i){
+        NSUInteger offset = _stringTableOffset + i * HSF_ARCHIVE_PAIR_FIELD_COUNT * HSF_ARCHIVE_WORD_SIZE;
+        uint64_t end = (uint64_t)HSFArchiveReadWord(_bytes, offset) + HSFArchiveReadWord(_bytes, offset + HSF_ARCHIVE_WORD_SIZE);
+        if (end > _stringDataLength) return NO;
+    }
+    for (NSUInteger i = 0; i < _attributeCount * HSF_ARCHIVE_PAIR_FIELD_COUNT; ++i){
+        if (HSFArchiveReadWord(_bytes, _attributeTableOffset + i * HSF_ARCHIVE_WORD_SIZE) >= _stringCount) return NO;
+    }
+
+    // Last child and number of children of every node seen so far.
+    uint32_t *lastChildren = malloc(_count * sizeof(uint32_t));
+    uint32_t *childCounts = calloc(_count, sizeof(uint32_t));
+    if (!lastChildren || !childCounts){
+        free(lastChildren);
+        free(childCounts);
+        return NO;
+    }
+    memset(lastChildren, 0xFF, _count * sizeof(uint32_t));
+
+    BOOL isValid = YES;
+    for (NSUInteger i = 0; i < _count && isValid; ++i){
+        uint32_t parent = [self wordOfNode:i field:HSFArchiveNodeParent];
+        uint32_t firstChild = [self wordOfNode:i field:HSFArchiveNodeFirstChild];
+        uint32_t nextSibling = [self wordOfNode:i field:HSFArchiveNodeNextSibling];
+        uint64_t attributeEnd = (uint64_t)[self wordOfNode:i field:HSFArchiveNodeFirstAttribute] + [self wordOfNode:i field:HSFArchiveNodeAttributeCount];
+        uint32_t subtreeEnd = [self wordOfNode:i field:HSFArchiveNodeSubtreeEnd];
+
+        // Name and value are absent if they are nil.
+        uint32_t name = [self wordOfNode:i field:HSFArchiveNodeName];
+        uint32_t value = [self wordOfNode:i field:HSFArchiveNodeValue];
+        isValid = (name < _stringCount || name == HSF_ARCHIVE_NONE)
+            && (value < _stringCount || value == HSF_ARCHIVE_NONE)
+            && attributeEnd <= _attributeCount
+            && subtreeEnd >= i && subtreeEnd < _count
+            && (firstChild == HSF_ARCHIVE_NONE ? subtreeEnd == i : (firstChild == i + 1 && subtreeEnd > i))
+            && (nextSibling == HSF_ARCHIVE_NONE || nextSibling == (uint64_t)subtreeEnd + 1);
+        if (!isValid) break;
+
+        if (i == 0){
+            isValid = parent == HSF_ARCHIVE_NONE && nextSibling == HSF_ARCHIVE_NONE && subtreeEnd == _count - 1;
+            continue;
+        }
+        // Parents precede children, and children of a parent are chained in order.
+        isValid = parent < i
+            && subtreeEnd <= [self wordOfNode:parent field:HSFArchiveNodeSubtreeEnd]
+            && [self wordOfNode:i field:HSFArchiveNodePosition] == childCounts[parent]
+            && (lastChildren[parent] == HSF_ARCHIVE_NONE ? [self wordOfNode:parent field:HSFArchiveNodeFirstChild] == i : [self wordOfNode:lastChildren[parent] field:HSFArchiveNodeNextSibling] == i);
+        lastChildren[parent] = (uint32_t)i;
+        ++childCounts[parent];
+    }
+    for (NSUInteger i = 0; i < _count && isValid; ++i){
+        isValid = lastChildren[i] == HSF_ARCHIVE_NONE ? [self wordOfNode:i field:HSFArchiveNodeFirstChild] == HSF_ARCHIVE_NONE : [self wordOfNode:lastChildren[i] field:HSFArchiveNodeNextSibling] == HSF_ARCHIVE_NONE;
+    }
+
+    free(lastChildren);
+    free(childCounts);
+    return isValid;
+}
+
+#pragma mark Class Methods
+
++(NSData*)archivedDataWithNode:(HSFNode*)node
+{
+    if (!node){
+        [NSException raise:NSInvalidArgumentException format:@"Node is nil."];
+    }
+    HSFNodeArchiveWriter *writer = [[HSFNodeArchiveWriter alloc] init];
+    [writer appendNode:node parent:HSF_ARCHIVE_NONE position:0];
+    return [writer archivedData];
+}
+
+@end
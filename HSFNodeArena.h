@@ -0,0 +1,57 @@
+//
+//  HSFNodeArena.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 16/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFNodeStorage.h"
+
+/*!
+ @abstract Compact storage of HSFNode tree parsed from XML document.
+ @discussion All nodes of an XML document are kept contiguously in one C array. Names, values and attributes are held as ranges of the document bytes, NSStrings are made only on demand. Node with index 0 is the root with name of ROOT_NODE_NAME macro, it is not a part of the document. Only nesting of tags is checked while parsing; entities, CDATA sections and attributes are handled the same way as NSXMLParser based tree does, but lazily.
+ */
+@interface HSFNodeArena : NSObject <HSFNodeStorage>
+
+/*!
+ @abstract XML document the arena refers to.
+ */
+@property (strong,nonatomic,readonly) NSData *data;
+
+/*!
+ @abstract Number of nodes, the root included.
+ */
+@property (nonatomic,readonly) NSUInteger count;
+
+/*!
+ @abstract Determine whether HSFNode tree backed by the arena was restructured.
+ */
+@property (nonatomic,getter=isTreeModified) BOOL treeModified;
+
+/*!
+ @abstract Symbol table to intern names and attribute keys when they are made.
+ */
+@property (strong,nonatomic) HSFSymbolTable *symbolTable;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @discussion Parses the document into the arena.
+ @param data XML document.
+ @param error Out parameter used if the document is not valid. May be NULL. Error domain will be HSFParseErrorDomain.
+ @return The initialized arena or nil if the document is not valid.
+ */
+-(id)initWithData:(NSData*)data error:(NSError**)error;
+
+/*!
+ @abstract Determine whether the arena can read the document.
+ @discussion The arena reads UTF-8 only. Documents with UTF-16 or UTF-32 byte order mark, without one but with zero bytes of such encodings, or with other encoding in XML declaration are not read.
+ @param data XML document.
+ @return YES if the document is in UTF-8 or US-ASCII.
+ */
++(BOOL)isUTF8Document:(NSData*)data;
+
+@end
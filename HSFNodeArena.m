@@ -0,0 +1,649 @@
+//
+//  HSFNodeArena.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 16/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFNodeArena.h"
+#import "HSFCommon.h"
+
+#define HSF_ARENA_INITIAL_CAPACITY 64
+#define HSF_UTF8_BOM "\xEF\xBB\xBF"
+// Attribute names of a start tag checked for duplicates without allocation.
+#define HSF_ARENA_LOCAL_ATTRIBUTES 16
+
+typedef struct {
+    // Bytes of the element, from '<' of the start tag to '>' of the end tag.
+    NSUInteger start;
+    NSUInteger end;
+    NSUInteger nameOffset;
+    NSUInteger nameLength;
+    // Bytes of the start tag between name and '>' or '/>'.
+    NSUInteger attributesOffset;
+    NSUInteger attributesLength;
+    // Bytes between start and end tags.
+    NSUInteger contentOffset;
+    NSUInteger contentLength;
+    NSUInteger parent;
+    NSUInteger firstChild;
+    NSUInteger lastChild;
+    NSUInteger nextSibling;
+    NSUInteger position;
+    NSUInteger childCount;
+    NSUInteger subtreeEnd;
+} HSFNodeArenaEntry;
+
+static inline BOOL HSFArenaIsWhitespace(unsigned char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/*
+ Bytes of XML names. Non-ASCII bytes are taken as name characters, as UTF-8 sequences of letters.
+ */
+static inline BOOL HSFArenaIsNameStartByte(unsigned char c)
+{
+    return c >= 0x80 || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+}
+
+static inline BOOL HSFArenaIsNameByte(unsigned char c)
+{
+    return HSFArenaIsNameStartByte(c) || (c >= '0' && c <= '9') || c == '-' || c == '.';
+}
+
+static inline BOOL HSFArenaIsCharacterCode(unsigned long code)
+{
+    return code == 0x9 || code == 0xA || code == 0xD || (code >= 0x20 && code <= 0xD7FF) || (code >= 0xE000 && code <= 0xFFFD) || (code >= 0x10000 && code <= 0x10FFFF);
+}
+
+@interface HSFNodeArena(){
+    HSFNodeArenaEntry *_entries;
+    NSUInteger _capacity;
+}
+
+@property (strong,nonatomic,readwrite) NSData *data;
+@property (nonatomic,readwrite) NSUInteger count;
+
+/*
+ Indexes of nodes by UTF-8 bytes of their names, made on the first search.
+ */
+@property (strong,nonatomic) NSDictionary *nameIndex;
+
+@end
+
+@implementation HSFNodeArena
+
+#pragma mark Public Methods
+
+-(id)initWithData:(NSData*)data error:(NSError**)error
+{
+    self = [super init];
+    if (self){
+        _data = data;
+        if (![self parseWithError:error]){
+            return nil;
+        }
+    }
+    return self;
+}
+
+-(id)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
+    return [super init];
+}
+
+-(void)dealloc
+{
+    free(_entries);
+}
+
+-(NSString*)nameAtIndex:(NSUInteger)index
+{
+    if (index == 0) return ROOT_NODE_NAME;
+    HSFNodeArenaEntry *entry = &_entries[index];
+    const char *name = (const char*)[self.data bytes] + entry->nameOffset;
+    if (self.symbolTable){
+        return [self.symbolTable symbolForBytes:name length:entry->nameLength];
+    }
+    return [[NSString alloc] initWithBytes:name length:entry->nameLength encoding:NSUTF8StringEncoding];
+}
+
+-(NSString*)valueAtIndex:(NSUInteger)index
+{
+    if (index == 0) return @"";
+
+    HSFNodeArenaEntry *entry = &_entries[index];
+    const unsigned char *bytes = [self.data bytes];
+    NSUInteger from = entry->contentOffset;
+    NSUInteger to = entry->contentOffset + entry->contentLength;
+
+    if (entry->childCount == 0 && ![self containsMarkupFrom:from to:to]){
+        return [[NSString alloc] initWithBytes:bytes + from length:to - from encoding:NSUTF8StringEncoding];
+    }
+
+    // Text of the node is what is left between children.
+    NSMutableString *value = [[NSMutableString alloc] init];
+    for (NSUInteger child = entry->firstChild; child != NSNotFound; child = _entries[child].nextSibling){
+        [self appendTextFrom:from to:_entries[child].start into:value];
+        from = _entries[child].end;
+    }
+    [self appendTextFrom:from to:to into:value];
+    return [value copy];
+}
+
+-(NSDictionary*)attributesAtIndex:(NSUInteger)index
+{
+    if (index == 0 || _entries[index].attributesLength == 0) return @{};
+
+    const unsigned char *bytes = [self.data bytes];
+    NSUInteger i = _entries[index].attributesOffset;
+    NSUInteger end = i + _entries[index].attributesLength;
+    NSMutableDictionary *attributes = [[NSMutableDictionary alloc] init];
+
+    while (i < end){
+        while (i < end && HSFArenaIsWhitespace(bytes[i])) ++i;
+        if (i >= end) break;
+
+        NSUInteger nameStart = i;
+        while (i < end && bytes[i] != '=' && !HSFArenaIsWhitespace(bytes[i])) ++i;
+        NSString *name;
+        if (self.symbolTable){
+            name = [self.symbolTable symbolForBytes:bytes + nameStart length:i - nameStart];
+        } else {
+            name = [[NSString alloc] initWithBytes:bytes + nameStart length:i - nameStart encoding:NSUTF8StringEncoding];
+        }
+
+        while (i < end && bytes[i] != '"' && bytes[i] != '\'') ++i;
+        if (i >= end) break;
+        unsigned char quote = bytes[i++];
+        NSUInteger valueStart = i;
+        while (i < end && bytes[i] != quote) ++i;
+
+        NSMutableString *value = [[NSMutableString alloc] init];
+        [self appendDecodedFrom:valueStart to:i normalizeWhitespace:YES into:value];
+        if (name) attributes[name] = [value copy];
+        ++i;
+    }
+    return [attributes copy];
+}
+
+-(NSUInteger)parentAtIndex:(NSUInteger)index
+{
+    return _entries[index].parent;
+}
+
+-(NSUInteger)firstChildAtIndex:(NSUInteger)index
+{
+    return _entries[index].firstChild;
+}
+
+-(NSUInteger)nextSiblingAtIndex:(NSUInteger)index
+{
+    return _entries[index].nextSibling;
+}
+
+-(NSUInteger)positionAtIndex:(NSUInteger)index
+{
+    return _entries[index].position;
+}
+
+-(NSUInteger)subtreeEndAtIndex:(NSUInteger)index
+{
+    return _entries[index].subtreeEnd;
+}
+
+-(NSUInteger)indexOfNodeByName:(NSString*)name inRange:(NSRange)range
+{
+    NSIndexSet *nodes = self.nameIndex[[name dataUsingEncoding:NSUTF8StringEncoding]];
+    if (!nodes) return NSNotFound;
+    NSUInteger found = [nodes indexGreaterThanOrEqualToIndex:range.location];
+    return found < NSMaxRange(range) ? found : NSNotFound;
+}
+
+-(NSUInteger)countOfNodesByName:(NSString*)name inSubtreeAtIndex:(NSUInteger)index
+{
+    NSIndexSet *nodes = self.nameIndex[[name dataUsingEncoding:NSUTF8StringEncoding]];
+    return [nodes countOfIndexesInRange:NSMakeRange(index, _entries[index].subtreeEnd - index + 1)];
+}
+
+#pragma mark Private Methods
+
+-(NSDictionary*)nameIndex
+{
+    @synchronized(self){
+        if (!_nameIndex){
+            NSMutableDictionary *nameIndex = [[NSMutableDictionary alloc] init];
+            const char *bytes = [self.data bytes];
+            for (NSUInteger i = 0; i < self.count; ++i){
+                NSData *name = i ? [NSData dataWithBytesNoCopy:(void*)(bytes + _entries[i].nameOffset) length:_entries[i].nameLength freeWhenDone:NO] : [ROOT_NODE_NAME dataUsingEncoding:NSUTF8StringEncoding];
+                NSMutableIndexSet *nodes = nameIndex[name];
+                if (!nodes){
+                    nodes = [[NSMutableIndexSet alloc] init];
+                    nameIndex[name] = nodes;
+                }
+                [nodes addIndex:i];
+            }
+            _nameIndex = [nameIndex copy];
+        }
+        return _nameIndex;
+    }
+}
+
+-(NSUInteger)addEntryWithParent:(NSUInteger)parent
+{
+    if (_count == _capacity){
+        _capacity = _capacity ? _capacity * 2 : HSF_ARENA_INITIAL_CAPACITY;
+        _entries = realloc(_entries, _capacity * sizeof(HSFNodeArenaEntry));
+    }
+
+    NSUInteger index = _count++;
+    HSFNodeArenaEntry *entry = &_entries[index];
+    memset(entry, 0, sizeof(HSFNodeArenaEntry));
+    entry->parent = parent;
+    entry->firstChild = NSNotFound;
+    entry->lastChild = NSNotFound;
+    entry->nextSibling = NSNotFound;
+    entry->subtreeEnd = index;
+
+    if (parent != NSNotFound){
+        HSFNodeArenaEntry *parentEntry = &_entries[parent];
+        if (parentEntry->lastChild != NSNotFound){
+            _entries[parentEntry->lastChild].nextSibling = index;
+        } else {
+            parentEntry->firstChild = index;
+        }
+        parentEntry->lastChild = index;
+        entry->position = parentEntry->childCount++;
+    }
+    return index;
+}
+
+/*
+ Index just after the pattern found from the given index, NSNotFound if there is no pattern.
+ */
+-(NSUInteger)indexAfterPattern:(const char*)pattern from:(NSUInteger)from
+{
+    const unsigned char *bytes = [self.data bytes];
+    NSUInteger length = [self.data length];
+    if (from >= length) return NSNotFound;
+    const unsigned char *found = memmem(bytes + from, length - from, pattern, strlen(pattern));
+    return found ? (found - bytes) + strlen(pattern) : NSNotFound;
+}
+
+-(BOOL)parseWithError:(NSError**)error
+{
+    const unsigned char *bytes = [self.data bytes];
+    NSUInteger length = [self.data length];
+
+    NSUInteger current = [self addEntryWithParent:NSNotFound];
+    _entries[current].end = length;
+    _entries[current].contentLength = length;
+    BOOL hasRoot = NO;
+
+    // Byte order mark may precede the document.
+    NSUInteger i = (length >= 3 && memcmp(bytes, HSF_UTF8_BOM, 3) == 0) ? 3 : 0;
+    while (i < length){
+        if (bytes[i] != '<'){
+            const unsigned char *next = memchr(bytes + i, '<', length - i);
+            NSUInteger end = next ? (NSUInteger)(next - bytes) : length;
+            if (current == 0){
+                // Only whitespace is allowed out of document element.
+                for (; i < end; ++i){
+                    if (!HSFArenaIsWhitespace(bytes[i])) return [self failAtIndex:i error:error];
+                }
+            } else if (![self areReferencesValidFrom:i to:end]){
+                return [self failAtIndex:i error:error];
+            }
+            i = end;
+            continue;
+        }
+
+        NSUInteger rest = length - i;
+        if (rest >= 2 && bytes[i+1] == '?'){
+            i = [self indexAfterPattern:"?>" from:i + 2];
+        } else if (rest >= 4 && memcmp(bytes + i, "<!--", 4) == 0){
+            i = [self indexAfterPattern:"-->" from:i + 4];
+        } else if (rest >= 9 && memcmp(bytes + i, "<![CDATA[", 9) == 0){
+            if (current == 0) return [self failAtIndex:i error:error];
+            i = [self indexAfterPattern:"]]>" from:i + 9];
+        } else if (rest >= 2 && bytes[i+1] == '!'){
+            // Document type declaration, possibly with internal subset.
+            if (current != 0 || hasRoot) return [self failAtIndex:i error:error];
+            NSUInteger j = i + 2;
+            NSUInteger brackets = 0;
+            unsigned char quote = 0;
+            for (; j < length; ++j){
+                unsigned char c = bytes[j];
+                if (quote){
+                    if (c == quote) quote = 0;
+                } else if (c == '"' || c == '\''){
+                    quote = c;
+                } else if (c == '['){
+                    ++brackets;
+                } else if (c == ']' && brackets){
+                    --brackets;
+                } else if (c == '>' && !brackets){
+                    break;
+                }
+            }
+            i = (j < length) ? j + 1 : NSNotFound;
+        } else if (rest >= 2 && bytes[i+1] == '/'){
+            NSUInteger nameStart = i + 2;
+            NSUInteger j = nameStart;
+            while (j < length && bytes[j] != '>' && !HSFArenaIsWhitespace(bytes[j])) ++j;
+            HSFNodeArenaEntry *entry = &_entries[current];
+            if (current == 0 || j - nameStart != entry->nameLength || memcmp(bytes + nameStart, bytes + entry->nameOffset, entry->nameLength) != 0){
+                return [self failAtIndex:i error:error];
+            }
+            while (j < length && HSFArenaIsWhitespace(bytes[j])) ++j;
+            if (j >= length || bytes[j] != '>') return [self failAtIndex:i error:error];
+
+            entry->contentLength = i - entry->contentOffset;
+            entry->end = j + 1;
+            entry->subtreeEnd = _count - 1;
+            current = entry->parent;
+            i = j + 1;
+        } else {
+            if (current == 0 && hasRoot) return [self failAtIndex:i error:error];
+
+            NSUInteger nameStart = i + 1;
+            NSUInteger j = nameStart;
+            if (j >= length || !HSFArenaIsNameStartByte(bytes[j])) return [self failAtIndex:i error:error];
+            while (j < length && HSFArenaIsNameByte(bytes[j])) ++j;
+            NSUInteger attributesStart = j;
+            j = [self indexOfTagEndFrom:attributesStart];
+            if (j == NSNotFound) return [self failAtIndex:i error:error];
+            BOOL isEmptyElement = (j > attributesStart && bytes[j-1] == '/');
+
+            NSUInteger index = [self addEntryWithParent:current];
+            HSFNodeArenaEntry *entry = &_entries[index];
+            entry->start = i;
+            entry->nameOffset = nameStart;
+            entry->nameLength = attributesStart - nameStart;
+            entry->attributesOffset = attributesStart;
+            entry->attributesLength = (isEmptyElement ? j - 1 : j) - attributesStart;
+            entry->contentOffset = j + 1;
+            if (isEmptyElement){
+                entry->end = j + 1;
+            } else {
+                current = index;
+            }
+            if (entry->parent == 0) hasRoot = YES;
+            i = j + 1;
+        }
+
+        if (i == NSNotFound) return [self failAtIndex:length error:error];
+    }
+
+    if (current != 0 || !hasRoot) return [self failAtIndex:length error:error];
+    _entries[0].subtreeEnd = _count - 1;
+    return YES;
+}
+
+/*
+ Check attributes of a start tag, from the end of its name. Every attribute is a name, '=' and a quoted value after whitespace, names are unique and values have no '<' and only valid references, as NSXMLParser requires. Returns index of '>' which ends the tag, NSNotFound if the tag is not well-formed.
+ */
+-(NSUInteger)indexOfTagEndFrom:(NSUInteger)from
+{
+    const unsigned char *bytes = [self.data bytes];
+    NSUInteger length = [self.data length];
+    NSRange localNames[HSF_ARENA_LOCAL_ATTRIBUTES];
+    NSRange *names = localNames;
+    NSUInteger capacity = HSF_ARENA_LOCAL_ATTRIBUTES;
+    NSUInteger count = 0;
+    NSUInteger tagEnd = NSNotFound;
+    NSUInteger i = from;
+
+    while (i < length){
+        NSUInteger spaceStart = i;
+        while (i < length && HSFArenaIsWhitespace(bytes[i])) ++i;
+        if (i >= length) break;
+        if (bytes[i] == '>'){
+            tagEnd = i;
+            break;
+        }
+        if (bytes[i] == '/'){
+            if (i + 1 < length && bytes[i+1] == '>') tagEnd = i + 1;
+            break;
+        }
+        if (i == spaceStart || !HSFArenaIsNameStartByte(bytes[i])) break;
+
+        NSUInteger nameStart = i;
+        while (i < length && HSFArenaIsNameByte(bytes[i])) ++i;
+        NSRange name = NSMakeRange(nameStart, i - nameStart);
+        BOOL isDuplicate = NO;
+        for (NSUInteger k = 0; k < count && !isDuplicate; ++k){
+            isDuplicate = names[k].length == name.length && memcmp(bytes + names[k].location, bytes + name.location, name.length) == 0;
+        }
+        if (isDuplicate) break;
+        if (count == capacity){
+            capacity *= 2;
+            if (names == localNames){
+                names = malloc(capacity * sizeof(NSRange));
+                memcpy(names, localNames, count * sizeof(NSRange));
+            } else {
+                names = realloc(names, capacity * sizeof(NSRange));
+            }
+        }
+        names[count++] = name;
+
+        while (i < length && HSFArenaIsWhitespace(bytes[i])) ++i;
+        if (i >= length || bytes[i] != '=') break;
+        ++i;
+        while (i < length && HSFArenaIsWhitespace(bytes[i])) ++i;
+        if (i >= length || (bytes[i] != '"' && bytes[i] != '\'')) break;
+        unsigned char quote = bytes[i++];
+        const unsigned char *close = memchr(bytes + i, quote, length - i);
+        if (!close) break;
+        NSUInteger valueEnd = close - bytes;
+        if (memchr(bytes + i, '<', valueEnd - i) || ![self areReferencesValidFrom:i to:valueEnd]) break;
+        i = valueEnd + 1;
+    }
+
+    if (names != localNames) free(names);
+    return tagEnd;
+}
+
+/*
+ Every '&' must start a predefined entity or a character reference. SOAP messages have no document type declaration, so no other entity can be declared and NSXMLParser fails on it.
+ */
+-(BOOL)areReferencesValidFrom:(NSUInteger)from to:(NSUInteger)to
+{
+    const unsigned char *bytes = [self.data bytes];
+    const unsigned char *end = bytes + to;
+    const unsigned char *p = bytes + from;
+    while (p < end && (p = memchr(p, '&', end - p))){
+        const unsigned char *q = p + 1;
+        if (q < end && *q == '#'){
+            ++q;
+            BOOL isHex = (q < end && *q == 'x');
+            if (isHex) ++q;
+            const unsigned char *digits = q;
+            unsigned long code = 0;
+            for (; q < end; ++q){
+                unsigned char c = *q;
+                unsigned long digit;
+                if (c >= '0' && c <= '9'){
+                    digit = c - '0';
+                } else if (isHex && ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')){
+                    digit = (c | 0x20) - 'a' + 10;
+                } else {
+                    break;
+                }
+                code = code * (isHex ? 16 : 10) + digit;
+                if (code > 0x10FFFF) return NO;
+            }
+            if (q == digits || !HSFArenaIsCharacterCode(code)) return NO;
+        } else {
+            const unsigned char *name = q;
+            while (q < end && HSFArenaIsNameByte(*q)) ++q;
+            size_t nameLength = q - name;
+            BOOL isPredefined = (nameLength == 2 && (memcmp(name, "lt", 2) == 0 || memcmp(name, "gt", 2) == 0))
+                || (nameLength == 3 && memcmp(name, "amp", 3) == 0)
+                || (nameLength == 4 && (memcmp(name, "quot", 4) == 0 || memcmp(name, "apos", 4) == 0));
+            if (!isPredefined) return NO;
+        }
+        if (q >= end || *q != ';') return NO;
+        p = q + 1;
+    }
+    return YES;
+}
+
+-(BOOL)failAtIndex:(NSUInteger)index error:(NSError**)error
+{
+#ifdef DEBUG
+    NSLog(@"[%@ %@] ERROR at byte %lu, XML: %@",[self class],NSStringFromSelector(_cmd),(unsigned long)index,[[NSString alloc] initWithData:self.data encoding:NSUTF8StringEncoding]);
+#endif
+    if (error != NULL){
+        NSDictionary *userInfo = @{NSLocalizedDescriptionKey:HSF_ERROR_MESSAGE_XML_PARSE_ERROR};
+        *error = [NSError errorWithDomain:HSFParseErrorDomain code:HSF_ERROR_CODE_XML_PARSE_ERROR userInfo:userInfo];
+    }
+    return NO;
+}
+
+-(BOOL)containsMarkupFrom:(NSUInteger)from to:(NSUInteger)to
+{
+    const unsigned char *bytes = [self.data bytes];
+    for (NSUInteger i = from; i < to; ++i){
+        unsigned char c = bytes[i];
+        if (c == '<' || c == '&' || c == '\r') return YES;
+    }
+    return NO;
+}
+
+/*
+ Append text skipping comments, CDATA sections and processing instructions, as NSXMLParser based tree does.
+ */
+-(void)appendTextFrom:(NSUInteger)from to:(NSUInteger)to into:(NSMutableString*)string
+{
+    const unsigned char *bytes = [self.data bytes];
+    while (from < to){
+        const unsigned char *next = memchr(bytes + from, '<', to - from);
+        NSUInteger end = next ? (NSUInteger)(next - bytes) : to;
+        [self appendDecodedFrom:from to:end normalizeWhitespace:NO into:string];
+        if (end >= to) break;
+
+        const char *terminator = ">";
+        if (to - end >= 4 && memcmp(bytes + end, "<!--", 4) == 0){
+            terminator = "-->";
+        } else if (to - end >= 9 && memcmp(bytes + end, "<![CDATA[", 9) == 0){
+            terminator = "]]>";
+        } else if (to - end >= 2 && bytes[end+1] == '?'){
+            terminator = "?>";
+        }
+        NSUInteger after = [self indexAfterPattern:terminator from:end + 1];
+        from = (after == NSNotFound || after > to) ? to : after;
+    }
+}
+
+/*
+ Append bytes decoding entities and normalizing line endings. Attribute values have whitespace normalized.
+ */
+-(void)appendDecodedFrom:(NSUInteger)from to:(NSUInteger)to normalizeWhitespace:(BOOL)normalizeWhitespace into:(NSMutableString*)string
+{
+    const unsigned char *bytes = [self.data bytes];
+    NSUInteger plain = from;
+    NSUInteger i = from;
+
+    while (i < to){
+        unsigned char c = bytes[i];
+        if (c != '&' && c != '\r' && !(normalizeWhitespace && (c == '\n' || c == '\t'))){
+            ++i;
+            continue;
+        }
+
+        if (i > plain){
+            NSString *segment = [[NSString alloc] initWithBytes:bytes + plain length:i - plain encoding:NSUTF8StringEncoding];
+            if (segment) [string appendString:segment];
+        }
+
+        if (c == '&'){
+            NSUInteger consumed = 0;
+            NSString *character = [self characterForEntityAtIndex:i to:to consumed:&consumed];
+            [string appendString:character];
+            i += consumed;
+        } else {
+            if (c == '\r' && i + 1 < to && bytes[i+1] == '\n') ++i;
+            [string appendString:normalizeWhitespace ? @" " : @"\n"];
+            ++i;
+        }
+        plain = i;
+    }
+
+    if (to > plain){
+        NSString *segment = [[NSString alloc] initWithBytes:bytes + plain length:to - plain encoding:NSUTF8StringEncoding];
+        if (segment) [string appendString:segment];
+    }
+}
+
+-(NSString*)characterForEntityAtIndex:(NSUInteger)index to:(NSUInteger)to consumed:(NSUInteger*)consumed
+{
+    const unsigned char *bytes = [self.data bytes];
+    const unsigned char *semicolon = memchr(bytes + index, ';', MIN(to - index, (NSUInteger)12));
+    if (!semicolon){
+        *consumed = 1;
+        return @"&";
+    }
+
+    NSUInteger length = semicolon - (bytes + index) + 1;
+    NSString *entity = [[NSString alloc] initWithBytes:bytes + index + 1 length:length - 2 encoding:NSUTF8StringEncoding];
+    *consumed = length;
+
+    if ([entity isEqualToString:@"lt"]) return @"<";
+    if ([entity isEqualToString:@"gt"]) return @">";
+    if ([entity isEqualToString:@"amp"]) return @"&";
+    if ([entity isEqualToString:@"quot"]) return @"\"";
+    if ([entity isEqualToString:@"apos"]) return @"'";
+
+    if ([entity hasPrefix:@"#"]){
+        unsigned long code;
+        if ([entity hasPrefix:@"#x"] || [entity hasPrefix:@"#X"]){
+            code = strtoul([[entity substringFromIndex:2] UTF8String], NULL, 16);
+        } else {
+            code = strtoul([[entity substringFromIndex:1] UTF8String], NULL, 10);
+        }
+        if (code > 0 && code <= 0x10FFFF){
+            UTF32Char character = CFSwapInt32HostToLittle((UTF32Char)code);
+            NSString *result = [[NSString alloc] initWithBytes:&character length:sizeof(character) encoding:NSUTF32LittleEndianStringEncoding];
+            if (result) return result;
+        }
+    }
+
+    // Unknown entity is left as it is.
+    *consumed = 1;
+    return @"&";
+}
+
+#pragma mark Class Methods
+
++(BOOL)isUTF8Document:(NSData*)data
+{
+    const unsigned char *bytes = [data bytes];
+    NSUInteger length = [data length];
+    if (length >= 3 && memcmp(bytes, HSF_UTF8_BOM, 3) == 0) return YES;
+    if (length >= 2 && ((bytes[0] == 0xFE && bytes[1] == 0xFF) || (bytes[0] == 0xFF && bytes[1] == 0xFE))) return NO;
+    if (length >= 2 && (bytes[0] == 0 || bytes[1] == 0)) return NO;
+
+    // Without declaration of encoding the document is UTF-8.
+    if (length < 5 || memcmp(bytes, "<?xml", 5) != 0) return YES;
+    const unsigned char *end = memmem(bytes, length, "?>", 2);
+    if (!end) return YES;
+    NSString *declaration = [[NSString alloc] initWithBytes:bytes length:end - bytes encoding:NSASCIIStringEncoding];
+    if (!declaration) return NO;
+    NSRange range = [declaration rangeOfString:@"encoding"];
+    if (range.location == NSNotFound) return YES;
+
+    NSScanner *scanner = [NSScanner scannerWithString:[declaration substringFromIndex:NSMaxRange(range)]];
+    NSCharacterSet *quotes = [NSCharacterSet characterSetWithCharactersInString:@"\"'"];
+    NSString *encoding;
+    [scanner scanString:@"=" intoString:NULL];
+    [scanner scanCharactersFromSet:quotes intoString:NULL];
+    if (![scanner scanUpToCharactersFromSet:quotes intoString:&encoding]) return NO;
+    encoding = [encoding lowercaseString];
+    return [encoding isEqualToString:@"utf-8"] || [encoding isEqualToString:@"utf8"] || [encoding isEqualToString:@"us-ascii"];
+}
+
+@end
@@ -0,0 +1,36 @@
+//
+//  HSFNodeDictionary.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFNode.h"
+
+/*!
+ @abstract Read-only dictionary view of node's children.
+ @discussion Keys are names of the children. Value of a child without children is its value string, otherwise it is another HSFNodeDictionary. Repeated siblings are returned as NSArray of such values in document order. Nothing is converted until a key is accessed; the children are indexed by name on first access, and converted values are cached, so repeated access costs O(1). The view keeps the node alive. The tree must not be modified while the view is in use. Thread safe.
+ */
+@interface HSFNodeDictionary : NSDictionary
+
+/*!
+ @abstract Node the dictionary is backed by.
+ */
+@property (strong,nonatomic,readonly) HSFNode *node;
+
+/*!
+ @abstract Designated initializer.
+ @param node Node whose children are the entries. Must not be nil.
+ @return The initialized dictionary.
+ */
+-(id)initWithNode:(HSFNode*)node;
+
+/*!
+ @abstract Value of node in dictionary view.
+ @return Value string of the node without children, HSFNodeDictionary otherwise.
+ */
++(id)valueOfNode:(HSFNode*)node;
+
+@end
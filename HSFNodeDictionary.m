@@ -0,0 +1,132 @@
+//
+//  HSFNodeDictionary.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFNodeDictionary.h"
+
+@interface HSFNodeDictionary()
+
+@property (strong,nonatomic,readwrite) HSFNode *node;
+
+/*
+ Children by name, HSFNode for a single child and NSMutableArray of nodes for repeated ones.
+ */
+@property (strong,nonatomic) NSMutableDictionary *childrenByName;
+
+/*
+ Names of the children in document order of their first occurrence.
+ */
+@property (strong,nonatomic) NSMutableArray *keys;
+
+/*
+ Converted values by key.
+ */
+@property (strong,nonatomic) NSMutableDictionary *values;
+
+@end
+
+@implementation HSFNodeDictionary
+
+#pragma mark Properties
+
+-(NSMutableDictionary*)childrenByName
+{
+    if (!_childrenByName){
+        _childrenByName = [[NSMutableDictionary alloc] init];
+        _keys = [[NSMutableArray alloc] init];
+        for (HSFNode *child in self.node){
+            id children = _childrenByName[child.name];
+            if (!children){
+                _childrenByName[child.name] = child;
+                [_keys addObject:child.name];
+            } else if ([children isKindOfClass:[NSMutableArray class]]){
+                [children addObject:child];
+            } else {
+                _childrenByName[child.name] = [NSMutableArray arrayWithObjects:children,child,nil];
+            }
+        }
+    }
+    return _childrenByName;
+}
+
+-(NSMutableDictionary*)values
+{
+    if(!_values)_values = [[NSMutableDictionary alloc] init];
+    return _values;
+}
+
+#pragma mark Public Methods
+
+-(id)initWithNode:(HSFNode*)node
+{
+    if (!node){
+        [NSException raise:NSInvalidArgumentException format:@"Node is nil."];
+    }
+    self = [super init];
+    if (self){
+        _node = node;
+    }
+    return self;
+}
+
+-(id)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
+    return nil;
+}
+
+-(NSUInteger)count
+{
+    @synchronized(self){
+        return [self.childrenByName count];
+    }
+}
+
+-(id)objectForKey:(id)key
+{
+    @synchronized(self){
+        id value = self.values[key];
+        if (value) return value;
+
+        id children = self.childrenByName[key];
+        if (!children) return nil;
+        if ([children isKindOfClass:[NSArray class]]){
+            NSMutableArray *array = [[NSMutableArray alloc] initWithCapacity:[children count]];
+            for (HSFNode *child in children){
+                [array addObject:[[self class] valueOfNode:child]];
+            }
+            value = [array copy];
+        } else {
+            value = [[self class] valueOfNode:children];
+        }
+        self.values[key] = value;
+        return value;
+    }
+}
+
+-(NSEnumerator*)keyEnumerator
+{
+    @synchronized(self){
+        [self childrenByName];
+        return [[self.keys copy] objectEnumerator];
+    }
+}
+
+-(id)copyWithZone:(NSZone *)zone
+{
+    // Immutable.
+    return self;
+}
+
+#pragma mark Class Methods
+
++(id)valueOfNode:(HSFNode*)node
+{
+    return node.childCount ? [[self alloc] initWithNode:node] : node.value;
+}
+
+@end
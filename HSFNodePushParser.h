@@ -0,0 +1,55 @@
+//
+//  HSFNodePushParser.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 14/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFNode.h"
+#import "HSFSymbolTable.h"
+
+/*!
+ @abstract Push parser of HSFNode tree.
+ @discussion Unlike nodeTreeFromData:error: this parser is fed with chunks of XML document as they come, so the tree grows while a response is still downloading and the document itself need not be kept in memory. The tree is the same as one made by nodeTreeFromData:error:, except root's treeData which is nil. Based on libxml2 push parser, so the application must be linked with libxml2.
+ */
+@interface HSFNodePushParser : NSObject
+
+/*!
+ @abstract Root node of the tree being built.
+ @discussion Root node with name of ROOT_NODE_NAME macro. Note that this root node itself is not a part of the XML document.
+ */
+@property (strong,nonatomic,readonly) HSFNode *rootNode;
+
+/*!
+ @abstract Parse error.
+ @discussion Set as soon as the parser meets an error, in HSFParseErrorDomain. Subsequent chunks are ignored.
+ */
+@property (strong,nonatomic,readonly) NSError *parseError;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @param symbolTable Symbol table to intern element names and attribute keys. May be nil.
+ @return The initialized parser.
+ */
+-(id)initWithSymbolTable:(HSFSymbolTable*)symbolTable;
+
+/*!
+ @abstract Parse next chunk of the document.
+ @param data Next chunk of XML document.
+ @return NO if the document turned out to be invalid, see parseError.
+ */
+-(BOOL)parseData:(NSData*)data;
+
+/*!
+ @abstract Finish parsing.
+ @discussion Tells the parser that the document is over. The parser can't be used after this call.
+ @param error Out parameter used if an error occurs while parsing the data. May be NULL. Error domain will be HSFParseErrorDomain.
+ @return Root node of the tree, see rootNode.
+ */
+-(HSFNode*)finishWithError:(NSError**)error;
+
+@end
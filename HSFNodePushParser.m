@@ -0,0 +1,194 @@
+//
+//  HSFNodePushParser.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 14/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFNodePushParser.h"
+#import "HSFNode+Parsing.h"
+#import "HSFCommon.h"
+#import <libxml/parser.h>
+
+@interface HSFNodePushParser(){
+    xmlParserCtxtPtr _context;
+}
+
+@property (strong,nonatomic,readwrite) HSFNode *rootNode;
+@property (strong,nonatomic,readwrite) NSError *parseError;
+
+/*
+ Node which receives characters and children.
+ */
+@property (strong,nonatomic) HSFNode *currentNode;
+
+@property (strong,nonatomic) HSFSymbolTable *symbolTable;
+
+-(void)startElement:(const xmlChar*)name attributes:(const xmlChar**)attributes;
+-(void)endElement;
+-(void)foundCharacters:(const xmlChar*)characters length:(int)length;
+-(void)errorOccurred:(xmlErrorPtr)error;
+-(NSString*)stringForName:(const xmlChar*)name;
+
+@end
+
+#pragma mark libxml2 SAX callbacks
+
+static void HSFPushParserStartElement(void *context, const xmlChar *name, const xmlChar **attributes)
+{
+    [(__bridge HSFNodePushParser*)context startElement:name attributes:attributes];
+}
+
+static void HSFPushParserEndElement(void *context, const xmlChar *name)
+{
+    [(__bridge HSFNodePushParser*)context endElement];
+}
+
+static void HSFPushParserCharacters(void *context, const xmlChar *characters, int length)
+{
+    [(__bridge HSFNodePushParser*)context foundCharacters:characters length:length];
+}
+
+static void HSFPushParserCDATABlock(void *context, const xmlChar *characters, int length)
+{
+    // NSXMLParser based nodeTreeFromData:error: ignores CDATA, trees must be the same.
+}
+
+static void HSFPushParserError(void *context, xmlErrorPtr error)
+{
+    [(__bridge HSFNodePushParser*)context errorOccurred:error];
+}
+
+@implementation HSFNodePushParser
+
+#pragma mark Public Methods
+
+-(id)initWithSymbolTable:(HSFSymbolTable*)symbolTable
+{
+    self = [super init];
+    if (self){
+        _symbolTable = symbolTable;
+        _rootNode = [[HSFNode alloc] initWithName:ROOT_NODE_NAME];
+        [_rootNode beginNameIndex];
+        _currentNode = _rootNode;
+
+        xmlSAXHandler handler;
+        memset(&handler, 0, sizeof(xmlSAXHandler));
+        // Only startElement/endElement (SAX1) are set, so names are qualified as NSXMLParser reports them.
+        handler.initialized = XML_SAX2_MAGIC;
+        handler.startElement = HSFPushParserStartElement;
+        handler.endElement = HSFPushParserEndElement;
+        handler.characters = HSFPushParserCharacters;
+        handler.ignorableWhitespace = HSFPushParserCharacters;
+        handler.cdataBlock = HSFPushParserCDATABlock;
+        handler.serror = HSFPushParserError;
+
+        _context = xmlCreatePushParserCtxt(&handler, (__bridge void*)self, NULL, 0, NULL);
+        xmlCtxtUseOptions(_context, XML_PARSE_NONET);
+    }
+    return self;
+}
+
+-(id)init
+{
+    return [self initWithSymbolTable:nil];
+}
+
+-(void)dealloc
+{
+    if (_context){
+        xmlFreeParserCtxt(_context);
+    }
+}
+
+-(BOOL)parseData:(NSData*)data
+{
+    if (!_context){
+        [NSException raise:NSInternalInconsistencyException format:@"Parser is finished."];
+    }
+    if (self.parseError) return NO;
+
+    const char *bytes = [data bytes];
+    NSUInteger length = [data length];
+    while (length > 0 && !self.parseError){
+        int size = (length > INT_MAX) ? INT_MAX : (int)length;
+        xmlParseChunk(_context, bytes, size, 0);
+        bytes += size;
+        length -= size;
+    }
+    return self.parseError == nil;
+}
+
+-(HSFNode*)finishWithError:(NSError**)error
+{
+    if (_context){
+        if (!self.parseError){
+            xmlParseChunk(_context, NULL, 0, 1);
+        }
+        xmlFreeParserCtxt(_context);
+        _context = NULL;
+    }
+    self.currentNode = nil;
+
+    if (error != NULL){
+        *error = self.parseError;
+    }
+    return self.rootNode;
+}
+
+#pragma mark Private Methods
+
+-(void)startElement:(const xmlChar*)name attributes:(const xmlChar**)attributes
+{
+    HSFNode *node = [[HSFNode alloc] initWithName:[self stringForName:name]];
+
+    if (attributes){
+        NSMutableDictionary *attributeDict = [[NSMutableDictionary alloc] init];
+        for (NSUInteger i = 0; attributes[i]; i += 2){
+            NSString *value = attributes[i+1] ? [NSString stringWithUTF8String:(const char*)attributes[i+1]] : @"";
+            attributeDict[[self stringForName:attributes[i]]] = value;
+        }
+        node.attributes = [attributeDict copy];
+    }
+
+    [self.currentNode addIndexedChild:node];
+    self.currentNode = node;
+}
+
+-(void)endElement
+{
+    [self.currentNode endIndexedNode];
+    if (self.currentNode.parent){
+        self.currentNode = self.currentNode.parent;
+    }
+}
+
+-(void)foundCharacters:(const xmlChar*)characters length:(int)length
+{
+    NSString *string = [[NSString alloc] initWithBytes:characters length:length encoding:NSUTF8StringEncoding];
+    [self.currentNode appendParsedText:string];
+}
+
+-(NSString*)stringForName:(const xmlChar*)name
+{
+    if (self.symbolTable){
+        return [self.symbolTable symbolForBytes:name length:strlen((const char*)name)];
+    }
+    return [NSString stringWithUTF8String:(const char*)name];
+}
+
+-(void)errorOccurred:(xmlErrorPtr)error
+{
+    if (error->level != XML_ERR_FATAL || self.parseError) return;
+
+    NSString *message = error->message ? [NSString stringWithUTF8String:error->message] : HSF_ERROR_MESSAGE_XML_PARSE_ERROR;
+    NSDictionary *userInfo = @{NSLocalizedDescriptionKey:message};
+#ifdef DEBUG
+    NSLog(@"[%@ %@] ERROR: %@, line: %d",[self class],NSStringFromSelector(_cmd),message,error->line);
+#endif
+    self.parseError = [NSError errorWithDomain:HSFParseErrorDomain code:error->code userInfo:userInfo];
+    xmlStopParser(_context);
+}
+
+@end
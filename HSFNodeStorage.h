@@ -0,0 +1,89 @@
+//
+//  HSFNodeStorage.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFSymbolTable.h"
+
+/*!
+ @abstract Compact storage of HSFNode tree.
+ @discussion Nodes are addressed by index. Node with index 0 is the root, other nodes follow in document order, so a subtree is a contiguous range of indexes. HSFNode objects backed by a storage are created lazily as the tree is traversed, and their strings are made on first access. Implemented by HSFNodeArena, which refers to XML document, and HSFNodeArchive, which refers to binary archive.
+ */
+@protocol HSFNodeStorage <NSObject>
+
+/*!
+ @abstract Number of nodes, the root included.
+ */
+@property (nonatomic,readonly) NSUInteger count;
+
+/*!
+ @abstract Determine whether HSFNode tree backed by the storage was restructured.
+ @discussion Searches are performed on the storage only while the tree is not modified by addChild:.
+ */
+@property (nonatomic,getter=isTreeModified) BOOL treeModified;
+
+/*!
+ @abstract Symbol table to intern names and attribute keys when they are made.
+ */
+@property (strong,nonatomic) HSFSymbolTable *symbolTable;
+
+/*!
+ @abstract Name of the node.
+ */
+-(NSString*)nameAtIndex:(NSUInteger)index;
+
+/*!
+ @abstract Value of the node.
+ @discussion Concatenated text of the node, children are not included. Entities are decoded. nil if the node has no value.
+ */
+-(NSString*)valueAtIndex:(NSUInteger)index;
+
+/*!
+ @abstract Attributes of the node.
+ */
+-(NSDictionary*)attributesAtIndex:(NSUInteger)index;
+
+/*!
+ @abstract Parent of the node, NSNotFound for the root.
+ */
+-(NSUInteger)parentAtIndex:(NSUInteger)index;
+
+/*!
+ @abstract First child of the node, NSNotFound if there are no children.
+ */
+-(NSUInteger)firstChildAtIndex:(NSUInteger)index;
+
+/*!
+ @abstract Next sibling of the node, NSNotFound if it is the last one.
+ */
+-(NSUInteger)nextSiblingAtIndex:(NSUInteger)index;
+
+/*!
+ @abstract Position of the node among children of its parent.
+ */
+-(NSUInteger)positionAtIndex:(NSUInteger)index;
+
+/*!
+ @abstract Last index of the subtree of the node.
+ */
+-(NSUInteger)subtreeEndAtIndex:(NSUInteger)index;
+
+/*!
+ @abstract Search range of indexes for node with specified name.
+ @discussion Returns the first node of the range in document order. HSFNode's searchNodeByName: builds its search order on it. Strings are not made.
+ @param name Name of an element to search.
+ @param range Range of node indexes.
+ @return Index of found node or NSNotFound.
+ */
+-(NSUInteger)indexOfNodeByName:(NSString*)name inRange:(NSRange)range;
+
+/*!
+ @abstract Count of nodes with specified name in subtree, the node itself included.
+ */
+-(NSUInteger)countOfNodesByName:(NSString*)name inSubtreeAtIndex:(NSUInteger)index;
+
+@end
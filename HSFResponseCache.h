@@ -0,0 +1,108 @@
+//
+//  HSFResponseCache.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 24/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Cache of raw responses.
+ @discussion Responses are kept in two tiers: memory, limited by memoryCapacity and evicted in least recently used order, and disk, which survives relaunches. Every response has its own expiration date. Thread safe.
+ */
+@interface HSFResponseCache : NSObject
+
+/*!
+ @abstract Maximum number of bytes kept in memory.
+ @discussion Default value is HSF_RESPONSE_CACHE_MEMORY_CAPACITY.
+ */
+@property (nonatomic) NSUInteger memoryCapacity;
+
+/*!
+ @abstract Number of bytes kept in memory.
+ */
+@property (nonatomic,readonly) NSUInteger memoryUsage;
+
+/*!
+ @abstract Directory of disk tier.
+ */
+@property (strong,nonatomic,readonly) NSString *path;
+
+/*!
+ @abstract Number of lookups answered from memory.
+ */
+@property (nonatomic,readonly) NSUInteger memoryHitCount;
+
+/*!
+ @abstract Number of lookups answered from disk.
+ */
+@property (nonatomic,readonly) NSUInteger diskHitCount;
+
+/*!
+ @abstract Number of lookups which found nothing or expired response.
+ */
+@property (nonatomic,readonly) NSUInteger missCount;
+
+/*!
+ @abstract Number of responses evicted from memory to fit memoryCapacity.
+ */
+@property (nonatomic,readonly) NSUInteger evictionCount;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @param path Directory of disk tier, created if needed. nil means memory tier only.
+ @return The initialized cache.
+ */
+-(id)initWithPath:(NSString*)path;
+
+/*!
+ @abstract Response which is not expired.
+ @discussion A response found on disk is moved to memory.
+ @param key Key made by keyForRequest:actionClass:.
+ @return Response or nil.
+ */
+-(NSData*)dataForKey:(NSString*)key;
+
+/*!
+ @abstract Store response.
+ @discussion Disk is written asynchronously.
+ @param data Response.
+ @param key Key made by keyForRequest:actionClass:.
+ @param lifetime Seconds the response is valid.
+ */
+-(void)storeData:(NSData*)data forKey:(NSString*)key lifetime:(NSTimeInterval)lifetime;
+
+/*!
+ @abstract Remove response from both tiers.
+ */
+-(void)removeDataForKey:(NSString*)key;
+
+/*!
+ @abstract Remove all responses from both tiers.
+ */
+-(void)removeAllData;
+
+/*!
+ @abstract Canonical key of request.
+ @discussion The same as keyForRequest:actionClass:credential: with nil credential.
+ @param request Request of an action.
+ @param actionClass Class of the action.
+ @return The key.
+ */
++(NSString*)keyForRequest:(NSURLRequest*)request actionClass:(Class)actionClass;
+
+/*!
+ @abstract Canonical key of request made on behalf of a user.
+ @discussion Made of action class, URL, SOAPAction header, SHA-256 of the body and SHA-256 of the identity: credential user and password and all HTTP header fields, so Authorization, cookies and session token headers of different users never share a response. Certificate credentials can't be keyed, nil is returned for them and the response must not be cached.
+ @param request Request of an action.
+ @param actionClass Class of the action.
+ @param credential Credential the request is authenticated with. May be nil.
+ @return The key, or nil if the request can't be cached.
+ */
++(NSString*)keyForRequest:(NSURLRequest*)request actionClass:(Class)actionClass credential:(NSURLCredential*)credential;
+
+@end
@@ -0,0 +1,246 @@
+//
+//  HSFResponseCache.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 24/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFResponseCache.h"
+#import "HSFCommon.h"
+#import <CommonCrypto/CommonDigest.h>
+
+static NSString *HSFSHA256String(NSData *data)
+{
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256([data bytes], (CC_LONG)[data length], digest);
+
+    NSMutableString *string = [[NSMutableString alloc] initWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; ++i){
+        [string appendFormat:@"%02x",digest[i]];
+    }
+    return string;
+}
+
+@interface HSFResponseCache()
+
+@property (strong,nonatomic,readwrite) NSString *path;
+@property (nonatomic,readwrite) NSUInteger memoryUsage;
+@property (nonatomic,readwrite) NSUInteger memoryHitCount;
+@property (nonatomic,readwrite) NSUInteger diskHitCount;
+@property (nonatomic,readwrite) NSUInteger missCount;
+@property (nonatomic,readwrite) NSUInteger evictionCount;
+
+/*
+ Memory tier: responses and expiration dates by key, keys from least to most recently used.
+ */
+@property (strong,nonatomic) NSMutableDictionary *responses;
+@property (strong,nonatomic) NSMutableDictionary *expirationDates;
+@property (strong,nonatomic) NSMutableOrderedSet *usageOrder;
+
+@property (strong,nonatomic) dispatch_queue_t diskQueue;
+
+@end
+
+@implementation HSFResponseCache
+
+#pragma mark Properties
+
+-(void)setMemoryCapacity:(NSUInteger)memoryCapacity
+{
+    @synchronized(self){
+        _memoryCapacity = memoryCapacity;
+        [self evictToFitCapacity];
+    }
+}
+
+#pragma mark Public Methods
+
+-(id)initWithPath:(NSString*)path
+{
+    self = [super init];
+    if (self){
+        _path = [path copy];
+        _memoryCapacity = HSF_RESPONSE_CACHE_MEMORY_CAPACITY;
+        _responses = [[NSMutableDictionary alloc] init];
+        _expirationDates = [[NSMutableDictionary alloc] init];
+        _usageOrder = [[NSMutableOrderedSet alloc] init];
+        _diskQueue = dispatch_queue_create(RESPONSE_CACHE_QUEUE, NULL);
+        if (_path){
+            [[NSFileManager defaultManager] createDirectoryAtPath:_path withIntermediateDirectories:YES attributes:nil error:NULL];
+        }
+    }
+    return self;
+}
+
+-(id)init
+{
+    return [self initWithPath:nil];
+}
+
+-(NSData*)dataForKey:(NSString*)key
+{
+    @synchronized(self){
+        NSData *data = self.responses[key];
+        if (data){
+            if ([self.expirationDates[key] timeIntervalSinceNow] > 0){
+                [self.usageOrder removeObject:key];
+                [self.usageOrder addObject:key];
+                self.memoryHitCount++;
+                return data;
+            }
+            [self removeMemoryDataForKey:key];
+        }
+    }
+
+    NSDate *expirationDate;
+    NSData *data = [self diskDataForKey:key expirationDate:&expirationDate];
+    @synchronized(self){
+        if (!data){
+            self.missCount++;
+            return nil;
+        }
+        self.diskHitCount++;
+        [self storeMemoryData:data forKey:key expirationDate:expirationDate];
+        return data;
+    }
+}
+
+-(void)storeData:(NSData*)data forKey:(NSString*)key lifetime:(NSTimeInterval)lifetime
+{
+    if (!data || !key || lifetime <= 0) return;
+
+    NSDate *expirationDate = [NSDate dateWithTimeIntervalSinceNow:lifetime];
+    data = [data copy];
+    @synchronized(self){
+        [self storeMemoryData:data forKey:key expirationDate:expirationDate];
+    }
+
+    NSString *filePath = [self filePathForKey:key];
+    if (!filePath) return;
+    dispatch_async(self.diskQueue, ^{
+        if ([data writeToFile:filePath atomically:YES]){
+            // Modification date of the file is the expiration date of the response.
+            [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate:expirationDate} ofItemAtPath:filePath error:NULL];
+        }
+    });
+}
+
+-(void)removeDataForKey:(NSString*)key
+{
+    @synchronized(self){
+        [self removeMemoryDataForKey:key];
+    }
+    NSString *filePath = [self filePathForKey:key];
+    if (!filePath) return;
+    dispatch_async(self.diskQueue, ^{
+        [[NSFileManager defaultManager] removeItemAtPath:filePath error:NULL];
+    });
+}
+
+-(void)removeAllData
+{
+    @synchronized(self){
+        [self.responses removeAllObjects];
+        [self.expirationDates removeAllObjects];
+        [self.usageOrder removeAllObjects];
+        self.memoryUsage = 0;
+    }
+    NSString *path = self.path;
+    if (!path) return;
+    dispatch_async(self.diskQueue, ^{
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        for (NSString *name in [fileManager contentsOfDirectoryAtPath:path error:NULL]){
+            [fileManager removeItemAtPath:[path stringByAppendingPathComponent:name] error:NULL];
+        }
+    });
+}
+
+#pragma mark Private Methods
+
+-(void)storeMemoryData:(NSData*)data forKey:(NSString*)key expirationDate:(NSDate*)expirationDate
+{
+    [self removeMemoryDataForKey:key];
+    // Response larger than the whole memory tier is kept on disk only.
+    if ([data length] > self.memoryCapacity) return;
+
+    self.responses[key] = data;
+    self.expirationDates[key] = expirationDate;
+    [self.usageOrder addObject:key];
+    self.memoryUsage += [data length];
+    [self evictToFitCapacity];
+}
+
+-(void)removeMemoryDataForKey:(NSString*)key
+{
+    NSData *data = self.responses[key];
+    if (!data) return;
+    self.memoryUsage -= [data length];
+    [self.responses removeObjectForKey:key];
+    [self.expirationDates removeObjectForKey:key];
+    [self.usageOrder removeObject:key];
+}
+
+-(void)evictToFitCapacity
+{
+    while (self.memoryUsage > self.memoryCapacity && [self.usageOrder count]){
+        [self removeMemoryDataForKey:[self.usageOrder firstObject]];
+        self.evictionCount++;
+    }
+}
+
+-(NSString*)filePathForKey:(NSString*)key
+{
+    if (!self.path) return nil;
+    return [self.path stringByAppendingPathComponent:HSFSHA256String([key dataUsingEncoding:NSUTF8StringEncoding])];
+}
+
+-(NSData*)diskDataForKey:(NSString*)key expirationDate:(NSDate**)expirationDate
+{
+    NSString *filePath = [self filePathForKey:key];
+    if (!filePath) return nil;
+
+    __block NSData *data;
+    __block NSDate *date;
+    // Pending writes of the key are finished first.
+    dispatch_sync(self.diskQueue, ^{
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        date = [fileManager attributesOfItemAtPath:filePath error:NULL][NSFileModificationDate];
+        if (!date) return;
+        if ([date timeIntervalSinceNow] <= 0){
+            [fileManager removeItemAtPath:filePath error:NULL];
+            return;
+        }
+        data = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedIfSafe error:NULL];
+    });
+    *expirationDate = date;
+    return data;
+}
+
+#pragma mark Class Methods
+
++(NSString*)keyForRequest:(NSURLRequest*)request actionClass:(Class)actionClass
+{
+    return [self keyForRequest:request actionClass:actionClass credential:nil];
+}
+
++(NSString*)keyForRequest:(NSURLRequest*)request actionClass:(Class)actionClass credential:(NSURLCredential*)credential
+{
+    // Client certificates have no stable representation to key by.
+    if (credential && !credential.user) return nil;
+
+    NSMutableString *identity = [[NSMutableString alloc] init];
+    if (credential){
+        [identity appendFormat:@"%@\n%@\n",credential.user,credential.password ? credential.password : @""];
+    }
+    NSDictionary *fields = [request allHTTPHeaderFields];
+    NSArray *names = [[fields allKeys] sortedArrayUsingSelector:@selector(caseInsensitiveCompare:)];
+    for (NSString *name in names){
+        [identity appendFormat:@"%@:%@\n",[name lowercaseString],fields[name]];
+    }
+
+    NSData *body = [request HTTPBody] ? [request HTTPBody] : [NSData data];
+    return [NSString stringWithFormat:@"%@ %@ %@ %@ %@",NSStringFromClass(actionClass),[request.URL absoluteString],[request valueForHTTPHeaderField:SOAP_ACTION_HEADER],HSFSHA256String(body),HSFSHA256String([identity dataUsingEncoding:NSUTF8StringEncoding])];
+}
+
+@end
@@ -0,0 +1,70 @@
+//
+//  HSFStreamedParameter.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Value of SOAP parameter which is not held in memory.
+ @discussion Put it into SOAPParameters of HSFAction to upload large content, e.g. a document. Its bytes are read from a file or an input stream while the request is sent, base64 encoded on the fly if needed, so the envelope is never made in memory. Bytes which are not base64 encoded are inserted as they are, like NSData values, so they must be valid XML content. Immutable, thread safe.
+ */
+@interface HSFStreamedParameter : NSObject
+
+/*!
+ @abstract Path of the file, nil if the parameter is backed by an input stream.
+ */
+@property (strong,nonatomic,readonly) NSString *path;
+
+/*!
+ @abstract Number of bytes of the content.
+ */
+@property (nonatomic,readonly) unsigned long long length;
+
+/*!
+ @abstract Determine whether the content is base64 encoded while it is sent.
+ */
+@property (nonatomic,readonly,getter=isBase64Encoded) BOOL base64Encoded;
+
+/*!
+ @abstract Number of bytes the parameter takes in the envelope.
+ @discussion The same as length, or length of base64 encoding of the content.
+ */
+@property (nonatomic,readonly) unsigned long long encodedLength;
+
+/*!
+ @abstract Determine whether the content can be read more than once.
+ @discussion YES for files. An input stream is read once, so an action with such parameter is not retried.
+ */
+@property (nonatomic,readonly,getter=isReplayable) BOOL replayable;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Initializer of parameter backed by file.
+ @discussion Throws an exception if the file can't be read.
+ @param path Path of the file.
+ @param base64Encoded Determine whether the content is base64 encoded.
+ @return The initialized parameter.
+ */
+-(id)initWithContentsOfFile:(NSString*)path base64Encoded:(BOOL)base64Encoded;
+
+/*!
+ @abstract Initializer of parameter backed by input stream.
+ @param stream Not opened stream of the content. Must not be nil.
+ @param length Number of bytes the stream will give, it is needed for Content-Length. Extra bytes are not sent; if the stream ends early, the request fails.
+ @param base64Encoded Determine whether the content is base64 encoded.
+ @return The initialized parameter.
+ */
+-(id)initWithInputStream:(NSInputStream*)stream length:(unsigned long long)length base64Encoded:(BOOL)base64Encoded;
+
+/*!
+ @abstract Stream of the content.
+ @discussion A new file stream for every call, or the given input stream for the first call and nil after that. The stream is not opened.
+ */
+-(NSInputStream*)inputStream;
+
+@end
@@ -0,0 +1,89 @@
+//
+//  HSFStreamedParameter.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFStreamedParameter.h"
+
+@interface HSFStreamedParameter()
+
+/*
+ Stream given to the initializer, released when it is taken.
+ */
+@property (strong,nonatomic) NSInputStream *stream;
+
+@end
+
+@implementation HSFStreamedParameter
+
+#pragma mark Properties
+
+-(unsigned long long)encodedLength
+{
+    return self.isBase64Encoded ? (self.length + 2) / 3 * 4 : self.length;
+}
+
+-(BOOL)isReplayable
+{
+    return self.path != nil;
+}
+
+#pragma mark Public Methods
+
+-(id)initWithContentsOfFile:(NSString*)path base64Encoded:(BOOL)base64Encoded
+{
+    NSDictionary *attributes = path ? [[NSFileManager defaultManager] attributesOfItemAtPath:path error:NULL] : nil;
+    if (!attributes || ![[NSFileManager defaultManager] isReadableFileAtPath:path]){
+        [NSException raise:NSInvalidArgumentException format:@"File can't be read: %@",path];
+    }
+    self = [super init];
+    if (self){
+        _path = [path copy];
+        _length = [attributes fileSize];
+        _base64Encoded = base64Encoded;
+    }
+    return self;
+}
+
+-(id)initWithInputStream:(NSInputStream*)stream length:(unsigned long long)length base64Encoded:(BOOL)base64Encoded
+{
+    if (!stream){
+        [NSException raise:NSInvalidArgumentException format:@"Stream is nil."];
+    }
+    self = [super init];
+    if (self){
+        _stream = stream;
+        _length = length;
+        _base64Encoded = base64Encoded;
+    }
+    return self;
+}
+
+-(id)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
+    return [super init];
+}
+
+-(NSInputStream*)inputStream
+{
+    if (self.path) return [[NSInputStream alloc] initWithFileAtPath:self.path];
+    @synchronized(self){
+        NSInputStream *stream = self.stream;
+        self.stream = nil;
+        return stream;
+    }
+}
+
+/*
+ Stands for the content in descriptions of actions.
+ */
+-(NSString*)description
+{
+    return [NSString stringWithFormat:@"<%@: %p, %@, %llu bytes%@>",[self class],self,self.path ? self.path : @"stream",self.length,self.isBase64Encoded ? @", base64" : @""];
+}
+
+@end
@@ -0,0 +1,62 @@
+//
+//  HSFSymbolTable.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 19/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Table of interned strings.
+ @discussion Responses repeat the same element names and attribute keys many times. Parsers intern them in a symbol table, so every name is kept in memory once. The table is thread safe, lookups of names which were interned before don't take its lock, so parsers sharing the table don't wait for each other. It stops interning new strings when it reaches its capacity, so garbage documents can't grow it forever.
+ */
+@interface HSFSymbolTable : NSObject
+
+/*!
+ @abstract Number of interned strings.
+ */
+@property (nonatomic,readonly) NSUInteger count;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @param capacity Maximum number of interned strings.
+ @return The initialized symbol table.
+ */
+-(id)initWithCapacity:(NSUInteger)capacity;
+
+/*!
+ @abstract Interned string equal to the given one.
+ @param string String to intern.
+ @return Interned string, or the string itself if the table is full.
+ */
+-(NSString*)symbolForString:(NSString*)string;
+
+/*!
+ @abstract Interned string for UTF-8 bytes.
+ @discussion No string is made if the symbol is already interned.
+ @param bytes UTF-8 bytes of the string.
+ @param length Number of bytes.
+ @return Interned string, or a new string if the table is full.
+ */
+-(NSString*)symbolForBytes:(const void*)bytes length:(NSUInteger)length;
+
+/*!
+ @abstract Attributes with interned keys.
+ @discussion Empty attributes are replaced with one shared empty dictionary.
+ @param attributes XML element attributes.
+ @return Dictionary with the same values and interned keys.
+ */
+-(NSDictionary*)attributesWithInternedKeys:(NSDictionary*)attributes;
+
+/*!
+ @abstract Symbol table shared by all catchers of the HSFAction class.
+ @param actionClass HSFAction subclass.
+ @return The shared symbol table for the class.
+ */
++(HSFSymbolTable*)sharedSymbolTableForActionClass:(Class)actionClass;
+
+@end
@@ -0,0 +1,135 @@
+//
+//  HSFSymbolTable.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 19/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFSymbolTable.h"
+#import "HSFCommon.h"
+
+static NSMutableDictionary *_sharedSymbolTables;
+
+@interface HSFSymbolTable()
+
+@property (strong,nonatomic) NSMutableSet *symbols;
+/*
+ Immutable copy of symbols, read without the lock. Symbols are published when they are looked up again, so the copy is made rarely once names of the documents are known.
+ */
+@property (strong,atomic) NSSet *publishedSymbols;
+@property (nonatomic) NSUInteger capacity;
+
+@end
+
+@implementation HSFSymbolTable
+
+#pragma mark Properties
+
+-(NSUInteger)count
+{
+    @synchronized(self){
+        return [self.symbols count];
+    }
+}
+
+#pragma mark Public Methods
+
+-(id)initWithCapacity:(NSUInteger)capacity
+{
+    self = [super init];
+    if (self){
+        _capacity = capacity;
+        _symbols = [[NSMutableSet alloc] init];
+    }
+    return self;
+}
+
+-(id)init
+{
+    return [self initWithCapacity:HSF_SYMBOL_TABLE_CAPACITY];
+}
+
+-(NSString*)symbolForString:(NSString*)string
+{
+    if (!string) return nil;
+    NSString *symbol = [self.publishedSymbols member:string];
+    if (symbol) return symbol;
+    @synchronized(self){
+        symbol = [self internedSymbolForKey:string];
+        if (symbol) return symbol;
+        if ([self.symbols count] >= self.capacity) return string;
+
+        symbol = [string copy];
+        [self.symbols addObject:symbol];
+        return symbol;
+    }
+}
+
+-(NSString*)symbolForBytes:(const void*)bytes length:(NSUInteger)length
+{
+    // Lookup key refers to the bytes, it is not kept.
+    NSString *key = [[NSString alloc] initWithBytesNoCopy:(void*)bytes length:length encoding:NSUTF8StringEncoding freeWhenDone:NO];
+    if (!key) return nil;
+    NSString *symbol = [self.publishedSymbols member:key];
+    if (symbol) return symbol;
+    @synchronized(self){
+        symbol = [self internedSymbolForKey:key];
+        if (symbol) return symbol;
+
+        symbol = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        if ([self.symbols count] < self.capacity){
+            [self.symbols addObject:symbol];
+        }
+        return symbol;
+    }
+}
+
+-(NSDictionary*)attributesWithInternedKeys:(NSDictionary*)attributes
+{
+    static NSDictionary *emptyAttributes;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        emptyAttributes = @{};
+    });
+
+    if (![attributes count]) return emptyAttributes;
+
+    NSMutableDictionary *result = [[NSMutableDictionary alloc] initWithCapacity:[attributes count]];
+    [attributes enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop){
+        result[[self symbolForString:key]] = obj;
+    }];
+    return [result copy];
+}
+
+#pragma mark Private Methods
+
+/*
+ Interned symbol equal to the key, nil if there is none. Called under the lock.
+ */
+-(NSString*)internedSymbolForKey:(NSString*)key
+{
+    NSString *symbol = [self.symbols member:key];
+    if (symbol && ![self.publishedSymbols member:key]){
+        self.publishedSymbols = [self.symbols copy];
+    }
+    return symbol;
+}
+
+#pragma mark Class Methods
+
++(HSFSymbolTable*)sharedSymbolTableForActionClass:(Class)actionClass
+{
+    @synchronized(self){
+        if (!_sharedSymbolTables)_sharedSymbolTables = [[NSMutableDictionary alloc] init];
+        NSString *key = NSStringFromClass(actionClass);
+        HSFSymbolTable *table = _sharedSymbolTables[key];
+        if (!table){
+            table = [[HSFSymbolTable alloc] init];
+            _sharedSymbolTables[key] = table;
+        }
+        return table;
+    }
+}
+
+@end
@@ -0,0 +1,87 @@
+//
+//  HSFTagScanner.h
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 12/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@protocol HSFTagScannerDelegate;
+
+/*!
+ @abstract Incremental scanner of special tags.
+ @discussion An instance of this class scans raw bytes of an XML document chunk by chunk and recognizes elements with special (unit or streaming) tags. All tags are matched at once in a single pass, bytes are never scanned twice and the state is kept between chunks, so a tag or a multibyte character may be broken at any place. Tags are matched case-insensitively. Comments and CDATA sections are skipped. Elements are recognized in document order; while inside a recognized element other special tags are not searched.
+ 
+ A special tag may also be a path selector, see isPathSelector:. Selector is a path of local names separated by slash, e.g. @"Body/GetOrdersResponse/Orders/Order", matched case-sensitively against the innermost open elements, or against all of them if it starts with slash. A step may require a namespace URI in braces, e.g. @"{http://example.com/orders}Order"; steps without URI match any namespace. With selectors the scanner tracks open elements, and namespace declarations if some step has URI, so only the matching subtrees are collected.
+ */
+@interface HSFTagScanner : NSObject
+
+/*!
+ @abstract HSFTagScanner delegate.
+ */
+@property (weak,nonatomic) id <HSFTagScannerDelegate> delegate;
+
+/*!
+ @abstract Determine whether scanner is inside of a recognized element.
+ @discussion YES from the moment a special start tag is recognized until its end tag is scanned.
+ */
+@property (nonatomic,readonly) BOOL isInElement;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Designated initializer.
+ @discussion Throws an exception if tags are empty.
+ @param tags Special tags to recognize, unit and streaming ones.
+ @param streamingTags Tags whose content is delivered chunk by chunk. Must be a subset of tags.
+ @return The initialized scanner.
+ */
+-(id)initWithTags:(NSArray*)tags streamingTags:(NSArray*)streamingTags;
+
+/*!
+ @abstract Scan next chunk of data.
+ @discussion Delegate is notified synchronously about every element or piece of streaming content recognized in the chunk.
+ @param data Next chunk of the document.
+ */
+-(void)scanData:(NSData*)data;
+
+/*!
+ @abstract Reset scanner state.
+ @discussion Scanner forgets all partial state and stops scanning of the current chunk, e.g. when loading is repeated or cancelled.
+ */
+-(void)reset;
+
+/*!
+ @abstract Determine whether tag is a path selector.
+ @return YES if tag contains slash or starts with namespace URI in braces.
+ */
++(BOOL)isPathSelector:(NSString*)tag;
+
+@end
+
+/*!
+ @abstract Protocol for delegate of HSFTagScanner.
+ */
+@protocol HSFTagScannerDelegate <NSObject>
+
+/*!
+ @abstract Element with non streaming tag is recognized.
+ @param scanner Scanner which recognized the element.
+ @param element Raw bytes of the element, start and end tags included.
+ @param tag Special tag as it was given to the scanner.
+ */
+-(void)tagScanner:(HSFTagScanner*)scanner didScanElement:(NSData*)element forTag:(NSString*)tag;
+
+/*!
+ @abstract Piece of content of streaming element is scanned.
+ @discussion Content is raw bytes, so a multibyte character may be broken between pieces. Content refers to the scanned chunk without copying, so it is valid only during the call; copy it to keep.
+ @param scanner Scanner which scanned the content.
+ @param content Raw bytes of the content. May be empty for the last chunk.
+ @param tag Special tag as it was given to the scanner.
+ @param lastChunk Indicates that the end tag was scanned.
+ */
+-(void)tagScanner:(HSFTagScanner*)scanner didScanContent:(NSData*)content forTag:(NSString*)tag lastChunk:(BOOL)lastChunk;
+
+@end
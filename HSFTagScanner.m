@@ -0,0 +1,809 @@
+//
+//  HSFTagScanner.m
+//  HSFramework
+//
+//  Created by Ilnar Aliullov on 12/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFTagScanner.h"
+#import "HSFExceptions.h"
+
+// Longer element names are never special, but "![CDATA[" must fit.
+#define HSF_SCANNER_NAME_CAPACITY 256
+
+#define HSF_SCANNER_COMMENT_START "!--"
+#define HSF_SCANNER_CDATA_START "![CDATA["
+
+typedef NS_ENUM(NSInteger, HSFTagScannerState) {
+    HSFTagScannerStateText,     // Looking for '<'.
+    HSFTagScannerStateTagName,  // Collecting a name after '<' or '</'.
+    HSFTagScannerStateOpenTag,  // Inside a start tag of a special element, or of any element for path selectors, looking for '>'.
+    HSFTagScannerStateCloseTag, // Inside an end tag of a special element, looking for '>'.
+    HSFTagScannerStateMarkup    // Inside comment, CDATA, processing instruction or declaration.
+};
+
+typedef struct {
+    unsigned char *name; // Local name.
+    NSUInteger length;
+    NSUInteger namespaceIndex; // 1-based index in namespaceURIs, 0 matches any namespace.
+} HSFScannerStep;
+
+typedef struct {
+    unsigned char *bytes; // Lowercase tag, NULL for path selector.
+    NSUInteger length;
+    BOOL streaming;
+    HSFScannerStep *steps; // Steps of path selector, NULL for tag.
+    NSUInteger stepCount;
+    BOOL anchored; // Path selector starts at the document element.
+} HSFScannerTag;
+
+typedef struct {
+    NSUInteger nameStart; // Local name in pathBytes.
+    NSUInteger nameLength;
+    NSUInteger namespaceIndex; // 1-based index in namespaceURIs, 0 for other namespaces.
+    NSUInteger bindingCount; // Namespace bindings in scope before the element.
+} HSFScannerPathElement;
+
+typedef struct {
+    NSUInteger prefixStart; // Prefix in bindingBytes, empty for default namespace.
+    NSUInteger prefixLength;
+    NSUInteger namespaceIndex;
+} HSFScannerBinding;
+
+static inline BOOL HSFScannerIsWhitespace(unsigned char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline unsigned char HSFScannerLowercase(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+@interface HSFTagScanner(){
+    HSFScannerTag *_table;
+    NSUInteger _tableCount;
+
+    HSFTagScannerState _state;
+    unsigned char _name[HSF_SCANNER_NAME_CAPACITY];
+    NSUInteger _nameLength;
+    BOOL _nameOverflow;
+    BOOL _isEndTag;
+    BOOL _slashPending;
+    unsigned char _quote;
+    const char *_terminator;
+    NSUInteger _terminatorLength;
+    unsigned char _window[2];
+
+    // Special element in progress, NSNotFound if none.
+    NSUInteger _tagIndex;
+    // Start tag of the special element is complete.
+    BOOL _inElement;
+    // Depth of nested elements with the same name, the special element included.
+    NSUInteger _depth;
+    // Name of special element matched by path selector, as it is written.
+    unsigned char _elementName[HSF_SCANNER_NAME_CAPACITY];
+    NSUInteger _elementNameLength;
+    // Special element is matched by path selector, so it is on the path.
+    BOOL _isElementOnPath;
+
+    // Tags include path selectors, so open elements are tracked.
+    BOOL _hasSelectors;
+    // Path selectors have namespace URIs, so namespace declarations are tracked.
+    BOOL _resolvesNamespaces;
+    // Start tag outside of special element is scanned to its end for path selectors.
+    BOOL _isPathTag;
+    // Open elements outside of special element.
+    HSFScannerPathElement *_path;
+    NSUInteger _pathCount;
+    NSUInteger _pathCapacity;
+    // Namespace declarations in scope.
+    HSFScannerBinding *_bindings;
+    NSUInteger _bindingCount;
+    NSUInteger _bindingCapacity;
+
+    // Chunk in scan.
+    const unsigned char *_bytes;
+    NSUInteger _length;
+    // Index of '<' of the current tag, NSNotFound if the tag started in one of previous chunks.
+    NSUInteger _tokenStart;
+    // Index from which bytes of the chunk are not yet consumed by element or content.
+    NSUInteger _flushStart;
+}
+
+@property (strong,nonatomic) NSArray *tags;
+
+/*
+ Bytes of the unit element collected so far.
+ */
+@property (strong,nonatomic) NSMutableData *element;
+
+/*
+ Bytes of a tag which is broken between chunks and is not yet recognized.
+ */
+@property (strong,nonatomic) NSMutableData *carry;
+
+/*
+ Local names of open elements and prefixes of namespace bindings, referred by offsets.
+ */
+@property (strong,nonatomic) NSMutableData *pathBytes;
+@property (strong,nonatomic) NSMutableData *bindingBytes;
+
+/*
+ UTF-8 namespace URIs of path selectors.
+ */
+@property (strong,nonatomic) NSMutableArray *namespaceURIs;
+
+@end
+
+@implementation HSFTagScanner
+
+#pragma mark Properties
+
+-(BOOL)isInElement
+{
+    return _tagIndex != NSNotFound;
+}
+
+-(NSMutableData*)carry
+{
+    if(!_carry)_carry = [[NSMutableData alloc] init];
+    return _carry;
+}
+
+#pragma mark Public Methods
+
+-(id)initWithTags:(NSArray*)tags streamingTags:(NSArray*)streamingTags
+{
+    if (![tags count]){
+        [NSException raise:NSInvalidArgumentException format:@"tags is nil or empty."];
+    }
+
+    self = [super init];
+    if (self){
+        _tags = [tags copy];
+        _tableCount = [_tags count];
+        _table = calloc(_tableCount, sizeof(HSFScannerTag));
+        _pathBytes = [[NSMutableData alloc] init];
+        _bindingBytes = [[NSMutableData alloc] init];
+        _namespaceURIs = [[NSMutableArray alloc] init];
+        for (NSUInteger i = 0; i < _tableCount; ++i){
+            _table[i].streaming = [streamingTags containsObject:_tags[i]];
+            if ([[self class] isPathSelector:_tags[i]]){
+                [self compileSelector:_tags[i] intoTag:&_table[i]];
+                _hasSelectors = YES;
+                continue;
+            }
+            NSData *tag = [[_tags[i] lowercaseString] dataUsingEncoding:NSUTF8StringEncoding];
+            if (![tag length] || [tag length] > HSF_SCANNER_NAME_CAPACITY){
+                [NSException raise:HSFCatcherSpecialTagsException format:@"HSFTagScanner tag '%@' is empty or too long.",_tags[i]];
+            }
+            _table[i].length = [tag length];
+            _table[i].bytes = malloc([tag length]);
+            memcpy(_table[i].bytes, [tag bytes], [tag length]);
+        }
+        _resolvesNamespaces = [_namespaceURIs count] > 0;
+        [self reset];
+    }
+    return self;
+}
+
+-(id)init
+{
+    [NSException raise:NSInternalInconsistencyException format:@"Use designated initializer."];
+    return [super init];
+}
+
+-(void)dealloc
+{
+    for (NSUInteger i = 0; i < _tableCount; ++i){
+        free(_table[i].bytes);
+        for (NSUInteger k = 0; k < _table[i].stepCount; ++k){
+            free(_table[i].steps[k].name);
+        }
+        free(_table[i].steps);
+    }
+    free(_table);
+    free(_path);
+    free(_bindings);
+}
+
+-(void)reset
+{
+    _state = HSFTagScannerStateText;
+    _tagIndex = NSNotFound;
+    _inElement = NO;
+    _depth = 0;
+    _nameLength = 0;
+    _isElementOnPath = NO;
+    _isPathTag = NO;
+    _pathCount = 0;
+    _bindingCount = 0;
+    [self.pathBytes setLength:0];
+    [self.bindingBytes setLength:0];
+    _bytes = NULL;
+    _length = 0;
+    self.element = nil;
+    [self.carry setLength:0];
+}
+
+-(void)scanData:(NSData*)data
+{
+    _bytes = [data bytes];
+    _length = [data length];
+    _tokenStart = NSNotFound;
+    _flushStart = 0;
+
+    NSUInteger i = 0;
+    // Note: delegate callbacks may reset the scanner, then _length becomes 0.
+    while (i < _length){
+        unsigned char c = _bytes[i];
+        switch (_state){
+            case HSFTagScannerStateText:{
+                const unsigned char *found = memchr(_bytes + i, '<', _length - i);
+                if (!found){
+                    i = _length;
+                    continue;
+                }
+                i = found - _bytes;
+                _tokenStart = i;
+                _state = HSFTagScannerStateTagName;
+                _nameLength = 0;
+                _nameOverflow = NO;
+                _isEndTag = NO;
+                break;
+            }
+            case HSFTagScannerStateTagName:
+                [self scanNameByte:c atIndex:i];
+                break;
+            case HSFTagScannerStateOpenTag:
+                if (_quote){
+                    if (c == _quote) _quote = 0;
+                } else if (c == '>'){
+                    [self finishOpenTagAtIndex:i];
+                } else if (c == '/'){
+                    _slashPending = YES;
+                } else if (c == '"' || c == '\''){
+                    _quote = c;
+                    _slashPending = NO;
+                } else if (!HSFScannerIsWhitespace(c)){
+                    _slashPending = NO;
+                }
+                break;
+            case HSFTagScannerStateCloseTag:
+                if (c == '>') [self finishCloseTagAtIndex:i];
+                break;
+            case HSFTagScannerStateMarkup:
+                if (c == (unsigned char)_terminator[_terminatorLength-1] && [self isWindowTerminated]){
+                    [self resolveTag];
+                } else {
+                    _window[0] = _window[1];
+                    _window[1] = c;
+                }
+                break;
+        }
+        ++i;
+    }
+
+    [self flushChunk];
+    _bytes = NULL;
+    _length = 0;
+}
+
+#pragma mark Private Methods
+
+-(void)scanNameByte:(unsigned char)c atIndex:(NSUInteger)index
+{
+    if (_nameLength == 0 && !_isEndTag){
+        if (c == '/'){
+            _isEndTag = YES;
+            return;
+        }
+        if (c == '?'){
+            [self beginMarkupWithTerminator:"?>"];
+            return;
+        }
+        if (c == '!'){
+            _name[_nameLength++] = c;
+            return;
+        }
+    }
+
+    if (_nameLength && _name[0] == '!'){
+        [self scanDeclarationByte:c];
+        return;
+    }
+
+    if (c == '>' || c == '/' || HSFScannerIsWhitespace(c)){
+        [self finishNameWithByte:c atIndex:index];
+        return;
+    }
+
+    if (_nameLength < HSF_SCANNER_NAME_CAPACITY){
+        _name[_nameLength++] = c;
+    } else {
+        _nameOverflow = YES;
+    }
+}
+
+/*
+ Distinguish comment, CDATA section and other declarations, e.g. DOCTYPE.
+ */
+-(void)scanDeclarationByte:(unsigned char)c
+{
+    if (c == '>'){
+        [self resolveTag];
+        return;
+    }
+
+    _name[_nameLength++] = c;
+
+    BOOL commentPrefix = _nameLength <= strlen(HSF_SCANNER_COMMENT_START) && memcmp(_name, HSF_SCANNER_COMMENT_START, _nameLength) == 0;
+    BOOL CDATAPrefix = _nameLength <= strlen(HSF_SCANNER_CDATA_START) && memcmp(_name, HSF_SCANNER_CDATA_START, _nameLength) == 0;
+
+    if (commentPrefix && _nameLength == strlen(HSF_SCANNER_COMMENT_START)){
+        [self beginMarkupWithTerminator:"-->"];
+    } else if (CDATAPrefix && _nameLength == strlen(HSF_SCANNER_CDATA_START)){
+        [self beginMarkupWithTerminator:"]]>"];
+    } else if (!commentPrefix && !CDATAPrefix){
+        [self beginMarkupWithTerminator:">"];
+    }
+}
+
+-(void)finishNameWithByte:(unsigned char)c atIndex:(NSUInteger)index
+{
+    BOOL isValidName = _nameLength > 0 && !_nameOverflow;
+
+    if (_tagIndex != NSNotFound){
+        // Inside of special element only the same name matters, to keep the depth.
+        if (!isValidName || ![self isNameOfElement]){
+            [self resolveTag];
+            return;
+        }
+    } else if (_isEndTag){
+        if (_nameLength > 0) [self popPathElement];
+        [self resolveTag];
+        return;
+    } else {
+        NSUInteger tagIndex = isValidName ? [self indexOfName] : NSNotFound;
+        if (tagIndex != NSNotFound){
+            [self beginElementWithTagIndex:tagIndex];
+        } else if (_hasSelectors && _nameLength > 0){
+            // Start tag is scanned to its end to know whether the element is empty and which namespaces it declares.
+            _isPathTag = YES;
+        } else {
+            [self resolveTag];
+            return;
+        }
+    }
+
+    if (_isEndTag){
+        _state = HSFTagScannerStateCloseTag;
+        if (c == '>') [self finishCloseTagAtIndex:index];
+    } else {
+        _state = HSFTagScannerStateOpenTag;
+        _quote = 0;
+        _slashPending = (c == '/');
+        if (c == '>') [self finishOpenTagAtIndex:index];
+    }
+}
+
+-(void)beginElementWithTagIndex:(NSUInteger)tagIndex
+{
+    _tagIndex = tagIndex;
+    _inElement = NO;
+    _depth = 0;
+    if (_table[tagIndex].steps){
+        memcpy(_elementName, _name, _nameLength);
+        _elementNameLength = _nameLength;
+    }
+    if (!_table[tagIndex].streaming){
+        // Element bytes start from '<' of the start tag.
+        self.element = [[NSMutableData alloc] init];
+        if (_tokenStart == NSNotFound){
+            [self.element appendData:self.carry];
+            _flushStart = 0;
+        } else {
+            _flushStart = _tokenStart;
+        }
+    }
+    [self.carry setLength:0];
+}
+
+-(void)finishOpenTagAtIndex:(NSUInteger)index
+{
+    if (_isPathTag){
+        [self finishPathTagAtIndex:index];
+        return;
+    }
+
+    BOOL isEmptyElement = _slashPending;
+
+    if (_inElement){
+        // Nested element with the same name.
+        if (!isEmptyElement) ++_depth;
+        [self resolveTag];
+        return;
+    }
+
+    if (isEmptyElement){
+        [self finishElementAtIndex:index];
+        return;
+    }
+
+    _state = HSFTagScannerStateText;
+    _inElement = YES;
+    _depth = 1;
+    if (_table[_tagIndex].streaming){
+        _flushStart = index + 1;
+    }
+}
+
+-(void)finishCloseTagAtIndex:(NSUInteger)index
+{
+    if (--_depth > 0){
+        [self resolveTag];
+        return;
+    }
+    [self finishElementAtIndex:index];
+}
+
+-(void)finishElementAtIndex:(NSUInteger)index
+{
+    NSString *tag = self.tags[_tagIndex];
+    BOOL streaming = _table[_tagIndex].streaming;
+    NSData *result;
+
+    if (streaming){
+        // Content ends where the end tag starts. If the end tag started in a previous chunk, the content was flushed already.
+        NSUInteger end = (_tokenStart == NSNotFound) ? 0 : _tokenStart;
+        if (_inElement && end > _flushStart){
+            result = [self contentFrom:_flushStart to:end];
+        } else {
+            result = [NSData data];
+        }
+    } else {
+        [self.element appendBytes:_bytes + _flushStart length:index + 1 - _flushStart];
+        result = self.element;
+        self.element = nil;
+    }
+
+    _tagIndex = NSNotFound;
+    _inElement = NO;
+    _depth = 0;
+    _state = HSFTagScannerStateText;
+    _tokenStart = NSNotFound;
+    _flushStart = index + 1;
+    [self.carry setLength:0];
+    if (_isElementOnPath){
+        _isElementOnPath = NO;
+        [self popPathElement];
+    }
+
+    if (streaming){
+        [self.delegate tagScanner:self didScanContent:result forTag:tag lastChunk:YES];
+    } else {
+        [self.delegate tagScanner:self didScanElement:result forTag:tag];
+    }
+}
+
+-(void)beginMarkupWithTerminator:(const char*)terminator
+{
+    _state = HSFTagScannerStateMarkup;
+    _terminator = terminator;
+    _terminatorLength = strlen(terminator);
+    _window[0] = 0;
+    _window[1] = 0;
+    // Markup can't be the end of streaming content, so it is flushed as a content.
+    [self releaseCarry];
+}
+
+-(BOOL)isWindowTerminated
+{
+    switch (_terminatorLength){
+        case 1:
+            return YES;
+        case 2:
+            return _window[1] == (unsigned char)_terminator[0];
+        default:
+            return _window[0] == (unsigned char)_terminator[0] && _window[1] == (unsigned char)_terminator[1];
+    }
+}
+
+/*
+ Current tag turned out to be nothing special, go on looking for '<'.
+ */
+-(void)resolveTag
+{
+    _state = HSFTagScannerStateText;
+    [self releaseCarry];
+}
+
+-(void)releaseCarry
+{
+    if (_carry.length && _inElement && _table[_tagIndex].streaming){
+        [self.delegate tagScanner:self didScanContent:[self.carry copy] forTag:self.tags[_tagIndex] lastChunk:NO];
+    }
+    [_carry setLength:0];
+}
+
+/*
+ Move bytes of the chunk which are not consumed yet into element, content or carry.
+ */
+-(void)flushChunk
+{
+    if (_length == 0) return;
+
+    BOOL isInTag = (_state == HSFTagScannerStateTagName || _state == HSFTagScannerStateOpenTag || _state == HSFTagScannerStateCloseTag);
+    NSUInteger tagStart = (_tokenStart == NSNotFound) ? 0 : _tokenStart;
+
+    if (_tagIndex != NSNotFound && !_table[_tagIndex].streaming){
+        [self.element appendBytes:_bytes + _flushStart length:_length - _flushStart];
+    } else if (_tagIndex != NSNotFound && _inElement){
+        NSUInteger end = isInTag ? tagStart : _length;
+        if (end > _flushStart){
+            [self.delegate tagScanner:self didScanContent:[self contentFrom:_flushStart to:end] forTag:self.tags[_tagIndex] lastChunk:NO];
+        }
+        if (isInTag){
+            [self.carry appendBytes:_bytes + tagStart length:_length - tagStart];
+        }
+    } else if (_state == HSFTagScannerStateTagName || _isPathTag){
+        // Start tag of a unit may continue in the next chunk.
+        [self.carry appendBytes:_bytes + tagStart length:_length - tagStart];
+    }
+}
+
+/*
+ Streaming content refers to the chunk, it is not copied.
+ */
+-(NSData*)contentFrom:(NSUInteger)start to:(NSUInteger)end
+{
+    return [[NSData alloc] initWithBytesNoCopy:(void*)(_bytes + start) length:end - start freeWhenDone:NO];
+}
+
+-(BOOL)isNameEqualToTagAtIndex:(NSUInteger)index
+{
+    if (_table[index].length != _nameLength) return NO;
+    for (NSUInteger i = 0; i < _nameLength; ++i){
+        if (HSFScannerLowercase(_name[i]) != _table[index].bytes[i]) return NO;
+    }
+    return YES;
+}
+
+/*
+ Tags are matched case-insensitively, path selectors by the exact name of the element they matched.
+ */
+-(BOOL)isNameOfElement
+{
+    if (!_table[_tagIndex].steps) return [self isNameEqualToTagAtIndex:_tagIndex];
+    return _elementNameLength == _nameLength && memcmp(_elementName, _name, _nameLength) == 0;
+}
+
+-(NSUInteger)indexOfName
+{
+    for (NSUInteger i = 0; i < _tableCount; ++i){
+        if ([self isNameEqualToTagAtIndex:i]) return i;
+    }
+    return NSNotFound;
+}
+
+#pragma mark Path Selectors
+
+-(void)compileSelector:(NSString*)selector intoTag:(HSFScannerTag*)tag
+{
+    NSMutableArray *names = [[NSMutableArray alloc] init];
+    NSMutableArray *namespaces = [[NSMutableArray alloc] init];
+    tag->anchored = [selector hasPrefix:@"/"];
+
+    NSUInteger length = [selector length];
+    NSUInteger location = tag->anchored ? 1 : 0;
+    while (location <= length){
+        NSUInteger namespaceIndex = 0;
+        if (location < length && [selector characterAtIndex:location] == '{'){
+            // URI may contain slashes.
+            NSRange close = [selector rangeOfString:@"}" options:0 range:NSMakeRange(location, length - location)];
+            if (close.location == NSNotFound){
+                [NSException raise:HSFCatcherSpecialTagsException format:@"HSFTagScanner selector '%@' has unclosed namespace.",selector];
+            }
+            NSData *URI = [[selector substringWithRange:NSMakeRange(location + 1, close.location - location - 1)] dataUsingEncoding:NSUTF8StringEncoding];
+            NSUInteger index = [self.namespaceURIs indexOfObject:URI];
+            if (index == NSNotFound){
+                [self.namespaceURIs addObject:URI];
+                index = [self.namespaceURIs count] - 1;
+            }
+            namespaceIndex = index + 1;
+            location = close.location + 1;
+        }
+
+        NSRange slash = [selector rangeOfString:@"/" options:0 range:NSMakeRange(location, length - location)];
+        NSUInteger end = (slash.location == NSNotFound) ? length : slash.location;
+        NSString *name = [selector substringWithRange:NSMakeRange(location, end - location)];
+        // Prefix in selector does not matter, namespace is given by URI.
+        NSRange colon = [name rangeOfString:@":" options:NSBackwardsSearch];
+        if (colon.location != NSNotFound) name = [name substringFromIndex:colon.location + 1];
+        NSData *nameData = [name dataUsingEncoding:NSUTF8StringEncoding];
+        if (![nameData length] || [nameData length] > HSF_SCANNER_NAME_CAPACITY){
+            [NSException raise:HSFCatcherSpecialTagsException format:@"HSFTagScanner selector '%@' has empty or too long step.",selector];
+        }
+        [names addObject:nameData];
+        [namespaces addObject:@(namespaceIndex)];
+        location = end + 1;
+    }
+
+    tag->stepCount = [names count];
+    tag->steps = calloc(tag->stepCount, sizeof(HSFScannerStep));
+    for (NSUInteger k = 0; k < tag->stepCount; ++k){
+        NSData *name = names[k];
+        tag->steps[k].length = [name length];
+        tag->steps[k].name = malloc([name length]);
+        memcpy(tag->steps[k].name, [name bytes], [name length]);
+        tag->steps[k].namespaceIndex = [namespaces[k] unsignedIntegerValue];
+    }
+}
+
+/*
+ Start tag outside of special element is complete. Element is put on the path and matched against path selectors.
+ */
+-(void)finishPathTagAtIndex:(NSUInteger)index
+{
+    _isPathTag = NO;
+    BOOL isEmptyElement = _slashPending;
+    [self pushPathElementWithTagEndingAtIndex:index];
+
+    NSUInteger tagIndex = [self indexOfMatchingSelector];
+    if (tagIndex == NSNotFound){
+        if (isEmptyElement) [self popPathElement];
+        [self resolveTag];
+        return;
+    }
+
+    // Element is popped from the path when it is finished.
+    [self beginElementWithTagIndex:tagIndex];
+    _isElementOnPath = YES;
+    [self finishOpenTagAtIndex:index];
+}
+
+-(void)pushPathElementWithTagEndingAtIndex:(NSUInteger)index
+{
+    NSUInteger bindingCount = _bindingCount;
+    if (_resolvesNamespaces){
+        [self declareNamespacesOfTagEndingAtIndex:index];
+    }
+
+    if (_pathCount == _pathCapacity){
+        _pathCapacity = _pathCapacity ? _pathCapacity * 2 : 16;
+        _path = realloc(_path, _pathCapacity * sizeof(HSFScannerPathElement));
+    }
+
+    // Element with too long name is kept with empty name, it never matches.
+    NSUInteger localStart = 0;
+    NSUInteger localLength = 0;
+    if (!_nameOverflow){
+        const unsigned char *colon = memchr(_name, ':', _nameLength);
+        localStart = colon ? colon - _name + 1 : 0;
+        localLength = _nameLength - localStart;
+    }
+
+    HSFScannerPathElement *element = &_path[_pathCount++];
+    element->nameStart = [self.pathBytes length];
+    element->nameLength = localLength;
+    element->bindingCount = bindingCount;
+    element->namespaceIndex = 0;
+    [self.pathBytes appendBytes:_name + localStart length:localLength];
+    if (_resolvesNamespaces && !_nameOverflow){
+        element->namespaceIndex = [self namespaceIndexOfPrefix:_name length:localStart ? localStart - 1 : 0];
+    }
+}
+
+-(void)popPathElement
+{
+    if (!_pathCount) return;
+    HSFScannerPathElement *element = &_path[--_pathCount];
+    [self.pathBytes setLength:element->nameStart];
+    if (_bindingCount > element->bindingCount){
+        [self.bindingBytes setLength:_bindings[element->bindingCount].prefixStart];
+        _bindingCount = element->bindingCount;
+    }
+}
+
+-(NSUInteger)indexOfMatchingSelector
+{
+    const unsigned char *names = [self.pathBytes bytes];
+    for (NSUInteger i = 0; i < _tableCount; ++i){
+        HSFScannerTag *tag = &_table[i];
+        if (!tag->steps || tag->stepCount > _pathCount) continue;
+        if (tag->anchored && tag->stepCount != _pathCount) continue;
+
+        BOOL matches = YES;
+        for (NSUInteger k = 0; k < tag->stepCount && matches; ++k){
+            HSFScannerStep *step = &tag->steps[tag->stepCount - 1 - k];
+            HSFScannerPathElement *element = &_path[_pathCount - 1 - k];
+            matches = step->length == element->nameLength
+                && memcmp(step->name, names + element->nameStart, step->length) == 0
+                && (!step->namespaceIndex || step->namespaceIndex == element->namespaceIndex);
+        }
+        if (matches) return i;
+    }
+    return NSNotFound;
+}
+
+/*
+ Read xmlns attributes of the start tag, '>' excluded. The tag is in carry if it started in one of previous chunks.
+ */
+-(void)declareNamespacesOfTagEndingAtIndex:(NSUInteger)index
+{
+    NSData *tag;
+    if (_tokenStart == NSNotFound){
+        NSMutableData *bytes = [self.carry mutableCopy];
+        [bytes appendBytes:_bytes length:index];
+        tag = bytes;
+    } else {
+        tag = [self contentFrom:_tokenStart to:index];
+    }
+
+    const unsigned char *p = [tag bytes];
+    const unsigned char *end = p + [tag length];
+    // Skip '<' and the name.
+    ++p;
+    while (p < end && !HSFScannerIsWhitespace(*p) && *p != '/') ++p;
+
+    while (p < end){
+        while (p < end && (HSFScannerIsWhitespace(*p) || *p == '/')) ++p;
+        const unsigned char *name = p;
+        while (p < end && *p != '=' && !HSFScannerIsWhitespace(*p)) ++p;
+        NSUInteger nameLength = p - name;
+        while (p < end && HSFScannerIsWhitespace(*p)) ++p;
+        if (p >= end || *p != '=') break;
+        ++p;
+        while (p < end && HSFScannerIsWhitespace(*p)) ++p;
+        if (p >= end || (*p != '"' && *p != '\'')) break;
+        unsigned char quote = *p++;
+        const unsigned char *value = p;
+        while (p < end && *p != quote) ++p;
+        NSData *URI = [[NSData alloc] initWithBytesNoCopy:(void*)value length:p - value freeWhenDone:NO];
+        ++p;
+
+        if (nameLength == 5 && memcmp(name, "xmlns", 5) == 0){
+            [self declarePrefix:name length:0 URI:URI];
+        } else if (nameLength > 6 && memcmp(name, "xmlns:", 6) == 0){
+            [self declarePrefix:name + 6 length:nameLength - 6 URI:URI];
+        }
+    }
+}
+
+-(void)declarePrefix:(const unsigned char*)prefix length:(NSUInteger)length URI:(NSData*)URI
+{
+    if (_bindingCount == _bindingCapacity){
+        _bindingCapacity = _bindingCapacity ? _bindingCapacity * 2 : 8;
+        _bindings = realloc(_bindings, _bindingCapacity * sizeof(HSFScannerBinding));
+    }
+    NSUInteger index = [self.namespaceURIs indexOfObject:URI];
+
+    HSFScannerBinding *binding = &_bindings[_bindingCount++];
+    binding->prefixStart = [self.bindingBytes length];
+    binding->prefixLength = length;
+    binding->namespaceIndex = (index == NSNotFound) ? 0 : index + 1;
+    [self.bindingBytes appendBytes:prefix length:length];
+}
+
+-(NSUInteger)namespaceIndexOfPrefix:(const unsigned char*)prefix length:(NSUInteger)length
+{
+    const unsigned char *prefixes = [self.bindingBytes bytes];
+    for (NSUInteger i = _bindingCount; i > 0; --i){
+        HSFScannerBinding *binding = &_bindings[i - 1];
+        if (binding->prefixLength == length && memcmp(prefixes + binding->prefixStart, prefix, length) == 0){
+            return binding->namespaceIndex;
+        }
+    }
+    return 0;
+}
+
+#pragma mark Class Methods
+
++(BOOL)isPathSelector:(NSString*)tag
+{
+    return [tag hasPrefix:@"{"] || [tag rangeOfString:@"/"].location != NSNotFound;
+}
+
+@end
@@ -0,0 +1,17 @@
+//
+//  HSFClientLoopbackTests.h
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFTestCase.h"
+
+/*!
+ @abstract Tests of the per-host connection limit of HSFClient against HSFLoopbackServer.
+ @discussion Several actions are loaded at once through real connections to 127.0.0.1 while the main run loop runs. With maxConnectionsPerHost set, the server must never serve more requests at the same time than the limit, the rest of the catchers must wait and all of them must finish; pool statistics of the client must count them. Without the limit no catcher waits.
+ */
+@interface HSFClientLoopbackTests : HSFTestCase
+
+@end
@@ -0,0 +1,150 @@
+//
+//  HSFClientLoopbackTests.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFClientLoopbackTests.h"
+#import "HSFLoopbackServer.h"
+#import "HSFLoopbackAction.h"
+#import "HSFClient.h"
+#import "HSFCatcher.h"
+
+#define HSF_TEST_CONNECTION_LIMIT 2
+#define HSF_TEST_LOAD_COUNT 6
+#define HSF_TEST_RESPONSE_DELAY 0.2
+#define HSF_TEST_LOAD_TIMEOUT 10.0
+#define HSF_TEST_RUN_LOOP_STEP 0.01
+
+@interface HSFClientLoopbackTests() <HSFCatcherDelegate>
+
+@property (strong,nonatomic) HSFLoopbackServer *server;
+
+/*
+ Catchers of the running test which finished or failed.
+ */
+@property (nonatomic) NSUInteger finishedCount;
+@property (nonatomic) NSUInteger failedCount;
+
+/*
+ Maximum of activeConnectionCountForURL: seen while loading.
+ */
+@property (nonatomic) NSUInteger maxActiveCount;
+
+@end
+
+@implementation HSFClientLoopbackTests
+
+#pragma mark Public Methods
+
+-(BOOL)run
+{
+    self.server = [[HSFLoopbackServer alloc] init];
+    if (![self.server start]){
+        [self runTest:@"loopbackServer" block:^{ HSFCheck(NO, @"loopback server is not started"); }];
+        return NO;
+    }
+    [self runTest:@"connectionLimit" block:^{ [self testConnectionLimit]; }];
+    [self runTest:@"unlimitedConnections" block:^{ [self testUnlimitedConnections]; }];
+    [self.server stop];
+    return self.failureCount == 0;
+}
+
+#pragma mark Tests
+
+-(void)testConnectionLimit
+{
+    HSFClient *client = [HSFClient sharedHSFClient];
+    NSUInteger limit = client.maxConnectionsPerHost;
+    client.maxConnectionsPerHost = HSF_TEST_CONNECTION_LIMIT;
+    NSUInteger admitted = client.admittedConnectionTotal;
+    NSUInteger queued = client.queuedConnectionTotal;
+    NSTimeInterval waited = client.totalWaitDuration;
+
+    [self loadActionCount:HSF_TEST_LOAD_COUNT];
+    client.maxConnectionsPerHost = limit;
+
+    HSFCheck(self.finishedCount == HSF_TEST_LOAD_COUNT, @"%lu of %d loads finished, %lu failed",(unsigned long)self.finishedCount,HSF_TEST_LOAD_COUNT,(unsigned long)self.failedCount);
+    HSFCheck(self.server.requestCount == HSF_TEST_LOAD_COUNT, @"server received %lu requests",(unsigned long)self.server.requestCount);
+    HSFCheck(self.server.maxConcurrentRequestCount <= HSF_TEST_CONNECTION_LIMIT, @"server served %lu requests at the same time",(unsigned long)self.server.maxConcurrentRequestCount);
+    HSFCheck(self.maxActiveCount <= HSF_TEST_CONNECTION_LIMIT, @"%lu connections were active",(unsigned long)self.maxActiveCount);
+    // Waiting catchers reuse kept-alive connections of finished ones.
+    HSFCheck(self.server.connectionCount < self.server.requestCount, @"%lu connections for %lu requests",(unsigned long)self.server.connectionCount,(unsigned long)self.server.requestCount);
+
+    HSFCheck(client.admittedConnectionTotal - admitted == HSF_TEST_LOAD_COUNT, @"%lu catchers admitted",(unsigned long)(client.admittedConnectionTotal - admitted));
+    HSFCheck(client.queuedConnectionTotal - queued >= HSF_TEST_LOAD_COUNT - HSF_TEST_CONNECTION_LIMIT, @"%lu catchers queued",(unsigned long)(client.queuedConnectionTotal - queued));
+    HSFCheck(client.peakWaitingCatcherCount >= HSF_TEST_LOAD_COUNT - HSF_TEST_CONNECTION_LIMIT, @"peak of waiting catchers is %lu",(unsigned long)client.peakWaitingCatcherCount);
+    HSFCheck(client.totalWaitDuration > waited, @"wait duration is not counted");
+    [self checkPoolIsEmpty];
+}
+
+-(void)testUnlimitedConnections
+{
+    HSFClient *client = [HSFClient sharedHSFClient];
+    NSUInteger limit = client.maxConnectionsPerHost;
+    client.maxConnectionsPerHost = 0;
+    NSUInteger admitted = client.admittedConnectionTotal;
+    NSUInteger queued = client.queuedConnectionTotal;
+
+    [self loadActionCount:HSF_TEST_LOAD_COUNT];
+    client.maxConnectionsPerHost = limit;
+
+    HSFCheck(self.finishedCount == HSF_TEST_LOAD_COUNT, @"%lu of %d loads finished, %lu failed",(unsigned long)self.finishedCount,HSF_TEST_LOAD_COUNT,(unsigned long)self.failedCount);
+    // Only the URL loading system limits connections now.
+    HSFCheck(self.server.maxConcurrentRequestCount > HSF_TEST_CONNECTION_LIMIT, @"server served only %lu requests at the same time",(unsigned long)self.server.maxConcurrentRequestCount);
+    HSFCheck(client.admittedConnectionTotal - admitted == HSF_TEST_LOAD_COUNT, @"%lu catchers admitted",(unsigned long)(client.admittedConnectionTotal - admitted));
+    HSFCheck(client.queuedConnectionTotal == queued, @"%lu catchers queued",(unsigned long)(client.queuedConnectionTotal - queued));
+    [self checkPoolIsEmpty];
+}
+
+#pragma mark HSFCatcherDelegate
+
+-(void)catcherDidFinishLoading:(HSFCatcher *)catcher
+{
+    ++self.finishedCount;
+}
+
+-(void)catcher:(HSFCatcher *)catcher didFailWithCommonError:(NSError*)error
+{
+    ++self.failedCount;
+}
+
+#pragma mark Private Methods
+
+/*
+ Load count actions at once and run the main run loop until all of them finish or fail, or the timeout expires.
+ */
+-(void)loadActionCount:(NSUInteger)count
+{
+    HSFClient *client = [HSFClient sharedHSFClient];
+    NSURL *url = self.server.URL;
+    self.server.responseDelay = HSF_TEST_RESPONSE_DELAY;
+    [self.server resetCounters];
+    self.finishedCount = 0;
+    self.failedCount = 0;
+    self.maxActiveCount = 0;
+
+    for (NSUInteger i = 0; i < count; ++i){
+        HSFLoopbackAction *action = [[HSFLoopbackAction alloc] initWithURL:url number:i];
+        [client loadAsynchronouslyWithAction:action delegate:self];
+    }
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:HSF_TEST_LOAD_TIMEOUT];
+    while (self.finishedCount + self.failedCount < count && [deadline timeIntervalSinceNow] > 0){
+        self.maxActiveCount = MAX(self.maxActiveCount, [client activeConnectionCountForURL:url]);
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:HSF_TEST_RUN_LOOP_STEP]];
+    }
+    if (self.finishedCount + self.failedCount < count) [client cancelAllCatchers];
+}
+
+-(void)checkPoolIsEmpty
+{
+    HSFClient *client = [HSFClient sharedHSFClient];
+    NSURL *url = self.server.URL;
+    HSFCheck([client activeConnectionCountForURL:url] == 0, @"%lu connections are still active",(unsigned long)[client activeConnectionCountForURL:url]);
+    HSFCheck([client waitingCatcherCountForURL:url] == 0, @"%lu catchers are still waiting",(unsigned long)[client waitingCatcherCountForURL:url]);
+}
+
+@end
@@ -0,0 +1,24 @@
+//
+//  HSFLoopbackAction.h
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFAction.h"
+
+/*!
+ @abstract SOAP action sent to HSFLoopbackServer.
+ @discussion Every instance has its own number in parameters, so actions are never answered from the cache or joined to each other.
+ */
+@interface HSFLoopbackAction : HSFAction
+
+/*!
+ @abstract Designated initializer.
+ @param url URL of the loopback server.
+ @param number Number put into parameters.
+ */
+-(id)initWithURL:(NSURL*)url number:(NSUInteger)number;
+
+@end
@@ -0,0 +1,62 @@
+//
+//  HSFLoopbackAction.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFLoopbackAction.h"
+
+@interface HSFLoopbackAction()
+
+@property (nonatomic) NSUInteger number;
+
+@end
+
+@implementation HSFLoopbackAction
+
+#pragma mark Properties
+
+-(NSDictionary*)HTTPHeaderFields
+{
+    return @{@"Content-Type":@"text/xml; charset=utf-8",@"Content-Length":@"0",@"SOAPAction":@"http://example.com/loopback/Loopback"};
+}
+
+-(NSString*)SOAPAction
+{
+    return @"Loopback";
+}
+
+-(NSString*)attributesForSOAPActionTag
+{
+    return @"xmlns=\"http://example.com/loopback\"";
+}
+
+-(NSString*)SOAPEnvelopeHead
+{
+    return @"<?xml version=\"1.0\" encoding=\"utf-8\"?><soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\"><soap:Body>";
+}
+
+-(NSString*)SOAPEnvelopeTail
+{
+    return @"</soap:Body></soap:Envelope>";
+}
+
+-(NSDictionary*)SOAPParameters
+{
+    return @{@"number":[NSString stringWithFormat:@"%lu",(unsigned long)self.number]};
+}
+
+#pragma mark Public Methods
+
+-(id)initWithURL:(NSURL*)url number:(NSUInteger)number
+{
+    self = [super initWithURL:url];
+    if (self){
+        _number = number;
+    }
+    return self;
+}
+
+@end
@@ -0,0 +1,61 @@
+//
+//  HSFLoopbackServer.h
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract HTTP server on 127.0.0.1 for tests of real connections.
+ @discussion Listens on a free port, serves every connection on its own thread and answers every POST with the same SOAP response after responseDelay. Connections are kept alive until the client closes them. Counts requests, connections and requests served at the same time.
+ */
+@interface HSFLoopbackServer : NSObject
+
+/*!
+ @abstract URL of the service, nil until the server is started.
+ */
+@property (strong,nonatomic,readonly) NSURL *URL;
+
+/*!
+ @abstract Time to wait before every response. Default value is 0.
+ */
+@property (atomic) NSTimeInterval responseDelay;
+
+/*!
+ @abstract Number of requests received since the last reset.
+ */
+@property (nonatomic,readonly) NSUInteger requestCount;
+
+/*!
+ @abstract Number of connections accepted since the last reset.
+ */
+@property (nonatomic,readonly) NSUInteger connectionCount;
+
+/*!
+ @abstract Maximum number of requests in progress at the same time since the last reset.
+ @discussion A request is in progress from the moment it is read until its response is written.
+ */
+@property (nonatomic,readonly) NSUInteger maxConcurrentRequestCount;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Start listening on a free port.
+ @return NO if the listening socket can't be created.
+ */
+-(BOOL)start;
+
+/*!
+ @abstract Stop accepting connections.
+ */
+-(void)stop;
+
+/*!
+ @abstract Reset all counters to 0.
+ */
+-(void)resetCounters;
+
+@end
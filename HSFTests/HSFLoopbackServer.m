@@ -0,0 +1,225 @@
+//
+//  HSFLoopbackServer.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFLoopbackServer.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#define HSF_LOOPBACK_BACKLOG 16
+#define HSF_LOOPBACK_READ_SIZE 4096
+#define HSF_LOOPBACK_PATH @"/service"
+
+static NSString * const HSFLoopbackResponse =
+    @"<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+    @"<soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\">"
+    @"<soap:Body><LoopbackResponse><Result>ok</Result></LoopbackResponse></soap:Body>"
+    @"</soap:Envelope>";
+
+@interface HSFLoopbackServer(){
+    int _listener;
+    NSUInteger _activeRequestCount;
+}
+
+@property (strong,nonatomic,readwrite) NSURL *URL;
+@property (nonatomic,readwrite) NSUInteger requestCount;
+@property (nonatomic,readwrite) NSUInteger connectionCount;
+@property (nonatomic,readwrite) NSUInteger maxConcurrentRequestCount;
+
+@end
+
+@implementation HSFLoopbackServer
+
+#pragma mark Properties
+
+-(NSUInteger)requestCount
+{
+    @synchronized(self){
+        return _requestCount;
+    }
+}
+
+-(NSUInteger)connectionCount
+{
+    @synchronized(self){
+        return _connectionCount;
+    }
+}
+
+-(NSUInteger)maxConcurrentRequestCount
+{
+    @synchronized(self){
+        return _maxConcurrentRequestCount;
+    }
+}
+
+#pragma mark Public Methods
+
+-(id)init
+{
+    self = [super init];
+    if (self){
+        _listener = -1;
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    [self stop];
+}
+
+-(BOOL)start
+{
+    if (_listener >= 0) return YES;
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) return NO;
+
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) < 0
+        || listen(listener, HSF_LOOPBACK_BACKLOG) < 0
+        || getsockname(listener, (struct sockaddr*)&address, &length) < 0){
+        close(listener);
+        return NO;
+    }
+
+    _listener = listener;
+    self.URL = [NSURL URLWithString:[NSString stringWithFormat:@"http://127.0.0.1:%d%@",ntohs(address.sin_port),HSF_LOOPBACK_PATH]];
+    [NSThread detachNewThreadSelector:@selector(acceptConnectionsOnSocket:) toTarget:self withObject:@(listener)];
+    return YES;
+}
+
+-(void)stop
+{
+    if (_listener < 0) return;
+    // Shutdown wakes up the accept thread.
+    shutdown(_listener, SHUT_RDWR);
+    close(_listener);
+    _listener = -1;
+}
+
+-(void)resetCounters
+{
+    @synchronized(self){
+        _requestCount = 0;
+        _connectionCount = 0;
+        _maxConcurrentRequestCount = 0;
+    }
+}
+
+#pragma mark Private Methods
+
+-(void)acceptConnectionsOnSocket:(NSNumber*)listener
+{
+    while (YES){
+        int connection = accept([listener intValue], NULL, NULL);
+        if (connection < 0) return;
+        int yes = 1;
+        setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes));
+        @synchronized(self){
+            ++_connectionCount;
+        }
+        [NSThread detachNewThreadSelector:@selector(serveConnection:) toTarget:self withObject:@(connection)];
+    }
+}
+
+/*
+ Answer requests until the client closes the connection.
+ */
+-(void)serveConnection:(NSNumber*)socket
+{
+    int connection = [socket intValue];
+    NSMutableData *buffer = [[NSMutableData alloc] init];
+    while ([self readRequestFromConnection:connection buffer:buffer]){
+        @autoreleasepool {
+            @synchronized(self){
+                ++_requestCount;
+                ++_activeRequestCount;
+                _maxConcurrentRequestCount = MAX(_maxConcurrentRequestCount, _activeRequestCount);
+            }
+            NSTimeInterval delay = self.responseDelay;
+            if (delay > 0) [NSThread sleepForTimeInterval:delay];
+            // The request ends before the client can see the response, so the next request it sends is never counted together with this one.
+            @synchronized(self){
+                --_activeRequestCount;
+            }
+            if (![self writeData:[self responseData] toConnection:connection]) break;
+        }
+    }
+    close(connection);
+}
+
+/*
+ Read headers and Content-Length bytes of the body of the next request and remove them from the buffer. Returns NO if the connection is closed or the request is broken.
+ */
+-(BOOL)readRequestFromConnection:(int)connection buffer:(NSMutableData*)buffer
+{
+    NSData *headersEnd = [@"\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    NSRange range;
+    while ((range = [buffer rangeOfData:headersEnd options:0 range:NSMakeRange(0, [buffer length])]).location == NSNotFound){
+        if (![self readFromConnection:connection buffer:buffer]) return NO;
+    }
+
+    NSString *headers = [[NSString alloc] initWithBytes:[buffer bytes] length:range.location encoding:NSISOLatin1StringEncoding];
+    NSUInteger bodyLength = 0;
+    for (NSString *line in [headers componentsSeparatedByString:@"\r\n"]){
+        NSRange colon = [line rangeOfString:@":"];
+        if (colon.location == NSNotFound) continue;
+        NSString *name = [[line substringToIndex:colon.location] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        if ([name caseInsensitiveCompare:@"Content-Length"] == NSOrderedSame){
+            bodyLength = (NSUInteger)[[line substringFromIndex:NSMaxRange(colon)] integerValue];
+        }
+    }
+
+    NSUInteger requestLength = NSMaxRange(range) + bodyLength;
+    while ([buffer length] < requestLength){
+        if (![self readFromConnection:connection buffer:buffer]) return NO;
+    }
+    [buffer replaceBytesInRange:NSMakeRange(0, requestLength) withBytes:NULL length:0];
+    return YES;
+}
+
+-(BOOL)readFromConnection:(int)connection buffer:(NSMutableData*)buffer
+{
+    uint8_t bytes[HSF_LOOPBACK_READ_SIZE];
+    ssize_t count = recv(connection, bytes, sizeof(bytes), 0);
+    if (count <= 0) return NO;
+    [buffer appendBytes:bytes length:(NSUInteger)count];
+    return YES;
+}
+
+-(BOOL)writeData:(NSData*)data toConnection:(int)connection
+{
+    const uint8_t *bytes = [data bytes];
+    NSUInteger written = 0;
+    while (written < [data length]){
+        ssize_t count = send(connection, bytes + written, [data length] - written, 0);
+        if (count <= 0) return NO;
+        written += (NSUInteger)count;
+    }
+    return YES;
+}
+
+-(NSData*)responseData
+{
+    NSData *body = [HSFLoopbackResponse dataUsingEncoding:NSUTF8StringEncoding];
+    NSString *head = [NSString stringWithFormat:@"HTTP/1.1 200 OK\r\nContent-Type: text/xml; charset=utf-8\r\nContent-Length: %lu\r\nConnection: keep-alive\r\n\r\n",(unsigned long)[body length]];
+    NSMutableData *data = [NSMutableData dataWithData:[head dataUsingEncoding:NSASCIIStringEncoding]];
+    [data appendData:body];
+    return data;
+}
+
+@end
@@ -0,0 +1,17 @@
+//
+//  HSFMultipartParserTests.h
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFTestCase.h"
+
+/*!
+ @abstract Tests of HSFMultipartParser on bodies split into chunks.
+ @discussion Every body is parsed byte by byte, so delimiters, delimiter lines and part headers are broken at every place. Parts must come out the same as from the whole body.
+ */
+@interface HSFMultipartParserTests : HSFTestCase
+
+@end
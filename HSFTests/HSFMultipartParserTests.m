@@ -0,0 +1,197 @@
+//
+//  HSFMultipartParserTests.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFMultipartParserTests.h"
+#import "HSFMultipartParser.h"
+
+#define HSF_TEST_BOUNDARY @"MIMEBoundary"
+
+@interface HSFMultipartParserTests() <HSFMultipartParserDelegate>
+
+/*
+ Parsed parts, each one is a dictionary with headers, data and whether it was ended.
+ */
+@property (strong,nonatomic) NSMutableArray *parts;
+
+@end
+
+@implementation HSFMultipartParserTests
+
+#pragma mark Public Methods
+
+-(BOOL)run
+{
+    [self runTest:@"brokenDelimiter" block:^{ [self testBrokenDelimiter]; }];
+    [self runTest:@"partWithoutHeaders" block:^{ [self testPartWithoutHeaders]; }];
+    [self runTest:@"missingCloseDelimiter" block:^{ [self testMissingCloseDelimiter]; }];
+    [self runTest:@"rootPart" block:^{ [self testRootPart]; }];
+    return self.failureCount == 0;
+}
+
+#pragma mark Tests
+
+-(void)testBrokenDelimiter
+{
+    // Second part holds bytes which look like the start of a delimiter.
+    NSString *body = @"preamble\r\n"
+                      "--MIMEBoundary\r\n"
+                      "Content-Type: application/xop+xml\r\n"
+                      "Content-ID: <root@example.com>\r\n"
+                      "\r\n"
+                      "<Envelope/>\r\n"
+                      "--MIMEBoundary \t\r\n"
+                      "Content-ID: <data@example.com>\r\n"
+                      "Content-Description: folded\r\n"
+                      " line\r\n"
+                      "\r\n"
+                      "\r\n--MIMEBoundar\r\n--MIMEBoundarx-\r\n-\r\n"
+                      "\r\n--MIMEBoundary--\r\n"
+                      "epilogue\r\n--MIMEBoundary\r\n";
+    NSArray *expected = @[[self partWithHeaders:@{@"content-type":@"application/xop+xml",@"content-id":@"<root@example.com>"} data:@"<Envelope/>" ended:YES],
+                          [self partWithHeaders:@{@"content-id":@"<data@example.com>",@"content-description":@"folded line"} data:@"\r\n--MIMEBoundar\r\n--MIMEBoundarx-\r\n-\r\n" ended:YES]];
+    HSFMultipartParser *parser = [self parserWithBody:body];
+    HSFCheck(!parser.error, @"body is rejected: %@",parser.error);
+    HSFCheck(parser.isFinished, @"close delimiter is not reached");
+    HSFCheck([self.parts isEqualToArray:expected], @"parts are %@",self.parts);
+
+    NSArray *whole = [self.parts copy];
+    HSFMultipartParser *wholeParser = [[HSFMultipartParser alloc] initWithBoundary:HSF_TEST_BOUNDARY];
+    wholeParser.delegate = self;
+    self.parts = [[NSMutableArray alloc] init];
+    [wholeParser parseData:[body dataUsingEncoding:NSUTF8StringEncoding]];
+    HSFCheck([self.parts isEqualToArray:whole], @"whole body gives %@",self.parts);
+}
+
+-(void)testPartWithoutHeaders
+{
+    NSString *body = @"--MIMEBoundary\r\n"
+                      "\r\n"
+                      "no headers\r\n"
+                      "--MIMEBoundary\r\n"
+                      "\r\n"
+                      "\r\n"
+                      "--MIMEBoundary--";
+    NSArray *expected = @[[self partWithHeaders:@{} data:@"no headers" ended:YES],
+                          [self partWithHeaders:@{} data:@"" ended:YES]];
+    HSFMultipartParser *parser = [self parserWithBody:body];
+    HSFCheck(!parser.error, @"body is rejected: %@",parser.error);
+    HSFCheck(parser.isFinished, @"close delimiter is not reached");
+    HSFCheck([self.parts isEqualToArray:expected], @"parts are %@",self.parts);
+}
+
+-(void)testMissingCloseDelimiter
+{
+    NSArray *bodies = @[@"--MIMEBoundary\r\nContent-ID: <a>\r\n\r\ntruncated part",
+                        @"--MIMEBoundary\r\nContent-ID: <a>\r\n\r\ndata\r\n--MIMEBoundary",
+                        @"--MIMEBoundary\r\nContent-ID: <a>\r\n\r\ndata\r\n--MIMEBoundary-",
+                        @"--MIMEBoundary\r\nContent-ID: <a>\r\n"];
+    for (NSString *body in bodies){
+        HSFMultipartParser *parser = [self parserWithBody:body];
+        // Truncated body is not an error of the parser, loading fails when the connection finishes.
+        HSFCheck(!parser.error, @"%@ is rejected: %@",body,parser.error);
+        HSFCheck(!parser.isFinished, @"%@ is finished",body);
+    }
+
+    HSFMultipartParser *parser = [self parserWithBody:bodies[0]];
+    NSDictionary *part = [self.parts firstObject];
+    HSFCheck([self.parts count] == 1 && ![part[@"ended"] boolValue], @"truncated part is ended: %@",self.parts);
+    NSData *received = part[@"data"];
+    NSData *sent = [@"truncated part" dataUsingEncoding:NSUTF8StringEncoding];
+    HSFCheck([received length] <= [sent length] && [[sent subdataWithRange:NSMakeRange(0, [received length])] isEqualToData:received], @"truncated part gives %@",received);
+
+    // Nothing is parsed after the body is found broken.
+    parser = [self parserWithBody:@"--MIMEBoundary\r\nbroken header\r\n\r\ndata\r\n--MIMEBoundary--"];
+    HSFCheck(parser.error != nil, @"broken header is accepted");
+    HSFCheck([self.parts count] == 0, @"parts of broken body are %@",self.parts);
+}
+
+-(void)testRootPart
+{
+    NSString *body = @"--MIMEBoundary\r\n"
+                      "Content-ID: <image@example.com>\r\n"
+                      "\r\n"
+                      "image\r\n"
+                      "--MIMEBoundary\r\n"
+                      "Content-ID: <root.message@example.com>\r\n"
+                      "Content-Type: application/xop+xml\r\n"
+                      "\r\n"
+                      "<Envelope><xop:Include href=\"cid:image%40example.com\"/></Envelope>\r\n"
+                      "--MIMEBoundary--";
+    NSString *contentType = @"Multipart/Related; type=\"application/xop+xml\"; boundary=\"MIMEBoundary\"; start=\"<root.message@example.com>\"; start-info=\"text/xml\"";
+    NSString *mediaType;
+    NSDictionary *parameters = [HSFMultipartParser parametersOfContentType:contentType mediaType:&mediaType];
+    HSFCheck([mediaType isEqualToString:@"multipart/related"], @"media type is %@",mediaType);
+    HSFCheck([parameters[@"boundary"] isEqualToString:HSF_TEST_BOUNDARY], @"boundary is %@",parameters[@"boundary"]);
+
+    [self parserWithBody:body];
+    HSFCheck([self.parts count] == 2, @"parts are %@",self.parts);
+    NSString *start = [HSFMultipartParser contentIDFromString:parameters[@"start"]];
+    HSFCheck([[self rootPartForStart:start][@"data"] isEqualToData:[@"<Envelope><xop:Include href=\"cid:image%40example.com\"/></Envelope>" dataUsingEncoding:NSUTF8StringEncoding]], @"root part is %@",[self rootPartForStart:start]);
+    HSFCheck([[self rootPartForStart:nil][@"data"] isEqualToData:[@"image" dataUsingEncoding:NSUTF8StringEncoding]], @"root part without start is %@",[self rootPartForStart:nil]);
+    HSFCheck([self rootPartForStart:@"missing@example.com"] == nil, @"root part is found by missing start");
+
+    // Both forms of the same ID match.
+    NSString *href = [HSFMultipartParser contentIDFromString:@"cid:image%40example.com"];
+    NSString *header = [HSFMultipartParser contentIDFromString:[self.parts firstObject][@"headers"][@"content-id"]];
+    HSFCheck([href isEqualToString:header], @"%@ does not match %@",href,header);
+}
+
+#pragma mark Private Methods
+
+/*
+ Parse the body byte by byte.
+ */
+-(HSFMultipartParser*)parserWithBody:(NSString*)body
+{
+    self.parts = [[NSMutableArray alloc] init];
+    HSFMultipartParser *parser = [[HSFMultipartParser alloc] initWithBoundary:HSF_TEST_BOUNDARY];
+    parser.delegate = self;
+    NSData *data = [body dataUsingEncoding:NSUTF8StringEncoding];
+    for (NSUInteger i = 0; i < [data length]; ++i){
+        if (![parser parseData:[data subdataWithRange:NSMakeRange(i, 1)]]) break;
+    }
+    return parser;
+}
+
+/*
+ Root part as HSFCatcher picks it: the part with start Content-ID, or the first part if there is no start.
+ */
+-(NSDictionary*)rootPartForStart:(NSString*)start
+{
+    for (NSDictionary *part in self.parts){
+        NSString *contentID = part[@"headers"][@"content-id"];
+        contentID = contentID ? [HSFMultipartParser contentIDFromString:contentID] : nil;
+        if (!start || [start isEqualToString:contentID]) return part;
+    }
+    return nil;
+}
+
+-(NSDictionary*)partWithHeaders:(NSDictionary*)headers data:(NSString*)data ended:(BOOL)ended
+{
+    return @{@"headers":headers,@"data":[data dataUsingEncoding:NSUTF8StringEncoding],@"ended":@(ended)};
+}
+
+#pragma mark HSFMultipartParserDelegate
+
+-(void)multipartParser:(HSFMultipartParser *)parser didBeginPartWithHeaders:(NSDictionary *)headers
+{
+    [self.parts addObject:[@{@"headers":headers,@"data":[[NSMutableData alloc] init],@"ended":@NO} mutableCopy]];
+}
+
+-(void)multipartParser:(HSFMultipartParser *)parser didReceiveData:(NSData *)data
+{
+    // Data refers to the parser buffer, it is copied.
+    [[self.parts lastObject][@"data"] appendData:data];
+}
+
+-(void)multipartParserDidEndPart:(HSFMultipartParser *)parser
+{
+    [self.parts lastObject][@"ended"] = @YES;
+}
+
+@end
@@ -0,0 +1,17 @@
+//
+//  HSFNodeArchiveTests.h
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFTestCase.h"
+
+/*!
+ @abstract Round-trip tests of HSFNodeArchive.
+ @discussion Trees parsed by NSXMLParser, compact trees and trees built with addChild: are archived and read back. Names, values, attributes, structure and name searches of the archived tree must match the original tree. Archives with broken tables must be rejected.
+ */
+@interface HSFNodeArchiveTests : HSFTestCase
+
+@end
@@ -0,0 +1,294 @@
+//
+//  HSFNodeArchiveTests.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFNodeArchiveTests.h"
+#import "HSFNode+NSXMLParserDelegate.h"
+#import "HSFNodeArchive.h"
+#import "HSFNodePushParser.h"
+#import "HSFCommon.h"
+#import <libkern/OSByteOrder.h>
+
+// Words of the archive header and of a node record, see HSFNodeArchive.
+#define HSF_TEST_VERSION_WORD 1
+#define HSF_TEST_NODE_TABLE_OFFSET_WORD 5
+#define HSF_TEST_NODE_FIELD_COUNT 9
+#define HSF_TEST_NODE_VALUE_FIELD 1
+#define HSF_TEST_NODE_PARENT_FIELD 4
+
+static NSString * const HSFTestDocument =
+    @"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    @"<soap:Envelope xmlns:soap=\"http://schemas.xmlsoap.org/soap/envelope/\">\n"
+    @"  <soap:Body>\n"
+    @"    <GetItemsResponse>\n"
+    @"      <Item id=\"1\" kind=\"first\">One &amp; only</Item>\n"
+    @"      <Item id=\"2\"><Name>Second</Name><Name/><Note><![CDATA[<raw>]]></Note></Item>\n"
+    @"      <Empty></Empty>\n"
+    @"      <Text lang=\"fr\">café</Text>\n"
+    @"      <Item id=\"3\"><Item id=\"4\">Nested</Item></Item>\n"
+    @"    </GetItemsResponse>\n"
+    @"  </soap:Body>\n"
+    @"</soap:Envelope>\n";
+
+@implementation HSFNodeArchiveTests
+
+#pragma mark Public Methods
+
+-(BOOL)run
+{
+    [self runTest:@"parsedTree" block:^{ [self testParsedTree]; }];
+    [self runTest:@"compactTree" block:^{ [self testCompactTree]; }];
+    [self runTest:@"builtTree" block:^{ [self testBuiltTree]; }];
+    [self runTest:@"subtree" block:^{ [self testSubtree]; }];
+    [self runTest:@"stableArchive" block:^{ [self testStableArchive]; }];
+    [self runTest:@"archiveFile" block:^{ [self testArchiveFile]; }];
+    [self runTest:@"brokenArchives" block:^{ [self testBrokenArchives]; }];
+    [self runTest:@"searchOrder" block:^{ [self testSearchOrder]; }];
+    return self.failureCount == 0;
+}
+
+#pragma mark Tests
+
+-(void)testParsedTree
+{
+    NSError *error;
+    HSFNode *root = [HSFNode nodeTreeFromData:[self documentData] error:&error];
+    HSFCheck(!error, @"document is not parsed: %@",error);
+    [self checkRoundTripOfNode:root];
+}
+
+-(void)testCompactTree
+{
+    NSError *error;
+    HSFNode *root = [HSFNode compactNodeTreeFromData:[self documentData] error:&error];
+    HSFCheck(root && !error, @"document is not parsed: %@",error);
+    [self checkRoundTripOfNode:root];
+}
+
+-(void)testBuiltTree
+{
+    HSFNode *root = [[HSFNode alloc] initWithName:@"items"];
+    HSFNode *withoutValue = [[HSFNode alloc] initWithName:@"item"];
+    HSFNode *emptyValue = [[HSFNode alloc] initWithName:@"item"];
+    emptyValue.value = @"";
+    HSFNode *withValue = [[HSFNode alloc] initWithName:@"item"];
+    withValue.value = @"text";
+    withValue.attributes = @{@"id":@"3",@"kind":@"last"};
+    HSFNode *leaf = [[HSFNode alloc] initWithName:@"leaf"];
+    leaf.value = @"leaf";
+    [root addChild:withoutValue];
+    [root addChild:emptyValue];
+    [root addChild:withValue];
+    [withValue addChild:leaf];
+
+    HSFNode *archived = [self checkRoundTripOfNode:root];
+    NSArray *children = archived.children;
+    HSFCheck([children count] == 3, @"archived root has %lu children",(unsigned long)[children count]);
+    if ([children count] != 3) return;
+    HSFCheck(![children[0] hasValue] && [[children[0] value] isEqualToString:@""], @"node without value is read back with value '%@'",[children[0] value]);
+    HSFCheck([children[1] hasValue] && [[children[1] value] isEqualToString:@""], @"empty value is not kept");
+    HSFCheck([[children[2] value] isEqualToString:@"text"], @"value is read back as '%@'",[children[2] value]);
+}
+
+-(void)testSubtree
+{
+    HSFNode *root = [HSFNode nodeTreeFromData:[self documentData] error:NULL];
+    HSFNode *item = [[root searchNodeByName:@"Item"] parent];
+    HSFCheck([item.name isEqualToString:@"GetItemsResponse"], @"unexpected node %@",item.name);
+
+    HSFNode *archived = [self checkRoundTripOfNode:item];
+    HSFCheck(archived.parent == nil, @"archived node has parent");
+}
+
+-(void)testStableArchive
+{
+    HSFNode *root = [HSFNode nodeTreeFromData:[self documentData] error:NULL];
+    NSData *archive = [root archivedData];
+    HSFNode *archived = [HSFNode nodeTreeFromArchivedData:archive error:NULL];
+    HSFCheck([[archived archivedData] isEqualToData:archive], @"archive of the archived tree differs");
+    HSFCheck([[[HSFNode nodeTreeFromData:[self documentData] error:NULL] archivedData] isEqualToData:archive], @"archives of equal trees differ");
+}
+
+-(void)testArchiveFile
+{
+    HSFNode *root = [HSFNode nodeTreeFromData:[self documentData] error:NULL];
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    HSFCheck([[root archivedData] writeToFile:path atomically:YES], @"archive is not written to %@",path);
+
+    NSError *error;
+    HSFNodeArchive *archive = [[HSFNodeArchive alloc] initWithContentsOfFile:path error:&error];
+    HSFCheck(archive && !error, @"archive file is not read: %@",error);
+    if (archive){
+        HSFNode *archived = [[HSFNode alloc] initWithArena:archive index:0];
+        [self compareNode:root withNode:archived names:[self namesOfNode:root] path:@"root"];
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+}
+
+-(void)testBrokenArchives
+{
+    HSFNode *root = [HSFNode nodeTreeFromData:[self documentData] error:NULL];
+    NSData *archive = [root archivedData];
+
+    for (NSUInteger length = 0; length < [archive length]; length += 4){
+        [self checkArchiveIsRejected:[archive subdataWithRange:NSMakeRange(0, length)] reason:[NSString stringWithFormat:@"truncated to %lu bytes",(unsigned long)length]];
+    }
+
+    NSMutableData *data = [archive mutableCopy];
+    [self setWord:HSF_ARCHIVE_VERSION + 1 atIndex:HSF_TEST_VERSION_WORD ofData:data];
+    [self checkArchiveIsRejected:data reason:@"unknown version"];
+
+    NSUInteger nodeTable = [self wordAtIndex:HSF_TEST_NODE_TABLE_OFFSET_WORD ofData:archive] / 4;
+    data = [archive mutableCopy];
+    [self setWord:1 atIndex:nodeTable + HSF_TEST_NODE_FIELD_COUNT + HSF_TEST_NODE_PARENT_FIELD ofData:data];
+    [self checkArchiveIsRejected:data reason:@"node is its own parent"];
+
+    data = [archive mutableCopy];
+    [self setWord:UINT32_MAX - 1 atIndex:nodeTable + HSF_TEST_NODE_FIELD_COUNT + HSF_TEST_NODE_VALUE_FIELD ofData:data];
+    [self checkArchiveIsRejected:data reason:@"value is out of string table"];
+}
+
+/*
+ A child with the name is found before a deeper node which comes first in document order, in every kind of tree.
+ */
+-(void)testSearchOrder
+{
+    NSData *data = [@"<a><b><c x=\"nested\"/></b><c x=\"direct\"/></a>" dataUsingEncoding:NSUTF8StringEncoding];
+    NSError *error;
+    HSFNode *parsed = [HSFNode nodeTreeFromData:data error:&error];
+    HSFCheck(parsed && !error, @"document is not parsed: %@",error);
+    HSFNode *compact = [HSFNode compactNodeTreeFromData:data error:&error];
+    HSFCheck(compact && !error, @"document is not parsed compactly: %@",error);
+    HSFNodePushParser *pushParser = [[HSFNodePushParser alloc] initWithSymbolTable:nil];
+    [pushParser parseData:data];
+    HSFNode *pushed = [pushParser finishWithError:&error];
+    HSFCheck(pushed && !error, @"document is not push parsed: %@",error);
+    HSFNode *archived = [HSFNode nodeTreeFromArchivedData:[parsed archivedData] error:&error];
+    HSFCheck(archived && !error, @"archive is not read: %@",error);
+    
+    HSFNode *built = [[HSFNode alloc] initWithName:@"a"];
+    HSFNode *b = [[HSFNode alloc] initWithName:@"b"];
+    HSFNode *nested = [[HSFNode alloc] initWithName:@"c"];
+    nested.attributes = @{@"x":@"nested"};
+    HSFNode *direct = [[HSFNode alloc] initWithName:@"c"];
+    direct.attributes = @{@"x":@"direct"};
+    [b addChild:nested];
+    [built addChild:b];
+    [built addChild:direct];
+    
+    NSDictionary *trees = @{@"parsed":parsed ? [parsed searchNodeByName:@"a"] : [NSNull null],
+                            @"compact":compact ? [compact searchNodeByName:@"a"] : [NSNull null],
+                            @"pushed":pushed ? [pushed searchNodeByName:@"a"] : [NSNull null],
+                            @"archived":archived ? [archived searchNodeByName:@"a"] : [NSNull null],
+                            @"built":built};
+    for (NSString *kind in trees){
+        HSFNode *a = trees[kind];
+        if (![a isKindOfClass:[HSFNode class]]){
+            HSFCheck(NO, @"%@ tree has no element a",kind);
+            continue;
+        }
+        HSFNode *found = [a searchNodeByName:@"c"];
+        HSFCheck([found.attributes[@"x"] isEqualToString:@"direct"], @"%@ tree: found %@ c",kind,found.attributes[@"x"]);
+        HSFCheck([[a searchNodeByName:@"b"] searchNodeByName:@"c"] != nil, @"%@ tree: nested c is not found",kind);
+    }
+}
+
+#pragma mark Private Methods
+
+-(NSData*)documentData
+{
+    return [HSFTestDocument dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+/*
+ Archive the node, read it back and compare the trees. Returns the archived tree.
+ */
+-(HSFNode*)checkRoundTripOfNode:(HSFNode*)node
+{
+    NSError *error;
+    HSFNode *archived = [HSFNode nodeTreeFromArchivedData:[node archivedData] error:&error];
+    HSFCheck(archived && !error, @"archive is not read: %@",error);
+    if (!archived) return nil;
+    [self compareNode:node withNode:archived names:[self namesOfNode:node] path:node.name];
+    return archived;
+}
+
+-(void)compareNode:(HSFNode*)node withNode:(HSFNode*)archived names:(NSSet*)names path:(NSString*)path
+{
+    HSFCheck([node.name isEqualToString:archived.name], @"%@: name is '%@'",path,archived.name);
+    HSFCheck([node.value isEqualToString:archived.value], @"%@: value is '%@' instead of '%@'",path,archived.value,node.value);
+    HSFCheck(node.hasValue == archived.hasValue, @"%@: hasValue is %d",path,archived.hasValue);
+    NSDictionary *attributes = node.attributes ? node.attributes : @{};
+    NSDictionary *archivedAttributes = archived.attributes ? archived.attributes : @{};
+    HSFCheck([attributes isEqualToDictionary:archivedAttributes], @"%@: attributes are %@",path,archivedAttributes);
+
+    // Searches go through the name index of the archive.
+    for (NSString *name in names){
+        HSFNode *found = [node searchNodeByName:name];
+        HSFNode *archivedFound = [archived searchNodeByName:name];
+        HSFCheck([[self pathOfNode:found] isEqualToString:[self pathOfNode:archivedFound]], @"%@: search of %@ found %@ instead of %@",path,name,[self pathOfNode:archivedFound],[self pathOfNode:found]);
+        HSFCheck([node countOfNodesByName:name] == [archived countOfNodesByName:name], @"%@: count of %@ is %lu",path,name,(unsigned long)[archived countOfNodesByName:name]);
+    }
+
+    NSArray *children = node.children;
+    NSArray *archivedChildren = archived.children;
+    HSFCheck([children count] == [archivedChildren count], @"%@: %lu children instead of %lu",path,(unsigned long)[archivedChildren count],(unsigned long)[children count]);
+    if ([children count] != [archivedChildren count]) return;
+    for (NSUInteger i = 0; i < [children count]; ++i){
+        HSFNode *archivedChild = archivedChildren[i];
+        HSFCheck(archivedChild.parent == archived, @"%@: child %lu has other parent",path,(unsigned long)i);
+        [self compareNode:children[i] withNode:archivedChild names:names path:[NSString stringWithFormat:@"%@/%@[%lu]",path,archivedChild.name,(unsigned long)i]];
+    }
+}
+
+-(NSSet*)namesOfNode:(HSFNode*)node
+{
+    NSMutableSet *names = [[NSMutableSet alloc] init];
+    if (node.name) [names addObject:node.name];
+    for (HSFNode *child in node){
+        [names unionSet:[self namesOfNode:child]];
+    }
+    // Name which is not in the tree is searched too.
+    [names addObject:@"Missing"];
+    return names;
+}
+
+/*
+ Positions of the node and its ancestors, so nodes of different trees can be compared.
+ */
+-(NSString*)pathOfNode:(HSFNode*)node
+{
+    if (!node) return @"nil";
+    NSMutableArray *positions = [[NSMutableArray alloc] init];
+    for (HSFNode *current = node; current.parent; current = current.parent){
+        [positions insertObject:@([current.parent.children indexOfObjectIdenticalTo:current]) atIndex:0];
+    }
+    return [positions componentsJoinedByString:@"/"];
+}
+
+-(void)checkArchiveIsRejected:(NSData*)data reason:(NSString*)reason
+{
+    NSError *error;
+    HSFNode *archived = [HSFNode nodeTreeFromArchivedData:data error:&error];
+    HSFCheck(!archived, @"archive is read though %@",reason);
+    HSFCheck([[error domain] isEqualToString:HSFParseErrorDomain] && [error code] == HSF_ERROR_CODE_ARCHIVE_ERROR, @"archive %@ fails with %@",reason,error);
+}
+
+-(uint32_t)wordAtIndex:(NSUInteger)index ofData:(NSData*)data
+{
+    uint32_t word;
+    [data getBytes:&word range:NSMakeRange(index * 4, 4)];
+    return OSSwapLittleToHostInt32(word);
+}
+
+-(void)setWord:(uint32_t)word atIndex:(NSUInteger)index ofData:(NSMutableData*)data
+{
+    word = OSSwapHostToLittleInt32(word);
+    [data replaceBytesInRange:NSMakeRange(index * 4, 4) withBytes:&word];
+}
+
+@end
@@ -0,0 +1,17 @@
+//
+//  HSFNodeArenaTests.h
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFTestCase.h"
+
+/*!
+ @abstract Tests of well-formedness checks of compact trees.
+ @discussion Every document is parsed by NSXMLParser and compactly. Both must accept or reject it, so whether a response is a parse error does not depend on compactNodeTree of the action.
+ */
+@interface HSFNodeArenaTests : HSFTestCase
+
+@end
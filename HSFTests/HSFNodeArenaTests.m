@@ -0,0 +1,78 @@
+//
+//  HSFNodeArenaTests.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFNodeArenaTests.h"
+#import "HSFNode+NSXMLParserDelegate.h"
+
+@implementation HSFNodeArenaTests
+
+#pragma mark Public Methods
+
+-(BOOL)run
+{
+    [self runTest:@"wellFormedDocuments" block:^{ [self testWellFormedDocuments]; }];
+    [self runTest:@"malformedDocuments" block:^{ [self testMalformedDocuments]; }];
+    return self.failureCount == 0;
+}
+
+#pragma mark Tests
+
+-(void)testWellFormedDocuments
+{
+    NSArray *documents = @[@"<a/>",
+                           @"<a x=\"1\" y='2'/>",
+                           @"<a x = \"1\"\n\ty=\"&lt;&amp;&#38;&#x26;\">text &gt; &quot;&apos;</a>",
+                           @"<a:b xmlns:a=\"urn:a\" a:x=\"1\" x=\"2\"><a:c/></a:b>",
+                           @"<a><![CDATA[& < bare]]><!-- & --></a>",
+                           @"<a x=\"/\">café &#233;</a>"];
+    for (NSString *document in documents){
+        NSData *data = [document dataUsingEncoding:NSUTF8StringEncoding];
+        NSError *error;
+        HSFNode *parsed = [HSFNode nodeTreeFromData:data error:&error];
+        HSFCheck(parsed && !error, @"%@ is rejected by NSXMLParser: %@",document,error);
+        error = nil;
+        HSFNode *compact = [HSFNode compactNodeTreeFromData:data error:&error];
+        HSFCheck(compact && !error, @"%@ is rejected compactly: %@",document,error);
+        HSFNode *parsedRoot = [parsed.children firstObject];
+        HSFNode *compactRoot = [compact.children firstObject];
+        HSFCheck([parsedRoot.attributes isEqualToDictionary:compactRoot.attributes], @"%@: attributes %@ and %@",document,parsedRoot.attributes,compactRoot.attributes);
+        HSFCheck([parsedRoot.value isEqualToString:compactRoot.value], @"%@: values '%@' and '%@'",document,parsedRoot.value,compactRoot.value);
+    }
+}
+
+-(void)testMalformedDocuments
+{
+    NSArray *documents = @[@"<a x/>",
+                           @"<a x=1/>",
+                           @"<a x=\"1\"y=\"2\"/>",
+                           @"<a x=\"1\" x=\"2\"/>",
+                           @"<a x=\"<\"/>",
+                           @"<a x=\"&\"/>",
+                           @"<a x=\"&unknown;\"/>",
+                           @"<a>&</a>",
+                           @"<a>fish & chips</a>",
+                           @"<a>&nbsp;</a>",
+                           @"<a>&#0;</a>",
+                           @"<a>&#xZZ;</a>",
+                           @"<a>&#x110000;</a>",
+                           @"<a>&lt</a>",
+                           @"<1a/>",
+                           @"<a =\"1\"/>",
+                           @"<a></b>"];
+    for (NSString *document in documents){
+        NSData *data = [document dataUsingEncoding:NSUTF8StringEncoding];
+        NSError *error;
+        [HSFNode nodeTreeFromData:data error:&error];
+        HSFCheck(error != nil, @"%@ is accepted by NSXMLParser",document);
+        error = nil;
+        HSFNode *compact = [HSFNode compactNodeTreeFromData:data error:&error];
+        HSFCheck(!compact && error, @"%@ is accepted compactly",document);
+    }
+}
+
+@end
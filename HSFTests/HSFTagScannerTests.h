@@ -0,0 +1,17 @@
+//
+//  HSFTagScannerTests.h
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFTestCase.h"
+
+/*!
+ @abstract Tests of HSFTagScanner on responses split into chunks.
+ @discussion Every document is scanned whole, then split in two at every byte offset and byte by byte. Elements and streaming content must come out the same however the document is split, also when it is broken inside a tag name, a comment, a CDATA section or a multibyte character.
+ */
+@interface HSFTagScannerTests : HSFTestCase
+
+@end
@@ -0,0 +1,144 @@
+//
+//  HSFTagScannerTests.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFTagScannerTests.h"
+#import "HSFTagScanner.h"
+
+@interface HSFTagScannerTests() <HSFTagScannerDelegate>
+
+/*
+ Elements and completed streaming contents in the order they were scanned.
+ */
+@property (strong,nonatomic) NSMutableArray *events;
+
+/*
+ Pieces of streaming content collected until the last chunk.
+ */
+@property (strong,nonatomic) NSMutableData *content;
+
+@end
+
+@implementation HSFTagScannerTests
+
+#pragma mark Public Methods
+
+-(BOOL)run
+{
+    [self runTest:@"unitTags" block:^{ [self testUnitTags]; }];
+    [self runTest:@"streamingTags" block:^{ [self testStreamingTags]; }];
+    [self runTest:@"pathSelectors" block:^{ [self testPathSelectors]; }];
+    return self.failureCount == 0;
+}
+
+#pragma mark Tests
+
+-(void)testUnitTags
+{
+    NSString *document = @"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                          "<Envelope><Body>"
+                          "<!-- <Order>commented</Order> -->"
+                          "<![CDATA[<Order>cdata</Order>]]>"
+                          "<Order id=\"1\">café</Order>"
+                          "<OrderList/>"
+                          "<Order id=\"2\"><Name>Ünïcødé ✓ 𝄞</Name><!-- </Order> --></Order>"
+                          "</Body></Envelope>";
+    NSArray *expected = @[@"Order: <Order id=\"1\">café</Order>",
+                          @"Order: <Order id=\"2\"><Name>Ünïcødé ✓ 𝄞</Name><!-- </Order> --></Order>"];
+    [self checkDocument:document tags:@[@"Order"] streamingTags:@[] expected:expected];
+}
+
+-(void)testStreamingTags
+{
+    NSString *document = @"<Envelope><Body>"
+                          "<Item>первый</Item>"
+                          "<!-- <Note>commented</Note> -->"
+                          "<Note>naïve — 𝄞 <![CDATA[<b>]]> текст</Note>"
+                          "<Item>второй 𝄞</Item>"
+                          "</Body></Envelope>";
+    NSArray *expected = @[@"Item: <Item>первый</Item>",
+                          @"Note: naïve — 𝄞 <![CDATA[<b>]]> текст",
+                          @"Item: <Item>второй 𝄞</Item>"];
+    [self checkDocument:document tags:@[@"Item",@"Note"] streamingTags:@[@"Note"] expected:expected];
+}
+
+-(void)testPathSelectors
+{
+    NSString *document = @"<Envelope><Body>"
+                          "<Orders><!-- <Order>commented</Order> --><Order>ä</Order></Orders>"
+                          "<Order>outside</Order>"
+                          "<Orders><Order><![CDATA[</Order>]]>ö</Order></Orders>"
+                          "</Body></Envelope>";
+    NSArray *expected = @[@"Orders/Order: <Order>ä</Order>",
+                          @"Orders/Order: <Order><![CDATA[</Order>]]>ö</Order>"];
+    [self checkDocument:document tags:@[@"Orders/Order"] streamingTags:@[] expected:expected];
+}
+
+#pragma mark Private Methods
+
+/*
+ Scan the document whole, in two chunks split at every offset and byte by byte.
+ */
+-(void)checkDocument:(NSString*)document tags:(NSArray*)tags streamingTags:(NSArray*)streamingTags expected:(NSArray*)expected
+{
+    NSData *data = [document dataUsingEncoding:NSUTF8StringEncoding];
+    NSArray *whole = [self eventsOfData:data tags:tags streamingTags:streamingTags chunkLengths:@[@([data length])]];
+    HSFCheck([whole isEqualToArray:expected], @"unsplit document gives %@",whole);
+
+    for (NSUInteger offset = 1; offset < [data length]; ++offset){
+        NSArray *lengths = @[@(offset),@([data length] - offset)];
+        NSArray *split = [self eventsOfData:data tags:tags streamingTags:streamingTags chunkLengths:lengths];
+        HSFCheck([split isEqualToArray:whole], @"split at %lu gives %@",(unsigned long)offset,split);
+    }
+
+    NSMutableArray *bytes = [[NSMutableArray alloc] init];
+    for (NSUInteger i = 0; i < [data length]; ++i){
+        [bytes addObject:@1];
+    }
+    NSArray *byByte = [self eventsOfData:data tags:tags streamingTags:streamingTags chunkLengths:bytes];
+    HSFCheck([byByte isEqualToArray:whole], @"byte by byte gives %@",byByte);
+}
+
+-(NSArray*)eventsOfData:(NSData*)data tags:(NSArray*)tags streamingTags:(NSArray*)streamingTags chunkLengths:(NSArray*)chunkLengths
+{
+    self.events = [[NSMutableArray alloc] init];
+    self.content = [[NSMutableData alloc] init];
+    HSFTagScanner *scanner = [[HSFTagScanner alloc] initWithTags:tags streamingTags:streamingTags];
+    scanner.delegate = self;
+    NSUInteger location = 0;
+    for (NSNumber *length in chunkLengths){
+        // Chunks are copied, as they come from the connection.
+        [scanner scanData:[data subdataWithRange:NSMakeRange(location, [length unsignedIntegerValue])]];
+        location += [length unsignedIntegerValue];
+    }
+    HSFCheck(!scanner.isInElement, @"scanner is left inside of an element");
+    return [self.events copy];
+}
+
+-(NSString*)eventWithTag:(NSString*)tag data:(NSData*)data
+{
+    NSString *string = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    return [NSString stringWithFormat:@"%@: %@",tag,string ? string : @"<invalid UTF-8>"];
+}
+
+#pragma mark HSFTagScannerDelegate
+
+-(void)tagScanner:(HSFTagScanner *)scanner didScanElement:(NSData *)element forTag:(NSString *)tag
+{
+    [self.events addObject:[self eventWithTag:tag data:element]];
+}
+
+-(void)tagScanner:(HSFTagScanner *)scanner didScanContent:(NSData *)content forTag:(NSString *)tag lastChunk:(BOOL)lastChunk
+{
+    // Content refers to the chunk, it is copied.
+    [self.content appendData:content];
+    if (!lastChunk) return;
+    [self.events addObject:[self eventWithTag:tag data:self.content]];
+    [self.content setLength:0];
+}
+
+@end
@@ -0,0 +1,48 @@
+//
+//  HSFTestCase.h
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/*!
+ @abstract Check a condition inside a test, the message is printed if it fails.
+ */
+#define HSFCheck(condition, ...) [self check:(condition) line:__LINE__ format:__VA_ARGS__]
+
+/*!
+ @abstract Base class of test suites.
+ @discussion A subclass runs its tests with runTest:block: from run and checks conditions with HSFCheck.
+ */
+@interface HSFTestCase : NSObject
+
+/*!
+ @abstract Number of failed checks so far.
+ */
+@property (nonatomic,readonly) NSUInteger failureCount;
+
+#pragma mark Tasks
+
+/*!
+ @abstract Run all tests.
+ @discussion Every failed check is printed to stderr. Abstract, must be customized in a subclass.
+ @return YES if all checks passed.
+ */
+-(BOOL)run;
+
+/*!
+ @abstract Run one test and print whether it passed.
+ @param name Name of the test, used in failure messages.
+ @param block Body of the test.
+ */
+-(void)runTest:(NSString*)name block:(void (^)(void))block;
+
+/*!
+ @abstract Count a failure and print the message if condition is NO. Use HSFCheck instead.
+ */
+-(void)check:(BOOL)condition line:(int)line format:(NSString*)format, ... NS_FORMAT_FUNCTION(3,4);
+
+@end
@@ -0,0 +1,53 @@
+//
+//  HSFTestCase.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import "HSFTestCase.h"
+
+@interface HSFTestCase()
+
+@property (nonatomic,readwrite) NSUInteger failureCount;
+
+/*
+ Name of the running test, for failure messages.
+ */
+@property (strong,nonatomic) NSString *testName;
+
+@end
+
+@implementation HSFTestCase
+
+#pragma mark Public Methods
+
+-(BOOL)run
+{
+    [NSException raise:NSInternalInconsistencyException format:@"%@ must implement %@.",[self class],NSStringFromSelector(_cmd)];
+    return NO;
+}
+
+-(void)runTest:(NSString*)name block:(void (^)(void))block
+{
+    @autoreleasepool {
+        self.testName = name;
+        NSUInteger failures = self.failureCount;
+        block();
+        printf("%s: %s\n",[name UTF8String],failures == self.failureCount ? "passed" : "FAILED");
+    }
+}
+
+-(void)check:(BOOL)condition line:(int)line format:(NSString*)format, ...
+{
+    if (condition) return;
+    ++self.failureCount;
+    va_list arguments;
+    va_start(arguments, format);
+    NSString *message = [[NSString alloc] initWithFormat:format arguments:arguments];
+    va_end(arguments);
+    fprintf(stderr, "%s:%d: %s: %s\n",[NSStringFromClass([self class]) UTF8String],line,[self.testName UTF8String],[message UTF8String]);
+}
+
+@end
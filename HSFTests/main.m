@@ -0,0 +1,31 @@
+//
+//  main.m
+//  HSFTests
+//
+//  Created by Ilnar Aliullov on 31/05/14.
+//  Copyright (c) 2014 Ilnar Aliullov. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "HSFNodeArchiveTests.h"
+#import "HSFNodeArenaTests.h"
+#import "HSFTagScannerTests.h"
+#import "HSFMultipartParserTests.h"
+#import "HSFClientLoopbackTests.h"
+
+int main(int argc, const char * argv[])
+{
+    NSUInteger failureCount = 0;
+    @autoreleasepool {
+        NSArray *suites = @[[[HSFNodeArchiveTests alloc] init],[[HSFNodeArenaTests alloc] init],[[HSFTagScannerTests alloc] init],[[HSFMultipartParserTests alloc] init],[[HSFClientLoopbackTests alloc] init]];
+        for (HSFTestCase *suite in suites){
+            [suite run];
+            failureCount += suite.failureCount;
+        }
+    }
+    if (failureCount){
+        fprintf(stderr, "%lu checks failed\n", (unsigned long)failureCount);
+        return 1;
+    }
+    return 0;
+}